@@ -20,6 +20,10 @@
 #include "gpos/version.h"
 #include "gpopt/version.h"
 
+extern "C" {
+#include "optimizer/optprofile.h"
+}
+
 extern "C" {
 
 PG_MODULE_MAGIC_CPP;
@@ -86,10 +90,12 @@ PG_FUNCTION_INFO_V1(Optimize);
 Datum EvalExprFromDXLFile(PG_FUNCTION_ARGS);
 Datum OptimizeMinidumpFromFile(PG_FUNCTION_ARGS);
 Datum ExecuteMinidumpFromFile(PG_FUNCTION_ARGS);
+Datum BenchmarkMinidumpFromFile(PG_FUNCTION_ARGS);
 
 PG_FUNCTION_INFO_V1(EvalExprFromDXLFile);
 PG_FUNCTION_INFO_V1(OptimizeMinidumpFromFile);
 PG_FUNCTION_INFO_V1(ExecuteMinidumpFromFile);
+PG_FUNCTION_INFO_V1(BenchmarkMinidumpFromFile);
 } // end extern C
 
 
@@ -577,6 +583,141 @@ ExecuteMinidumpFromFile(PG_FUNCTION_ARGS)
 }
 
 
+//---------------------------------------------------------------------------
+//	@function:
+//		compareLatencies
+//
+//	@doc:
+//		qsort comparator for optimization latencies
+//
+//---------------------------------------------------------------------------
+
+static int compareLatencies(const void *pvA, const void *pvB)
+{
+	double dA = *(const double *) pvA;
+	double dB = *(const double *) pvB;
+
+	return (dA > dB) - (dA < dB);
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		getPercentile
+//
+//	@doc:
+//		Return the nearest-rank percentile of a sorted array of latencies
+//
+//---------------------------------------------------------------------------
+
+static double getPercentile(const double *rgdLatencies, int iCount, int iPercentile)
+{
+	int iRank = (iCount * iPercentile + 99) / 100;
+
+	return rgdLatencies[Max(iRank, 1) - 1];
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		getPlanCost
+//
+//	@doc:
+//		Return the total cost of the root of a plan serialized as DXL, the
+//		first cost in the document
+//
+//---------------------------------------------------------------------------
+
+static char *getPlanCost(const char *szPlanDXL)
+{
+	const char *szAttr = "TotalCost=\"";
+	const char *szStart = strstr(szPlanDXL, szAttr);
+	if (NULL == szStart)
+	{
+		return pstrdup("unknown");
+	}
+
+	szStart += strlen(szAttr);
+	const char *szEnd = strchr(szStart, '"');
+	if (NULL == szEnd)
+	{
+		return pstrdup("unknown");
+	}
+
+	return pnstrdup(szStart, szEnd - szStart);
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		BenchmarkMinidumpFromFile
+//
+//	@doc:
+//		Loads a minidump from the given file path and optimizes it the given
+//		number of times. Returns the percentiles of the optimization latency,
+//		the peak size of the optimizer's memory pool and the cost of the plan.
+//
+//---------------------------------------------------------------------------
+
+extern "C" {
+Datum
+BenchmarkMinidumpFromFile(PG_FUNCTION_ARGS)
+{
+	char *szFileName = text_to_cstring(PG_GETARG_TEXT_P(0));
+	int iIterations = PG_GETARG_INT32(1);
+	if (0 >= iIterations)
+	{
+		elog(ERROR, "number of iterations must be positive");
+	}
+
+	double *rgdLatencies = (double *) palloc(iIterations * sizeof(double));
+	uint64 ullMemoryPeak = 0;
+	char *szCost = NULL;
+
+	for (int i = 0; i < iIterations; i++)
+	{
+		char *szResultDXL = COptTasks::SzOptimizeMinidumpFromFile(szFileName);
+		if (NULL == szResultDXL)
+		{
+			elog(NOTICE, "Execution of UDF 'BenchmarkMinidumpFromFile' failed. Consult the LOG for more information.");
+
+			// return a dummy value
+			PG_RETURN_NULL();
+		}
+
+		const OptProfile *pprof = GetOptProfile();
+		rgdLatencies[i] = pprof->totalTime;
+		ullMemoryPeak = Max(ullMemoryPeak, pprof->memoryPeak);
+
+		// the plan is the same in every iteration
+		if (NULL == szCost)
+		{
+			szCost = getPlanCost(szResultDXL);
+		}
+		gpdb::GPDBFree(szResultDXL);
+	}
+
+	qsort(rgdLatencies, iIterations, sizeof(double), compareLatencies);
+
+	StringInfoData str;
+	initStringInfo(&str);
+	appendStringInfo(&str, "iterations: %d", iIterations);
+	appendStringInfo(&str, ", p50: %.3f ms", getPercentile(rgdLatencies, iIterations, 50));
+	appendStringInfo(&str, ", p90: %.3f ms", getPercentile(rgdLatencies, iIterations, 90));
+	appendStringInfo(&str, ", p99: %.3f ms", getPercentile(rgdLatencies, iIterations, 99));
+	appendStringInfo(&str, ", max: %.3f ms", rgdLatencies[iIterations - 1]);
+	appendStringInfo(&str, ", memory peak: " UINT64_FORMAT " kB", (ullMemoryPeak + 1023) / 1024);
+	appendStringInfo(&str, ", cost: %s", szCost);
+	text *ptResult = cstring_to_text(str.data);
+
+	pfree(rgdLatencies);
+	pfree(szCost);
+
+	PG_RETURN_TEXT_P(ptResult);
+}
+}
+
+
 //---------------------------------------------------------------------------
 //	@function:
 //		RestorePlanDXL
@@ -0,0 +1,54 @@
+#ifndef INCLUDE_CODEC_H_
+#define INCLUDE_CODEC_H_
+
+#include "s3common_headers.h"
+#include "s3exception.h"
+#include "s3macros.h"
+#include "s3params.h"
+
+// Number of leading bytes needed to detect the compression type of a file.
+#define S3_MAGIC_BYTES_NUM 4
+
+// Streaming compressor of a codec, which generates one frame from all input data.
+class Compressor {
+   public:
+    virtual ~Compressor() {
+    }
+
+    // Compress len bytes of data and append the output (if any) to out. Data might be buffered
+    // inside the codec, until more data comes or finish() is called.
+    virtual void compress(const char *in, uint64_t len, vector<char> &out) = 0;
+
+    // Flush data buffered inside the codec and end the frame.
+    virtual void finish(vector<char> &out) = 0;
+};
+
+// Streaming decompressor of a codec, concatenated frames are decompressed one by one.
+class Decompressor {
+   public:
+    virtual ~Decompressor() {
+    }
+
+    // Decompress from in to out. On return, inLen is updated to the size of data consumed and
+    // outLen to the size of data generated. Return true if the current frame is finished.
+    virtual bool decompress(const char *in, uint64_t &inLen, char *out, uint64_t &outLen) = 0;
+};
+
+// Create codec for compressionType, throw S3RuntimeError if gpcloud is built without the codec.
+// Gzip is not created here, it's handled by CompressWriter and DecompressReader.
+Compressor *NewCompressor(S3CompressionType compressionType);
+Decompressor *NewDecompressor(S3CompressionType compressionType);
+
+// Detect compression type from the first len bytes of a file.
+S3CompressionType DetectCompressionType(const unsigned char *magic, uint64_t len);
+
+// Parse codec name used in config file and URL, return false if name is unknown.
+bool ParseCompressionType(const string &name, S3CompressionType &compressionType);
+
+// Codec name used in config file and URL, e.g. "zstd".
+string GetCompressionName(S3CompressionType compressionType);
+
+// File name extension of compressed file, e.g. ".gz".
+string GetCompressionExt(S3CompressionType compressionType);
+
+#endif
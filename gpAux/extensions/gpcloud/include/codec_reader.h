@@ -0,0 +1,54 @@
+#ifndef INCLUDE_CODEC_READER_H_
+#define INCLUDE_CODEC_READER_H_
+
+#include "codec.h"
+#include "reader.h"
+#include "s3common_headers.h"
+#include "s3exception.h"
+#include "s3macros.h"
+
+// Decompress data of a streaming codec (zstd or lz4) read from the underlying reader.
+// Concatenated frames are decompressed one by one, data following the last frame is ignored.
+class CodecReader : public Reader {
+   public:
+    CodecReader();
+    virtual ~CodecReader();
+
+    // Compression type is taken from params.
+    virtual void open(const S3Params &params);
+
+    // Initialize decompression only, for upstream reader which is already opened.
+    void openWithoutReader(S3CompressionType compressionType);
+
+    // read() attempts to read up to count bytes into the buffer.
+    // Return 0 if EOF. Throw exception if encounters errors.
+    virtual uint64_t read(char *buf, uint64_t count);
+
+    // This should be reentrant, has no side effects when called multiple times.
+    virtual void close();
+
+    void setReader(Reader *reader);
+
+    void resizeCodecReaderBuffer(uint64_t size);
+
+   private:
+    void readInput();
+    bool startNextFrame();
+
+    Reader *reader;
+    Decompressor *decompressor;
+    S3CompressionType compressionType;
+
+    vector<char> in;    // Input buffer for decompression.
+    uint64_t inOffset;  // Next position to decompress in input buffer.
+    uint64_t inLen;     // Size of data in input buffer.
+
+    bool isInputEnd;  // No more data from upstream reader.
+    bool isFrameEnd;  // Current frame is finished.
+    bool isEOF;
+
+    // add this flag to make close() reentrant
+    bool isClosed;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef INCLUDE_CODEC_WRITER_H_
+#define INCLUDE_CODEC_WRITER_H_
+
+#include "codec.h"
+#include "s3common_headers.h"
+#include "s3exception.h"
+#include "s3macros.h"
+#include "writer.h"
+
+// Compress data with a streaming codec (zstd or lz4) before passing it to the underlying writer.
+class CodecWriter : public Writer {
+   public:
+    CodecWriter();
+    virtual ~CodecWriter();
+
+    virtual void open(const S3Params &params);
+
+    // write() attempts to write up to count bytes from the buffer.
+    // Always return 0 if EOF, no matter how many times it's invoked. Throw exception if encounters
+    // errors.
+    virtual uint64_t write(const char *buf, uint64_t count);
+
+    // This should be reentrant, has no side effects when called multiple times.
+    virtual void close();
+
+    void setWriter(Writer *writer);
+
+   private:
+    void flush();
+
+    Writer *writer;
+    Compressor *compressor;
+
+    vector<char> out;  // Compressed data not written to underlying writer yet.
+
+    // add this flag to make close() reentrant
+    bool isClosed;
+};
+
+#endif
@@ -9,6 +9,25 @@
 // 2MB by default
 extern uint64_t S3_ZIP_COMPRESS_CHUNKSIZE;
 
+// A block of input data compressed by a compression thread, independent of other blocks.
+struct CompressBlock {
+    CompressBlock() : crc(0), inputLen(0), isLast(false), isDone(false) {
+    }
+
+    vector<char> in;    // uncompressed data
+    vector<char> dict;  // tail of previous block, to keep compression ratio close to serial mode
+    vector<char> out;   // raw deflate data, ends at a byte boundary
+
+    uLong crc;          // crc32 of uncompressed data
+    uint64_t inputLen;  // size of uncompressed data
+
+    bool isLast;
+    bool isDone;
+    string error;  // not empty if compression failed
+};
+
+// With compress threads more than one, input is split into blocks compressed in parallel, and
+// the raw deflate data of blocks is concatenated into one gzip member, as pigz does.
 class CompressWriter : public Writer {
    public:
     CompressWriter();
@@ -27,9 +46,19 @@ class CompressWriter : public Writer {
     void setWriter(Writer *writer);
 
    private:
+    static void *CompressThreadFunc(void *data);
+    static void compressBlock(CompressBlock *block);
+
     void flush();
     uint64_t writeOneChunk(const char *buf, uint64_t count);
 
+    void openParallel();
+    uint64_t writeParallel(const char *buf, uint64_t count);
+    void closeParallel();
+    void submitBlock(bool isLast);
+    void writeFinishedBlocks(bool waitForAll);
+    void stopCompressThreads();
+
     Writer *writer;
 
     // zlib related variables.
@@ -38,6 +67,23 @@ class CompressWriter : public Writer {
 
     // add this flag to make close() reentrant
     bool isClosed;
+
+    uint64_t threadNum;
+
+    // Blocks submitted but not written yet, in the order of input.
+    std::deque<CompressBlock *> pendingBlocks;
+    // Blocks waiting for a compression thread.
+    std::deque<CompressBlock *> queuedBlocks;
+    CompressBlock *curBlock;
+
+    uLong totalCrc;
+    uint64_t totalLen;
+
+    vector<pthread_t> threads;
+    pthread_mutex_t blockMutex;
+    pthread_cond_t queuedCond;
+    pthread_cond_t doneCond;
+    bool isStopping;
 };
 
 #endif
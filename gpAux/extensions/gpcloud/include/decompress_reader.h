@@ -10,6 +10,11 @@
 // 2MB by default
 extern uint64_t S3_ZIP_DECOMPRESS_CHUNKSIZE;
 
+// Number of output buffers, decompression thread fills one while reader consumes another.
+#define S3_ZIP_DECOMPRESS_BUFFER_NUM 2
+
+// Data is decompressed by a separate thread, pipelined with downloading and the caller of read().
+// Multi-member gzip files (e.g. concatenated gzip files) are decompressed member by member.
 class DecompressReader : public Reader {
    public:
     DecompressReader();
@@ -17,6 +22,9 @@ class DecompressReader : public Reader {
 
     virtual void open(const S3Params &params);
 
+    // Initialize decompression only, for upstream reader which is already opened.
+    void openWithoutReader();
+
     // read() attempts to read up to count bytes into the buffer.
     // Return 0 if EOF. Throw exception if encounters errors.
     virtual uint64_t read(char *buf, uint64_t count);
@@ -29,20 +37,45 @@ class DecompressReader : public Reader {
     void resizeDecompressReaderBuffer(uint64_t size);
 
    private:
-    void decompress();
+    static void *DecompressThreadFunc(void *data);
 
-    uint64_t getDecompressedBytesNum() {
-        return S3_ZIP_DECOMPRESS_CHUNKSIZE - this->zstream.avail_out;
-    }
+    uint64_t decompress(char *out);
+    bool readInput();
+    bool startNextMember();
+
+    void startDecompressThread();
+    void stopDecompressThread();
 
     Reader *reader;
 
     // zlib related variables.
     z_stream zstream;
-    char *in;            // Input buffer for decompression.
-    char *out;           // Output buffer for decompression.
+    char *in;  // Input buffer for decompression.
+
+    // Ring of output buffers, filled by decompression thread in order.
+    char *out[S3_ZIP_DECOMPRESS_BUFFER_NUM];
+    uint64_t outLen[S3_ZIP_DECOMPRESS_BUFFER_NUM];
+    uint64_t readIndex;  // Buffer to read by read().
+    uint64_t fillIndex;  // Buffer to fill by decompression thread.
+    uint64_t filledNum;  // Number of buffers ready to read.
     uint64_t outOffset;  // Next position to read in out buffer.
 
+    bool isInputEnd;   // No more data from upstream reader.
+    bool isStreamEnd;  // Current gzip member is finished.
+    bool isEOF;        // Decompression thread finished, no more buffer is filled.
+    bool isStopping;
+    std::exception_ptr sharedException;
+
+    pthread_t thread;
+    bool isThreadStarted;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    // Statistics for debug log.
+    uint64_t memberNum;
+    uint64_t decompressedBytes;
+    uint64_t inflateNanos;
+
     bool isClosed;
 };
 
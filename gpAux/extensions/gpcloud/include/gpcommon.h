@@ -24,4 +24,8 @@ typedef struct GpId {
 } GpId;
 extern GpId GpIdentity;
 
+// session id and command count, which identify a query on all segments
+extern int gp_session_id;
+extern int gp_command_count;
+
 #endif
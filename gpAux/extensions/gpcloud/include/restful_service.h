@@ -127,6 +127,17 @@ class Response {
     S3VectorUInt8 dataBuffer;
 };
 
+// DataReceiver takes the response body piece by piece as it arrives, so that the body could be
+// consumed before it is completely downloaded.
+class DataReceiver {
+   public:
+    virtual ~DataReceiver() {
+    }
+
+    // Return false to abort the transfer.
+    virtual bool receive(const char* ptr, uint64_t size) = 0;
+};
+
 class RESTfulService {
    public:
     RESTfulService() {
@@ -136,6 +147,24 @@ class RESTfulService {
 
     virtual Response get(const string& url, HTTPHeaders& headers) = 0;
 
+    // Same as get(), but successful response body is handed to receiver instead of being kept in
+    // Response. By default the body is handed over after it is completely downloaded.
+    virtual Response streamingGet(const string& url, HTTPHeaders& headers,
+                                  DataReceiver& receiver) {
+        Response response = this->get(url, headers);
+
+        if (response.isSuccess()) {
+            S3VectorUInt8& data = response.getRawData();
+            if (!data.empty() && !receiver.receive((const char*)data.data(), data.size())) {
+                response.setStatus(RESPONSE_ERROR);
+                response.setMessage("Data is rejected by receiver");
+            }
+            data.release();
+        }
+
+        return response;
+    }
+
     virtual Response put(const string& url, HTTPHeaders& headers, const S3VectorUInt8& data) = 0;
 
     virtual Response post(const string& url, HTTPHeaders& headers, const vector<uint8_t>& data) = 0;
@@ -5,6 +5,7 @@
 #include "s3common_headers.h"
 #include "s3exception.h"
 #include "s3interface.h"
+#include "s3key_manifest.h"
 
 // S3BucketReader read multiple files in a bucket.
 class S3BucketReader : public Reader {
@@ -28,6 +29,10 @@ class S3BucketReader : public Reader {
         return keyList;
     }
 
+    const vector<uint64_t> &getSegmentKeys() const {
+        return segmentKeys;
+    }
+
    private:
     S3Params params;
 
@@ -45,9 +50,11 @@ class S3BucketReader : public Reader {
     // copy valid data into buf and return its size.
     uint64_t readWithoutHeaderLine(char *buf, uint64_t count);
 
-    ListBucketResult keyList;  // List of matched keys/files.
-    uint64_t keyIndex;         // BucketContent index of keylist->contents.
+    ListBucketResult keyList;       // List of matched keys/files.
+    vector<uint64_t> segmentKeys;  // Indexes of keyList.contents to be read by this segment.
+    uint64_t keyIndex;             // Next index of segmentKeys.
 
+    void distributeKeys();
     BucketContent &getNextKey();
     S3Params constructReaderParams(BucketContent &key);
 };
@@ -11,10 +11,13 @@
 #include <pthread.h>
 #include <zlib.h>
 #include <algorithm>
+#include <atomic>
 #include <csignal>
+#include <functional>
 #include <cstring>
 #include <map>
 #include <memory>
+#include <queue>
 #include <set>
 #include <sstream>
 #include <stdexcept>
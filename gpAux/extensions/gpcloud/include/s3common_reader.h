@@ -1,6 +1,7 @@
 #ifndef INCLUDE_S3COMMON_READER_H_
 #define INCLUDE_S3COMMON_READER_H_
 
+#include "codec_reader.h"
 #include "decompress_reader.h"
 #include "s3common_headers.h"
 #include "s3exception.h"
@@ -30,10 +31,13 @@ class S3CommonReader : public Reader {
     }
 
    protected:
+    S3CompressionType detectCompressionType();
+
     Reader* upstreamReader;
     S3Interface* s3InterfaceService;
     S3KeyReader keyReader;
     DecompressReader decompressReader;
+    CodecReader codecReader;
 };
 
 #endif /* INCLUDE_S3COMMON_READER_H_ */
@@ -1,6 +1,7 @@
 #ifndef INCLUDE_S3COMMON_WRITER_H_
 #define INCLUDE_S3COMMON_WRITER_H_
 
+#include "codec_writer.h"
 #include "compress_writer.h"
 #include "s3common_headers.h"
 #include "s3key_writer.h"
@@ -35,6 +36,7 @@ class S3CommonWriter : public Writer {
     S3Interface* s3InterfaceService;
     S3KeyWriter keyWriter;
     CompressWriter compressWriter;
+    CodecWriter codecWriter;
 };
 
 #endif
@@ -8,18 +8,11 @@
 #include "s3restful_service.h"
 #include "s3url.h"
 
-#define S3_MAGIC_BYTES_NUM 4
-
 #define S3_REQUEST_NO_RETRY 1
 #define S3_REQUEST_MAX_RETRIES 3
 
 #define S3_RANGE_HEADER_STRING_LEN 128
 
-enum S3CompressionType {
-    S3_COMPRESSION_GZIP,
-    S3_COMPRESSION_PLAIN,
-};
-
 struct BucketContent {
     BucketContent() : name(""), size(0) {
     }
@@ -77,7 +70,18 @@ class S3Interface {
     virtual uint64_t fetchData(uint64_t offset, S3VectorUInt8 &data, uint64_t len,
                                const S3Url &s3Url) = 0;
 
-    virtual S3CompressionType checkCompressionType(const S3Url &s3Url) = 0;
+    // Hand data of [offset, offset + len) to receiver as it arrives, return the size of data
+    // received. By default, data is handed over after the whole range is fetched.
+    virtual uint64_t streamData(uint64_t offset, DataReceiver &receiver, uint64_t len,
+                                const S3Url &s3Url) {
+        S3VectorUInt8 data;
+        uint64_t readLen = this->fetchData(offset, data, len, s3Url);
+
+        S3_CHECK_OR_DIE(readLen == 0 || receiver.receive((const char *)data.data(), readLen),
+                        S3RuntimeError, "Data is rejected by receiver");
+
+        return readLen;
+    }
 
     virtual bool checkKeyExistence(const S3Url &s3Url) = 0;
 
@@ -102,7 +106,7 @@ class S3InterfaceService : public S3Interface {
 
     uint64_t fetchData(uint64_t offset, S3VectorUInt8 &data, uint64_t len, const S3Url &s3Url);
 
-    S3CompressionType checkCompressionType(const S3Url &s3Url);
+    uint64_t streamData(uint64_t offset, DataReceiver &receiver, uint64_t len, const S3Url &s3Url);
 
     bool checkKeyExistence(const S3Url &s3Url);
 
@@ -138,6 +142,8 @@ class S3InterfaceService : public S3Interface {
     bool abortUpload(const S3Url &s3Url, const string &uploadId);
 
    private:
+    void addRangeHeaders(HTTPHeaders &headers, const S3Url &s3Url, uint64_t offset, uint64_t len);
+
     bool parseBucketXML(ListBucketResult *result, xmlParserCtxtPtr xmlcontext, string &marker);
 
     Response getBucketResponse(const S3Url &s3Url, const string &encodedQuery);
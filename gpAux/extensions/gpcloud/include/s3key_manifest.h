@@ -0,0 +1,46 @@
+#ifndef INCLUDE_S3KEY_MANIFEST_H_
+#define INCLUDE_S3KEY_MANIFEST_H_
+
+#include "s3common_headers.h"
+#include "s3exception.h"
+#include "s3interface.h"
+#include "s3params.h"
+
+#define S3_MANIFEST_MAGIC "gpcloud manifest v1"
+
+// S3KeyManifest caches the key list of a bucket prefix in a local file, so that the segments of a
+// query on the same host don't all have to list the bucket. Listing is serialized with a file lock,
+// only one segment lists the bucket while the others wait and read its result.
+//
+// Segments distribute keys by computing the same assignment from the same list, so every segment
+// of a query must see the same list. The file is therefore keyed by the query, and never reused by
+// another query. Files older than the TTL are removed when another query lists the bucket.
+class S3KeyManifest {
+   public:
+    S3KeyManifest(const S3Params& params);
+    virtual ~S3KeyManifest() {
+    }
+
+    // Return the key list of s3Url, from the cache file of the query if there is one.
+    ListBucketResult listBucket(S3Interface* s3Interface, S3Url& s3Url);
+
+    // Path of the cache file, which is unique for each url, credential and query.
+    string getManifestPath(const S3Url& s3Url) const;
+
+   protected:
+    virtual time_t now() const {
+        return time(NULL);
+    }
+
+   private:
+    bool load(const string& path, ListBucketResult& result) const;
+    bool save(const string& path, const ListBucketResult& result) const;
+    void removeExpired(const string& path) const;
+
+    string manifestDir;
+    uint64_t ttl;
+    S3Credential cred;
+    string queryId;
+};
+
+#endif /* INCLUDE_S3KEY_MANIFEST_H_ */
@@ -60,8 +60,9 @@ class OffsetMgr {
 };
 
 enum ChunkStatus {
-    ReadyToRead,
-    ReadyToFill,
+    ReadyToRead,  // chunk is completely downloaded
+    ReadyToFill,  // chunk is consumed, ready to download next chunk
+    Filling,      // chunk is being downloaded, data arrived so far could be read
 };
 
 class ChunkBuffer;
@@ -87,6 +88,10 @@ class S3KeyReader : public Reader {
     uint64_t read(char* buf, uint64_t count);
     void close();
 
+    // Copy the first count bytes not read yet into buf, without consuming them. Only data of
+    // current chunk is peeked, return the size of data copied.
+    uint64_t peek(char* buf, uint64_t count);
+
     void setS3InterfaceService(S3Interface* s3) {
         this->s3Interface = s3;
     }
@@ -162,11 +167,13 @@ class S3KeyReader : public Reader {
 
     void reset();
 
+    void rethrowSharedError();
+
     bool hasEol;
     bool eolAppended;
 };
 
-class ChunkBuffer {
+class ChunkBuffer : public DataReceiver {
    public:
     ChunkBuffer(const S3Url& s3Url, S3KeyReader& reader, const S3MemoryContext& context);
 
@@ -187,8 +194,12 @@ class ChunkBuffer {
     }
 
     uint64_t read(char* buf, uint64_t len);
+    uint64_t peek(char* buf, uint64_t len);
     uint64_t fill();
 
+    // Called by download thread when a piece of chunk data arrives.
+    bool receive(const char* ptr, uint64_t size);
+
     void setS3InterfaceService(S3Interface* s3) {
         this->s3Interface = s3;
     }
@@ -6,11 +6,32 @@
 #include "s3interface.h"
 #include "writer.h"
 
+// S3 requires every part except the last one to be at least 5MB.
+#define S3_MIN_PART_SIZE (5 * 1024 * 1024)
+
+// Part size doubles after every S3_PART_SIZE_GROWTH_PARTS parts, up to S3_MAX_PART_SIZE.
+#define S3_PART_SIZE_GROWTH_PARTS 1000
+#define S3_MAX_PART_SIZE (128 * 1024 * 1024)
+
 class WriterBuffer : public vector<uint8_t> {};
 
+// A part of the key, waiting in queue for an upload thread.
+struct UploadPart {
+    S3VectorUInt8 data;
+    uint64_t partNumber;
+};
+
+// Parts are uploaded by a pool of threadnum threads, which lives from open() to close().
 class S3KeyWriter : public Writer {
    public:
-    S3KeyWriter() : sharedError(false), s3Interface(NULL), partNumber(0), activeThreads(0) {
+    S3KeyWriter()
+        : sharedError(false),
+          bufferLimit(0),
+          s3Interface(NULL),
+          partNumber(0),
+          pendingParts(0),
+          pendingBytes(0),
+          isStopping(false) {
         pthread_mutex_init(&this->mutex, NULL);
         pthread_cond_init(&this->cv, NULL);
         pthread_mutex_init(&this->exceptionMutex, NULL);
@@ -20,6 +41,7 @@ class S3KeyWriter : public Writer {
             this->close();
         } catch (...) {
         }
+        this->stopUploadThreads();
         pthread_mutex_destroy(&this->mutex);
         pthread_cond_destroy(&this->cv);
         pthread_mutex_destroy(&this->exceptionMutex);
@@ -38,9 +60,19 @@ class S3KeyWriter : public Writer {
         this->s3Interface = s3;
     }
 
+    // Size of the partNumber-th part, which grows with amount of data written.
+    uint64_t getPartSize(uint64_t partNumber) const;
+
+    // Upper bound of bytes held by parts queued or being uploaded, unless a single part is larger.
+    uint64_t getInflightLimit() const;
+
    protected:
     static void* UploadThreadFunc(void* p);
 
+    void uploadPart(UploadPart* part);
+    void startUploadThreads();
+    void stopUploadThreads();
+
     void flushBuffer();
     void completeKeyWriting();
     void checkQueryCancelSignal();
@@ -50,16 +82,20 @@ class S3KeyWriter : public Writer {
     pthread_mutex_t exceptionMutex;
 
     S3VectorUInt8 buffer;
+    uint64_t bufferLimit;  // size of the part being buffered
     S3Interface* s3Interface;
 
     string uploadId;
     map<uint64_t, string> etagList;
 
     vector<pthread_t> threadList;
+    std::deque<UploadPart*> partQueue;
     pthread_mutex_t mutex;
     pthread_cond_t cv;
     uint64_t partNumber;
-    uint64_t activeThreads;
+    uint64_t pendingParts;  // parts queued or being uploaded
+    uint64_t pendingBytes;  // size of the parts queued or being uploaded
+    bool isStopping;
 
     S3Params params;
 };
@@ -8,79 +8,77 @@
 void* S3Alloc(size_t);
 void S3Free(void*);
 
+// How long Allocate() waits for a chunk to be released when all chunks are in use, before
+// falling back to malloc().
+#define S3_MEMORY_WAIT_TIMEOUT_MS 100
+
+// Fixed-size chunks allocated when a query starts, shared by download/upload threads. Free chunks
+// are kept in a lock-free stack, so threads don't contend on a lock to get or return a chunk.
+// Allocating more chunks than prepared, or a block larger than a chunk, doesn't fail but falls
+// back to malloc() after a short wait, and is reported in statistics.
 class PreAllocatedMemory {
    public:
-    PreAllocatedMemory(size_t chunkSize, size_t numOfChunk) {
-        maxSize = chunkSize * numOfChunk;
-        // we will have no more than 9 chunks, 8 for thread thunk, one for main buffer.
-        // Each chunk is limited to 128MB.
-        const uint64_t memoryLimit = 9 * 128 * 1024 * 1024;
-        S3_CHECK_OR_DIE(maxSize <= memoryLimit, S3MemoryOverLimit, memoryLimit, maxSize);
-
-        used.resize(numOfChunk);
-        chunks.resize(numOfChunk);
-        for (size_t i = 0; i < numOfChunk; i++) {
-            chunks[i] = S3Alloc(chunkSize);
-            if (chunks[i] == NULL) {
-                for (size_t j = 0; j < i; j++) {
-                    S3Free(chunks[j]);
-                }
-                S3_DIE(S3AllocationError, chunkSize);
-            }
-            used[i] = false;
-        }
+    PreAllocatedMemory(size_t chunkSize, size_t numOfChunk);
+    ~PreAllocatedMemory();
 
-        pthread_mutex_init(&memLock, NULL);
+    size_t MaxSize() const {
+        return maxSize;
     }
 
-    ~PreAllocatedMemory() {
-        for (size_t i = 0; i < chunks.size(); i++) {
-            if (chunks[i]) {
-                S3Free(chunks[i]);
-                chunks[i] = NULL;
-            }
-        }
-
-        pthread_mutex_destroy(&memLock);
+    size_t ChunkSize() const {
+        return chunkSize;
     }
 
-    size_t MaxSize() const {
-        return maxSize;
+    // Thread safe, called by download/upload threads.
+    void* Allocate(size_t size);
+    void Deallocate(void* p);
+
+    // Statistics, for debug log and tests.
+    uint64_t GetUsedChunks() const {
+        return usedChunks.load();
     }
 
-    void* Allocate() {
-        UniqueLock lock(&memLock);
-        for (size_t i = 0; i < used.size(); i++) {
-            if (!used[i]) {
-                used[i] = true;
-                return chunks[i];
-            }
-        }
+    uint64_t GetPeakUsedChunks() const {
+        return peakUsedChunks.load();
+    }
 
-        S3_DIE(S3RuntimeError, "Requested more than preallocated memory");
+    uint64_t GetWaitCount() const {
+        return waitCount.load();
     }
 
-    void Deallocate(void* p) {
-        UniqueLock lock(&memLock);
-        for (size_t i = 0; i < used.size(); i++) {
-            if (chunks[i] == p) {
-                used[i] = false;
-                return;
-            }
-        }
-        stringstream ss;
-        ss << "Free invalid memory: " << p;
-        S3_DIE(S3RuntimeError, ss.str());
+    uint64_t GetFallbackCount() const {
+        return fallbackCount.load();
     }
 
    private:
     PreAllocatedMemory(const PreAllocatedMemory&);
     PreAllocatedMemory& operator=(const PreAllocatedMemory&);
 
+    bool popFreeChunk(uint32_t& index);
+    void pushFreeChunk(uint32_t index);
+
+    void* useChunk(uint32_t index);
+    void* waitForChunk();
+    void* allocateFallback(size_t size);
+
     size_t maxSize;
-    vector<bool> used;
-    vector<void*> chunks;
-    pthread_mutex_t memLock;
+    size_t chunkSize;
+    vector<char*> chunks;  // each chunk starts with a header, see s3memory_mgmt.cpp
+
+    // Top of the free chunk stack: (tag << 32) | (index + 1), 0 means empty. Tag is increased by
+    // every push to avoid ABA problem.
+    std::atomic<uint64_t> freeTop;
+    std::unique_ptr<std::atomic<uint32_t>[]> freeNext;  // index + 1 of next free chunk
+
+    std::atomic<uint64_t> usedChunks;
+    std::atomic<uint64_t> peakUsedChunks;
+    std::atomic<uint64_t> waitCount;
+    std::atomic<uint64_t> fallbackCount;
+
+    // Only used when all chunks are in use.
+    std::atomic<uint64_t> waiters;
+    pthread_mutex_t waitLock;
+    pthread_cond_t waitCond;
 };
 
 template <class T>
@@ -116,7 +114,7 @@ struct PGAllocator {
 
     T* allocate(size_t n) {
         if (prealloc) {
-            return (T*)prealloc->Allocate();
+            return (T*)prealloc->Allocate(n * sizeof(T));
         } else {
             return std::allocator<T>().allocate(n);
         }
@@ -7,6 +7,18 @@
 
 enum S3SSEType { SSE_NONE, SSE_S3 };
 
+// How keys of a bucket are distributed across segments.
+//   KEY_DIST_ROUNDROBIN: the i-th key goes to segment (i % segnum).
+//   KEY_DIST_SIZE: keys are balanced by their sizes, so all segments read similar amount of bytes.
+enum S3KeyDistType { KEY_DIST_ROUNDROBIN, KEY_DIST_SIZE };
+
+enum S3CompressionType {
+    S3_COMPRESSION_GZIP,
+    S3_COMPRESSION_PLAIN,
+    S3_COMPRESSION_ZSTD,
+    S3_COMPRESSION_LZ4,
+};
+
 class S3Params {
    public:
     S3Params(const string& sourceUrl = "", bool useHttps = true, const string& version = "",
@@ -20,7 +32,11 @@ class S3Params {
           debugCurl(false),
           autoCompress(false),
           verifyCert(false),
-          sseType(SSE_NONE) {
+          sseType(SSE_NONE),
+          keyDistType(KEY_DIST_SIZE),
+          manifestTTL(0),
+          compressThreadNum(1),
+          compressionType(S3_COMPRESSION_GZIP) {
     }
 
     virtual ~S3Params() {
@@ -129,6 +145,54 @@ class S3Params {
         this->sseType = sseType;
     }
 
+    const S3KeyDistType& getKeyDistType() const {
+        return keyDistType;
+    }
+
+    void setKeyDistType(S3KeyDistType keyDistType) {
+        this->keyDistType = keyDistType;
+    }
+
+    const string& getManifestDir() const {
+        return manifestDir;
+    }
+
+    void setManifestDir(const string& manifestDir) {
+        this->manifestDir = manifestDir;
+    }
+
+    uint64_t getManifestTTL() const {
+        return manifestTTL;
+    }
+
+    void setManifestTTL(uint64_t manifestTTL) {
+        this->manifestTTL = manifestTTL;
+    }
+
+    const string& getQueryId() const {
+        return queryId;
+    }
+
+    void setQueryId(const string& queryId) {
+        this->queryId = queryId;
+    }
+
+    uint64_t getCompressThreadNum() const {
+        return compressThreadNum;
+    }
+
+    void setCompressThreadNum(uint64_t compressThreadNum) {
+        this->compressThreadNum = compressThreadNum;
+    }
+
+    S3CompressionType getCompressionType() const {
+        return compressionType;
+    }
+
+    void setCompressionType(S3CompressionType compressionType) {
+        this->compressionType = compressionType;
+    }
+
    private:
     S3Url s3Url;  // original url to read/write.
 
@@ -149,6 +213,16 @@ class S3Params {
 
     S3SSEType sseType;
 
+    S3KeyDistType keyDistType;  // how keys are distributed across segments
+
+    string manifestDir;    // where to cache the key list of bucket
+    uint64_t manifestTTL;  // seconds a cached key list is kept for, 0 means no cache
+    string queryId;        // identifies the query, whose segments share a cached key list
+
+    uint64_t compressThreadNum;  // number of threads compressing data before uploading
+
+    S3CompressionType compressionType;  // codec to compress data with if autoCompress is set
+
     S3MemoryContext memoryContext;
 };
 
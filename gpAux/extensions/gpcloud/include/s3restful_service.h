@@ -10,6 +10,65 @@
 #include "s3macros.h"
 #include "s3params.h"
 
+// CURLHandlePool keeps a bounded number of idle curl easy handles, so that the keep-alive
+// connection held by a handle could be reused by the next request instead of doing a new
+// TCP + TLS handshake. All handles in a pool share DNS and TLS session caches.
+class CURLHandlePool {
+   public:
+    CURLHandlePool(uint64_t capacity = 1);
+    ~CURLHandlePool();
+
+    // Borrow a handle, create a new one if no idle handle is available.
+    CURL* acquire();
+
+    // Return a handle to the pool, it is cleaned up if the pool is full already.
+    void release(CURL* handle);
+
+    // Clean up all idle handles, must be called before curl_global_cleanup().
+    void clear();
+
+    // Count the connection used by the last transfer of the handle.
+    void countConnection(CURL* handle);
+
+    uint64_t getCapacity() const {
+        return capacity;
+    }
+
+    void setCapacity(uint64_t capacity) {
+        this->capacity = capacity;
+    }
+
+    uint64_t getIdleHandleNum() {
+        UniqueLock lock(&this->poolLock);
+        return idleHandles.size();
+    }
+
+    uint64_t getReusedConnectionNum() const {
+        return reusedConnectionNum;
+    }
+
+    uint64_t getNewConnectionNum() const {
+        return newConnectionNum;
+    }
+
+   private:
+    CURLHandlePool(const CURLHandlePool&);
+    CURLHandlePool& operator=(const CURLHandlePool&);
+
+    static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* userp);
+    static void unlockShare(CURL* handle, curl_lock_data data, void* userp);
+
+    uint64_t capacity;
+    vector<CURL*> idleHandles;
+    pthread_mutex_t poolLock;
+
+    CURLSH* share;
+    pthread_mutex_t shareLocks[CURL_LOCK_DATA_LAST];
+
+    uint64_t reusedConnectionNum;
+    uint64_t newConnectionNum;
+};
+
 class S3RESTfulService : public RESTfulService {
    public:
     S3RESTfulService();
@@ -20,12 +79,18 @@ class S3RESTfulService : public RESTfulService {
 
     Response get(const string& url, HTTPHeaders& headers);
 
+    Response streamingGet(const string& url, HTTPHeaders& headers, DataReceiver& receiver);
+
     Response put(const string& url, HTTPHeaders& headers, const S3VectorUInt8& data);
 
     Response post(const string& url, HTTPHeaders& headers, const vector<uint8_t>& data);
 
     Response deleteRequest(const string& url, HTTPHeaders& headers);
 
+    CURLHandlePool& getHandlePool() {
+        return handlePool;
+    }
+
    private:
     uint64_t lowSpeedLimit;
     uint64_t lowSpeedTime;
@@ -36,6 +101,8 @@ class S3RESTfulService : public RESTfulService {
     uint64_t chunkBufferSize;
     S3MemoryContext s3MemContext;
 
+    CURLHandlePool handlePool;
+
     void performCurl(CURL* curl, Response& response);
 };
 
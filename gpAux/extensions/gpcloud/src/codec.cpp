@@ -0,0 +1,290 @@
+#include "codec.h"
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef USE_LZ4
+#include <lz4frame.h>
+#endif
+
+static const unsigned char gzipMagic[] = {0x1f, 0x8b};
+static const unsigned char zstdMagic[] = {0x28, 0xb5, 0x2f, 0xfd};
+static const unsigned char lz4Magic[] = {0x04, 0x22, 0x4d, 0x18};
+
+#ifdef USE_ZSTD
+
+class ZstdCompressor : public Compressor {
+   public:
+    ZstdCompressor() {
+        this->cctx = ZSTD_createCCtx();
+        S3_CHECK_OR_DIE(this->cctx != NULL, S3RuntimeError, "Failed to initialize zstd library");
+
+        // Checksum is cheap and lets reader detect corrupted files, as gzip does.
+        ZSTD_CCtx_setParameter(this->cctx, ZSTD_c_checksumFlag, 1);
+    }
+
+    virtual ~ZstdCompressor() {
+        ZSTD_freeCCtx(this->cctx);
+    }
+
+    virtual void compress(const char *in, uint64_t len, vector<char> &out) {
+        ZSTD_inBuffer input = {in, len, 0};
+        while (input.pos < input.size) {
+            this->compressStream(input, ZSTD_e_continue, out);
+        }
+    }
+
+    virtual void finish(vector<char> &out) {
+        ZSTD_inBuffer input = {NULL, 0, 0};
+        while (this->compressStream(input, ZSTD_e_end, out) != 0) {
+        }
+    }
+
+   private:
+    // Return how many bytes are still buffered inside zstd.
+    size_t compressStream(ZSTD_inBuffer &input, ZSTD_EndDirective mode, vector<char> &out) {
+        size_t offset = out.size();
+        out.resize(offset + ZSTD_CStreamOutSize());
+
+        ZSTD_outBuffer output = {out.data() + offset, out.size() - offset, 0};
+        size_t ret = ZSTD_compressStream2(this->cctx, &output, &input, mode);
+        out.resize(offset + output.pos);
+
+        S3_CHECK_OR_DIE(!ZSTD_isError(ret), S3RuntimeError,
+                        string("Failed to compress data with zstd: ") + ZSTD_getErrorName(ret));
+        return ret;
+    }
+
+    ZSTD_CCtx *cctx;
+};
+
+class ZstdDecompressor : public Decompressor {
+   public:
+    ZstdDecompressor() {
+        this->dctx = ZSTD_createDCtx();
+        S3_CHECK_OR_DIE(this->dctx != NULL, S3RuntimeError, "Failed to initialize zstd library");
+    }
+
+    virtual ~ZstdDecompressor() {
+        ZSTD_freeDCtx(this->dctx);
+    }
+
+    virtual bool decompress(const char *in, uint64_t &inLen, char *out, uint64_t &outLen) {
+        ZSTD_inBuffer input = {in, inLen, 0};
+        ZSTD_outBuffer output = {out, outLen, 0};
+
+        size_t ret = ZSTD_decompressStream(this->dctx, &output, &input);
+        S3_CHECK_OR_DIE(!ZSTD_isError(ret), S3RuntimeError,
+                        string("Failed to decompress data with zstd: ") + ZSTD_getErrorName(ret));
+
+        inLen = input.pos;
+        outLen = output.pos;
+
+        // 0 means frame is completely decoded and flushed.
+        return ret == 0;
+    }
+
+   private:
+    ZSTD_DCtx *dctx;
+};
+
+#endif
+
+#ifdef USE_LZ4
+
+class Lz4Compressor : public Compressor {
+   public:
+    Lz4Compressor() : isStarted(false) {
+        LZ4F_errorCode_t ret = LZ4F_createCompressionContext(&this->cctx, LZ4F_VERSION);
+        S3_CHECK_OR_DIE(!LZ4F_isError(ret), S3RuntimeError,
+                        string("Failed to initialize lz4 library: ") + LZ4F_getErrorName(ret));
+
+        memset(&this->prefs, 0, sizeof(this->prefs));
+        this->prefs.frameInfo.blockMode = LZ4F_blockLinked;
+        this->prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+    }
+
+    virtual ~Lz4Compressor() {
+        LZ4F_freeCompressionContext(this->cctx);
+    }
+
+    virtual void compress(const char *in, uint64_t len, vector<char> &out) {
+        this->begin(out);
+
+        size_t offset = out.size();
+        out.resize(offset + LZ4F_compressBound(len, &this->prefs));
+
+        size_t ret =
+            LZ4F_compressUpdate(this->cctx, out.data() + offset, out.size() - offset, in, len, NULL);
+        this->checkResult(ret, offset, out);
+    }
+
+    virtual void finish(vector<char> &out) {
+        this->begin(out);
+
+        size_t offset = out.size();
+        out.resize(offset + LZ4F_compressBound(0, &this->prefs));
+
+        size_t ret = LZ4F_compressEnd(this->cctx, out.data() + offset, out.size() - offset, NULL);
+        this->checkResult(ret, offset, out);
+    }
+
+   private:
+    // Frame header is generated before any data.
+    void begin(vector<char> &out) {
+        if (this->isStarted) {
+            return;
+        }
+
+        size_t offset = out.size();
+        out.resize(offset + LZ4F_HEADER_SIZE_MAX);
+
+        size_t ret = LZ4F_compressBegin(this->cctx, out.data() + offset, LZ4F_HEADER_SIZE_MAX,
+                                        &this->prefs);
+        this->checkResult(ret, offset, out);
+
+        this->isStarted = true;
+    }
+
+    void checkResult(size_t ret, size_t offset, vector<char> &out) {
+        if (LZ4F_isError(ret)) {
+            out.resize(offset);
+            S3_CHECK_OR_DIE(false, S3RuntimeError,
+                            string("Failed to compress data with lz4: ") + LZ4F_getErrorName(ret));
+        }
+
+        out.resize(offset + ret);
+    }
+
+    LZ4F_compressionContext_t cctx;
+    LZ4F_preferences_t prefs;
+    bool isStarted;
+};
+
+class Lz4Decompressor : public Decompressor {
+   public:
+    Lz4Decompressor() {
+        LZ4F_errorCode_t ret = LZ4F_createDecompressionContext(&this->dctx, LZ4F_VERSION);
+        S3_CHECK_OR_DIE(!LZ4F_isError(ret), S3RuntimeError,
+                        string("Failed to initialize lz4 library: ") + LZ4F_getErrorName(ret));
+    }
+
+    virtual ~Lz4Decompressor() {
+        LZ4F_freeDecompressionContext(this->dctx);
+    }
+
+    virtual bool decompress(const char *in, uint64_t &inLen, char *out, uint64_t &outLen) {
+        size_t srcSize = inLen;
+        size_t dstSize = outLen;
+
+        size_t ret = LZ4F_decompress(this->dctx, out, &dstSize, in, &srcSize, NULL);
+        S3_CHECK_OR_DIE(!LZ4F_isError(ret), S3RuntimeError,
+                        string("Failed to decompress data with lz4: ") + LZ4F_getErrorName(ret));
+
+        inLen = srcSize;
+        outLen = dstSize;
+
+        // 0 means frame is completely decoded, context is ready for the next frame.
+        return ret == 0;
+    }
+
+   private:
+    LZ4F_decompressionContext_t dctx;
+};
+
+#endif
+
+Compressor *NewCompressor(S3CompressionType compressionType) {
+    switch (compressionType) {
+#ifdef USE_ZSTD
+        case S3_COMPRESSION_ZSTD:
+            return new ZstdCompressor();
+#endif
+#ifdef USE_LZ4
+        case S3_COMPRESSION_LZ4:
+            return new Lz4Compressor();
+#endif
+        default:
+            break;
+    }
+
+    S3_DIE(S3RuntimeError, "gpcloud is built without " + GetCompressionName(compressionType) +
+                               " support");
+    return NULL;
+}
+
+Decompressor *NewDecompressor(S3CompressionType compressionType) {
+    switch (compressionType) {
+#ifdef USE_ZSTD
+        case S3_COMPRESSION_ZSTD:
+            return new ZstdDecompressor();
+#endif
+#ifdef USE_LZ4
+        case S3_COMPRESSION_LZ4:
+            return new Lz4Decompressor();
+#endif
+        default:
+            break;
+    }
+
+    S3_DIE(S3RuntimeError, "gpcloud is built without " + GetCompressionName(compressionType) +
+                               " support");
+    return NULL;
+}
+
+S3CompressionType DetectCompressionType(const unsigned char *magic, uint64_t len) {
+    if (len >= sizeof(gzipMagic) && memcmp(magic, gzipMagic, sizeof(gzipMagic)) == 0) {
+        return S3_COMPRESSION_GZIP;
+    }
+
+    if (len >= sizeof(zstdMagic) && memcmp(magic, zstdMagic, sizeof(zstdMagic)) == 0) {
+        return S3_COMPRESSION_ZSTD;
+    }
+
+    if (len >= sizeof(lz4Magic) && memcmp(magic, lz4Magic, sizeof(lz4Magic)) == 0) {
+        return S3_COMPRESSION_LZ4;
+    }
+
+    return S3_COMPRESSION_PLAIN;
+}
+
+bool ParseCompressionType(const string &name, S3CompressionType &compressionType) {
+    const S3CompressionType types[] = {S3_COMPRESSION_GZIP, S3_COMPRESSION_PLAIN,
+                                       S3_COMPRESSION_ZSTD, S3_COMPRESSION_LZ4};
+
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        if (name == GetCompressionName(types[i])) {
+            compressionType = types[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+string GetCompressionName(S3CompressionType compressionType) {
+    switch (compressionType) {
+        case S3_COMPRESSION_GZIP:
+            return "gzip";
+        case S3_COMPRESSION_ZSTD:
+            return "zstd";
+        case S3_COMPRESSION_LZ4:
+            return "lz4";
+        default:
+            return "none";
+    }
+}
+
+string GetCompressionExt(S3CompressionType compressionType) {
+    switch (compressionType) {
+        case S3_COMPRESSION_GZIP:
+            return ".gz";
+        case S3_COMPRESSION_ZSTD:
+            return ".zst";
+        case S3_COMPRESSION_LZ4:
+            return ".lz4";
+        default:
+            return "";
+    }
+}
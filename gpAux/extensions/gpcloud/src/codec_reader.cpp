@@ -0,0 +1,137 @@
+#include "codec_reader.h"
+
+CodecReader::CodecReader()
+    : reader(NULL),
+      decompressor(NULL),
+      compressionType(S3_COMPRESSION_PLAIN),
+      inOffset(0),
+      inLen(0),
+      isInputEnd(false),
+      isFrameEnd(false),
+      isEOF(false),
+      isClosed(true) {
+    this->in.resize(S3_ZIP_DECOMPRESS_CHUNKSIZE);
+}
+
+CodecReader::~CodecReader() {
+    this->close();
+    delete this->decompressor;
+}
+
+// Used for unit test to adjust buffer size
+void CodecReader::resizeCodecReaderBuffer(uint64_t size) {
+    this->in.resize(size);
+}
+
+void CodecReader::setReader(Reader *reader) {
+    this->reader = reader;
+}
+
+void CodecReader::open(const S3Params &params) {
+    this->openWithoutReader(params.getCompressionType());
+
+    this->reader->open(params);
+}
+
+void CodecReader::openWithoutReader(S3CompressionType compressionType) {
+    delete this->decompressor;
+    this->decompressor = NULL;
+
+    this->decompressor = NewDecompressor(compressionType);
+    this->compressionType = compressionType;
+
+    this->inOffset = 0;
+    this->inLen = 0;
+    this->isInputEnd = false;
+    this->isFrameEnd = false;
+    this->isEOF = false;
+
+    this->isClosed = false;
+}
+
+// Move data left in input buffer to the beginning, and fill the rest with data from underlying
+// reader. Underlying reader returns 0 every time once reaching EOF.
+void CodecReader::readInput() {
+    uint64_t remaining = this->inLen - this->inOffset;
+    if (remaining > 0 && this->inOffset > 0) {
+        memmove(this->in.data(), this->in.data() + this->inOffset, remaining);
+    }
+
+    this->inOffset = 0;
+    this->inLen = remaining;
+
+    while (this->inLen < this->in.size()) {
+        uint64_t count = this->reader->read(this->in.data() + this->inLen,
+                                            this->in.size() - this->inLen);
+        if (count == 0) {
+            this->isInputEnd = true;
+            break;
+        }
+
+        this->inLen += count;
+    }
+}
+
+// Data following a finished frame is either another frame or trailing data (e.g. EOL appended by
+// key reader), which is ignored. Return true if next frame starts.
+bool CodecReader::startNextFrame() {
+    if (this->inLen - this->inOffset < S3_MAGIC_BYTES_NUM && !this->isInputEnd) {
+        this->readInput();
+    }
+
+    uint64_t remaining = this->inLen - this->inOffset;
+    const unsigned char *next = (const unsigned char *)this->in.data() + this->inOffset;
+    if (DetectCompressionType(next, remaining) == this->compressionType) {
+        this->isFrameEnd = false;
+        return true;
+    }
+
+    if (remaining > 0) {
+        S3DEBUG("Ignored %" PRIu64 " bytes of trailing data after %s stream", remaining,
+                GetCompressionName(this->compressionType).c_str());
+        this->inOffset = this->inLen;
+    }
+
+    return false;
+}
+
+uint64_t CodecReader::read(char *buf, uint64_t count) {
+    if (this->isEOF || count == 0) {
+        return 0;
+    }
+
+    while (true) {
+        if (this->isFrameEnd && !this->startNextFrame()) {
+            this->isEOF = true;
+            return 0;
+        }
+
+        if (this->inOffset == this->inLen && !this->isInputEnd) {
+            this->readInput();
+        }
+
+        uint64_t consumed = this->inLen - this->inOffset;
+        uint64_t produced = count;
+
+        // Decompressor is called even if no input left, to flush pending output.
+        this->isFrameEnd = this->decompressor->decompress(this->in.data() + this->inOffset,
+                                                          consumed, buf, produced);
+        this->inOffset += consumed;
+
+        if (produced > 0) {
+            return produced;
+        }
+
+        if (!this->isFrameEnd && this->isInputEnd && this->inOffset == this->inLen) {
+            S3_DIE(S3RuntimeError, "Unexpected end of " +
+                                       GetCompressionName(this->compressionType) + " stream");
+        }
+    }
+}
+
+void CodecReader::close() {
+    if (!this->isClosed) {
+        this->reader->close();
+        this->isClosed = true;
+    }
+}
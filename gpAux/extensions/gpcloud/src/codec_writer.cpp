@@ -0,0 +1,65 @@
+#include "codec_writer.h"
+
+CodecWriter::CodecWriter() : writer(NULL), compressor(NULL), isClosed(true) {
+}
+
+CodecWriter::~CodecWriter() {
+    try {
+        this->close();
+    } catch (...) {
+    }
+
+    delete this->compressor;
+}
+
+void CodecWriter::setWriter(Writer *writer) {
+    this->writer = writer;
+}
+
+void CodecWriter::open(const S3Params &params) {
+    delete this->compressor;
+    this->compressor = NULL;
+
+    this->compressor = NewCompressor(params.getCompressionType());
+    this->out.clear();
+    this->isClosed = false;
+
+    this->writer->open(params);
+}
+
+uint64_t CodecWriter::write(const char *buf, uint64_t count) {
+    // Defensive code
+    if (buf == NULL || count == 0) {
+        return 0;
+    }
+
+    this->compressor->compress(buf, count, this->out);
+
+    // Codecs buffer data internally, output is flushed once it's big enough to avoid small writes.
+    if (this->out.size() >= S3_ZIP_COMPRESS_CHUNKSIZE) {
+        this->flush();
+    }
+
+    return count;
+}
+
+void CodecWriter::flush() {
+    if (!this->out.empty()) {
+        this->writer->write(this->out.data(), this->out.size());
+        this->out.clear();
+    }
+}
+
+void CodecWriter::close() {
+    if (this->isClosed) {
+        return;
+    }
+
+    // Mark closed first, a failed close() should not be retried by destructor.
+    this->isClosed = true;
+
+    this->compressor->finish(this->out);
+    this->flush();
+
+    this->writer->close();
+}
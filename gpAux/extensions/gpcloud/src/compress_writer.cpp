@@ -2,8 +2,25 @@
 
 uint64_t S3_ZIP_COMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
 
-CompressWriter::CompressWriter() : writer(NULL), isClosed(true) {
+// Deflate window size, also the size of dictionary a block inherits from the previous block.
+#define S3_DEFLATE_DICT_SIZE 32768
+
+// Minimal gzip header: no file name, no timestamp, OS is unix.
+static const unsigned char gzipHeader[] = {0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 3};
+
+CompressWriter::CompressWriter()
+    : writer(NULL),
+      isClosed(true),
+      threadNum(1),
+      curBlock(NULL),
+      totalCrc(0),
+      totalLen(0),
+      isStopping(false) {
     this->out = new char[S3_ZIP_COMPRESS_CHUNKSIZE];
+
+    pthread_mutex_init(&this->blockMutex, NULL);
+    pthread_cond_init(&this->queuedCond, NULL);
+    pthread_cond_init(&this->doneCond, NULL);
 }
 
 CompressWriter::~CompressWriter() {
@@ -11,10 +28,24 @@ CompressWriter::~CompressWriter() {
         this->close();
     } catch (...) {
     }
+    this->stopCompressThreads();
     delete this->out;
+
+    pthread_mutex_destroy(&this->blockMutex);
+    pthread_cond_destroy(&this->queuedCond);
+    pthread_cond_destroy(&this->doneCond);
 }
 
 void CompressWriter::open(const S3Params& params) {
+    this->threadNum = params.getCompressThreadNum();
+    if (this->threadNum > 1) {
+        this->openParallel();
+        this->isClosed = false;
+        this->writer->open(params);
+        this->writer->write((const char*)gzipHeader, sizeof(gzipHeader));
+        return;
+    }
+
     this->zstream.zalloc = Z_NULL;
     this->zstream.zfree = Z_NULL;
     this->zstream.opaque = Z_NULL;
@@ -74,6 +105,10 @@ uint64_t CompressWriter::write(const char* buf, uint64_t count) {
         return 0;
     }
 
+    if (this->threadNum > 1) {
+        return this->writeParallel(buf, count);
+    }
+
     uint64_t writtenLen = 0;
 
     for (uint64_t i = 0; i < (count / S3_ZIP_COMPRESS_CHUNKSIZE); i++) {
@@ -92,6 +127,11 @@ void CompressWriter::close() {
         return;
     }
 
+    if (this->threadNum > 1) {
+        this->closeParallel();
+        return;
+    }
+
     int status;
     do {
         status = deflate(&this->zstream, Z_FINISH);
@@ -123,3 +163,238 @@ void CompressWriter::flush() {
         this->zstream.avail_out = S3_ZIP_COMPRESS_CHUNKSIZE;
     }
 }
+
+void CompressWriter::openParallel() {
+    this->stopCompressThreads();
+
+    this->totalCrc = crc32(0L, Z_NULL, 0);
+    this->totalLen = 0;
+    this->isStopping = false;
+
+    this->curBlock = new CompressBlock();
+    this->curBlock->in.reserve(S3_ZIP_COMPRESS_CHUNKSIZE);
+
+    for (uint64_t i = 0; i < this->threadNum; i++) {
+        pthread_t thread;
+        pthread_create(&thread, NULL, CompressThreadFunc, this);
+        this->threads.push_back(thread);
+    }
+}
+
+uint64_t CompressWriter::writeParallel(const char* buf, uint64_t count) {
+    uint64_t offset = 0;
+    while (offset < count) {
+        uint64_t blockRemaining = S3_ZIP_COMPRESS_CHUNKSIZE - this->curBlock->in.size();
+        uint64_t dataToBlock = std::min(blockRemaining, count - offset);
+
+        this->curBlock->in.insert(this->curBlock->in.end(), buf + offset,
+                                  buf + offset + dataToBlock);
+        offset += dataToBlock;
+
+        if (this->curBlock->in.size() == S3_ZIP_COMPRESS_CHUNKSIZE) {
+            this->submitBlock(false);
+        }
+    }
+
+    return count;
+}
+
+void CompressWriter::closeParallel() {
+    // Mark closed first, a failed close() should not be retried by destructor.
+    this->isClosed = true;
+
+    try {
+        this->submitBlock(true);
+        this->writeFinishedBlocks(true);
+    } catch (...) {
+        this->stopCompressThreads();
+        throw;
+    }
+
+    this->stopCompressThreads();
+
+    // gzip trailer: crc32 and size of uncompressed data, both in little endian.
+    unsigned char trailer[8];
+    for (int i = 0; i < 4; i++) {
+        trailer[i] = (this->totalCrc >> (8 * i)) & 0xFF;
+        trailer[i + 4] = (this->totalLen >> (8 * i)) & 0xFF;
+    }
+    this->writer->write((const char*)trailer, sizeof(trailer));
+
+    S3DEBUG("Parallel compression finished, %" PRIu64 " bytes compressed.", this->totalLen);
+
+    this->writer->close();
+}
+
+void CompressWriter::submitBlock(bool isLast) {
+    CompressBlock* block = this->curBlock;
+    block->isLast = isLast;
+
+    this->curBlock = NULL;
+    if (!isLast) {
+        this->curBlock = new CompressBlock();
+        this->curBlock->in.reserve(S3_ZIP_COMPRESS_CHUNKSIZE);
+
+        uint64_t dictLen = std::min((uint64_t)S3_DEFLATE_DICT_SIZE, (uint64_t)block->in.size());
+        this->curBlock->dict.assign(block->in.end() - dictLen, block->in.end());
+    }
+
+    {
+        UniqueLock blockLock(&this->blockMutex);
+        this->pendingBlocks.push_back(block);
+        this->queuedBlocks.push_back(block);
+        pthread_cond_signal(&this->queuedCond);
+    }
+
+    // Write out what is ready, and keep at most one more block than threads in flight to bound
+    // the memory used.
+    this->writeFinishedBlocks(false);
+    while (this->pendingBlocks.size() > this->threadNum) {
+        CompressBlock* oldest = this->pendingBlocks.front();
+        {
+            UniqueLock blockLock(&this->blockMutex);
+            while (!oldest->isDone) {
+                pthread_cond_wait(&this->doneCond, &this->blockMutex);
+            }
+        }
+        this->writeFinishedBlocks(false);
+    }
+}
+
+// Write compressed blocks in the order of input. Only called by the writer thread.
+void CompressWriter::writeFinishedBlocks(bool waitForAll) {
+    while (!this->pendingBlocks.empty()) {
+        CompressBlock* block = this->pendingBlocks.front();
+        {
+            UniqueLock blockLock(&this->blockMutex);
+            while (waitForAll && !block->isDone) {
+                pthread_cond_wait(&this->doneCond, &this->blockMutex);
+            }
+
+            if (!block->isDone) {
+                return;
+            }
+        }
+
+        this->pendingBlocks.pop_front();
+        std::unique_ptr<CompressBlock> blockHolder(block);
+
+        S3_CHECK_OR_DIE(block->error.empty(), S3RuntimeError,
+                        "Failed to compress data: " + block->error);
+
+        this->totalCrc = crc32_combine(this->totalCrc, block->crc, block->inputLen);
+        this->totalLen += block->inputLen;
+
+        if (!block->out.empty()) {
+            this->writer->write(block->out.data(), block->out.size());
+        }
+    }
+}
+
+void CompressWriter::stopCompressThreads() {
+    {
+        UniqueLock blockLock(&this->blockMutex);
+        this->isStopping = true;
+        pthread_cond_broadcast(&this->queuedCond);
+    }
+
+    for (size_t i = 0; i < this->threads.size(); i++) {
+        pthread_join(this->threads[i], NULL);
+    }
+    this->threads.clear();
+
+    // Blocks left by a failed or interrupted writing.
+    for (size_t i = 0; i < this->pendingBlocks.size(); i++) {
+        delete this->pendingBlocks[i];
+    }
+    this->pendingBlocks.clear();
+    this->queuedBlocks.clear();
+
+    delete this->curBlock;
+    this->curBlock = NULL;
+}
+
+void* CompressWriter::CompressThreadFunc(void* data) {
+    MaskThreadSignals();
+
+    CompressWriter* writer = static_cast<CompressWriter*>(data);
+
+    while (true) {
+        CompressBlock* block = NULL;
+        {
+            UniqueLock blockLock(&writer->blockMutex);
+            while (writer->queuedBlocks.empty() && !writer->isStopping) {
+                pthread_cond_wait(&writer->queuedCond, &writer->blockMutex);
+            }
+
+            if (writer->isStopping) {
+                return NULL;
+            }
+
+            block = writer->queuedBlocks.front();
+            writer->queuedBlocks.pop_front();
+        }
+
+        compressBlock(block);
+
+        UniqueLock blockLock(&writer->blockMutex);
+        block->isDone = true;
+        pthread_cond_broadcast(&writer->doneCond);
+    }
+
+    return NULL;
+}
+
+// Compress a block into raw deflate data. Blocks but the last one end with a sync flush, so
+// that they end at byte boundary and could be concatenated.
+void CompressWriter::compressBlock(CompressBlock* block) {
+    z_stream zs;
+    zs.zalloc = Z_NULL;
+    zs.zfree = Z_NULL;
+    zs.opaque = Z_NULL;
+
+    int ret = deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                           Z_DEFAULT_STRATEGY);
+    if (ret != Z_OK) {
+        block->error = "failed to initialize zlib library";
+        return;
+    }
+
+    if (!block->dict.empty()) {
+        deflateSetDictionary(&zs, (const Bytef*)block->dict.data(), block->dict.size());
+    }
+
+    block->inputLen = block->in.size();
+    block->crc = crc32(0L, (const Bytef*)block->in.data(), block->in.size());
+
+    // Reserve some more space for the sync flush marker.
+    block->out.resize(deflateBound(&zs, block->in.size()) + 16);
+
+    zs.next_in = (Bytef*)block->in.data();
+    zs.avail_in = block->in.size();
+    zs.next_out = (Bytef*)block->out.data();
+    zs.avail_out = block->out.size();
+
+    int flush = block->isLast ? Z_FINISH : Z_SYNC_FLUSH;
+    do {
+        if (zs.avail_out == 0) {
+            uint64_t used = block->out.size();
+            block->out.resize(used * 2);
+            zs.next_out = (Bytef*)block->out.data() + used;
+            zs.avail_out = block->out.size() - used;
+        }
+
+        ret = deflate(&zs, flush);
+        if (ret == Z_STREAM_ERROR) {
+            block->error = std::to_string((long long)ret) + ", " + (zs.msg ? zs.msg : "");
+            break;
+        }
+    } while (block->isLast ? (ret != Z_STREAM_END) : (zs.avail_in > 0 || zs.avail_out == 0));
+
+    block->out.resize(block->out.size() - zs.avail_out);
+    deflateEnd(&zs);
+
+    // Input is not needed anymore, next block has its own copy of dictionary.
+    vector<char>().swap(block->in);
+    vector<char>().swap(block->dict);
+}
@@ -2,28 +2,60 @@
 
 uint64_t S3_ZIP_DECOMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
 
-DecompressReader::DecompressReader() : isClosed(true) {
+static uint64_t getMonotonicNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+DecompressReader::DecompressReader()
+    : readIndex(0),
+      fillIndex(0),
+      filledNum(0),
+      outOffset(0),
+      isInputEnd(false),
+      isStreamEnd(false),
+      isEOF(false),
+      isStopping(false),
+      isThreadStarted(false),
+      memberNum(0),
+      decompressedBytes(0),
+      inflateNanos(0),
+      isClosed(true) {
     this->reader = NULL;
     this->in = new char[S3_ZIP_DECOMPRESS_CHUNKSIZE];
-    this->out = new char[S3_ZIP_DECOMPRESS_CHUNKSIZE];
-    this->outOffset = 0;
+    for (int i = 0; i < S3_ZIP_DECOMPRESS_BUFFER_NUM; i++) {
+        this->out[i] = new char[S3_ZIP_DECOMPRESS_CHUNKSIZE];
+        this->outLen[i] = 0;
+    }
+
+    pthread_mutex_init(&this->mutex, NULL);
+    pthread_cond_init(&this->cond, NULL);
 }
 
 DecompressReader::~DecompressReader() {
     this->close();
 
-    delete this->in;
-    delete this->out;
+    delete[] this->in;
+    for (int i = 0; i < S3_ZIP_DECOMPRESS_BUFFER_NUM; i++) {
+        delete[] this->out[i];
+    }
+
+    pthread_mutex_destroy(&this->mutex);
+    pthread_cond_destroy(&this->cond);
 }
 
 // Used for unit test to adjust buffer size
 void DecompressReader::resizeDecompressReaderBuffer(uint64_t size) {
-    delete this->in;
-    delete this->out;
+    delete[] this->in;
     this->in = new char[size];
-    this->out = new char[size];
+
+    for (int i = 0; i < S3_ZIP_DECOMPRESS_BUFFER_NUM; i++) {
+        delete[] this->out[i];
+        this->out[i] = new char[size];
+    }
+
     this->outOffset = 0;
-    this->zstream.avail_out = size;
 }
 
 void DecompressReader::setReader(Reader *reader) {
@@ -31,99 +63,266 @@ void DecompressReader::setReader(Reader *reader) {
 }
 
 void DecompressReader::open(const S3Params &params) {
+    this->openWithoutReader();
+
+    this->reader->open(params);
+}
+
+void DecompressReader::openWithoutReader() {
     // allocate inflate state for zlib
     zstream.zalloc = Z_NULL;
     zstream.zfree = Z_NULL;
     zstream.opaque = Z_NULL;
     zstream.next_in = Z_NULL;
-    zstream.next_out = (Byte *)this->out;
+    zstream.next_out = Z_NULL;
 
     zstream.avail_in = 0;
-    zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
+    zstream.avail_out = 0;
 
+    this->readIndex = 0;
+    this->fillIndex = 0;
+    this->filledNum = 0;
     this->outOffset = 0;
 
+    this->isInputEnd = false;
+    this->isStreamEnd = false;
+    this->isEOF = false;
+    this->isStopping = false;
+    this->sharedException = NULL;
+
+    this->memberNum = 1;
+    this->decompressedBytes = 0;
+    this->inflateNanos = 0;
+
     // with S3_INFLATE_WINDOWSBITS, it could recognize and decode both zlib and gzip stream.
     int ret = inflateInit2(&zstream, S3_INFLATE_WINDOWSBITS);
     S3_CHECK_OR_DIE(ret == Z_OK, S3RuntimeError, "failed to initialize zlib library");
 
     this->isClosed = false;
-
-    this->reader->open(params);
 }
 
 uint64_t DecompressReader::read(char *buf, uint64_t bufSize) {
-    uint64_t remainingOutLen = this->getDecompressedBytesNum() - this->outOffset;
+    // Started at the first read() instead of open(), so that upstream reader is not touched by
+    // decompression thread before data is really wanted.
+    if (!this->isThreadStarted) {
+        this->startDecompressThread();
+    }
+
+    uint64_t index;
+    {
+        UniqueLock lock(&this->mutex);
+        while (this->filledNum == 0 && !this->isEOF) {
+            pthread_cond_wait(&this->cond, &this->mutex);
+        }
 
-    if (remainingOutLen == 0) {
-        this->decompress();
-        this->outOffset = 0;  // reset cursor for out buffer to read from beginning.
-        remainingOutLen = this->getDecompressedBytesNum();
+        if (this->filledNum == 0) {
+            if (this->sharedException != NULL) {
+                std::rethrow_exception(this->sharedException);
+            }
+            return 0;
+        }
+
+        index = this->readIndex;
     }
 
-    uint64_t count = std::min(remainingOutLen, bufSize);
-    memcpy(buf, this->out + outOffset, count);
+    // Filled buffer is not touched by decompression thread until it is released below.
+    uint64_t count = std::min(this->outLen[index] - this->outOffset, bufSize);
+    memcpy(buf, this->out[index] + this->outOffset, count);
 
     this->outOffset += count;
 
+    if (this->outOffset == this->outLen[index]) {
+        UniqueLock lock(&this->mutex);
+        this->outOffset = 0;
+        this->readIndex = (index + 1) % S3_ZIP_DECOMPRESS_BUFFER_NUM;
+        this->filledNum--;
+        pthread_cond_broadcast(&this->cond);
+    }
+
     return count;
 }
 
-// Read compressed data from underlying reader and decompress to this->out buffer.
-// If no more data to consume, this->zstream.avail_out == S3_ZIP_DECOMPRESS_CHUNKSIZE;
-void DecompressReader::decompress() {
-    if (this->zstream.avail_in == 0) {
-        this->zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
-        this->zstream.next_out = (Byte *)this->out;
+void *DecompressReader::DecompressThreadFunc(void *data) {
+    MaskThreadSignals();
 
-        // read S3_ZIP_DECOMPRESS_CHUNKSIZE data from underlying reader and put into this->in
-        // buffer. read() might happen more than once when reaching EOF, make sure every time read()
-        // will return 0.
-        uint64_t hasRead = this->reader->read(this->in, S3_ZIP_DECOMPRESS_CHUNKSIZE);
+    DecompressReader *reader = static_cast<DecompressReader *>(data);
 
-        // EOF, no more data to decompress.
-        if (hasRead == 0) {
-            S3DEBUG(
-                "No more data to decompress: avail_in = %u, avail_out = %u, total_in = %u, "
-                "total_out = %u",
-                zstream.avail_in, zstream.avail_out, zstream.total_in, zstream.total_out);
-            return;
+    while (true) {
+        uint64_t index;
+        {
+            UniqueLock lock(&reader->mutex);
+            while (reader->filledNum == S3_ZIP_DECOMPRESS_BUFFER_NUM && !reader->isStopping) {
+                pthread_cond_wait(&reader->cond, &reader->mutex);
+            }
+
+            if (reader->isStopping) {
+                return NULL;
+            }
+
+            index = reader->fillIndex;
         }
 
-        // Fill this->in as possible as it could, otherwise data in this->in might not be able to be
-        // inflated.
-        while (hasRead < S3_ZIP_DECOMPRESS_CHUNKSIZE) {
-            uint64_t count =
-                this->reader->read(this->in + hasRead, S3_ZIP_DECOMPRESS_CHUNKSIZE - hasRead);
+        uint64_t len = 0;
+        try {
+            len = reader->decompress(reader->out[index]);
+        } catch (...) {
+            UniqueLock lock(&reader->mutex);
+            reader->sharedException = std::current_exception();
+            reader->isEOF = true;
+            pthread_cond_broadcast(&reader->cond);
+            return NULL;
+        }
 
-            if (count == 0) {
-                break;
-            }
+        UniqueLock lock(&reader->mutex);
+        if (len == 0) {
+            reader->isEOF = true;
+            pthread_cond_broadcast(&reader->cond);
+            return NULL;
+        }
+
+        reader->outLen[index] = len;
+        reader->fillIndex = (index + 1) % S3_ZIP_DECOMPRESS_BUFFER_NUM;
+        reader->filledNum++;
+        pthread_cond_broadcast(&reader->cond);
+    }
+
+    return NULL;
+}
+
+void DecompressReader::startDecompressThread() {
+    int ret = pthread_create(&this->thread, NULL, DecompressThreadFunc, this);
+    S3_CHECK_OR_DIE(ret == 0, S3RuntimeError, "Failed to create decompression thread");
 
-            hasRead += count;
+    this->isThreadStarted = true;
+}
+
+void DecompressReader::stopDecompressThread() {
+    if (!this->isThreadStarted) {
+        return;
+    }
+
+    {
+        UniqueLock lock(&this->mutex);
+        this->isStopping = true;
+        pthread_cond_broadcast(&this->cond);
+    }
+
+    pthread_join(this->thread, NULL);
+    this->isThreadStarted = false;
+}
+
+// Read data from underlying reader and append to data left in this->in buffer. Return false if
+// no more data is read.
+bool DecompressReader::readInput() {
+    uint64_t remaining = this->zstream.avail_in;
+    if (remaining > 0) {
+        memmove(this->in, this->zstream.next_in, remaining);
+    }
+
+    // Fill this->in as possible as it could, otherwise data in this->in might not be able to be
+    // inflated. Underlying reader returns 0 every time once reaching EOF.
+    uint64_t hasRead = remaining;
+    while (hasRead < S3_ZIP_DECOMPRESS_CHUNKSIZE) {
+        uint64_t count =
+            this->reader->read(this->in + hasRead, S3_ZIP_DECOMPRESS_CHUNKSIZE - hasRead);
+
+        if (count == 0) {
+            this->isInputEnd = true;
+            break;
         }
 
-        this->zstream.next_in = (Byte *)this->in;
-        this->zstream.avail_in = hasRead;
-    } else {
-        // Still have more data in 'in' buffer to decode.
-        this->zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
-        this->zstream.next_out = (Byte *)this->out;
+        hasRead += count;
+    }
+
+    this->zstream.next_in = (Byte *)this->in;
+    this->zstream.avail_in = hasRead;
+
+    return hasRead > remaining;
+}
+
+// Data following a finished gzip member is either another member or trailing data (e.g. EOL
+// appended by key reader), which is ignored as gzip does. Return true if next member starts.
+bool DecompressReader::startNextMember() {
+    if (this->zstream.avail_in < 2 && !this->isInputEnd) {
+        this->readInput();
     }
 
-    int status = inflate(&this->zstream, Z_NO_FLUSH);
-    if (status == Z_STREAM_END) {
-        S3DEBUG("Decompression finished: Z_STREAM_END.");
-    } else if (status < 0 || status == Z_NEED_DICT) {
-        inflateEnd(&this->zstream);
-        S3_CHECK_OR_DIE(
-            false, S3RuntimeError,
-            string("Failed to decompress data: ") + std::to_string((unsigned long long)status));
+    if (this->zstream.avail_in >= 2 && this->zstream.next_in[0] == 0x1f &&
+        this->zstream.next_in[1] == 0x8b) {
+        int ret = inflateReset(&this->zstream);
+        S3_CHECK_OR_DIE(ret == Z_OK, S3RuntimeError, "failed to reset zlib library");
+
+        this->isStreamEnd = false;
+        this->memberNum++;
+        return true;
     }
+
+    if (this->zstream.avail_in > 0) {
+        S3DEBUG("Ignored %u bytes of trailing data after gzip stream", this->zstream.avail_in);
+        this->zstream.avail_in = 0;
+    }
+
+    return false;
+}
+
+// Decompress data from underlying reader into out buffer of S3_ZIP_DECOMPRESS_CHUNKSIZE, return
+// size of decompressed data. Return 0 only if there is no more data. Called by decompression
+// thread only.
+uint64_t DecompressReader::decompress(char *out) {
+    this->zstream.next_out = (Byte *)out;
+    this->zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
+
+    while (true) {
+        if (this->isStreamEnd && !this->startNextMember()) {
+            break;
+        }
+
+        if (this->zstream.avail_in == 0 && !this->isInputEnd) {
+            this->readInput();
+        }
+
+        // inflate() is called even if no input left, to flush pending output.
+        uint64_t startNanos = getMonotonicNanos();
+        int status = inflate(&this->zstream, Z_NO_FLUSH);
+        this->inflateNanos += getMonotonicNanos() - startNanos;
+
+        if (status == Z_STREAM_END) {
+            S3DEBUG("Decompression finished: Z_STREAM_END.");
+            this->isStreamEnd = true;
+        } else if (status == Z_NEED_DICT || (status < 0 && status != Z_BUF_ERROR)) {
+            S3_CHECK_OR_DIE(
+                false, S3RuntimeError,
+                string("Failed to decompress data: ") + std::to_string((unsigned long long)status));
+        }
+
+        uint64_t decompressedLen = S3_ZIP_DECOMPRESS_CHUNKSIZE - this->zstream.avail_out;
+        if (decompressedLen > 0) {
+            this->decompressedBytes += decompressedLen;
+            return decompressedLen;
+        }
+
+        if (this->isInputEnd && this->zstream.avail_in == 0 && !this->isStreamEnd) {
+            S3DEBUG(
+                "No more data to decompress: avail_in = %u, avail_out = %u, total_in = %lu, "
+                "total_out = %lu",
+                zstream.avail_in, zstream.avail_out, zstream.total_in, zstream.total_out);
+            break;
+        }
+    }
+
+    return 0;
 }
 
 void DecompressReader::close() {
     if (!this->isClosed) {
+        this->stopDecompressThread();
+
+        double seconds = this->inflateNanos / 1e9;
+        S3DEBUG("Decompressed %" PRIu64 " bytes from %" PRIu64
+                " gzip member(s), inflate took %.3f seconds, %.2f MB/s",
+                this->decompressedBytes, this->memberNum, seconds,
+                seconds > 0 ? this->decompressedBytes / seconds / 1024 / 1024 : 0.0);
+
         inflateEnd(&zstream);
         this->reader->close();
         this->isClosed = true;
@@ -17,7 +17,7 @@ S3BucketReader::~S3BucketReader() {
 void S3BucketReader::open(const S3Params& params) {
     this->params = params;
 
-    this->keyIndex = s3ext_segid;  // we may change it in unit tests
+    this->keyIndex = 0;
 
     S3_CHECK_OR_DIE(this->s3Interface != NULL, S3RuntimeError, "s3Interface is NULL");
 
@@ -26,12 +26,70 @@ void S3BucketReader::open(const S3Params& params) {
     S3_CHECK_OR_DIE(s3Url.isValidUrl(), S3ConfigError, s3Url.getFullUrlForCurl() + " is not valid",
                     s3Url.getFullUrlForCurl());
 
-    this->keyList = this->s3Interface->listBucket(s3Url);
+    S3KeyManifest manifest(this->params);
+    this->keyList = manifest.listBucket(this->s3Interface, s3Url);
+
+    this->distributeKeys();
+}
+
+// Every segment computes the whole distribution by itself and picks up its own share without any
+// coordination, so the segments of a query must list the same keys. Segments on the same host
+// share the list of the query through the manifest, if it's enabled.
+void S3BucketReader::distributeKeys() {
+    vector<BucketContent>& contents = this->keyList.contents;
+    this->segmentKeys.clear();
+
+    if (this->params.getKeyDistType() == KEY_DIST_ROUNDROBIN) {
+        for (uint64_t i = s3ext_segid; i < contents.size(); i += s3ext_segnum) {
+            this->segmentKeys.push_back(i);
+        }
+        return;
+    }
+
+    // Greedy longest-processing-time assignment: assign keys from the largest to the smallest,
+    // each to the segment having the least bytes so far. Ties are broken by key index and
+    // segment id, to make sure all segments get the same result.
+    vector<uint64_t> sortedKeys(contents.size());
+    for (uint64_t i = 0; i < contents.size(); i++) {
+        sortedKeys[i] = i;
+    }
+
+    std::stable_sort(sortedKeys.begin(), sortedKeys.end(), [&contents](uint64_t a, uint64_t b) {
+        return contents[a].getSize() > contents[b].getSize();
+    });
+
+    typedef std::pair<uint64_t, int32_t> SegmentLoad;  // (bytes assigned, segment id)
+    std::priority_queue<SegmentLoad, vector<SegmentLoad>, std::greater<SegmentLoad> > loads;
+    for (int32_t seg = 0; seg < s3ext_segnum; seg++) {
+        loads.push(SegmentLoad(0, seg));
+    }
+
+    uint64_t segmentBytes = 0;
+    for (uint64_t i = 0; i < sortedKeys.size(); i++) {
+        SegmentLoad load = loads.top();
+        loads.pop();
+
+        uint64_t keySize = contents[sortedKeys[i]].getSize();
+        if (load.second == s3ext_segid) {
+            this->segmentKeys.push_back(sortedKeys[i]);
+            segmentBytes += keySize;
+        }
+
+        load.first += keySize;
+        loads.push(load);
+    }
+
+    // Read keys in the listed order, as round-robin does.
+    std::sort(this->segmentKeys.begin(), this->segmentKeys.end());
+
+    S3DEBUG("Segment %d is assigned %" PRIu64 " of %" PRIu64 " keys, %" PRIu64 " bytes",
+            s3ext_segid, (uint64_t)this->segmentKeys.size(), (uint64_t)contents.size(),
+            segmentBytes);
 }
 
 BucketContent& S3BucketReader::getNextKey() {
-    BucketContent& key = this->keyList.contents[this->keyIndex];
-    this->keyIndex += s3ext_segnum;
+    BucketContent& key = this->keyList.contents[this->segmentKeys[this->keyIndex]];
+    this->keyIndex++;
     return key;
 }
 
@@ -98,7 +156,7 @@ uint64_t S3BucketReader::read(char* buf, uint64_t count) {
     uint64_t readCount = 0;
     while (true) {
         if (this->needNewReader) {
-            if (this->keyIndex >= this->keyList.contents.size()) {
+            if (this->keyIndex >= this->segmentKeys.size()) {
                 S3DEBUG("Read finished for segment: %d", s3ext_segid);
                 return 0;
             }
@@ -137,4 +195,6 @@ void S3BucketReader::close() {
     if (!this->keyList.contents.empty()) {
         this->keyList.contents.clear();
     }
+
+    this->segmentKeys.clear();
 }
\ No newline at end of file
@@ -3,12 +3,23 @@
 void S3CommonReader::open(const S3Params &params) {
     this->keyReader.setS3InterfaceService(s3InterfaceService);
 
-    S3CompressionType compressionType = s3InterfaceService->checkCompressionType(params.getS3Url());
+    // Key reader starts downloading at once, compression type is then detected from the first
+    // bytes of the first chunk, no extra request is needed.
+    this->keyReader.open(params);
+
+    S3CompressionType compressionType = this->detectCompressionType();
 
     switch (compressionType) {
         case S3_COMPRESSION_GZIP:
             this->upstreamReader = &this->decompressReader;
             this->decompressReader.setReader(&this->keyReader);
+            this->decompressReader.openWithoutReader();
+            break;
+        case S3_COMPRESSION_ZSTD:
+        case S3_COMPRESSION_LZ4:
+            this->upstreamReader = &this->codecReader;
+            this->codecReader.setReader(&this->keyReader);
+            this->codecReader.openWithoutReader(compressionType);
             break;
         case S3_COMPRESSION_PLAIN:
             this->upstreamReader = &this->keyReader;
@@ -16,8 +27,17 @@ void S3CommonReader::open(const S3Params &params) {
         default:
             S3_CHECK_OR_DIE(false, S3RuntimeError, "unknown file type");
     };
+}
+
+S3CompressionType S3CommonReader::detectCompressionType() {
+    unsigned char magic[S3_MAGIC_BYTES_NUM] = {0};
 
-    this->upstreamReader->open(params);
+    uint64_t len = this->keyReader.peek((char *)magic, S3_MAGIC_BYTES_NUM);
+    if (len < S3_MAGIC_BYTES_NUM) {
+        return S3_COMPRESSION_PLAIN;
+    }
+
+    return DetectCompressionType(magic, len);
 }
 
 // read() attempts to read up to count bytes into the buffer.
@@ -32,4 +52,7 @@ void S3CommonReader::close() {
         this->upstreamReader->close();
         this->upstreamReader = NULL;
     }
+
+    // Key reader is opened before upstream reader is decided, close it in case detection failed.
+    this->keyReader.close();
 }
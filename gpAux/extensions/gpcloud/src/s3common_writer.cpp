@@ -3,9 +3,12 @@
 void S3CommonWriter::open(const S3Params& params) {
     this->keyWriter.setS3InterfaceService(this->s3InterfaceService);
 
-    if (params.isAutoCompress()) {
+    if (params.isAutoCompress() && params.getCompressionType() == S3_COMPRESSION_GZIP) {
         this->upstreamWriter = &this->compressWriter;
         this->compressWriter.setWriter(&this->keyWriter);
+    } else if (params.isAutoCompress()) {
+        this->upstreamWriter = &this->codecWriter;
+        this->codecWriter.setWriter(&this->keyWriter);
     } else {
         this->upstreamWriter = &this->keyWriter;
     }
@@ -1,8 +1,10 @@
+#include "codec.h"
 #include "s3conf.h"
 #include "s3macros.h"
 #include "s3params.h"
 
 #include <arpa/inet.h>
+#include <unistd.h>
 
 #ifndef S3_STANDALONE
 extern "C" {
@@ -77,6 +79,13 @@ S3Params InitConfig(const string& urlWithOptions) {
         params.setSSEType(SSE_NONE);
     }
 
+    string keyDist = s3Cfg.Get(configSection, "key_distribution", "size");
+    if (keyDist == "roundrobin") {
+        params.setKeyDistType(KEY_DIST_ROUNDROBIN);
+    } else {
+        params.setKeyDistType(KEY_DIST_SIZE);
+    }
+
     string content = s3Cfg.Get(configSection, "loglevel", "WARNING");
     s3ext_loglevel = getLogLevel(content.c_str());
 
@@ -99,6 +108,32 @@ S3Params InitConfig(const string& urlWithOptions) {
                                        8 * 1024 * 1024, 128 * 1024 * 1024);
     params.setChunkSize(chunkSize);
 
+    // compression in URL takes precedence over the one in config file, if neither is set, data is
+    // compressed with gzip only if autocompress is true. Uploaded files are not compressed by
+    // default, as before these options existed.
+    string compression = GetOptS3(urlWithOptions, "compression");
+    if (compression.empty()) {
+        compression = s3Cfg.Get(configSection, "compression", "");
+    }
+
+    if (compression.empty()) {
+        params.setAutoCompress(s3Cfg.GetBool(configSection, "autocompress", "false"));
+    } else {
+        S3CompressionType compressionType;
+        S3_CHECK_OR_DIE(ParseCompressionType(compression, compressionType), S3ConfigError,
+                        "Unknown compression type '" + compression +
+                            "', it should be one of gzip, zstd, lz4 and none",
+                        "compression");
+
+        params.setAutoCompress(compressionType != S3_COMPRESSION_PLAIN);
+        if (compressionType != S3_COMPRESSION_PLAIN) {
+            params.setCompressionType(compressionType);
+        }
+    }
+
+    int64_t compressThreadNum = s3Cfg.SafeScan("compress_threadnum", configSection, 1, 1, 8);
+    params.setCompressThreadNum(compressThreadNum);
+
     int64_t lowSpeedLimit = s3Cfg.SafeScan("low_speed_limit", configSection, 10240, 0, INT_MAX);
     params.setLowSpeedLimit(lowSpeedLimit);
 
@@ -107,6 +142,21 @@ S3Params InitConfig(const string& urlWithOptions) {
 
     params.setVerifyCert(verifyCert);
 
+    // Relative to the data directory, the working directory of segments.
+    params.setManifestDir(s3Cfg.Get(configSection, "manifest_dir", "gpcloud_manifest"));
+
+    int64_t manifestTTL = s3Cfg.SafeScan("manifest_ttl", configSection, 0, 0, INT_MAX);
+    params.setManifestTTL(manifestTTL);
+
+    // All segments of a query get the same session id and command count from the dispatcher.
+    stringstream queryId;
+#ifdef S3_STANDALONE
+    queryId << getpid();
+#else
+    queryId << gp_session_id << "-" << gp_command_count;
+#endif
+    params.setQueryId(queryId.str());
+
     CheckEssentialConfig(params);
 
     return params;
@@ -308,10 +308,8 @@ ListBucketResult S3InterfaceService::listBucket(S3Url &s3Url) {
     return result;
 }
 
-uint64_t S3InterfaceService::fetchData(uint64_t offset, S3VectorUInt8 &data, uint64_t len,
-                                       const S3Url &s3Url) {
-    HTTPHeaders headers;
-
+void S3InterfaceService::addRangeHeaders(HTTPHeaders &headers, const S3Url &s3Url,
+                                         uint64_t offset, uint64_t len) {
     char rangeBuf[S3_RANGE_HEADER_STRING_LEN] = {0};
     snprintf(rangeBuf, sizeof(rangeBuf), "bytes=%" PRIu64 "-%" PRIu64, offset, offset + len - 1);
     headers.Add(HOST, s3Url.getHostForCurl());
@@ -323,6 +321,12 @@ uint64_t S3InterfaceService::fetchData(uint64_t offset, S3VectorUInt8 &data, uin
 
     SignRequestV4("GET", &headers, s3Url.getRegion(), s3Url.getPathForCurl(), "",
                   this->params.getCred());
+}
+
+uint64_t S3InterfaceService::fetchData(uint64_t offset, S3VectorUInt8 &data, uint64_t len,
+                                       const S3Url &s3Url) {
+    HTTPHeaders headers;
+    this->addRangeHeaders(headers, s3Url, offset, len);
 
     Response resp = this->getResponseWithRetries(s3Url.getFullUrlForCurl(), headers);
     if (resp.getStatus() == RESPONSE_OK) {
@@ -337,43 +341,78 @@ uint64_t S3InterfaceService::fetchData(uint64_t offset, S3VectorUInt8 &data, uin
     }
 }
 
-S3CompressionType S3InterfaceService::checkCompressionType(const S3Url &s3Url) {
-    HTTPHeaders headers;
+// ResumableReceiver counts data handed to the real receiver, so that a broken transfer could be
+// resumed from where it stopped instead of from the beginning.
+class ResumableReceiver : public DataReceiver {
+   public:
+    ResumableReceiver(DataReceiver &receiver)
+        : receiver(receiver), receivedLen(0), rejected(false) {
+    }
 
-    char rangeBuf[S3_RANGE_HEADER_STRING_LEN] = {0};
-    snprintf(rangeBuf, sizeof(rangeBuf), "bytes=%d-%d", 0, S3_MAGIC_BYTES_NUM - 1);
+    bool receive(const char *ptr, uint64_t size) {
+        if (!this->receiver.receive(ptr, size)) {
+            this->rejected = true;
+            return false;
+        }
 
-    headers.Add(HOST, s3Url.getHostForCurl());
-    headers.Add(RANGE, rangeBuf);
-    headers.Add(X_AMZ_CONTENT_SHA256,
-                "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");  // sha256hex
-                                                                                      // of empty
-                                                                                      // string
+        this->receivedLen += size;
+        return true;
+    }
 
-    SignRequestV4("GET", &headers, s3Url.getRegion(), s3Url.getPathForCurl(), "",
-                  this->params.getCred());
+    DataReceiver &receiver;
+    uint64_t receivedLen;
+    bool rejected;
+};
 
-    Response resp = this->getResponseWithRetries(s3Url.getFullUrlForCurl(), headers);
-    if (resp.getStatus() == RESPONSE_OK) {
-        S3VectorUInt8 &responseData = resp.getRawData();
-        if (responseData.size() < S3_MAGIC_BYTES_NUM) {
-            return S3_COMPRESSION_PLAIN;
-        }
+uint64_t S3InterfaceService::streamData(uint64_t offset, DataReceiver &receiver, uint64_t len,
+                                        const S3Url &s3Url) {
+    ResumableReceiver resumableReceiver(receiver);
+    string url = s3Url.getFullUrlForCurl();
+    string message;
+
+    uint64_t retry = S3_REQUEST_MAX_RETRIES;
+    while (retry--) {
+        uint64_t receivedLen = resumableReceiver.receivedLen;
 
-        S3_CHECK_OR_DIE(responseData.size() == S3_MAGIC_BYTES_NUM, S3PartialResponseError,
-                        S3_MAGIC_BYTES_NUM, responseData.size());
+        HTTPHeaders headers;
+        this->addRangeHeaders(headers, s3Url, offset + receivedLen, len - receivedLen);
 
-        if ((responseData[0] == 0x1f) && (responseData[1] == 0x8b)) {
-            return S3_COMPRESSION_GZIP;
+        try {
+            Response resp = this->restfulService->streamingGet(url, headers, resumableReceiver);
+
+            if (resp.getStatus() == RESPONSE_OK) {
+                S3_CHECK_OR_DIE(resumableReceiver.receivedLen == len, S3PartialResponseError, len,
+                                resumableReceiver.receivedLen);
+                return len;
+            } else if (resumableReceiver.rejected) {
+                S3_DIE(S3RuntimeError, "Data is rejected by receiver");
+            } else if (resp.getStatus() == RESPONSE_ERROR) {
+                S3MessageParser s3msg(resp);
+                S3_DIE(S3LogicError, s3msg.getCode(), s3msg.getMessage());
+            } else {
+                S3_DIE(S3RuntimeError, "unexpected response status");
+            }
+        } catch (S3ConnectionError &e) {
+            message = e.getMessage();
+            if (S3QueryIsAbortInProgress()) {
+                S3_DIE(S3QueryAbort, "Downloading is interrupted");
+            }
+
+            // Receiver refuses more data, curl treats it as a write error.
+            S3_CHECK_OR_DIE(!resumableReceiver.rejected, S3RuntimeError,
+                            "Data is rejected by receiver");
+
+            if (resumableReceiver.receivedLen == len) {
+                return len;
+            }
+
+            S3WARN("Failed to get a good response in GET from '%s', retrying from offset %" PRIu64
+                   " ...",
+                   url.c_str(), offset + resumableReceiver.receivedLen);
         }
-    } else if (resp.getStatus() == RESPONSE_ERROR) {
-        S3MessageParser s3msg(resp);
-        S3_DIE(S3LogicError, s3msg.getCode(), s3msg.getMessage());
-    } else {
-        S3_DIE(S3RuntimeError, "unexpected response status");
     }
 
-    return S3_COMPRESSION_PLAIN;
+    S3_DIE(S3FailedAfterRetry, url, S3_REQUEST_MAX_RETRIES, message);
 }
 
 bool S3InterfaceService::checkKeyExistence(const S3Url &s3Url) {
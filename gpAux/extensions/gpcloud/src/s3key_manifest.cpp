@@ -0,0 +1,230 @@
+#include "s3key_manifest.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <fstream>
+
+// use destructor ~FileLockHolder() to release the lock
+class FileLockHolder {
+   public:
+    FileLockHolder(const string& path) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+        if (fd >= 0 && flock(fd, LOCK_EX) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    ~FileLockHolder() {
+        if (fd >= 0) {
+            flock(fd, LOCK_UN);
+            ::close(fd);
+        }
+    }
+
+    bool isLocked() const {
+        return fd >= 0;
+    }
+
+   private:
+    int fd;
+};
+
+S3KeyManifest::S3KeyManifest(const S3Params& params)
+    : manifestDir(params.getManifestDir()),
+      ttl(params.getManifestTTL()),
+      cred(params.getCred()),
+      queryId(params.getQueryId()) {
+}
+
+string S3KeyManifest::getManifestPath(const S3Url& s3Url) const {
+    // Different credentials might see different keys, so access id is a part of the cache key.
+    stringstream ss;
+    ss << s3Url.getFullUrlForCurl() << "\n" << s3Url.getRegion() << "\n" << this->cred.accessID
+       << "\n" << this->queryId;
+
+    char hash[SHA256_DIGEST_STRING_LENGTH];
+    sha256_hex(ss.str().c_str(), hash);
+
+    return this->manifestDir + "/gpcloud_manifest_" + hash;
+}
+
+ListBucketResult S3KeyManifest::listBucket(S3Interface* s3Interface, S3Url& s3Url) {
+    if (this->ttl == 0) {
+        return s3Interface->listBucket(s3Url);
+    }
+
+    // The directory is created on demand, readable by the owner only, since the key list might be
+    // confidential.
+    if (mkdir(this->manifestDir.c_str(), S_IRWXU) != 0 && errno != EEXIST) {
+        S3WARN("Failed to create manifest directory '%s', list bucket directly",
+               this->manifestDir.c_str());
+        return s3Interface->listBucket(s3Url);
+    }
+
+    string path = this->getManifestPath(s3Url);
+
+    FileLockHolder lock(path + ".lock");
+    if (!lock.isLocked()) {
+        S3WARN("Failed to lock manifest '%s', list bucket directly", path.c_str());
+        return s3Interface->listBucket(s3Url);
+    }
+
+    // However old it is, the list of the query is the one its other segments have used.
+    ListBucketResult result;
+    if (this->load(path, result)) {
+        S3DEBUG("Loaded %" PRIu64 " keys from manifest '%s'", (uint64_t)result.contents.size(),
+                path.c_str());
+        return result;
+    }
+
+    result = s3Interface->listBucket(s3Url);
+
+    if (!this->save(path, result)) {
+        S3WARN("Failed to save manifest '%s'", path.c_str());
+    }
+
+    this->removeExpired(path);
+
+    return result;
+}
+
+// Remove the manifests and lock files of earlier queries, once they are older than the TTL. A
+// segment that starts reading that late would list the bucket again.
+void S3KeyManifest::removeExpired(const string& path) const {
+    DIR* dir = opendir(this->manifestDir.c_str());
+    if (dir == NULL) {
+        return;
+    }
+
+    string ownName = path.substr(path.rfind('/') + 1);
+    time_t now = this->now();
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        string name = entry->d_name;
+        if (name.compare(0, strlen("gpcloud_manifest_"), "gpcloud_manifest_") != 0 ||
+            name.compare(0, ownName.size(), ownName) == 0) {
+            continue;
+        }
+
+        string entryPath = this->manifestDir + "/" + name;
+        struct stat st;
+        if (lstat(entryPath.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+
+        if (now >= st.st_mtime && (uint64_t)(now - st.st_mtime) >= this->ttl) {
+            S3DEBUG("Removing expired manifest '%s'", entryPath.c_str());
+            unlink(entryPath.c_str());
+        }
+    }
+
+    closedir(dir);
+}
+
+// Strings are saved as "<length> <content>\n", so that key names could contain any character.
+static void writeString(std::ostream& out, const string& str) {
+    out << str.size() << " " << str << "\n";
+}
+
+static bool readString(std::istream& in, string& str) {
+    uint64_t len = 0;
+    if (!(in >> len) || in.get() != ' ') {
+        return false;
+    }
+
+    str.resize(len);
+    if (len > 0 && !in.read(&str[0], len)) {
+        return false;
+    }
+
+    return in.get() == '\n';
+}
+
+bool S3KeyManifest::load(const string& path, ListBucketResult& result) const {
+    std::ifstream in(path.c_str(), std::ios::binary);
+
+    string magic;
+    uint64_t count = 0;
+    if (!std::getline(in, magic) || magic != S3_MANIFEST_MAGIC) {
+        return false;
+    }
+
+    if (!readString(in, result.Name) || !readString(in, result.Prefix) || !(in >> count)) {
+        return false;
+    }
+
+    result.contents.clear();
+    result.contents.reserve(count);
+
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t size = 0;
+        string name;
+        if (!(in >> size) || in.get() != ' ' || !readString(in, name)) {
+            result.contents.clear();
+            return false;
+        }
+        result.contents.emplace_back(name, size);
+    }
+
+    return true;
+}
+
+bool S3KeyManifest::save(const string& path, const ListBucketResult& result) const {
+    stringstream out;
+
+    out << S3_MANIFEST_MAGIC << "\n";
+    writeString(out, result.Name);
+    writeString(out, result.Prefix);
+    out << result.contents.size() << "\n";
+
+    for (uint64_t i = 0; i < result.contents.size(); i++) {
+        out << result.contents[i].getSize() << " ";
+        writeString(out, result.contents[i].getName());
+    }
+
+    // Write to a temporary file first, and rename it to make the update atomic. The file is
+    // created with owner-only permissions regardless of umask, and O_EXCL makes sure we never
+    // write through a file or link someone else left behind.
+    stringstream tmpPath;
+    tmpPath << path << "." << getpid();
+    unlink(tmpPath.str().c_str());
+
+    int fd = ::open(tmpPath.str().c_str(), O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        return false;
+    }
+
+    string content = out.str();
+    const char* buf = content.data();
+    size_t left = content.size();
+    while (left > 0) {
+        ssize_t written = ::write(fd, buf, left);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            ::close(fd);
+            unlink(tmpPath.str().c_str());
+            return false;
+        }
+        buf += written;
+        left -= written;
+    }
+
+    if (::close(fd) != 0) {
+        unlink(tmpPath.str().c_str());
+        return false;
+    }
+
+    if (rename(tmpPath.str().c_str(), path.c_str()) != 0) {
+        unlink(tmpPath.str().c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -59,7 +59,10 @@ uint64_t ChunkBuffer::read(char* buf, uint64_t len) {
     S3_CHECK_OR_DIE(!S3QueryIsAbortInProgress(), S3QueryAbort, "");
 
     UniqueLock statusLock(&this->statusMutex);
-    while (this->status != ReadyToRead) {
+
+    // While chunk is being downloaded, wait for enough data only, instead of the whole chunk.
+    while (this->status == ReadyToFill ||
+           (this->status == Filling && this->chunkData.size() - this->curChunkOffset < len)) {
         pthread_cond_wait(&this->statusCondVar, &this->statusMutex);
     }
 
@@ -68,6 +71,12 @@ uint64_t ChunkBuffer::read(char* buf, uint64_t len) {
         return 0;
     }
 
+    if (this->status == Filling) {
+        memcpy(buf, this->chunkData.data() + this->curChunkOffset, len);
+        this->curChunkOffset += len;
+        return len;
+    }
+
     uint64_t leftLen = this->chunkDataSize - this->curChunkOffset;
     uint64_t lenToRead = std::min(len, leftLen);
 
@@ -97,29 +106,82 @@ uint64_t ChunkBuffer::read(char* buf, uint64_t len) {
     return lenToRead;
 }
 
-// returning uint64_t(-1) means error
-uint64_t ChunkBuffer::fill() {
+uint64_t ChunkBuffer::peek(char* buf, uint64_t len) {
     UniqueLock statusLock(&this->statusMutex);
 
-    while (this->status != ReadyToFill) {
+    while (this->status == ReadyToFill ||
+           (this->status == Filling && this->chunkData.size() - this->curChunkOffset < len)) {
         pthread_cond_wait(&this->statusCondVar, &this->statusMutex);
     }
 
+    if (this->isError()) {
+        return 0;
+    }
+
+    uint64_t lenToPeek = len;
+    if (this->status == ReadyToRead) {
+        lenToPeek = std::min(len, this->chunkDataSize - this->curChunkOffset);
+    }
+
+    if (lenToPeek != 0) {
+        memcpy(buf, this->chunkData.data() + this->curChunkOffset, lenToPeek);
+    }
+
+    return lenToPeek;
+}
+
+bool ChunkBuffer::receive(const char* ptr, uint64_t size) {
+    UniqueLock statusLock(&this->statusMutex);
+
     if (S3QueryIsAbortInProgress() || this->isError()) {
-        this->setSharedError(true);
-        this->status = ReadyToRead;
-        pthread_cond_signal(&this->statusCondVar);
-        return -1;
+        return false;
     }
 
-    uint64_t offset = this->curFileOffset;
-    uint64_t leftLen = this->chunkDataSize;
+    // Never grow beyond the reserved size, reader might be reading chunkData now.
+    if (this->chunkData.size() + size > this->chunkDataSize) {
+        S3DEBUG("Got more data than requested from S3");
+        return false;
+    }
+
+    this->chunkData.insert(this->chunkData.end(), ptr, ptr + size);
+    pthread_cond_signal(&this->statusCondVar);
+
+    return true;
+}
+
+// returning uint64_t(-1) means error
+uint64_t ChunkBuffer::fill() {
+    uint64_t offset = 0;
+    uint64_t leftLen = 0;
+
+    {
+        UniqueLock statusLock(&this->statusMutex);
+
+        while (this->status != ReadyToFill) {
+            pthread_cond_wait(&this->statusCondVar, &this->statusMutex);
+        }
+
+        if (S3QueryIsAbortInProgress() || this->isError()) {
+            this->setSharedError(true);
+            this->status = ReadyToRead;
+            pthread_cond_signal(&this->statusCondVar);
+            return -1;
+        }
+
+        offset = this->curFileOffset;
+        leftLen = this->chunkDataSize;
+
+        // Reserve the whole chunk at once, data arrived is appended without reallocation.
+        this->chunkData.reserve(leftLen);
+        this->status = Filling;
+    }
 
     uint64_t readLen = 0;
 
+    // Lock is not held while downloading, data is handed to reader by receive() as it arrives.
     if (leftLen != 0) {
         try {
-            readLen = this->s3Interface->fetchData(offset, this->chunkData, leftLen, this->s3Url);
+            readLen = this->s3Interface->streamData(offset, *this, leftLen, this->s3Url);
             if (readLen != leftLen) {
                 S3DEBUG("Failed to fetch expected data from S3");
                 this->setSharedError(true, S3PartialResponseError(leftLen, readLen));
@@ -132,6 +194,8 @@ uint64_t ChunkBuffer::fill() {
         }
     }
 
+    UniqueLock statusLock(&this->statusMutex);
+
     if (offset + leftLen >= offsetMgr.getKeySize()) {
         readLen = 0;  // Nothing to read, EOF
         S3DEBUG("Reached the end of file");
@@ -233,13 +297,7 @@ uint64_t S3KeyReader::read(char* buf, uint64_t count) {
 
         readLen = buffer.read(buf, count);
 
-        if (this->isSharedError()) {
-            if (this->sharedException != NULL) {
-                std::rethrow_exception(this->sharedException);
-            } else {
-                throw S3RuntimeError("Unexpected runtime error, sharedException is NULL");
-            }
-        }
+        this->rethrowSharedError();
 
         this->transferredKeyLen += readLen;
         if (this->transferredKeyLen == fileLen) {
@@ -259,6 +317,30 @@ uint64_t S3KeyReader::read(char* buf, uint64_t count) {
     return readLen;
 }
 
+uint64_t S3KeyReader::peek(char* buf, uint64_t count) {
+    if (this->transferredKeyLen >= this->offsetMgr.getKeySize()) {
+        return 0;
+    }
+
+    ChunkBuffer& buffer = chunkBuffers[this->curReadingChunk % this->numOfChunks];
+
+    uint64_t peekLen = buffer.peek(buf, count);
+
+    this->rethrowSharedError();
+
+    return peekLen;
+}
+
+void S3KeyReader::rethrowSharedError() {
+    if (this->isSharedError()) {
+        if (this->sharedException != NULL) {
+            std::rethrow_exception(this->sharedException);
+        } else {
+            throw S3RuntimeError("Unexpected runtime error, sharedException is NULL");
+        }
+    }
+}
+
 // reset marks before reading next key
 void S3KeyReader::reset() {
     this->sharedError = false;
@@ -6,13 +6,43 @@ void S3KeyWriter::open(const S3Params& params) {
     S3_CHECK_OR_DIE(this->s3Interface != NULL, S3RuntimeError, "s3Interface must not be NULL");
     S3_CHECK_OR_DIE(this->params.getChunkSize() > 0, S3RuntimeError, "chunkSize must not be zero");
 
-    buffer.reserve(this->params.getChunkSize());
+    this->partNumber = 0;
+    this->bufferLimit = this->getPartSize(1);
+    buffer.reserve(this->bufferLimit);
 
     this->uploadId = this->s3Interface->getUploadId(this->params.getS3Url());
     S3_CHECK_OR_DIE(!this->uploadId.empty(), S3RuntimeError, "Failed to get upload id");
 
     S3DEBUG("key: %s, upload id: %s", this->params.getS3Url().getFullUrlForCurl().c_str(),
             this->uploadId.c_str());
+
+    this->startUploadThreads();
+}
+
+// Parts start small, so that uploading starts early and small keys don't hold a whole chunk, and
+// double until reaching chunksize. Then part size doubles after every S3_PART_SIZE_GROWTH_PARTS
+// parts, so that huge keys fit in S3's limit of 10,000 parts.
+uint64_t S3KeyWriter::getPartSize(uint64_t partNumber) const {
+    uint64_t chunkSize = this->params.getChunkSize();
+    uint64_t partSize = std::min(chunkSize, (uint64_t)S3_MIN_PART_SIZE);
+
+    for (uint64_t i = 1; i < partNumber && partSize < chunkSize; i++) {
+        partSize = std::min(partSize * 2, chunkSize);
+    }
+
+    uint64_t maxPartSize = std::max(chunkSize, (uint64_t)S3_MAX_PART_SIZE);
+    for (uint64_t i = S3_PART_SIZE_GROWTH_PARTS; i < partNumber && partSize < maxPartSize;
+         i += S3_PART_SIZE_GROWTH_PARTS) {
+        partSize = std::min(partSize * 2, maxPartSize);
+    }
+
+    return partSize;
+}
+
+// Parts being uploaded get as much memory as threadnum chunks, which is what the chunk buffers of
+// the writer are sized for.
+uint64_t S3KeyWriter::getInflightLimit() const {
+    return std::max(this->params.getNumOfChunks(), (uint64_t)1) * this->params.getChunkSize();
 }
 
 // write() first fills up the data buffer before flush it out
@@ -27,13 +57,13 @@ uint64_t S3KeyWriter::write(const char* buf, uint64_t count) {
             std::rethrow_exception(sharedException);
         }
 
-        uint64_t bufferRemaining = this->params.getChunkSize() - this->buffer.size();
+        uint64_t bufferRemaining = this->bufferLimit - this->buffer.size();
         uint64_t dataRemaining = count - offset;
         uint64_t dataToBuffer = bufferRemaining < dataRemaining ? bufferRemaining : dataRemaining;
 
         this->buffer.insert(this->buffer.end(), buf + offset, buf + offset + dataToBuffer);
 
-        if (this->buffer.size() == this->params.getChunkSize()) {
+        if (this->buffer.size() == this->bufferLimit) {
             this->flushBuffer();
         }
 
@@ -50,19 +80,11 @@ void S3KeyWriter::close() {
     }
 }
 
+// Must be called without this->mutex held.
 void S3KeyWriter::checkQueryCancelSignal() {
     if (S3QueryIsAbortInProgress() && !this->uploadId.empty()) {
-        // to avoid dead-lock when other upload threads hold the lock
-        pthread_mutex_unlock(&this->mutex);
-
-        // wait for all threads to complete
-        for (size_t i = 0; i < threadList.size(); i++) {
-            pthread_join(threadList[i], NULL);
-        }
-        this->threadList.clear();
-
-        // to avoid double unlock as other parts may lock it
-        pthread_mutex_lock(&this->mutex);
+        // wait for all threads to complete, S3Interface gives up uploading once query is aborted.
+        this->stopUploadThreads();
 
         S3DEBUG("Start aborting multipart uploading (uploadID: %s, %lu parts uploaded)",
                 this->uploadId.c_str(), this->etagList.size());
@@ -76,72 +98,139 @@ void S3KeyWriter::checkQueryCancelSignal() {
     }
 }
 
-struct ThreadParams {
-    S3KeyWriter* keyWriter;
-    S3VectorUInt8 data;
-    uint64_t currentNumber;
-};
+void S3KeyWriter::startUploadThreads() {
+    this->stopUploadThreads();
+
+    this->isStopping = false;
+
+    uint64_t threadNum = std::max(this->params.getNumOfChunks(), (uint64_t)1);
+    for (uint64_t i = 0; i < threadNum; i++) {
+        pthread_t thread;
+        int ret = pthread_create(&thread, NULL, UploadThreadFunc, this);
+        if (ret != 0) {
+            this->stopUploadThreads();
+            S3_DIE(S3RuntimeError, "Failed to create upload thread");
+        }
+
+        this->threadList.push_back(thread);
+    }
+}
+
+// Upload threads exit after all queued parts are uploaded.
+void S3KeyWriter::stopUploadThreads() {
+    {
+        UniqueLock queueLock(&this->mutex);
+        this->isStopping = true;
+        pthread_cond_broadcast(&this->cv);
+    }
+
+    for (size_t i = 0; i < this->threadList.size(); i++) {
+        pthread_join(this->threadList[i], NULL);
+    }
+    this->threadList.clear();
+}
 
 void* S3KeyWriter::UploadThreadFunc(void* data) {
     MaskThreadSignals();
 
-    ThreadParams* params = (ThreadParams*)data;
-    S3KeyWriter* writer = params->keyWriter;
+    S3KeyWriter* writer = (S3KeyWriter*)data;
+
+    while (true) {
+        UploadPart* part = NULL;
+        {
+            UniqueLock queueLock(&writer->mutex);
+            while (writer->partQueue.empty() && !writer->isStopping) {
+                pthread_cond_wait(&writer->cv, &writer->mutex);
+            }
+
+            if (writer->partQueue.empty()) {
+                return NULL;
+            }
+
+            part = writer->partQueue.front();
+            writer->partQueue.pop_front();
+        }
+
+        uint64_t partSize = part->data.size();
+        writer->uploadPart(part);
+        delete part;
+
+        UniqueLock queueLock(&writer->mutex);
+        writer->pendingParts--;
+        writer->pendingBytes -= partSize;
+        pthread_cond_broadcast(&writer->cv);
+    }
+
+    return NULL;
+}
+
+void S3KeyWriter::uploadPart(UploadPart* part) {
+    // Once a part fails the key is broken, no need to upload the rest.
+    if (this->sharedError) {
+        return;
+    }
 
     try {
         S3DEBUG("Upload thread start: %p, part number: %" PRIu64 ", data size: %" PRIu64,
-                pthread_self(), params->currentNumber, params->data.size());
-        string etag = writer->s3Interface->uploadPartOfData(
-            params->data, writer->params.getS3Url(), params->currentNumber, writer->uploadId);
+                pthread_self(), part->partNumber, part->data.size());
+        string etag = this->s3Interface->uploadPartOfData(part->data, this->params.getS3Url(),
+                                                          part->partNumber, this->uploadId);
 
         // when unique_lock destructs it will automatically unlock the mutex.
-        UniqueLock threadLock(&writer->mutex);
+        UniqueLock threadLock(&this->mutex);
 
         // etag is empty if the query is cancelled by user.
         if (!etag.empty()) {
-            writer->etagList[params->currentNumber] = etag;
+            this->etagList[part->partNumber] = etag;
         }
-        writer->activeThreads--;
-        pthread_cond_broadcast(&writer->cv);
         S3DEBUG("Upload part finish: %p, eTag: %s, part number: %" PRIu64, pthread_self(),
-                etag.c_str(), params->currentNumber);
+                etag.c_str(), part->partNumber);
     } catch (S3Exception& e) {
         S3ERROR("Upload thread error: %s", e.getMessage().c_str());
-        UniqueLock exceptLock(&writer->exceptionMutex);
-        writer->sharedError = true;
-        writer->sharedException = std::current_exception();
-
-        // notify the flushBuffer, otherwise it will be locked when trying to create a new thread.
-        writer->activeThreads--;
-        pthread_cond_broadcast(&writer->cv);
+        UniqueLock exceptLock(&this->exceptionMutex);
+        this->sharedError = true;
+        this->sharedException = std::current_exception();
     }
-
-    delete params;
-    return NULL;
 }
 
 void S3KeyWriter::flushBuffer() {
     if (!this->buffer.empty()) {
-        UniqueLock queueLock(&this->mutex);
-        while (this->activeThreads >= this->params.getNumOfChunks()) {
-            pthread_cond_wait(&this->cv, &this->mutex);
+        {
+            // At most threadnum parts are queued or uploading, and they hold at most
+            // getInflightLimit() bytes, to bound memory usage once parts grow beyond chunksize. A
+            // part larger than the limit is uploaded alone.
+            UniqueLock queueLock(&this->mutex);
+            while (this->pendingParts >= std::max(this->params.getNumOfChunks(), (uint64_t)1) ||
+                   (this->pendingParts > 0 &&
+                    this->pendingBytes + this->buffer.size() > this->getInflightLimit())) {
+                pthread_cond_wait(&this->cv, &this->mutex);
+            }
         }
 
         // Most time query is canceled during uploadPartOfData(). This is the first chance to cancel
         // and clean up upload.
         this->checkQueryCancelSignal();
 
-        this->activeThreads++;
+        UploadPart* part = new UploadPart();
+        part->data.swap(this->buffer);
+        part->partNumber = ++this->partNumber;
+
+        {
+            UniqueLock queueLock(&this->mutex);
+            this->partQueue.push_back(part);
+            this->pendingParts++;
+            this->pendingBytes += part->data.size();
+            pthread_cond_signal(&this->cv);
+        }
 
-        pthread_t writerThread;
-        ThreadParams* params = new ThreadParams();
-        params->keyWriter = this;
-        params->data.swap(this->buffer);
-        params->currentNumber = ++this->partNumber;
-        pthread_create(&writerThread, NULL, UploadThreadFunc, params);
-        threadList.emplace_back(writerThread);
+        uint64_t partSize = this->getPartSize(this->partNumber + 1);
+        if (partSize != this->bufferLimit) {
+            S3DEBUG("Part size grows from %" PRIu64 " to %" PRIu64 " at part %" PRIu64,
+                    this->bufferLimit, partSize, this->partNumber + 1);
+            this->bufferLimit = partSize;
+        }
 
-        this->buffer.reserve(this->params.getChunkSize());
+        this->buffer.reserve(this->bufferLimit);
     }
 }
 
@@ -149,11 +238,8 @@ void S3KeyWriter::completeKeyWriting() {
     // make sure the buffer is clear
     this->flushBuffer();
 
-    // wait for all threads to complete
-    for (size_t i = 0; i < threadList.size(); i++) {
-        pthread_join(threadList[i], NULL);
-    }
-    this->threadList.clear();
+    // wait for all queued parts to be uploaded
+    this->stopUploadThreads();
 
     this->checkQueryCancelSignal();
 
@@ -0,0 +1,205 @@
+#include "s3memory_mgmt.h"
+
+// Every block handed out starts after a header, so that Deallocate() finds out which chunk it is,
+// or whether it's a fallback block, without searching.
+struct MemoryHeader {
+    uint64_t magic;
+    uint32_t index;                // S3_MEMORY_FALLBACK_INDEX for blocks from malloc()
+    std::atomic<uint32_t> inUse;  // to detect double free
+};
+
+#define S3_MEMORY_MAGIC 0x53334d454d4f5259ULL
+#define S3_MEMORY_FALLBACK_INDEX UINT32_MAX
+
+// Keep data aligned as malloc() does.
+#define S3_MEMORY_HEADER_SIZE 16
+
+static_assert(sizeof(MemoryHeader) <= S3_MEMORY_HEADER_SIZE, "header is too large");
+
+static MemoryHeader* initHeader(char* block, uint32_t index, bool inUse) {
+    MemoryHeader* header = new (block) MemoryHeader();
+    header->magic = S3_MEMORY_MAGIC;
+    header->index = index;
+    header->inUse.store(inUse);
+    return header;
+}
+
+PreAllocatedMemory::PreAllocatedMemory(size_t chunkSize, size_t numOfChunk)
+    : maxSize(chunkSize * numOfChunk),
+      chunkSize(chunkSize),
+      freeTop(0),
+      freeNext(new std::atomic<uint32_t>[numOfChunk]),
+      usedChunks(0),
+      peakUsedChunks(0),
+      waitCount(0),
+      fallbackCount(0),
+      waiters(0) {
+    // we will have no more than 9 chunks, 8 for thread thunk, one for main buffer.
+    // Each chunk is limited to 128MB.
+    const uint64_t memoryLimit = 9 * 128 * 1024 * 1024;
+    S3_CHECK_OR_DIE(maxSize <= memoryLimit, S3MemoryOverLimit, memoryLimit, maxSize);
+
+    chunks.resize(numOfChunk);
+    for (size_t i = 0; i < numOfChunk; i++) {
+        chunks[i] = (char*)S3Alloc(S3_MEMORY_HEADER_SIZE + chunkSize);
+        if (chunks[i] == NULL) {
+            for (size_t j = 0; j < i; j++) {
+                S3Free(chunks[j]);
+            }
+            S3_DIE(S3AllocationError, chunkSize);
+        }
+        initHeader(chunks[i], i, false);
+    }
+
+    // Push in reverse order, so that chunks are handed out from the first one.
+    for (size_t i = numOfChunk; i > 0; i--) {
+        this->pushFreeChunk(i - 1);
+    }
+
+    pthread_mutex_init(&waitLock, NULL);
+    pthread_cond_init(&waitCond, NULL);
+}
+
+PreAllocatedMemory::~PreAllocatedMemory() {
+    S3DEBUG("Memory pool of %zu chunks (%zu bytes each): peak usage %" PRIu64
+            " chunks, waited %" PRIu64 " times, fell back to malloc %" PRIu64 " times",
+            chunks.size(), chunkSize, peakUsedChunks.load(), waitCount.load(),
+            fallbackCount.load());
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (chunks[i]) {
+            S3Free(chunks[i]);
+            chunks[i] = NULL;
+        }
+    }
+
+    pthread_mutex_destroy(&waitLock);
+    pthread_cond_destroy(&waitCond);
+}
+
+bool PreAllocatedMemory::popFreeChunk(uint32_t& index) {
+    uint64_t top = freeTop.load();
+    while (true) {
+        uint32_t topIndex = (uint32_t)top;
+        if (topIndex == 0) {
+            return false;
+        }
+
+        // Tag is kept, so that a concurrent pop-push of the same chunk fails this CAS.
+        uint64_t next = (top & 0xFFFFFFFF00000000ULL) | freeNext[topIndex - 1].load();
+        if (freeTop.compare_exchange_weak(top, next)) {
+            index = topIndex - 1;
+            return true;
+        }
+    }
+}
+
+void PreAllocatedMemory::pushFreeChunk(uint32_t index) {
+    uint64_t top = freeTop.load();
+    while (true) {
+        freeNext[index].store((uint32_t)top);
+
+        uint64_t tag = (top >> 32) + 1;
+        if (freeTop.compare_exchange_weak(top, (tag << 32) | (index + 1))) {
+            return;
+        }
+    }
+}
+
+void* PreAllocatedMemory::Allocate(size_t size) {
+    if (size > chunkSize) {
+        S3WARN("Requested %zu bytes, larger than preallocated chunk of %zu bytes", size,
+               chunkSize);
+        return this->allocateFallback(size);
+    }
+
+    uint32_t index;
+    if (!this->popFreeChunk(index)) {
+        return this->waitForChunk();
+    }
+
+    return this->useChunk(index);
+}
+
+void* PreAllocatedMemory::useChunk(uint32_t index) {
+    ((MemoryHeader*)chunks[index])->inUse.store(true);
+
+    uint64_t used = ++usedChunks;
+    uint64_t peak = peakUsedChunks.load();
+    while (used > peak && !peakUsedChunks.compare_exchange_weak(peak, used)) {
+    }
+
+    return chunks[index] + S3_MEMORY_HEADER_SIZE;
+}
+
+// All chunks are in use, wait a while for one to be released before falling back to malloc().
+void* PreAllocatedMemory::waitForChunk() {
+    waitCount++;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += S3_MEMORY_WAIT_TIMEOUT_MS * 1000 * 1000;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000;
+    deadline.tv_nsec %= 1000000000;
+
+    uint32_t index;
+    bool found = false;
+    {
+        UniqueLock lock(&waitLock);
+        waiters++;
+
+        // Check again after waiters is increased, a chunk released before that is not notified.
+        while (!(found = this->popFreeChunk(index))) {
+            if (pthread_cond_timedwait(&waitCond, &waitLock, &deadline) == ETIMEDOUT) {
+                found = this->popFreeChunk(index);
+                break;
+            }
+        }
+
+        waiters--;
+    }
+
+    if (!found) {
+        S3WARN("All %zu preallocated chunks are in use, fall back to malloc()", chunks.size());
+        return this->allocateFallback(chunkSize);
+    }
+
+    return this->useChunk(index);
+}
+
+// S3Alloc() is not used, since palloc() is not thread safe.
+void* PreAllocatedMemory::allocateFallback(size_t size) {
+    char* block = (char*)malloc(S3_MEMORY_HEADER_SIZE + size);
+    S3_CHECK_OR_DIE(block != NULL, S3AllocationError, size);
+
+    fallbackCount++;
+    initHeader(block, S3_MEMORY_FALLBACK_INDEX, true);
+    return block + S3_MEMORY_HEADER_SIZE;
+}
+
+void PreAllocatedMemory::Deallocate(void* p) {
+    char* block = (char*)p - S3_MEMORY_HEADER_SIZE;
+    MemoryHeader* header = (MemoryHeader*)block;
+
+    if (p == NULL || header->magic != S3_MEMORY_MAGIC ||
+        (header->index != S3_MEMORY_FALLBACK_INDEX &&
+         (header->index >= chunks.size() || chunks[header->index] != block)) ||
+        !header->inUse.exchange(false)) {
+        stringstream ss;
+        ss << "Free invalid memory: " << p;
+        S3_DIE(S3RuntimeError, ss.str());
+    }
+
+    if (header->index == S3_MEMORY_FALLBACK_INDEX) {
+        free(block);
+        return;
+    }
+
+    usedChunks--;
+    this->pushFreeChunk(header->index);
+
+    if (waiters.load() > 0) {
+        UniqueLock lock(&waitLock);
+        pthread_cond_broadcast(&waitCond);
+    }
+}
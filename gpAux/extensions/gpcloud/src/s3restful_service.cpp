@@ -1,5 +1,107 @@
 #include "s3restful_service.h"
 
+CURLHandlePool::CURLHandlePool(uint64_t capacity)
+    : capacity(capacity), share(NULL), reusedConnectionNum(0), newConnectionNum(0) {
+    pthread_mutex_init(&this->poolLock, NULL);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_init(&this->shareLocks[i], NULL);
+    }
+}
+
+CURLHandlePool::~CURLHandlePool() {
+    this->clear();
+
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_destroy(&this->shareLocks[i]);
+    }
+    pthread_mutex_destroy(&this->poolLock);
+}
+
+void CURLHandlePool::lockShare(CURL *handle, curl_lock_data data, curl_lock_access access,
+                               void *userp) {
+    CURLHandlePool *pool = (CURLHandlePool *)userp;
+    pthread_mutex_lock(&pool->shareLocks[data]);
+}
+
+void CURLHandlePool::unlockShare(CURL *handle, curl_lock_data data, void *userp) {
+    CURLHandlePool *pool = (CURLHandlePool *)userp;
+    pthread_mutex_unlock(&pool->shareLocks[data]);
+}
+
+CURL *CURLHandlePool::acquire() {
+    UniqueLock lock(&this->poolLock);
+
+    if (!this->idleHandles.empty()) {
+        CURL *handle = this->idleHandles.back();
+        this->idleHandles.pop_back();
+        return handle;
+    }
+
+    // Share is created lazily, so that it is always created after curl_global_init().
+    if (this->share == NULL) {
+        this->share = curl_share_init();
+        S3_CHECK_OR_DIE(this->share != NULL, S3RuntimeError, "Failed to create curl share handle");
+
+        curl_share_setopt(this->share, CURLSHOPT_LOCKFUNC, CURLHandlePool::lockShare);
+        curl_share_setopt(this->share, CURLSHOPT_UNLOCKFUNC, CURLHandlePool::unlockShare);
+        curl_share_setopt(this->share, CURLSHOPT_USERDATA, (void *)this);
+        curl_share_setopt(this->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(this->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    CURL *handle = curl_easy_init();
+    S3_CHECK_OR_DIE(handle != NULL, S3RuntimeError, "Failed to create curl handle");
+
+    curl_easy_setopt(handle, CURLOPT_SHARE, this->share);
+    return handle;
+}
+
+void CURLHandlePool::release(CURL *handle) {
+    if (handle == NULL) {
+        return;
+    }
+
+    // curl_easy_reset() resets options only, live connections and caches are kept in handle.
+    curl_easy_reset(handle);
+    curl_easy_setopt(handle, CURLOPT_SHARE, this->share);
+
+    UniqueLock lock(&this->poolLock);
+    if (this->idleHandles.size() < this->capacity) {
+        this->idleHandles.push_back(handle);
+    } else {
+        curl_easy_cleanup(handle);
+    }
+}
+
+void CURLHandlePool::clear() {
+    UniqueLock lock(&this->poolLock);
+
+    for (size_t i = 0; i < this->idleHandles.size(); i++) {
+        curl_easy_cleanup(this->idleHandles[i]);
+    }
+    this->idleHandles.clear();
+
+    if (this->share != NULL) {
+        curl_share_cleanup(this->share);
+        this->share = NULL;
+    }
+}
+
+void CURLHandlePool::countConnection(CURL *handle) {
+    long newConnects = 0;
+
+    // CURLINFO_NUM_CONNECTS is 0 if the transfer reused an existing connection.
+    if (curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &newConnects) != CURLE_OK) {
+        return;
+    }
+
+    if (newConnects > 0) {
+        __sync_add_and_fetch(&this->newConnectionNum, newConnects);
+    } else {
+        __sync_add_and_fetch(&this->reusedConnectionNum, 1);
+    }
+}
+
 S3RESTfulService::S3RESTfulService()
     : lowSpeedLimit(0),
       lowSpeedTime(0),
@@ -19,9 +121,18 @@ S3RESTfulService::S3RESTfulService(const S3Params &params)
     this->debugCurl = params.isDebugCurl();
     this->chunkBufferSize = params.getChunkSize();
     this->verifyCert = params.isVerifyCert();
+
+    // One handle for each downloading/uploading thread, plus one for the main thread.
+    this->handlePool.setCapacity(params.getNumOfChunks() + 1);
 }
 
 S3RESTfulService::~S3RESTfulService() {
+    S3DEBUG("Connections reused: %" PRIu64 ", connections created: %" PRIu64,
+            this->handlePool.getReusedConnectionNum(), this->handlePool.getNewConnectionNum());
+
+    // Idle handles must be cleaned up before curl_global_cleanup().
+    this->handlePool.clear();
+
     // This function is not thread safe, must NOT call it when any other
     // threads are running, that is, do NOT put it in threads.
     curl_global_cleanup();
@@ -39,6 +150,39 @@ size_t RESTfulServiceWriteFuncCallback(char *ptr, size_t size, size_t nmemb, voi
     return realsize;
 }
 
+struct StreamingData {
+    StreamingData(CURL *curl, Response &response, DataReceiver &receiver)
+        : curl(curl), response(response), receiver(receiver) {
+    }
+
+    CURL *curl;
+    Response &response;
+    DataReceiver &receiver;
+};
+
+// curl's write function callback for streamingGet(), successful response body goes to receiver,
+// error response body is kept in response to be parsed later.
+size_t RESTfulServiceStreamingWriteFuncCallback(char *ptr, size_t size, size_t nmemb,
+                                                void *userp) {
+    if (S3QueryIsAbortInProgress()) {
+        return 0;
+    }
+
+    size_t realsize = size * nmemb;
+    StreamingData *data = (StreamingData *)userp;
+
+    // Response code is ready once we start to receive body.
+    long responseCode = 0;
+    curl_easy_getinfo(data->curl, CURLINFO_RESPONSE_CODE, &responseCode);
+
+    if (!isSuccessfulResponse(responseCode)) {
+        data->response.appendDataBuffer(ptr, realsize);
+        return realsize;
+    }
+
+    return data->receiver.receive(ptr, realsize) ? realsize : 0;
+}
+
 // cURL's write function callback, only used by DELETE request when query is canceled.
 // It shouldn't be interrupted.
 size_t RESTfulServiceAbortFuncCallback(char *ptr, size_t size, size_t nmemb, void *userp) {
@@ -83,12 +227,13 @@ size_t RESTfulServiceReadFuncCallback(char *ptr, size_t size, size_t nmemb, void
 }
 
 struct CURLWrapper {
-    CURLWrapper(const string &url, curl_slist *headers, uint64_t lowSpeedLimit,
-                uint64_t lowSpeedTime, bool debugCurl) {
-        curl = curl_easy_init();
+    CURLWrapper(CURLHandlePool &pool, const string &url, curl_slist *headers,
+                uint64_t lowSpeedLimit, uint64_t lowSpeedTime, bool debugCurl)
+        : pool(pool) {
+        curl = pool.acquire();
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, 1L);
         curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
         curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
         curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, lowSpeedLimit);
         curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, lowSpeedTime);
@@ -98,8 +243,9 @@ struct CURLWrapper {
         }
     }
     ~CURLWrapper() {
-        curl_easy_cleanup(curl);
+        pool.release(curl);
     }
+    CURLHandlePool &pool;
     CURL *curl;
 };
 
@@ -112,6 +258,8 @@ void S3RESTfulService::performCurl(CURL *curl, Response &response) {
             S3_DIE(S3ConnectionError, curl_easy_strerror(res));
         }
     } else {
+        this->handlePool.countConnection(curl);
+
         long responseCode;
         // Get the HTTP response status code from HTTP header
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
@@ -134,8 +282,8 @@ Response S3RESTfulService::get(const string &url, HTTPHeaders &headers) {
     response.getRawData().reserve(this->chunkBufferSize);
 
     headers.CreateList();
-    CURLWrapper wrapper(url, headers.GetList(), this->lowSpeedLimit, this->lowSpeedTime,
-                        this->debugCurl);
+    CURLWrapper wrapper(this->handlePool, url, headers.GetList(), this->lowSpeedLimit,
+                        this->lowSpeedTime, this->debugCurl);
     CURL *curl = wrapper.curl;
 
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
@@ -147,12 +295,33 @@ Response S3RESTfulService::get(const string &url, HTTPHeaders &headers) {
     return response;
 }
 
+// streamingGet() is like get(), but hands successful response body to receiver as it arrives,
+// so that caller could consume data before the whole response is downloaded.
+Response S3RESTfulService::streamingGet(const string &url, HTTPHeaders &headers,
+                                        DataReceiver &receiver) {
+    Response response(RESPONSE_ERROR);
+
+    headers.CreateList();
+    CURLWrapper wrapper(this->handlePool, url, headers.GetList(), this->lowSpeedLimit,
+                        this->lowSpeedTime, this->debugCurl);
+    CURL *curl = wrapper.curl;
+
+    StreamingData streamingData(curl, response, receiver);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&streamingData);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, RESTfulServiceStreamingWriteFuncCallback);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, this->verifyCert);
+
+    this->performCurl(curl, response);
+
+    return response;
+}
+
 Response S3RESTfulService::put(const string &url, HTTPHeaders &headers, const S3VectorUInt8 &data) {
     Response response(RESPONSE_ERROR);
 
     headers.CreateList();
-    CURLWrapper wrapper(url, headers.GetList(), this->lowSpeedLimit, this->lowSpeedTime,
-                        this->debugCurl);
+    CURLWrapper wrapper(this->handlePool, url, headers.GetList(), this->lowSpeedLimit,
+                        this->lowSpeedTime, this->debugCurl);
     CURL *curl = wrapper.curl;
 
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
@@ -178,8 +347,8 @@ Response S3RESTfulService::post(const string &url, HTTPHeaders &headers,
     Response response(RESPONSE_ERROR);
 
     headers.CreateList();
-    CURLWrapper wrapper(url, headers.GetList(), this->lowSpeedLimit, this->lowSpeedTime,
-                        this->debugCurl);
+    CURLWrapper wrapper(this->handlePool, url, headers.GetList(), this->lowSpeedLimit,
+                        this->lowSpeedTime, this->debugCurl);
     CURL *curl = wrapper.curl;
 
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
@@ -207,8 +376,8 @@ ResponseCode S3RESTfulService::head(const string &url, HTTPHeaders &headers) {
     Response response(RESPONSE_ERROR);
 
     headers.CreateList();
-    CURLWrapper wrapper(url, headers.GetList(), this->lowSpeedLimit, this->lowSpeedTime,
-                        this->debugCurl);
+    CURLWrapper wrapper(this->handlePool, url, headers.GetList(), this->lowSpeedLimit,
+                        this->lowSpeedTime, this->debugCurl);
     CURL *curl = wrapper.curl;
 
     curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "HEAD");
@@ -224,8 +393,8 @@ Response S3RESTfulService::deleteRequest(const string &url, HTTPHeaders &headers
     Response response(RESPONSE_ERROR);
 
     headers.CreateList();
-    CURLWrapper wrapper(url, headers.GetList(), this->lowSpeedLimit, this->lowSpeedTime,
-                        this->debugCurl);
+    CURLWrapper wrapper(this->handlePool, url, headers.GetList(), this->lowSpeedLimit,
+                        this->lowSpeedTime, this->debugCurl);
     CURL *curl = wrapper.curl;
 
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
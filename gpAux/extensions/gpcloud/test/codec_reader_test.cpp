@@ -0,0 +1,142 @@
+#include "codec_reader.cpp"
+#include "gtest/gtest.h"
+
+class MockCodecReader : public Reader {
+   public:
+    MockCodecReader() : offset(0), chunkSize(1024), isClosed(false) {
+    }
+
+    virtual void open(const S3Params &params) {
+    }
+
+    virtual uint64_t read(char *buf, uint64_t count) {
+        uint64_t size = std::min(std::min(count, this->chunkSize), this->data.size() - offset);
+        memcpy(buf, this->data.data() + this->offset, size);
+
+        this->offset += size;
+        return size;
+    }
+
+    virtual void close() {
+        this->isClosed = true;
+    }
+
+    vector<char> data;
+    uint64_t offset;
+    uint64_t chunkSize;
+    bool isClosed;
+};
+
+class CodecReaderTest : public testing::TestWithParam<S3CompressionType> {
+   protected:
+    virtual void SetUp() {
+        this->params.setCompressionType(GetParam());
+        this->codecReader.setReader(&this->reader);
+    }
+
+    virtual void TearDown() {
+        this->codecReader.close();
+    }
+
+    // Append one compressed frame of input to data of underlying reader.
+    void appendFrame(const vector<char> &input) {
+        std::unique_ptr<Compressor> compressor(NewCompressor(GetParam()));
+
+        compressor->compress(input.data(), input.size(), this->reader.data);
+        compressor->finish(this->reader.data);
+    }
+
+    vector<char> readAll(uint64_t len) {
+        vector<char> out;
+        vector<char> buf(len);
+
+        uint64_t count;
+        while ((count = this->codecReader.read(buf.data(), len)) > 0) {
+            out.insert(out.end(), buf.begin(), buf.begin() + count);
+        }
+
+        return out;
+    }
+
+    S3Params params;
+    MockCodecReader reader;
+    CodecReader codecReader;
+};
+
+#if defined(USE_ZSTD) || defined(USE_LZ4)
+
+TEST_P(CodecReaderTest, ReadSmallData) {
+    const char hello[] = "The quick brown fox jumps over the lazy dog";
+    vector<char> input(hello, hello + sizeof(hello));
+    this->appendFrame(input);
+
+    this->codecReader.open(this->params);
+
+    EXPECT_TRUE(input == this->readAll(100));
+    EXPECT_EQ((uint64_t)0, this->codecReader.read((char *)hello, 10));
+
+    this->codecReader.close();
+    EXPECT_TRUE(this->reader.isClosed);
+}
+
+TEST_P(CodecReaderTest, ReadLargeDataWithSmallBuffers) {
+    vector<char> input(1024 * 1024 + 7);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = 'a' + (i * 7 + i / 113) % 26;
+    }
+    this->appendFrame(input);
+
+    this->codecReader.resizeCodecReaderBuffer(333);
+    this->reader.chunkSize = 100;
+    this->codecReader.open(this->params);
+
+    EXPECT_TRUE(input == this->readAll(1000));
+}
+
+TEST_P(CodecReaderTest, ReadConcatenatedFramesWithTrailingData) {
+    const char hello[] = "The quick brown fox jumps over the lazy dog";
+    vector<char> input(hello, hello + sizeof(hello));
+    this->appendFrame(input);
+    this->appendFrame(vector<char>());
+    this->appendFrame(input);
+
+    // Key reader appends EOL to files not ended with it.
+    this->reader.data.push_back('\n');
+
+    // Frames end at different places of input buffer.
+    this->codecReader.resizeCodecReaderBuffer(7);
+    this->reader.chunkSize = 3;
+    this->codecReader.open(this->params);
+
+    vector<char> expected = input;
+    expected.insert(expected.end(), input.begin(), input.end());
+    EXPECT_TRUE(expected == this->readAll(10));
+}
+
+TEST_P(CodecReaderTest, ReadTruncatedData) {
+    vector<char> input(4096, 'x');
+    this->appendFrame(input);
+    this->reader.data.resize(this->reader.data.size() - 4);
+
+    this->codecReader.open(this->params);
+
+    EXPECT_THROW(this->readAll(input.size()), S3RuntimeError);
+}
+
+#else
+
+TEST_P(CodecReaderTest, OpenWithoutCodecBuiltIn) {
+    EXPECT_THROW(this->codecReader.open(this->params), S3RuntimeError);
+}
+
+#endif
+
+INSTANTIATE_TEST_CASE_P(Codecs, CodecReaderTest, testing::Values(
+#if defined(USE_ZSTD) && defined(USE_LZ4)
+                                                      S3_COMPRESSION_ZSTD, S3_COMPRESSION_LZ4
+#elif defined(USE_LZ4)
+                                                      S3_COMPRESSION_LZ4
+#else
+                                                      S3_COMPRESSION_ZSTD
+#endif
+                                                      ));
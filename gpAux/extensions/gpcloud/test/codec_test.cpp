@@ -0,0 +1,163 @@
+#include "codec.cpp"
+#include "gtest/gtest.h"
+
+TEST(Codec, DetectCompressionType) {
+    const unsigned char gzip[] = {0x1f, 0x8b, 0x08, 0x00};
+    const unsigned char zstd[] = {0x28, 0xb5, 0x2f, 0xfd};
+    const unsigned char lz4[] = {0x04, 0x22, 0x4d, 0x18};
+    const unsigned char plain[] = {'a', 'b', 'c', 'd'};
+
+    EXPECT_EQ(S3_COMPRESSION_GZIP, DetectCompressionType(gzip, sizeof(gzip)));
+    EXPECT_EQ(S3_COMPRESSION_ZSTD, DetectCompressionType(zstd, sizeof(zstd)));
+    EXPECT_EQ(S3_COMPRESSION_LZ4, DetectCompressionType(lz4, sizeof(lz4)));
+    EXPECT_EQ(S3_COMPRESSION_PLAIN, DetectCompressionType(plain, sizeof(plain)));
+}
+
+TEST(Codec, DetectCompressionTypeOfShortData) {
+    const unsigned char gzip[] = {0x1f, 0x8b};
+    const unsigned char zstd[] = {0x28, 0xb5, 0x2f};
+
+    EXPECT_EQ(S3_COMPRESSION_GZIP, DetectCompressionType(gzip, sizeof(gzip)));
+    EXPECT_EQ(S3_COMPRESSION_PLAIN, DetectCompressionType(zstd, sizeof(zstd)));
+    EXPECT_EQ(S3_COMPRESSION_PLAIN, DetectCompressionType(gzip, 0));
+}
+
+TEST(Codec, ParseCompressionType) {
+    S3CompressionType compressionType;
+
+    EXPECT_TRUE(ParseCompressionType("gzip", compressionType));
+    EXPECT_EQ(S3_COMPRESSION_GZIP, compressionType);
+
+    EXPECT_TRUE(ParseCompressionType("zstd", compressionType));
+    EXPECT_EQ(S3_COMPRESSION_ZSTD, compressionType);
+
+    EXPECT_TRUE(ParseCompressionType("lz4", compressionType));
+    EXPECT_EQ(S3_COMPRESSION_LZ4, compressionType);
+
+    EXPECT_TRUE(ParseCompressionType("none", compressionType));
+    EXPECT_EQ(S3_COMPRESSION_PLAIN, compressionType);
+
+    EXPECT_FALSE(ParseCompressionType("ZSTD", compressionType));
+    EXPECT_FALSE(ParseCompressionType("", compressionType));
+}
+
+TEST(Codec, GetCompressionExt) {
+    EXPECT_EQ(".gz", GetCompressionExt(S3_COMPRESSION_GZIP));
+    EXPECT_EQ(".zst", GetCompressionExt(S3_COMPRESSION_ZSTD));
+    EXPECT_EQ(".lz4", GetCompressionExt(S3_COMPRESSION_LZ4));
+    EXPECT_EQ("", GetCompressionExt(S3_COMPRESSION_PLAIN));
+}
+
+TEST(Codec, GzipIsNotCreatedByFactory) {
+    EXPECT_THROW(NewCompressor(S3_COMPRESSION_GZIP), S3RuntimeError);
+    EXPECT_THROW(NewDecompressor(S3_COMPRESSION_PLAIN), S3RuntimeError);
+}
+
+class CodecTest : public testing::TestWithParam<S3CompressionType> {
+   protected:
+    // Compress input with a new compressor, write len bytes a time.
+    vector<char> compress(const vector<char> &input, uint64_t len) {
+        std::unique_ptr<Compressor> compressor(NewCompressor(GetParam()));
+
+        vector<char> out;
+        for (uint64_t offset = 0; offset < input.size(); offset += len) {
+            compressor->compress(input.data() + offset, std::min(len, input.size() - offset),
+                                 out);
+        }
+        compressor->finish(out);
+
+        return out;
+    }
+
+    // Decompress all frames in input, with output buffer of len bytes.
+    vector<char> decompress(const vector<char> &input, uint64_t len) {
+        std::unique_ptr<Decompressor> decompressor(NewDecompressor(GetParam()));
+
+        vector<char> out;
+        vector<char> buf(len);
+        uint64_t offset = 0;
+        bool isFrameEnd = false;
+        while (offset < input.size() || !isFrameEnd) {
+            uint64_t inLen = input.size() - offset;
+            uint64_t outLen = len;
+            isFrameEnd = decompressor->decompress(input.data() + offset, inLen, buf.data(), outLen);
+
+            if (inLen == 0 && outLen == 0 && !isFrameEnd) {
+                ADD_FAILURE() << "Decompressor makes no progress";
+                break;
+            }
+
+            offset += inLen;
+            out.insert(out.end(), buf.begin(), buf.begin() + outLen);
+        }
+
+        return out;
+    }
+};
+
+#if defined(USE_ZSTD) || defined(USE_LZ4)
+
+TEST_P(CodecTest, CompressEmptyData) {
+    vector<char> input;
+    vector<char> compressed = this->compress(input, 1);
+
+    EXPECT_EQ(GetParam(),
+              DetectCompressionType((const unsigned char *)compressed.data(), compressed.size()));
+    EXPECT_TRUE(this->decompress(compressed, 16).empty());
+}
+
+TEST_P(CodecTest, CompressLargeData) {
+    vector<char> input(1024 * 1024 + 13);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = 'a' + (i * 7 + i / 113) % 26;
+    }
+
+    vector<char> compressed = this->compress(input, 100 * 1000);
+    EXPECT_LT(compressed.size(), input.size());
+
+    EXPECT_TRUE(input == this->decompress(compressed, 4096));
+}
+
+TEST_P(CodecTest, DecompressConcatenatedFrames) {
+    const char hello[] = "The quick brown fox jumps over the lazy dog";
+    vector<char> input(hello, hello + sizeof(hello));
+
+    vector<char> compressed = this->compress(input, 5);
+    vector<char> twice = compressed;
+    twice.insert(twice.end(), compressed.begin(), compressed.end());
+
+    vector<char> expected = input;
+    expected.insert(expected.end(), input.begin(), input.end());
+
+    EXPECT_TRUE(expected == this->decompress(twice, 7));
+}
+
+TEST_P(CodecTest, DecompressCorruptedData) {
+    vector<char> input(4096, 'x');
+    vector<char> compressed = this->compress(input, input.size());
+
+    // Break the magic number.
+    compressed[1] ^= 0xff;
+
+    EXPECT_THROW(this->decompress(compressed, 4096), S3RuntimeError);
+}
+
+#else
+
+TEST_P(CodecTest, CodecIsNotBuiltIn) {
+    EXPECT_THROW(NewCompressor(GetParam()), S3RuntimeError);
+    EXPECT_THROW(NewDecompressor(GetParam()), S3RuntimeError);
+}
+
+#endif
+
+// Only codecs built in are tested, at least one is needed by instantiation.
+INSTANTIATE_TEST_CASE_P(Codecs, CodecTest, testing::Values(
+#if defined(USE_ZSTD) && defined(USE_LZ4)
+                                                S3_COMPRESSION_ZSTD, S3_COMPRESSION_LZ4
+#elif defined(USE_LZ4)
+                                                S3_COMPRESSION_LZ4
+#else
+                                                S3_COMPRESSION_ZSTD
+#endif
+                                                ));
@@ -0,0 +1,143 @@
+#include "codec_writer.cpp"
+#include "gtest/gtest.h"
+
+class MockCodecWriter : public Writer {
+   public:
+    MockCodecWriter() : writeTimes(0), isClosed(false) {
+    }
+
+    virtual void open(const S3Params &params) {
+        this->isClosed = false;
+    }
+
+    virtual uint64_t write(const char *buf, uint64_t count) {
+        this->data.insert(this->data.end(), buf, buf + count);
+        this->writeTimes++;
+        return count;
+    }
+
+    virtual void close() {
+        this->isClosed = true;
+    }
+
+    vector<char> data;
+    uint64_t writeTimes;
+    bool isClosed;
+};
+
+class CodecWriterTest : public testing::TestWithParam<S3CompressionType> {
+   protected:
+    virtual void SetUp() {
+        // reset to default, because some tests will modify it
+        S3_ZIP_COMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
+
+        this->params.setAutoCompress(true);
+        this->params.setCompressionType(GetParam());
+
+        this->codecWriter.setWriter(&this->writer);
+    }
+
+    virtual void TearDown() {
+        this->codecWriter.close();
+    }
+
+    vector<char> decompress(const vector<char> &input) {
+        std::unique_ptr<Decompressor> decompressor(NewDecompressor(GetParam()));
+
+        vector<char> out;
+        char buf[4096];
+        uint64_t offset = 0;
+        bool isFrameEnd = false;
+        while (!isFrameEnd) {
+            uint64_t inLen = input.size() - offset;
+            uint64_t outLen = sizeof(buf);
+            isFrameEnd = decompressor->decompress(input.data() + offset, inLen, buf, outLen);
+
+            if (inLen == 0 && outLen == 0 && !isFrameEnd) {
+                ADD_FAILURE() << "Data is truncated";
+                break;
+            }
+
+            offset += inLen;
+            out.insert(out.end(), buf, buf + outLen);
+        }
+
+        EXPECT_EQ(input.size(), offset);
+        return out;
+    }
+
+    S3Params params;
+    MockCodecWriter writer;
+    CodecWriter codecWriter;
+};
+
+#if defined(USE_ZSTD) || defined(USE_LZ4)
+
+TEST_P(CodecWriterTest, WriteNothing) {
+    this->codecWriter.open(this->params);
+    this->codecWriter.close();
+
+    EXPECT_TRUE(this->writer.isClosed);
+    EXPECT_FALSE(this->writer.data.empty());
+    EXPECT_TRUE(this->decompress(this->writer.data).empty());
+}
+
+TEST_P(CodecWriterTest, WriteSmallData) {
+    this->codecWriter.open(this->params);
+
+    const char hello[] = "The quick brown fox jumps over the lazy dog";
+    EXPECT_EQ(sizeof(hello), this->codecWriter.write(hello, sizeof(hello)));
+    EXPECT_EQ((uint64_t)0, this->codecWriter.write(hello, 0));
+    this->codecWriter.close();
+
+    vector<char> result = this->decompress(this->writer.data);
+    ASSERT_EQ(sizeof(hello), result.size());
+    EXPECT_EQ(0, memcmp(hello, result.data(), sizeof(hello)));
+}
+
+TEST_P(CodecWriterTest, WriteLargeDataInBatches) {
+    S3_ZIP_COMPRESS_CHUNKSIZE = 16 * 1024;
+    this->codecWriter.open(this->params);
+
+    vector<char> input(1024 * 1024);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = 'a' + (i * 7 + i / 113) % 26;
+    }
+
+    for (size_t offset = 0; offset < input.size(); offset += 1000) {
+        this->codecWriter.write(input.data() + offset, std::min((size_t)1000, input.size() - offset));
+    }
+    this->codecWriter.close();
+
+    // Small writes are batched before passing to underlying writer.
+    EXPECT_LT(this->writer.writeTimes, input.size() / 1000 / 4);
+    EXPECT_TRUE(input == this->decompress(this->writer.data));
+}
+
+TEST_P(CodecWriterTest, CloseIsReentrant) {
+    this->codecWriter.open(this->params);
+    this->codecWriter.close();
+
+    uint64_t size = this->writer.data.size();
+    this->codecWriter.close();
+    EXPECT_EQ(size, this->writer.data.size());
+}
+
+#else
+
+TEST_P(CodecWriterTest, OpenWithoutCodecBuiltIn) {
+    EXPECT_THROW(this->codecWriter.open(this->params), S3RuntimeError);
+    EXPECT_FALSE(this->writer.isClosed);
+}
+
+#endif
+
+INSTANTIATE_TEST_CASE_P(Codecs, CodecWriterTest, testing::Values(
+#if defined(USE_ZSTD) && defined(USE_LZ4)
+                                                      S3_COMPRESSION_ZSTD, S3_COMPRESSION_LZ4
+#elif defined(USE_LZ4)
+                                                      S3_COMPRESSION_LZ4
+#else
+                                                      S3_COMPRESSION_ZSTD
+#endif
+                                                      ));
@@ -210,3 +210,170 @@ TEST_F(CompressWriterTest, CompressCompressedData) {
 
     EXPECT_TRUE(memcmp(compressedData.data(), result.get(), compressedData.size()) == 0);
 }
+
+class ParallelCompressWriterTest : public CompressWriterTest {
+   protected:
+    virtual void SetUp() {
+        // Small blocks to have data split into many blocks.
+        S3_ZIP_COMPRESS_CHUNKSIZE = 64 * 1024;
+
+        S3Params params("s3://abc/def/");
+        params.setCompressThreadNum(4);
+
+        compressWriter.setWriter(&writer);
+        compressWriter.open(params);
+
+        this->out = new Byte[S3_ZIP_DECOMPRESS_CHUNKSIZE];
+    }
+
+    virtual void TearDown() {
+        CompressWriterTest::TearDown();
+
+        S3_ZIP_COMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
+    }
+};
+
+TEST_F(ParallelCompressWriterTest, AbleToCompressEmptyData) {
+    compressWriter.close();
+
+    const char *header = writer.getRawData();
+    ASSERT_TRUE(header[0] == char(0x1f));
+    ASSERT_TRUE(header[1] == char(0x8b));
+
+    uint8_t result[16];
+    z_stream zstream;
+    zstream.zalloc = Z_NULL;
+    zstream.zfree = Z_NULL;
+    zstream.opaque = Z_NULL;
+    ASSERT_EQ(Z_OK, inflateInit2(&zstream, S3_INFLATE_WINDOWSBITS));
+
+    zstream.next_in = (Byte *)writer.getRawData();
+    zstream.avail_in = writer.getDataSize();
+    zstream.next_out = result;
+    zstream.avail_out = sizeof(result);
+
+    EXPECT_EQ(Z_STREAM_END, inflate(&zstream, Z_FINISH));
+    EXPECT_EQ((uLong)0, zstream.total_out);
+    inflateEnd(&zstream);
+}
+
+TEST_F(ParallelCompressWriterTest, AbleToCompressOneSmallString) {
+    const char input[] = "The quick brown fox jumps over the lazy dog";
+
+    compressWriter.write(input, sizeof(input));
+    compressWriter.close();
+
+    this->simpleUncompress(writer.getRawData(), writer.getDataSize());
+    EXPECT_STREQ(input, (const char *)this->out);
+}
+
+TEST_F(ParallelCompressWriterTest, AbleToWriteAcrossBlocks) {
+    const char pangram[] = "The quick brown fox jumps over the lazy dog";
+    uint64_t times = S3_ZIP_COMPRESS_CHUNKSIZE * 20 / (sizeof(pangram) - 1) + 1;
+
+    string input;
+    for (uint64_t i = 0; i < times; i++) input.append(pangram);
+
+    // Write in pieces of different sizes, which are not aligned to blocks.
+    uint64_t offset = 0;
+    for (uint64_t piece = 1; offset < input.length(); piece = piece * 3 + 7) {
+        uint64_t len = std::min(piece, input.length() - offset);
+        compressWriter.write(input.c_str() + offset, len);
+        offset += len;
+    }
+    compressWriter.close();
+
+    // Compression ratio stays good since blocks inherit dictionary from previous block.
+    EXPECT_LT(writer.getDataSize(), input.length() / 50);
+
+    Byte *result = new Byte[input.length() + 1];
+    this->coreUncompress((Byte *)writer.getRawData(), writer.getDataSize(), result,
+                         input.length() + 1);
+
+    EXPECT_TRUE(memcmp(input.c_str(), result, input.length()) == 0);
+
+    delete[] result;
+}
+
+TEST_F(ParallelCompressWriterTest, CheckGZipTrailer) {
+    std::default_random_engine re(1234);
+
+    vector<char> input(S3_ZIP_COMPRESS_CHUNKSIZE * 7 + 123);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = re() % 16;
+    }
+
+    compressWriter.write(input.data(), input.size());
+    compressWriter.close();
+
+    const unsigned char *trailer =
+        (const unsigned char *)writer.getRawData() + writer.getDataSize() - 8;
+    uLong crc = crc32(0L, (const Bytef *)input.data(), input.size());
+    uLong size = input.size();
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ((crc >> (8 * i)) & 0xFF, trailer[i]);
+        EXPECT_EQ((size >> (8 * i)) & 0xFF, trailer[i + 4]);
+    }
+
+    // inflate() checks crc and size as well.
+    Byte *result = new Byte[input.size()];
+    z_stream zstream;
+    zstream.zalloc = Z_NULL;
+    zstream.zfree = Z_NULL;
+    zstream.opaque = Z_NULL;
+    ASSERT_EQ(Z_OK, inflateInit2(&zstream, S3_INFLATE_WINDOWSBITS));
+
+    zstream.next_in = (Byte *)writer.getRawData();
+    zstream.avail_in = writer.getDataSize();
+    zstream.next_out = result;
+    zstream.avail_out = input.size();
+
+    EXPECT_EQ(Z_STREAM_END, inflate(&zstream, Z_FINISH));
+    EXPECT_EQ((uLong)input.size(), zstream.total_out);
+    EXPECT_TRUE(memcmp(input.data(), result, input.size()) == 0);
+    inflateEnd(&zstream);
+
+    delete[] result;
+}
+
+TEST_F(ParallelCompressWriterTest, CompressCompressedData) {
+    std::default_random_engine re(5678);
+
+    vector<char> input(S3_ZIP_COMPRESS_CHUNKSIZE * 5);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = re();
+    }
+
+    compressWriter.write(input.data(), input.size());
+    compressWriter.close();
+
+    // Random data gets larger after compressed.
+    EXPECT_GT(writer.getDataSize(), input.size());
+
+    Byte *result = new Byte[input.size()];
+    this->coreUncompress((Byte *)writer.getRawData(), writer.getDataSize(), result, input.size());
+
+    EXPECT_TRUE(memcmp(input.data(), result, input.size()) == 0);
+
+    delete[] result;
+}
+
+TEST_F(ParallelCompressWriterTest, ReopenAfterClose) {
+    const char input[] = "The quick brown fox jumps over the lazy dog";
+
+    compressWriter.write(input, sizeof(input));
+    compressWriter.close();
+
+    writer.getRawDataVector().clear();
+
+    S3Params params("s3://abc/def/");
+    params.setCompressThreadNum(2);
+    compressWriter.open(params);
+
+    compressWriter.write(input, sizeof(input));
+    compressWriter.close();
+
+    this->simpleUncompress(writer.getRawData(), writer.getDataSize());
+    EXPECT_STREQ(input, (const char *)this->out);
+}
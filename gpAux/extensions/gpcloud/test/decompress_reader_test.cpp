@@ -311,3 +311,111 @@ TEST_F(DecompressReaderTest, AbleToDecompressWithIncorrectEncodedStream) {
 
     EXPECT_THROW(decompressReader.read(outputBuffer, sizeof(outputBuffer)), S3RuntimeError);
 }
+
+// Compress input into one gzip member and append to output.
+static void appendGzipMember(vector<uint8_t> &output, const void *input, uint64_t len) {
+    z_stream zstream;
+    zstream.zalloc = Z_NULL;
+    zstream.zfree = Z_NULL;
+    zstream.opaque = Z_NULL;
+
+    ASSERT_EQ(Z_OK, deflateInit2(&zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, S3_DEFLATE_WINDOWSBITS,
+                                 8, Z_DEFAULT_STRATEGY));
+
+    uint64_t offset = output.size();
+    output.resize(offset + deflateBound(&zstream, len) + 32);
+
+    zstream.next_in = (Bytef *)input;
+    zstream.avail_in = len;
+    zstream.next_out = output.data() + offset;
+    zstream.avail_out = output.size() - offset;
+
+    ASSERT_EQ(Z_STREAM_END, deflate(&zstream, Z_FINISH));
+    output.resize(offset + zstream.total_out);
+
+    deflateEnd(&zstream);
+}
+
+TEST_F(DecompressReaderTest, AbleToDecompressMultiMemberGzip) {
+    S3_ZIP_DECOMPRESS_CHUNKSIZE = 64;
+    decompressReader.resizeDecompressReaderBuffer(S3_ZIP_DECOMPRESS_CHUNKSIZE);
+
+    const char *members[] = {"The quick brown fox ", "jumps over ", "the lazy dog"};
+    vector<uint8_t> compressed;
+    string expected;
+    for (int i = 0; i < 3; i++) {
+        appendGzipMember(compressed, members[i], strlen(members[i]));
+        expected.append(members[i]);
+    }
+    bufReader.setData(compressed.data(), compressed.size());
+
+    // Fragmented input, members end at different places of input buffer.
+    this->bufReader.setChunkSize(7);
+
+    char outputBuffer[16];
+    string result;
+    uint64_t count;
+    while ((count = decompressReader.read(outputBuffer, sizeof(outputBuffer))) > 0) {
+        result.append(outputBuffer, count);
+    }
+
+    EXPECT_EQ(expected, result);
+}
+
+TEST_F(DecompressReaderTest, AbleToIgnoreTrailingDataAfterGzip) {
+    const char hello[] = "The quick brown fox jumps over the lazy dog";
+    vector<uint8_t> compressed;
+    appendGzipMember(compressed, hello, sizeof(hello));
+
+    // Key reader appends EOL to files not ended with it.
+    compressed.push_back('\n');
+    bufReader.setData(compressed.data(), compressed.size());
+
+    char buf[100];
+    EXPECT_EQ(sizeof(hello), decompressReader.read(buf, sizeof(buf)));
+    EXPECT_EQ(0, strncmp(hello, buf, sizeof(hello)));
+    EXPECT_EQ((uint64_t)0, decompressReader.read(buf, sizeof(buf)));
+}
+
+TEST_F(DecompressReaderTest, AbleToDecompressLargeDataWithManyBuffers) {
+    S3_ZIP_DECOMPRESS_CHUNKSIZE = 1024;
+    decompressReader.resizeDecompressReaderBuffer(S3_ZIP_DECOMPRESS_CHUNKSIZE);
+
+    vector<char> input(S3_ZIP_DECOMPRESS_CHUNKSIZE * 100 + 17);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = 'a' + (i * 7 + i / 13) % 26;
+    }
+
+    vector<uint8_t> compressed;
+    appendGzipMember(compressed, input.data(), input.size() / 2);
+    appendGzipMember(compressed, input.data() + input.size() / 2, input.size() - input.size() / 2);
+    bufReader.setData(compressed.data(), compressed.size());
+    this->bufReader.setChunkSize(100);
+
+    // Read slower than decompression, to have all output buffers filled.
+    vector<char> result;
+    char outputBuffer[300];
+    uint64_t count;
+    while ((count = decompressReader.read(outputBuffer, sizeof(outputBuffer))) > 0) {
+        result.insert(result.end(), outputBuffer, outputBuffer + count);
+    }
+
+    ASSERT_EQ(input.size(), result.size());
+    EXPECT_TRUE(memcmp(input.data(), result.data(), input.size()) == 0);
+}
+
+TEST_F(DecompressReaderTest, CloseWithoutFinishReading) {
+    S3_ZIP_DECOMPRESS_CHUNKSIZE = 32;
+    decompressReader.resizeDecompressReaderBuffer(S3_ZIP_DECOMPRESS_CHUNKSIZE);
+
+    char hello[S3_ZIP_DECOMPRESS_CHUNKSIZE * 10];
+    memset((void *)hello, 'A', sizeof(hello));
+    setBufReaderByRawData(hello, sizeof(hello));
+
+    char outputBuffer[8];
+    EXPECT_EQ((uint64_t)8, decompressReader.read(outputBuffer, sizeof(outputBuffer)));
+
+    // Decompression thread is blocked since all buffers are filled, close() must stop it.
+    decompressReader.close();
+    decompressReader.close();
+}
@@ -125,9 +125,7 @@ TEST_F(GPReaderTest, ReadSmallData) {
 
     EXPECT_CALL(mockRESTfulService, get(_, _))
         .WillOnce(Return(listBucketResponse))
-        // first 4 bytes is retrieved once for format detection.
-        .WillOnce(Return(keyReaderResponse))
-        // whole file content
+        // whole file content, format is detected from it without extra request.
         .WillOnce(Return(keyReaderResponse));
 
     gpreader.open(p);
@@ -276,6 +274,8 @@ TEST_F(GPReaderTest, ReadAndGetFailedListBucketResponse) {
 TEST_F(GPReaderTest, ReadAndGetFailedKeyReaderResponse) {
     string url = "s3://s3-us-west-2.amazonaws.com/s3test.pivotal.io/dataset1/normal";
     S3Params p(url);
+    p.setNumOfChunks(1);
+    p.setChunkSize(1024);
     MockS3RESTfulService mockRESTfulService(p);
     MockGPReader gpreader(p, &mockRESTfulService);
 
@@ -15,8 +15,6 @@ class MockS3Interface : public S3Interface {
     MOCK_METHOD4(fetchData,
                  uint64_t(uint64_t , S3VectorUInt8& , uint64_t len, const S3Url &));
 
-    MOCK_METHOD1(checkCompressionType, S3CompressionType(const S3Url&));
-
     MOCK_METHOD1(checkKeyExistence, bool(const S3Url&));
 
     MOCK_METHOD1(getUploadId, string(const S3Url&));
@@ -47,6 +45,11 @@ class MockS3RESTfulService : public S3RESTfulService {
                                 const vector<uint8_t> &));
 
     MOCK_METHOD2(deleteRequest, Response(const string &, HTTPHeaders &));
+
+    // Route streaming GET to mocked get(), as the default RESTfulService does.
+    Response streamingGet(const string &url, HTTPHeaders &headers, DataReceiver &receiver) {
+        return RESTfulService::streamingGet(url, headers, receiver);
+    }
 };
 
 class XMLGenerator {
@@ -148,6 +148,90 @@ TEST_F(S3BucketReaderTest, ReaderShouldSkipIfFileIsNotForThisSegment) {
     EXPECT_EQ((uint64_t)0, bucketReader->read(buf, sizeof(buf)));
 }
 
+TEST_F(S3BucketReaderTest, DistributeKeysRoundRobin) {
+    ListBucketResult result;
+    result.contents.emplace_back("foo", 1000);
+    result.contents.emplace_back("bar", 10);
+    result.contents.emplace_back("baz", 10);
+    result.contents.emplace_back("qux", 10);
+
+    S3Params params("https://s3-us-east-2.amazonaws.com/s3test.pivotal.io/whatever");
+    params.setKeyDistType(KEY_DIST_ROUNDROBIN);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    s3ext_segid = 0;
+    s3ext_segnum = 2;
+    bucketReader->open(params);
+
+    vector<uint64_t> expected = {0, 2};
+    EXPECT_EQ(expected, bucketReader->getSegmentKeys());
+}
+
+TEST_F(S3BucketReaderTest, DistributeKeysBySize) {
+    ListBucketResult result;
+    result.contents.emplace_back("foo", 1000);
+    result.contents.emplace_back("bar", 10);
+    result.contents.emplace_back("baz", 10);
+    result.contents.emplace_back("qux", 10);
+
+    S3Params params("https://s3-us-east-2.amazonaws.com/s3test.pivotal.io/whatever");
+    params.setKeyDistType(KEY_DIST_SIZE);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(2).WillRepeatedly(Return(result));
+
+    s3ext_segnum = 2;
+
+    s3ext_segid = 0;
+    bucketReader->open(params);
+    vector<uint64_t> expectedSeg0 = {0};
+    EXPECT_EQ(expectedSeg0, bucketReader->getSegmentKeys());
+    bucketReader->close();
+
+    s3ext_segid = 1;
+    bucketReader->open(params);
+    vector<uint64_t> expectedSeg1 = {1, 2, 3};
+    EXPECT_EQ(expectedSeg1, bucketReader->getSegmentKeys());
+}
+
+TEST_F(S3BucketReaderTest, DistributeKeysBySizeCoversEveryKeyOnce) {
+    ListBucketResult result;
+    for (uint64_t i = 0; i < 100; i++) {
+        result.contents.emplace_back(std::to_string((unsigned long long)i), (i * 7919) % 1000 + 1);
+    }
+
+    S3Params params("https://s3-us-east-2.amazonaws.com/s3test.pivotal.io/whatever");
+
+    s3ext_segnum = 8;
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(s3ext_segnum).WillRepeatedly(Return(result));
+
+    vector<int> readTimes(result.contents.size(), 0);
+    uint64_t maxBytes = 0, minBytes = UINT64_MAX;
+
+    for (s3ext_segid = 0; s3ext_segid < s3ext_segnum; s3ext_segid++) {
+        bucketReader->open(params);
+
+        uint64_t bytes = 0;
+        const vector<uint64_t>& keys = bucketReader->getSegmentKeys();
+        for (uint64_t i = 0; i < keys.size(); i++) {
+            readTimes[keys[i]]++;
+            bytes += result.contents[keys[i]].getSize();
+        }
+
+        maxBytes = std::max(maxBytes, bytes);
+        minBytes = std::min(minBytes, bytes);
+
+        bucketReader->close();
+    }
+
+    for (uint64_t i = 0; i < readTimes.size(); i++) {
+        EXPECT_EQ(1, readTimes[i]);
+    }
+
+    // LPT guarantees the gap is no more than the largest key.
+    EXPECT_LE(maxBytes - minBytes, (uint64_t)1000);
+}
+
 TEST_F(S3BucketReaderTest, UpstreamReaderThrowException) {
     ListBucketResult result;
     result.contents.emplace_back("foo", 0);
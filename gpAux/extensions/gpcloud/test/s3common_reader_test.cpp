@@ -22,6 +22,27 @@ class MockS3InterfaceForCompressionRead : public MockS3Interface {
     S3VectorUInt8 data;
 };
 
+// compress() generates zlib stream, gzip stream is needed for magic bytes detection.
+static void gzipCompress(Byte *dest, uLong *destLen, const char *source, uLong sourceLen) {
+    z_stream zstream;
+    zstream.zalloc = Z_NULL;
+    zstream.zfree = Z_NULL;
+    zstream.opaque = Z_NULL;
+
+    ASSERT_EQ(Z_OK, deflateInit2(&zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 31, 8,
+                                 Z_DEFAULT_STRATEGY));
+
+    zstream.next_in = (Bytef *)source;
+    zstream.avail_in = sourceLen;
+    zstream.next_out = dest;
+    zstream.avail_out = *destLen;
+
+    ASSERT_EQ(Z_STREAM_END, deflate(&zstream, Z_FINISH));
+    *destLen = zstream.total_out;
+
+    deflateEnd(&zstream);
+}
+
 class S3CommonReaderTest : public ::testing::Test, public S3CommonReader {
    protected:
     // Remember that SetUp() is run immediately before a test starts.
@@ -39,39 +60,132 @@ class S3CommonReaderTest : public ::testing::Test, public S3CommonReader {
 
 TEST_F(S3CommonReaderTest, OpenGZip) {
     // test case for: the file format is gzip, then decompressReader should be called
-    EXPECT_CALL(mockS3Interface, checkCompressionType(_)).WillOnce(Return(S3_COMPRESSION_GZIP));
+    Byte compressionBuff[0x100];
+    uLong compressedLen = sizeof(compressionBuff);
+    const char hello[] = "The quick brown fox jumps over the lazy dog";
+
+    gzipCompress(compressionBuff, &compressedLen, hello, sizeof(hello));
+    mockS3Interface.setData(compressionBuff, compressedLen);
+
+    EXPECT_CALL(mockS3Interface, fetchData(_, _, _, _))
+        .WillOnce(Invoke(&mockS3Interface, &MockS3InterfaceForCompressionRead::mockFetchData));
+
     S3Params params("s3://abc/def");
     params.setNumOfChunks(1);
     params.setChunkSize(1024 * 1024 * 2);
+    params.setKeySize(compressedLen);
     this->open(params);
 
     ASSERT_EQ(this->upstreamReader, &this->decompressReader);
     ASSERT_TRUE(NULL != dynamic_cast<DecompressReader *>(this->upstreamReader));
 }
 
+TEST_F(S3CommonReaderTest, OpenGZipHeader) {
+    // test case for: the file starts with gzip magic bytes
+    Byte gzipHeader[] = {0x1f, 0x8b, 0x08, 0x00};
+    mockS3Interface.setData(gzipHeader, sizeof(gzipHeader));
+
+    EXPECT_CALL(mockS3Interface, fetchData(_, _, _, _))
+        .WillOnce(Invoke(&mockS3Interface, &MockS3InterfaceForCompressionRead::mockFetchData));
+
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setChunkSize(1024 * 1024 * 2);
+    params.setKeySize(sizeof(gzipHeader));
+    this->open(params);
+
+    ASSERT_EQ(this->upstreamReader, &this->decompressReader);
+}
+
+TEST_F(S3CommonReaderTest, OpenZstdHeader) {
+    Byte zstdHeader[] = {0x28, 0xb5, 0x2f, 0xfd};
+    mockS3Interface.setData(zstdHeader, sizeof(zstdHeader));
+
+    EXPECT_CALL(mockS3Interface, fetchData(_, _, _, _))
+        .WillOnce(Invoke(&mockS3Interface, &MockS3InterfaceForCompressionRead::mockFetchData));
+
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setChunkSize(1024 * 1024 * 2);
+    params.setKeySize(sizeof(zstdHeader));
+
+#ifdef USE_ZSTD
+    this->open(params);
+    ASSERT_EQ(this->upstreamReader, &this->codecReader);
+#else
+    EXPECT_THROW(this->open(params), S3RuntimeError);
+#endif
+}
+
+TEST_F(S3CommonReaderTest, OpenLz4Header) {
+    Byte lz4Header[] = {0x04, 0x22, 0x4d, 0x18};
+    mockS3Interface.setData(lz4Header, sizeof(lz4Header));
+
+    EXPECT_CALL(mockS3Interface, fetchData(_, _, _, _))
+        .WillOnce(Invoke(&mockS3Interface, &MockS3InterfaceForCompressionRead::mockFetchData));
+
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setChunkSize(1024 * 1024 * 2);
+    params.setKeySize(sizeof(lz4Header));
+
+#ifdef USE_LZ4
+    this->open(params);
+    ASSERT_EQ(this->upstreamReader, &this->codecReader);
+#else
+    EXPECT_THROW(this->open(params), S3RuntimeError);
+#endif
+}
+
 TEST_F(S3CommonReaderTest, OpenPlain) {
-    // test case for: the file format is gzip, then S3keyReader should be called
-    EXPECT_CALL(mockS3Interface, checkCompressionType(_)).WillOnce(Return(S3_COMPRESSION_PLAIN));
+    // test case for: the file format is plain, then S3keyReader should be called
+    const char hello[] = "The quick brown fox jumps over the lazy dog";
+    mockS3Interface.setData((Byte *)hello, sizeof(hello));
+
+    EXPECT_CALL(mockS3Interface, fetchData(_, _, _, _))
+        .WillOnce(Invoke(&mockS3Interface, &MockS3InterfaceForCompressionRead::mockFetchData));
+
     S3Params params("s3://abc/def");
     params.setNumOfChunks(1);
     params.setChunkSize(1024 * 1024 * 2);
+    params.setKeySize(sizeof(hello));
     this->open(params);
 
     ASSERT_EQ(this->upstreamReader, &this->keyReader);
     ASSERT_TRUE(NULL != dynamic_cast<S3KeyReader *>(this->upstreamReader));
 }
 
+TEST_F(S3CommonReaderTest, OpenPlainSmallerThanMagicBytes) {
+    // test case for: the file is too small to be gzip, with partial magic bytes
+    Byte data[] = {0x1f, 0x8b};
+    mockS3Interface.setData(data, sizeof(data));
+
+    EXPECT_CALL(mockS3Interface, fetchData(_, _, _, _))
+        .WillOnce(Invoke(&mockS3Interface, &MockS3InterfaceForCompressionRead::mockFetchData));
+
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setChunkSize(1024 * 1024 * 2);
+    params.setKeySize(sizeof(data));
+    this->open(params);
+
+    ASSERT_EQ(this->upstreamReader, &this->keyReader);
+
+    // peeked data is not consumed.
+    char result[0x10];
+    EXPECT_EQ((uint64_t)2, this->upstreamReader->read(result, sizeof(result)));
+    EXPECT_EQ(0, memcmp(result, data, sizeof(data)));
+}
+
 TEST_F(S3CommonReaderTest, ReadGZip) {
     Byte compressionBuff[0x100];
     uLong compressedLen = sizeof(compressionBuff);
     const char hello[] = "The quick brown fox jumps over the lazy dog";
 
-    compress(compressionBuff, &compressedLen, (const Bytef *)hello, sizeof(hello));
+    gzipCompress(compressionBuff, &compressedLen, hello, sizeof(hello));
 
     mockS3Interface.setData(compressionBuff, compressedLen);
 
-    EXPECT_CALL(mockS3Interface, checkCompressionType(_)).WillOnce(Return(S3_COMPRESSION_GZIP));
-
     EXPECT_CALL(mockS3Interface, fetchData(_, _, _, _))
         .WillOnce(Invoke(&mockS3Interface, &MockS3InterfaceForCompressionRead::mockFetchData));
 
@@ -86,3 +200,15 @@ TEST_F(S3CommonReaderTest, ReadGZip) {
     EXPECT_EQ((uint64_t)0, this->upstreamReader->read(result, sizeof(result)));
     EXPECT_EQ(0, memcmp(result, hello, sizeof(hello)));
 }
+
+TEST_F(S3CommonReaderTest, OpenWithFetchDataError) {
+    EXPECT_CALL(mockS3Interface, fetchData(_, _, _, _))
+        .WillOnce(Throw(S3FailedAfterRetry("", 3, "")));
+
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setChunkSize(1024 * 1024 * 2);
+    params.setKeySize(1024);
+
+    EXPECT_THROW(this->open(params), S3Exception);
+}
@@ -127,6 +127,31 @@ TEST_F(S3CommonWriteTest, UsingGZip) {
     ASSERT_TRUE(NULL != dynamic_cast<CompressWriter *>(this->upstreamWriter));
 }
 
+TEST_F(S3CommonWriteTest, UsingZstd) {
+    S3Params params("s3://abc/def");
+    params.setAutoCompress(true);
+    params.setCompressionType(S3_COMPRESSION_ZSTD);
+    params.setNumOfChunks(1);
+    params.setChunkSize(S3_ZIP_COMPRESS_CHUNKSIZE + 1);
+
+#ifdef USE_ZSTD
+    EXPECT_CALL(mockS3Interface, getUploadId(_))
+        .WillOnce(Invoke(&mockS3Interface, &MockS3InterfaceForCompressionWrite::mockGetUploadId));
+    EXPECT_CALL(mockS3Interface, uploadPartOfData(_, _, _, _))
+        .WillOnce(
+            Invoke(&mockS3Interface, &MockS3InterfaceForCompressionWrite::mockUploadPartOfData));
+    EXPECT_CALL(mockS3Interface, completeMultiPart(_, _, _))
+        .WillOnce(
+            Invoke(&mockS3Interface, &MockS3InterfaceForCompressionWrite::mockCompleteMultiPart));
+
+    this->open(params);
+
+    ASSERT_EQ(this->upstreamWriter, &this->codecWriter);
+#else
+    EXPECT_THROW(this->open(params), S3RuntimeError);
+#endif
+}
+
 // We need not to mock uploadPartOfData() and completeMultiPart() in plain mode,
 TEST_F(S3CommonWriteTest, UsingPlain) {
     EXPECT_CALL(mockS3Interface, getUploadId(_))
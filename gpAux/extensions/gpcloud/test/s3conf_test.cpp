@@ -32,6 +32,15 @@ TEST(Config, Basic) {
     EXPECT_FALSE(params.isDebugCurl());
 
     EXPECT_EQ(SSE_S3, params.getSSEType());
+    EXPECT_EQ(KEY_DIST_SIZE, params.getKeyDistType());
+
+    EXPECT_EQ("gpcloud_manifest", params.getManifestDir());
+    EXPECT_EQ((uint64_t)0, params.getManifestTTL());
+
+    EXPECT_EQ((uint64_t)1, params.getCompressThreadNum());
+
+    EXPECT_FALSE(params.isAutoCompress());
+    EXPECT_EQ(S3_COMPRESSION_GZIP, params.getCompressionType());
 }
 
 TEST(Config, SpecialSectionValues) {
@@ -45,6 +54,15 @@ TEST(Config, SpecialSectionValues) {
 
     EXPECT_FALSE(params.isDebugCurl());
     EXPECT_EQ(SSE_NONE, params.getSSEType());
+    EXPECT_EQ(KEY_DIST_ROUNDROBIN, params.getKeyDistType());
+
+    EXPECT_EQ("/data/manifest", params.getManifestDir());
+    EXPECT_EQ((uint64_t)300, params.getManifestTTL());
+
+    EXPECT_EQ((uint64_t)8, params.getCompressThreadNum());
+
+    EXPECT_TRUE(params.isAutoCompress());
+    EXPECT_EQ(S3_COMPRESSION_ZSTD, params.getCompressionType());
 }
 
 TEST(Config, SpecialSectionLowValues) {
@@ -52,6 +70,29 @@ TEST(Config, SpecialSectionLowValues) {
 
     EXPECT_EQ((uint64_t)1, params.getNumOfChunks());
     EXPECT_EQ((uint64_t)(8 * 1024 * 1024), params.getChunkSize());
+    EXPECT_EQ((uint64_t)1, params.getCompressThreadNum());
+    EXPECT_FALSE(params.isAutoCompress());
+}
+
+TEST(Config, CompressionInURL) {
+    S3Params params =
+        InitConfig("s3://abc/a config=data/s3test.conf section=special_over compression=lz4");
+    EXPECT_TRUE(params.isAutoCompress());
+    EXPECT_EQ(S3_COMPRESSION_LZ4, params.getCompressionType());
+
+    params = InitConfig("s3://abc/a config=data/s3test.conf section=special_over compression=none");
+    EXPECT_FALSE(params.isAutoCompress());
+
+    params = InitConfig("s3://abc/a config=data/s3test.conf section=special_low compression=gzip");
+    EXPECT_TRUE(params.isAutoCompress());
+    EXPECT_EQ(S3_COMPRESSION_GZIP, params.getCompressionType());
+}
+
+TEST(Config, UnknownCompression) {
+    EXPECT_THROW(InitConfig("s3://abc/a config=data/s3test.conf section=bad_compression"),
+                 S3ConfigError);
+    EXPECT_THROW(InitConfig("s3://abc/a config=data/s3test.conf compression=bzip2"),
+                 S3ConfigError);
 }
 
 TEST(Config, SpecialSectionWrongKeyName) {
@@ -387,62 +387,125 @@ TEST_F(S3InterfaceServiceTest, fetchDataPartialResponse) {
         S3PartialResponseError);
 }
 
-TEST_F(S3InterfaceServiceTest, checkSmallFile) {
+class VectorDataReceiver : public DataReceiver {
+   public:
+    VectorDataReceiver(uint64_t capacity) : capacity(capacity) {
+    }
+
+    bool receive(const char *ptr, uint64_t size) {
+        if (data.size() + size > capacity) {
+            return false;
+        }
+        data.insert(data.end(), ptr, ptr + size);
+        return true;
+    }
+
+    uint64_t capacity;
+    vector<char> data;
+};
+
+// Feeds the first part of data then breaks the connection, and the rest on next request.
+class BrokenStreamRESTfulService : public MockS3RESTfulService {
+   public:
+    BrokenStreamRESTfulService(const S3Params &params, uint64_t breakAt)
+        : MockS3RESTfulService(params), breakAt(breakAt), requestNum(0) {
+        for (int i = 0; i < 100; i++) {
+            raw.push_back('a' + i % 26);
+        }
+    }
+
+    Response streamingGet(const string &url, HTTPHeaders &headers, DataReceiver &receiver) {
+        this->ranges.push_back(headers.Get(RANGE));
+
+        if (this->requestNum++ == 0) {
+            receiver.receive(raw.data(), breakAt);
+            throw S3ConnectionError("connection reset");
+        }
+
+        receiver.receive(raw.data() + breakAt, raw.size() - breakAt);
+        return Response(RESPONSE_OK);
+    }
+
+    vector<char> raw;
+    vector<string> ranges;
+    uint64_t breakAt;
+    uint64_t requestNum;
+};
+
+TEST_F(S3InterfaceServiceTest, streamDataRoutine) {
     vector<uint8_t> raw;
-    raw.resize(2);
-    raw[0] = 0x1f;
-    raw[1] = 0x8b;
+    for (int i = 0; i < 100; i++) {
+        raw.push_back(i);
+    }
+
     Response response(RESPONSE_OK, raw);
     EXPECT_CALL(mockRESTfulService, get(_, _)).WillOnce(Return(response));
 
-    S3Url s3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever");
-    EXPECT_EQ(S3_COMPRESSION_PLAIN, this->checkCompressionType(s3Url.getFullUrlForCurl()));
+    VectorDataReceiver receiver(100);
+
+    uint64_t len = this->streamData(
+        0, receiver, 100, S3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever"));
+
+    EXPECT_EQ((uint64_t)100, len);
+    EXPECT_EQ((uint64_t)100, receiver.data.size());
+    EXPECT_EQ(0, memcmp(receiver.data.data(), raw.data(), 100));
 }
 
-TEST_F(S3InterfaceServiceTest, checkItsGzipCompressed) {
+TEST_F(S3InterfaceServiceTest, streamDataPartialResponse) {
     vector<uint8_t> raw;
-    raw.resize(4);
-    raw[0] = 0x1f;
-    raw[1] = 0x8b;
+    raw.resize(80);
     Response response(RESPONSE_OK, raw);
     EXPECT_CALL(mockRESTfulService, get(_, _)).WillOnce(Return(response));
 
-    S3Url s3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever");
-    EXPECT_EQ(S3_COMPRESSION_GZIP, this->checkCompressionType(s3Url));
+    VectorDataReceiver receiver(100);
+
+    EXPECT_THROW(
+        this->streamData(0, receiver, 100,
+                         S3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever")),
+        S3PartialResponseError);
 }
 
-TEST_F(S3InterfaceServiceTest, checkItsNotCompressed) {
+TEST_F(S3InterfaceServiceTest, streamDataRejectedByReceiver) {
     vector<uint8_t> raw;
-    raw.resize(4);
-    raw[0] = 0x1f;
-    raw[1] = 0x88;
+    raw.resize(100);
     Response response(RESPONSE_OK, raw);
     EXPECT_CALL(mockRESTfulService, get(_, _)).WillOnce(Return(response));
 
-    S3Url s3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever");
-    EXPECT_EQ(S3_COMPRESSION_PLAIN, this->checkCompressionType(s3Url));
+    VectorDataReceiver receiver(50);
+
+    EXPECT_THROW(
+        this->streamData(0, receiver, 100,
+                         S3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever")),
+        S3RuntimeError);
 }
 
-TEST_F(S3InterfaceServiceTest, checkCompreesionTypeWithResponseError) {
-    uint8_t xml[] =
-        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
-        "<Error>"
-        "<Code>PermanentRedirect</Code>"
-        "<Message>The bucket you are attempting to access must be addressed "
-        "using the specified endpoint. "
-        "Please send all future requests to this endpoint.</Message>"
-        "<Bucket>foo</Bucket><Endpoint>s3.amazonaws.com</Endpoint>"
-        "<RequestId>27DD9B7004AF83E3</RequestId>"
-        "<HostId>NL3pyGvn+FajhQLKz/"
-        "hXUzV1VnFbbwNjUQsqWeFiDANkV4EVkh8Kpq5NNAi27P7XDhoA9M9Xhg0=</HostId>"
-        "</Error>";
-    vector<uint8_t> raw(xml, xml + sizeof(xml) - 1);
-    Response response(RESPONSE_ERROR, raw);
+TEST_F(S3InterfaceServiceTest, streamDataResumeAfterConnectionError) {
+    BrokenStreamRESTfulService brokenService(this->params, 40);
+    this->setRESTfulService(&brokenService);
 
-    EXPECT_CALL(mockRESTfulService, get(_, _)).WillRepeatedly(Return(response));
+    VectorDataReceiver receiver(100);
 
-    S3Url s3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever");
-    EXPECT_THROW(this->checkCompressionType(s3Url), S3LogicError);
+    uint64_t len = this->streamData(
+        1000, receiver, 100, S3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever"));
+
+    EXPECT_EQ((uint64_t)100, len);
+    EXPECT_EQ(0, memcmp(receiver.data.data(), brokenService.raw.data(), 100));
+
+    // Second request only asks for what is left.
+    ASSERT_EQ((size_t)2, brokenService.ranges.size());
+    EXPECT_EQ("bytes=1000-1099", brokenService.ranges[0]);
+    EXPECT_EQ("bytes=1040-1099", brokenService.ranges[1]);
+}
+
+TEST_F(S3InterfaceServiceTest, streamDataFailedResponse) {
+    EXPECT_CALL(mockRESTfulService, get(_, _)).WillRepeatedly(Throw(S3ConnectionError("")));
+
+    VectorDataReceiver receiver(100);
+
+    EXPECT_THROW(
+        this->streamData(0, receiver, 100,
+                         S3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever")),
+        S3FailedAfterRetry);
 }
 
 TEST_F(S3InterfaceServiceTest, fetchDataWithResponseError) {
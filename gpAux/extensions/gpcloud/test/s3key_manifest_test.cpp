@@ -0,0 +1,229 @@
+#include "s3key_manifest.cpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "mock_classes.h"
+
+#include <utime.h>
+
+using ::testing::Return;
+using ::testing::_;
+
+// S3KeyManifest at a given time
+class S3KeyManifestAt : public S3KeyManifest {
+   public:
+    S3KeyManifestAt(const S3Params& params, time_t clock) : S3KeyManifest(params), clock(clock) {
+    }
+
+   protected:
+    virtual time_t now() const {
+        return clock;
+    }
+
+   private:
+    time_t clock;
+};
+
+class S3KeyManifestTest : public testing::Test {
+   protected:
+    // Remember that SetUp() is run immediately before a test starts.
+    virtual void SetUp() {
+        char dirTemplate[] = "/tmp/gpcloud_manifest_test_XXXXXX";
+        ASSERT_TRUE(mkdtemp(dirTemplate) != NULL);
+        manifestDir = dirTemplate;
+
+        params = S3Params("https://s3-us-east-2.amazonaws.com/s3test.pivotal.io/whatever");
+        params.setManifestDir(manifestDir);
+        params.setManifestTTL(60);
+        params.setQueryId("1-1");
+
+        result.Name = "s3test.pivotal.io";
+        result.Prefix = "whatever";
+        result.contents.emplace_back("whatever/foo", 456);
+        result.contents.emplace_back("whatever/bar baz\nqux", 123);
+    }
+
+    // TearDown() is invoked immediately after a test finishes.
+    virtual void TearDown() {
+        string cmd = "rm -rf " + manifestDir;
+        EXPECT_EQ(0, system(cmd.c_str()));
+    }
+
+    void setModificationTime(const string& path, time_t modtime) {
+        struct utimbuf times;
+        times.actime = times.modtime = modtime;
+        ASSERT_EQ(0, utime(path.c_str(), &times));
+    }
+
+    bool exists(const string& path) {
+        struct stat st;
+        return stat(path.c_str(), &st) == 0;
+    }
+
+    void expectSameKeys(const ListBucketResult& expected, const ListBucketResult& actual) {
+        EXPECT_EQ(expected.Name, actual.Name);
+        EXPECT_EQ(expected.Prefix, actual.Prefix);
+        ASSERT_EQ(expected.contents.size(), actual.contents.size());
+        for (uint64_t i = 0; i < expected.contents.size(); i++) {
+            EXPECT_EQ(expected.contents[i].getName(), actual.contents[i].getName());
+            EXPECT_EQ(expected.contents[i].getSize(), actual.contents[i].getSize());
+        }
+    }
+
+    string manifestDir;
+    S3Params params;
+    ListBucketResult result;
+    MockS3Interface s3Interface;
+};
+
+TEST_F(S3KeyManifestTest, ListBucketDirectlyIfTTLIsZero) {
+    params.setManifestTTL(0);
+    S3KeyManifest manifest(params);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(2).WillRepeatedly(Return(result));
+
+    manifest.listBucket(&s3Interface, params.getS3Url());
+    manifest.listBucket(&s3Interface, params.getS3Url());
+
+    struct stat st;
+    EXPECT_NE(0, stat(manifest.getManifestPath(params.getS3Url()).c_str(), &st));
+}
+
+TEST_F(S3KeyManifestTest, ListBucketOncePerQuery) {
+    S3KeyManifest manifest(params);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    expectSameKeys(result, manifest.listBucket(&s3Interface, params.getS3Url()));
+    expectSameKeys(result, manifest.listBucket(&s3Interface, params.getS3Url()));
+}
+
+TEST_F(S3KeyManifestTest, ListBucketAgainForAnotherQuery) {
+    S3Params nextQuery = params;
+    nextQuery.setQueryId("1-2");
+
+    ListBucketResult nextResult = result;
+    nextResult.contents.emplace_back("whatever/new", 789);
+
+    EXPECT_CALL(s3Interface, listBucket(_))
+        .Times(2)
+        .WillOnce(Return(result))
+        .WillOnce(Return(nextResult));
+
+    expectSameKeys(result, S3KeyManifest(params).listBucket(&s3Interface, params.getS3Url()));
+    expectSameKeys(nextResult,
+                   S3KeyManifest(nextQuery).listBucket(&s3Interface, nextQuery.getS3Url()));
+
+    // segments of the first query which start late still get its list
+    expectSameKeys(result, S3KeyManifest(params).listBucket(&s3Interface, params.getS3Url()));
+}
+
+TEST_F(S3KeyManifestTest, ListBucketOncePerQueryEvenAfterTTL) {
+    S3KeyManifest manifest(params);
+    string path = manifest.getManifestPath(params.getS3Url());
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    manifest.listBucket(&s3Interface, params.getS3Url());
+    setModificationTime(path, time(NULL) - 120);
+
+    expectSameKeys(result, manifest.listBucket(&s3Interface, params.getS3Url()));
+}
+
+TEST_F(S3KeyManifestTest, RemoveManifestsOfEarlierQueriesOnceExpired) {
+    S3Params expiredQuery = params;
+    expiredQuery.setQueryId("1-2");
+    S3Params recentQuery = params;
+    recentQuery.setQueryId("1-3");
+    S3Params nextQuery = params;
+    nextQuery.setQueryId("1-4");
+
+    string expiredPath = S3KeyManifest(expiredQuery).getManifestPath(expiredQuery.getS3Url());
+    string recentPath = S3KeyManifest(recentQuery).getManifestPath(recentQuery.getS3Url());
+    string otherPath = manifestDir + "/not_a_manifest";
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(3).WillRepeatedly(Return(result));
+
+    S3KeyManifest(expiredQuery).listBucket(&s3Interface, expiredQuery.getS3Url());
+    S3KeyManifest(recentQuery).listBucket(&s3Interface, recentQuery.getS3Url());
+    FILE* fp = fopen(otherPath.c_str(), "w");
+    ASSERT_TRUE(fp != NULL);
+    fclose(fp);
+
+    // listed exactly the TTL, and one second less than the TTL, before the next query
+    time_t now = time(NULL);
+    setModificationTime(expiredPath, now - 60);
+    setModificationTime(expiredPath + ".lock", now - 60);
+    setModificationTime(recentPath, now - 59);
+    setModificationTime(recentPath + ".lock", now - 59);
+    setModificationTime(otherPath, now - 60);
+
+    S3KeyManifestAt(nextQuery, now).listBucket(&s3Interface, nextQuery.getS3Url());
+
+    EXPECT_FALSE(exists(expiredPath));
+    EXPECT_FALSE(exists(expiredPath + ".lock"));
+    EXPECT_TRUE(exists(recentPath));
+    EXPECT_TRUE(exists(recentPath + ".lock"));
+    EXPECT_TRUE(exists(otherPath));
+    EXPECT_TRUE(exists(S3KeyManifest(nextQuery).getManifestPath(nextQuery.getS3Url())));
+}
+
+TEST_F(S3KeyManifestTest, ListBucketAgainIfManifestIsBroken) {
+    S3KeyManifest manifest(params);
+    string path = manifest.getManifestPath(params.getS3Url());
+
+    FILE* fp = fopen(path.c_str(), "w");
+    ASSERT_TRUE(fp != NULL);
+    fprintf(fp, "%s\n4 abc", S3_MANIFEST_MAGIC);
+    fclose(fp);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    expectSameKeys(result, manifest.listBucket(&s3Interface, params.getS3Url()));
+}
+
+TEST_F(S3KeyManifestTest, ManifestPathDependsOnUrlCredentialAndQuery) {
+    S3KeyManifest manifest(params);
+    string path = manifest.getManifestPath(params.getS3Url());
+
+    S3Params otherPrefix = params.setPrefix("another");
+    EXPECT_NE(path, manifest.getManifestPath(otherPrefix.getS3Url()));
+
+    S3Params otherCred = params;
+    otherCred.setCred("another_id", "secret", "");
+    EXPECT_NE(path, S3KeyManifest(otherCred).getManifestPath(otherCred.getS3Url()));
+
+    S3Params otherQuery = params;
+    otherQuery.setQueryId("2-1");
+    EXPECT_NE(path, S3KeyManifest(otherQuery).getManifestPath(otherQuery.getS3Url()));
+
+    EXPECT_EQ(0u, path.find(manifestDir + "/gpcloud_manifest_"));
+}
+
+TEST_F(S3KeyManifestTest, ListBucketDirectlyIfDirIsNotWritable) {
+    params.setManifestDir(manifestDir + "/not_exist/manifest");
+    S3KeyManifest manifest(params);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(2).WillRepeatedly(Return(result));
+
+    expectSameKeys(result, manifest.listBucket(&s3Interface, params.getS3Url()));
+    expectSameKeys(result, manifest.listBucket(&s3Interface, params.getS3Url()));
+}
+
+TEST_F(S3KeyManifestTest, ManifestIsOnlyAccessibleByOwner) {
+    params.setManifestDir(manifestDir + "/manifest");
+    S3KeyManifest manifest(params);
+    string path = manifest.getManifestPath(params.getS3Url());
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    mode_t oldMask = umask(0);
+    manifest.listBucket(&s3Interface, params.getS3Url());
+    umask(oldMask);
+
+    struct stat st;
+    ASSERT_EQ(0, stat(params.getManifestDir().c_str(), &st));
+    EXPECT_EQ((mode_t)S_IRWXU, st.st_mode & 0777);
+
+    ASSERT_EQ(0, stat(path.c_str(), &st));
+    EXPECT_EQ((mode_t)(S_IRUSR | S_IWUSR), st.st_mode & 0777);
+}
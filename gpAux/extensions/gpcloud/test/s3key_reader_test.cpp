@@ -309,6 +309,93 @@ TEST_F(S3KeyReaderTest, ReadWithSmallBuffer) {
     EXPECT_EQ((uint64_t)0, this->read(buffer, 64));
 }
 
+// Mock function object of streamData
+// Hand data to receiver piece by piece, as curl does.
+class MockStreamData {
+   public:
+    MockStreamData(uint64_t pieceLen) : pieceLen(pieceLen) {
+    }
+
+    uint64_t operator()(uint64_t offset, DataReceiver &receiver, uint64_t len,
+                        const S3Url &sourceUrl) {
+        char piece[256];
+        for (uint64_t done = 0; done < len; done += pieceLen) {
+            uint64_t size = std::min(pieceLen, len - done);
+            for (uint64_t i = 0; i < size; i++) {
+                piece[i] = (char)(offset + done + i);
+            }
+
+            if (!receiver.receive(piece, size)) {
+                return done;
+            }
+            usleep(1000);
+        }
+        return len;
+    }
+
+   private:
+    uint64_t pieceLen;
+};
+
+class MockS3InterfaceForStreaming : public MockS3Interface {
+   public:
+    MOCK_METHOD4(streamData, uint64_t(uint64_t, DataReceiver &, uint64_t len, const S3Url &));
+};
+
+TEST(S3KeyReaderStreamingTest, ReadWhileChunkIsFilling) {
+    MockS3InterfaceForStreaming s3Interface;
+    S3KeyReader reader;
+    reader.setS3InterfaceService(&s3Interface);
+
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setKeySize(255);
+    params.setChunkSize(8192);
+
+    EXPECT_CALL(s3Interface, streamData(_, _, _, _)).WillOnce(Invoke(MockStreamData(16)));
+
+    reader.open(params);
+
+    char buffer[64];
+    for (int round = 0; round < 3; round++) {
+        EXPECT_EQ((uint64_t)64, reader.read(buffer, 64));
+        for (int i = 0; i < 64; i++) {
+            EXPECT_EQ((char)(round * 64 + i), buffer[i]);
+        }
+    }
+    EXPECT_EQ((uint64_t)63, reader.read(buffer, 64));
+    EXPECT_EQ((char)(192 + 62), buffer[62]);
+    EXPECT_EQ((uint64_t)1, reader.read(buffer, 64));
+    EXPECT_EQ((uint64_t)0, reader.read(buffer, 64));
+
+    reader.close();
+}
+
+TEST(S3KeyReaderStreamingTest, ReceiveMoreThanChunkSize) {
+    MockS3InterfaceForStreaming s3Interface;
+    S3KeyReader reader;
+    reader.setS3InterfaceService(&s3Interface);
+
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setKeySize(16);
+    params.setChunkSize(8192);
+
+    // Ask for 32 bytes while chunk has 16 bytes only, receiver must reject.
+    EXPECT_CALL(s3Interface, streamData(_, _, _, _))
+        .WillOnce(Invoke([](uint64_t offset, DataReceiver &receiver, uint64_t len,
+                            const S3Url &sourceUrl) -> uint64_t {
+            return MockStreamData(32)(offset, receiver, len * 2, sourceUrl);
+        }));
+
+    reader.open(params);
+
+    char buffer[64];
+    EXPECT_THROW(reader.read(buffer, 64), S3PartialResponseError);
+
+    reader.close();
+}
+
 TEST_F(S3KeyReaderTest, CloseWithoutFinishReading) {
     S3Params params("s3://abc/def");
 
@@ -186,3 +186,203 @@ TEST_F(S3KeyWriterTest, TestWriteAbortInClosing) {
     EXPECT_THROW(this->close(), S3QueryAbort);
     QueryCancelPending = false;
 }
+
+TEST_F(S3KeyWriterTest, TestPartSizeGrowth) {
+    testParams.setChunkSize(64 * 1024 * 1024);
+    this->params = testParams;
+
+    // Ramp up from S3's minimal part size to chunk size.
+    EXPECT_EQ((uint64_t)S3_MIN_PART_SIZE, this->getPartSize(1));
+    EXPECT_EQ((uint64_t)S3_MIN_PART_SIZE * 2, this->getPartSize(2));
+    EXPECT_EQ((uint64_t)S3_MIN_PART_SIZE * 8, this->getPartSize(4));
+    EXPECT_EQ((uint64_t)64 * 1024 * 1024, this->getPartSize(5));
+    EXPECT_EQ((uint64_t)64 * 1024 * 1024, this->getPartSize(S3_PART_SIZE_GROWTH_PARTS));
+
+    // Then grow with number of parts, up to S3_MAX_PART_SIZE.
+    EXPECT_EQ((uint64_t)128 * 1024 * 1024, this->getPartSize(S3_PART_SIZE_GROWTH_PARTS + 1));
+    EXPECT_EQ((uint64_t)S3_MAX_PART_SIZE, this->getPartSize(10000));
+}
+
+TEST_F(S3KeyWriterTest, TestPartSizeOfSmallChunk) {
+    testParams.setChunkSize(1000);
+    this->params = testParams;
+
+    EXPECT_EQ((uint64_t)1000, this->getPartSize(1));
+    EXPECT_EQ((uint64_t)1000, this->getPartSize(S3_PART_SIZE_GROWTH_PARTS));
+    EXPECT_EQ((uint64_t)2000, this->getPartSize(S3_PART_SIZE_GROWTH_PARTS + 1));
+    EXPECT_EQ((uint64_t)1000 << 9, this->getPartSize(10000));
+}
+
+TEST_F(S3KeyWriterTest, TestPartSizeOfLargeChunk) {
+    testParams.setChunkSize(256 * 1024 * 1024);
+    this->params = testParams;
+
+    // Chunk size larger than S3_MAX_PART_SIZE is not shrunk.
+    EXPECT_EQ((uint64_t)256 * 1024 * 1024, this->getPartSize(7));
+    EXPECT_EQ((uint64_t)256 * 1024 * 1024, this->getPartSize(10000));
+}
+
+class MockUploadPartCollector {
+   public:
+    MockUploadPartCollector() {
+        pthread_mutex_init(&this->lock, NULL);
+    }
+
+    ~MockUploadPartCollector() {
+        pthread_mutex_destroy(&this->lock);
+    }
+
+    string mockUploadPartOfData(S3VectorUInt8 &data, const S3Url &s3Url, uint64_t partNumber,
+                                const string &uploadId) {
+        UniqueLock uniqueLock(&this->lock);
+        this->parts[partNumber].assign(data.begin(), data.end());
+        return "\"etag" + std::to_string((unsigned long long)partNumber) + "\"";
+    }
+
+    pthread_mutex_t lock;
+    map<uint64_t, vector<uint8_t>> parts;
+};
+
+TEST_F(S3KeyWriterTest, TestUploadManyPartsByThreadPool) {
+    testParams.setChunkSize(0x100);
+    testParams.setNumOfChunks(3);
+
+    MockUploadPartCollector collector;
+    vector<string> expectedEtags;
+    for (int i = 1; i <= 20; i++) {
+        expectedEtags.push_back("\"etag" + std::to_string((unsigned long long)i) + "\"");
+    }
+
+    EXPECT_CALL(this->mockS3Interface, getUploadId(_)).WillOnce(Return("uploadId"));
+    EXPECT_CALL(this->mockS3Interface, uploadPartOfData(_, _, _, "uploadId"))
+        .Times(20)
+        .WillRepeatedly(Invoke(&collector, &MockUploadPartCollector::mockUploadPartOfData));
+    EXPECT_CALL(this->mockS3Interface, completeMultiPart(_, "uploadId", expectedEtags))
+        .WillOnce(Return(true));
+
+    this->open(testParams);
+    EXPECT_EQ((uint64_t)3, this->threadList.size());
+
+    vector<uint8_t> data(0x100 * 20 - 0x10);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = i % 251;
+    }
+
+    for (size_t offset = 0; offset < data.size(); offset += 0x30) {
+        this->write((const char *)data.data() + offset, std::min((size_t)0x30, data.size() - offset));
+    }
+    this->close();
+
+    // Threads are reused for all parts, and stopped by close().
+    EXPECT_TRUE(this->threadList.empty());
+
+    vector<uint8_t> uploaded;
+    for (map<uint64_t, vector<uint8_t>>::iterator i = collector.parts.begin();
+         i != collector.parts.end(); i++) {
+        uploaded.insert(uploaded.end(), i->second.begin(), i->second.end());
+    }
+    EXPECT_TRUE(data == uploaded);
+}
+
+class MockInflightPartCounter {
+   public:
+    MockInflightPartCounter() : inflightParts(0), inflightBytes(0), maxParts(0), maxBytes(0) {
+        pthread_mutex_init(&this->lock, NULL);
+    }
+
+    ~MockInflightPartCounter() {
+        pthread_mutex_destroy(&this->lock);
+    }
+
+    string mockUploadPartOfData(S3VectorUInt8 &data, const S3Url &s3Url, uint64_t partNumber,
+                                const string &uploadId) {
+        {
+            UniqueLock uniqueLock(&this->lock);
+            this->inflightParts++;
+            this->inflightBytes += data.size();
+            this->maxParts = std::max(this->maxParts, this->inflightParts);
+            this->maxBytes = std::max(this->maxBytes, this->inflightBytes);
+        }
+
+        // Give the other threads a chance to upload at the same time.
+        usleep(10000);
+
+        UniqueLock uniqueLock(&this->lock);
+        this->inflightParts--;
+        this->inflightBytes -= data.size();
+        return "\"etag" + std::to_string((unsigned long long)partNumber) + "\"";
+    }
+
+    pthread_mutex_t lock;
+    uint64_t inflightParts;
+    uint64_t inflightBytes;
+    uint64_t maxParts;
+    uint64_t maxBytes;
+};
+
+TEST_F(S3KeyWriterTest, TestInflightPartsOfSmallPartSize) {
+    testParams.setChunkSize(0x100);
+    testParams.setNumOfChunks(3);
+
+    MockInflightPartCounter counter;
+    EXPECT_CALL(this->mockS3Interface, getUploadId(_)).WillOnce(Return("uploadId"));
+    EXPECT_CALL(this->mockS3Interface, uploadPartOfData(_, _, _, "uploadId"))
+        .Times(12)
+        .WillRepeatedly(Invoke(&counter, &MockInflightPartCounter::mockUploadPartOfData));
+    EXPECT_CALL(this->mockS3Interface, completeMultiPart(_, "uploadId", _)).WillOnce(Return(true));
+
+    this->open(testParams);
+
+    vector<char> data(0x100 * 12);
+    this->write(data.data(), data.size());
+    this->close();
+
+    EXPECT_LE(counter.maxParts, (uint64_t)3);
+    EXPECT_LE(counter.maxBytes, this->getInflightLimit());
+}
+
+TEST_F(S3KeyWriterTest, TestInflightPartsOfGrownPartSize) {
+    testParams.setChunkSize(0x100);
+    testParams.setNumOfChunks(3);
+
+    MockInflightPartCounter counter;
+    EXPECT_CALL(this->mockS3Interface, getUploadId(_)).WillOnce(Return("uploadId"));
+    EXPECT_CALL(this->mockS3Interface, uploadPartOfData(_, _, _, "uploadId"))
+        .Times(6)
+        .WillRepeatedly(Invoke(&counter, &MockInflightPartCounter::mockUploadPartOfData));
+    EXPECT_CALL(this->mockS3Interface, completeMultiPart(_, "uploadId", _)).WillOnce(Return(true));
+
+    this->open(testParams);
+
+    // Pretend many parts are uploaded, so that parts grow to 4 chunks, larger than the limit.
+    this->partNumber = S3_PART_SIZE_GROWTH_PARTS * 2;
+    this->bufferLimit = this->getPartSize(this->partNumber + 1);
+    ASSERT_EQ((uint64_t)0x400, this->bufferLimit);
+
+    vector<char> data(0x400 * 6);
+    this->write(data.data(), data.size());
+    this->close();
+
+    // Grown parts are uploaded one by one instead of by all threads at the same time.
+    EXPECT_EQ((uint64_t)1, counter.maxParts);
+    EXPECT_EQ((uint64_t)0x400, counter.maxBytes);
+}
+
+TEST_F(S3KeyWriterTest, TestUploadPartFailed) {
+    testParams.setChunkSize(0x100);
+    testParams.setNumOfChunks(1);
+
+    char data[0x100];
+    EXPECT_CALL(this->mockS3Interface, getUploadId(_)).WillOnce(Return("uploadId"));
+    EXPECT_CALL(this->mockS3Interface, uploadPartOfData(_, _, 1, "uploadId"))
+        .WillOnce(Throw(S3FailedAfterRetry("", 3, "")));
+    EXPECT_CALL(this->mockS3Interface, completeMultiPart(_, _, _)).Times(AtMost(1));
+
+    this->open(testParams);
+    this->write(data, sizeof(data));
+
+    // Wait until the part is handled by upload thread.
+    this->stopUploadThreads();
+
+    EXPECT_THROW(this->write(data, sizeof(data)), S3FailedAfterRetry);
+}
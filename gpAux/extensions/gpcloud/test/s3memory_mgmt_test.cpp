@@ -0,0 +1,150 @@
+#include "s3memory_mgmt.cpp"
+#include "gtest/gtest.h"
+
+TEST(PreAllocatedMemory, AllocateAndDeallocate) {
+    PreAllocatedMemory memory(1024, 3);
+
+    void *p1 = memory.Allocate(1024);
+    void *p2 = memory.Allocate(100);
+    EXPECT_NE(p1, p2);
+    EXPECT_EQ((uint64_t)2, memory.GetUsedChunks());
+
+    // Memory is usable.
+    memset(p1, 0xFF, 1024);
+    memset(p2, 0xFF, 1024);
+
+    memory.Deallocate(p1);
+    EXPECT_EQ((uint64_t)1, memory.GetUsedChunks());
+
+    // Freed chunk is reused at once.
+    EXPECT_EQ(p1, memory.Allocate(1024));
+
+    memory.Deallocate(p1);
+    memory.Deallocate(p2);
+    EXPECT_EQ((uint64_t)0, memory.GetUsedChunks());
+    EXPECT_EQ((uint64_t)2, memory.GetPeakUsedChunks());
+    EXPECT_EQ((uint64_t)0, memory.GetFallbackCount());
+}
+
+TEST(PreAllocatedMemory, OverLimit) {
+    EXPECT_THROW(PreAllocatedMemory(128 * 1024 * 1024, 10), S3MemoryOverLimit);
+}
+
+TEST(PreAllocatedMemory, FallbackWhenExhausted) {
+    PreAllocatedMemory memory(1024, 1);
+
+    void *p1 = memory.Allocate(1024);
+    void *p2 = memory.Allocate(1024);
+    ASSERT_TRUE(p2 != NULL);
+    memset(p2, 0xFF, 1024);
+
+    EXPECT_EQ((uint64_t)1, memory.GetWaitCount());
+    EXPECT_EQ((uint64_t)1, memory.GetFallbackCount());
+    EXPECT_EQ((uint64_t)1, memory.GetUsedChunks());
+
+    memory.Deallocate(p2);
+    memory.Deallocate(p1);
+    EXPECT_EQ((uint64_t)0, memory.GetUsedChunks());
+}
+
+TEST(PreAllocatedMemory, FallbackForLargeBlock) {
+    PreAllocatedMemory memory(1024, 2);
+
+    void *p = memory.Allocate(4096);
+    memset(p, 0xFF, 4096);
+
+    EXPECT_EQ((uint64_t)0, memory.GetWaitCount());
+    EXPECT_EQ((uint64_t)1, memory.GetFallbackCount());
+    EXPECT_EQ((uint64_t)0, memory.GetUsedChunks());
+
+    memory.Deallocate(p);
+}
+
+TEST(PreAllocatedMemory, FreeInvalidMemory) {
+    PreAllocatedMemory memory(1024, 2);
+
+    void *p = memory.Allocate(1024);
+    memory.Deallocate(p);
+
+    // double free
+    EXPECT_THROW(memory.Deallocate(p), S3RuntimeError);
+
+    char buf[64] = {0};
+    EXPECT_THROW(memory.Deallocate(buf + 32), S3RuntimeError);
+    EXPECT_THROW(memory.Deallocate(NULL), S3RuntimeError);
+}
+
+struct MemoryWaiterParams {
+    PreAllocatedMemory *memory;
+    void *result;
+};
+
+static void *AllocateInThread(void *data) {
+    MemoryWaiterParams *params = (MemoryWaiterParams *)data;
+    params->result = params->memory->Allocate(1024);
+    return NULL;
+}
+
+TEST(PreAllocatedMemory, WaitForReleasedChunk) {
+    PreAllocatedMemory memory(1024, 1);
+    void *p = memory.Allocate(1024);
+
+    MemoryWaiterParams params = {&memory, NULL};
+    pthread_t thread;
+    pthread_create(&thread, NULL, AllocateInThread, &params);
+
+    // Released before the waiter times out.
+    usleep(S3_MEMORY_WAIT_TIMEOUT_MS * 1000 / 4);
+    memory.Deallocate(p);
+    pthread_join(thread, NULL);
+
+    EXPECT_EQ(p, params.result);
+    EXPECT_EQ((uint64_t)0, memory.GetFallbackCount());
+
+    memory.Deallocate(params.result);
+}
+
+static void *AllocateManyTimes(void *data) {
+    PreAllocatedMemory *memory = (PreAllocatedMemory *)data;
+
+    for (int i = 0; i < 10000; i++) {
+        uint64_t *p = (uint64_t *)memory->Allocate(64);
+        *p = (uint64_t)pthread_self();
+        sched_yield();
+        EXPECT_EQ((uint64_t)pthread_self(), *p);
+        memory->Deallocate(p);
+    }
+
+    return NULL;
+}
+
+TEST(PreAllocatedMemory, ConcurrentAllocation) {
+    PreAllocatedMemory memory(64, 4);
+
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, AllocateManyTimes, &memory);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // Enough chunks for every thread, no chunk is handed out twice.
+    EXPECT_EQ((uint64_t)0, memory.GetUsedChunks());
+    EXPECT_EQ((uint64_t)0, memory.GetFallbackCount());
+    EXPECT_LE(memory.GetPeakUsedChunks(), (uint64_t)4);
+}
+
+TEST(PreAllocatedMemory, UsedByVector) {
+    S3MemoryContext context;
+    context.prepare(1024, 2);
+
+    S3VectorUInt8 v1(context);
+    v1.reserve(1024);
+    S3VectorUInt8 v2(context);
+    v2.reserve(100);
+    EXPECT_EQ((uint64_t)2, context.prealloc->GetUsedChunks());
+
+    v1.release();
+    EXPECT_EQ((uint64_t)1, context.prealloc->GetUsedChunks());
+}
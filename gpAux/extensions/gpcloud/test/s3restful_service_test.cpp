@@ -320,3 +320,58 @@ TEST(S3RESTfulService, DISABLED_DeleteToDummyServerWithData) {
     Response resp = service.deleteRequest(url, headers);
     EXPECT_EQ(RESPONSE_OK, resp.getStatus());
 }
+
+TEST(CURLHandlePool, ReuseReleasedHandle) {
+    CURLHandlePool pool(2);
+
+    CURL *first = pool.acquire();
+    ASSERT_TRUE(first != NULL);
+    pool.release(first);
+    EXPECT_EQ((uint64_t)1, pool.getIdleHandleNum());
+
+    CURL *second = pool.acquire();
+    EXPECT_EQ(first, second);
+    EXPECT_EQ((uint64_t)0, pool.getIdleHandleNum());
+
+    pool.release(second);
+}
+
+TEST(CURLHandlePool, KeepNoMoreThanCapacity) {
+    CURLHandlePool pool(2);
+
+    CURL *handles[3];
+    for (int i = 0; i < 3; i++) {
+        handles[i] = pool.acquire();
+        ASSERT_TRUE(handles[i] != NULL);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        pool.release(handles[i]);
+    }
+
+    EXPECT_EQ((uint64_t)2, pool.getIdleHandleNum());
+
+    pool.clear();
+    EXPECT_EQ((uint64_t)0, pool.getIdleHandleNum());
+}
+
+TEST(CURLHandlePool, CapacityFollowsThreadNum) {
+    S3Params params;
+    params.setNumOfChunks(6);
+
+    S3RESTfulService service(params);
+
+    EXPECT_EQ((uint64_t)7, service.getHandlePool().getCapacity());
+}
+
+TEST(CURLHandlePool, FailedRequestIsNotCounted) {
+    HTTPHeaders headers;
+    string url;
+    S3RESTfulService service;
+
+    EXPECT_THROW(service.get(url, headers), S3ConnectionError);
+
+    EXPECT_EQ((uint64_t)0, service.getHandlePool().getReusedConnectionNum());
+    EXPECT_EQ((uint64_t)0, service.getHandlePool().getNewConnectionNum());
+    EXPECT_EQ((uint64_t)1, service.getHandlePool().getIdleHandleNum());
+}
@@ -0,0 +1,225 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    calc_hash_value_codegen.cc
+//
+//  @doc:
+//    Generates code for calc_hash_value function.
+//
+//---------------------------------------------------------------------------
+#include <string>
+
+#include "codegen/calc_hash_value_codegen.h"
+#include "codegen/exec_hash_get_hash_value_codegen.h"
+
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "access/hash.h"
+#include "executor/execHHashagg.h"
+#include "executor/executor.h"
+#include "executor/tuptable.h"
+#include "nodes/execnodes.h"
+#include "nodes/plannodes.h"
+#include "utils/palloc.h"
+}
+
+namespace llvm {
+class BasicBlock;
+class Function;
+class Value;
+}  // namespace llvm
+
+using gpcodegen::CalcHashValueCodegen;
+using gpcodegen::ExecHashGetHashValueCodegen;
+
+constexpr char CalcHashValueCodegen::kCalcHashValuePrefix[];
+
+CalcHashValueCodegen::CalcHashValueCodegen(
+    CodegenManager* manager,
+    CalcHashValueFn regular_func_ptr,
+    CalcHashValueFn* ptr_to_regular_func_ptr,
+    AggState *aggstate)
+: BaseCodegen(manager,
+              kCalcHashValuePrefix,
+              regular_func_ptr,
+              ptr_to_regular_func_ptr),
+              aggstate_(aggstate) {
+}
+
+bool CalcHashValueCodegen::GenerateCalcHashValue(
+    gpcodegen::GpCodegenUtils* codegen_utils) {
+
+  assert(NULL != codegen_utils);
+  if (nullptr == aggstate_ ||
+      nullptr == aggstate_->hashfunctions ||
+      nullptr == outerPlanState(aggstate_)) {
+    return false;
+  }
+
+  Agg *agg = reinterpret_cast<Agg*>(aggstate_->ss.ps.plan);
+  TupleDesc input_desc = ExecGetResultType(outerPlanState(aggstate_));
+  if (agg->numCols <= 0 || nullptr == input_desc) {
+    return false;
+  }
+
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::Function* calc_hash_value_func = CreateFunction<CalcHashValueFn>(
+      codegen_utils, GetUniqueFuncName());
+
+  // BasicBlock of function entry.
+  llvm::BasicBlock* entry_block = codegen_utils->CreateBasicBlock(
+      "entry_block", calc_hash_value_func);
+  llvm::BasicBlock* implementation_block = codegen_utils->CreateBasicBlock(
+      "implementation_block", calc_hash_value_func);
+  llvm::BasicBlock* error_aggstate_block = codegen_utils->CreateBasicBlock(
+      "error_aggstate_block", calc_hash_value_func);
+
+  // External functions
+  llvm::Function* llvm_slot_getattr =
+      codegen_utils->GetOrRegisterExternalFunction(slot_getattr_regular,
+                                                   "slot_getattr_regular");
+  llvm::Function* llvm_MemoryContextSwitchTo =
+      codegen_utils->GetOrRegisterExternalFunction(MemoryContextSwitchTo,
+                                                   "MemoryContextSwitchTo");
+  llvm::Function* llvm_hash_any =
+      codegen_utils->GetOrRegisterExternalFunction(hash_any, "hash_any");
+
+  // Function arguments to calc_hash_value
+  llvm::Value* llvm_aggstate_arg = ArgumentByPosition(calc_hash_value_func, 0);
+  llvm::Value* llvm_inputslot_arg = ArgumentByPosition(calc_hash_value_func, 1);
+
+  // Generation-time constants
+  llvm::Value* llvm_aggstate = codegen_utils->GetConstant(aggstate_);
+  llvm::Value *llvm_tuplecontext = codegen_utils->GetConstant<MemoryContext>(
+      aggstate_->tmpcontext->ecxt_per_tuple_memory);
+
+  // entry block
+  // ----------
+  irb->SetInsertPoint(entry_block);
+
+#ifdef CODEGEN_DEBUG
+  EXPAND_CREATE_ELOG(codegen_utils, DEBUG1,
+                     "Codegen'ed calc_hash_value called!");
+#endif
+
+  // Compare aggstate given during code generation and the one passed
+  // in as an argument to calc_hash_value
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(llvm_aggstate, llvm_aggstate_arg),
+      implementation_block /* true */,
+      error_aggstate_block /* false */);
+
+  // implementation block
+  // ----------
+  irb->SetInsertPoint(implementation_block);
+
+  // oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+  llvm::Value *llvm_oldContext = irb->CreateCall(llvm_MemoryContextSwitchTo,
+                                                 {llvm_tuplecontext});
+
+  // The hash keys of the columns are kept on the stack, instead of in
+  // hashtable->hashkey_buf, since no one else reads them.
+  llvm::Value* llvm_hashkey_buf = irb->CreateAlloca(
+      codegen_utils->GetType<HashKey>(),
+      codegen_utils->GetConstant(agg->numCols), "hashkey_buf");
+  llvm::Value* llvm_isnull_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "isnull");
+
+  for (int i = 0; i < agg->numCols; i++) {
+    AttrNumber att = agg->grpColIdx[i];
+    if (att <= 0 || att > input_desc->natts) {
+      elog(DEBUG1, "We don't codegen grouping on system columns");
+      return false;
+    }
+    Oid key_type = input_desc->attrs[att - 1]->atttypid;
+
+    llvm::BasicBlock* null_key_block = codegen_utils->CreateBasicBlock(
+        "null_key_block_" + std::to_string(i), calc_hash_value_func);
+    llvm::BasicBlock* hash_key_block = codegen_utils->CreateBasicBlock(
+        "hash_key_block_" + std::to_string(i), calc_hash_value_func);
+    llvm::BasicBlock* next_key_block = codegen_utils->CreateBasicBlock(
+        "next_key_block_" + std::to_string(i), calc_hash_value_func);
+
+    llvm::Value* llvm_hashkey_ptr = irb->CreateInBoundsGEP(
+        codegen_utils->GetType<HashKey>(),
+        llvm_hashkey_buf,
+        codegen_utils->GetConstant(i));
+
+    // value = slot_getattr(inputslot, att, &isnull);
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false), llvm_isnull_ptr);
+    llvm::Value* llvm_value = irb->CreateCall(llvm_slot_getattr, {
+        llvm_inputslot_arg,
+        codegen_utils->GetConstant<int32_t>(att),
+        llvm_isnull_ptr});
+    irb->CreateCondBr(irb->CreateLoad(llvm_isnull_ptr),
+                      null_key_block /* true */,
+                      hash_key_block /* false */);
+
+    // null_key_block
+    // --------------
+    // Treat nulls as having hash key 0xdeadbeef
+    irb->SetInsertPoint(null_key_block);
+    irb->CreateStore(codegen_utils->GetConstant<HashKey>(0xdeadbeef),
+                     llvm_hashkey_ptr);
+    irb->CreateBr(next_key_block);
+
+    // hash_key_block
+    // --------------
+    // hashkey_buf[i] = DatumGetUInt32(FunctionCall1(info, value));
+    irb->SetInsertPoint(hash_key_block);
+    irb->CreateStore(
+        ExecHashGetHashValueCodegen::GenerateHashKey(
+            codegen_utils,
+            aggstate_->hashfunctions[i].fn_oid,
+            key_type,
+            llvm_value,
+            codegen_utils->GetConstant(&aggstate_->hashfunctions[i])),
+        llvm_hashkey_ptr);
+    irb->CreateBr(next_key_block);
+
+    irb->SetInsertPoint(next_key_block);
+  }
+
+  // MemoryContextSwitchTo(oldContext);
+  irb->CreateCall(llvm_MemoryContextSwitchTo, {llvm_oldContext});
+
+  // return hash_any((unsigned char *) hashkey_buf,
+  //                 agg->numCols * sizeof(HashKey));
+  llvm::Value* llvm_hash = irb->CreateCall(llvm_hash_any, {
+      irb->CreateBitCast(llvm_hashkey_buf,
+                         codegen_utils->GetType<const unsigned char*>()),
+      codegen_utils->GetConstant<int>(
+          static_cast<int>(agg->numCols * sizeof(HashKey)))});
+  irb->CreateRet(codegen_utils->CreateDatumToCppTypeCast<uint32_t>(llvm_hash));
+
+  // Error aggstate block
+  // ---------------
+  irb->SetInsertPoint(error_aggstate_block);
+
+  EXPAND_CREATE_ELOG(codegen_utils, ERROR, "Codegened calc_hash_value: "
+                     "use of different aggstate.");
+
+  irb->CreateRet(codegen_utils->GetConstant<uint32_t>(0));
+
+  return true;
+}
+
+
+bool CalcHashValueCodegen::GenerateCodeInternal(
+    GpCodegenUtils* codegen_utils) {
+  bool isGenerated = GenerateCalcHashValue(codegen_utils);
+
+  if (isGenerated) {
+    elog(DEBUG1, "calc_hash_value was generated successfully!");
+    return true;
+  } else {
+    elog(DEBUG1, "calc_hash_value generation failed!");
+    return false;
+  }
+}
@@ -13,12 +13,18 @@
 
 #include <string>
 
+#include "codegen/codegen_manager.h"
+
 using gpcodegen::CodegenInterface;
+using gpcodegen::CodegenManager;
 
 // Initalization of unique counter
 unsigned CodegenInterface::unique_counter_ = 0;
 
 std::string CodegenInterface::GenerateUniqueName(
-    const std::string& orig_func_name) {
+    const std::string& orig_func_name, CodegenManager* manager) {
+  if (nullptr != manager) {
+    return orig_func_name + std::to_string(manager->GetNextUniqueFuncId());
+  }
   return orig_func_name + std::to_string(unique_counter_++);
 }
@@ -10,15 +10,24 @@
 //
 //---------------------------------------------------------------------------
 #include <assert.h>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
 #include <iosfwd>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <string>
+#include <system_error>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "codegen/codegen_interface.h"
 #include "codegen/codegen_manager.h"
+#include "codegen/codegen_module_cache.h"
 #include "codegen/codegen_wrapper.h"
 #include "codegen/utils/codegen_utils.h"
 #include "codegen/utils/gp_codegen_utils.h"
@@ -29,12 +38,75 @@ extern "C" {
 }
 
 using gpcodegen::CodegenManager;
+using gpcodegen::CodegenModuleCache;
 
-CodegenManager::CodegenManager(const std::string& module_name) {
+namespace {
+
+// Number of modules of this process being compiled in the background, see
+// CodegenManager::WaitForBackgroundCompilations().
+std::mutex background_compilations_mutex;
+std::condition_variable background_compilations_done;
+int background_compilations = 0;
+
+// Cost model of generated code, in microseconds. Compiling a module costs a
+// fixed amount, for setting up the ExecutionEngine and loading the machine
+// code (codegen_compile_fixed_cost), plus an amount per IR instruction that
+// grows with the optimization level. In return, every row processed saves an
+// amount per instruction over the regular functions, which also grows with
+// the optimization level. The amounts per instruction are set for the
+// default level by codegen_compile_instruction_cost and
+// codegen_instruction_saving, and the other levels are scaled from them.
+// The defaults are rough guesses rather than measurements, which is why
+// codegen_cost_based_enrollment is off by default.
+//
+// With codegen_async_compile, the executor doesn't wait for the compilation,
+// but the rows it processes meanwhile save nothing. As long as the generated
+// code is faster than the regular functions, those rows cost less than the
+// compilation would, so the model counts the whole compilation as an upper
+// bound.
+struct OptimizationLevelCost {
+  const char* name;
+  double compile_cost_factor;
+  double saving_factor;
+};
+
+// Indexed by codegen_optimization_level
+const OptimizationLevelCost kOptimizationLevelCosts[] = {
+  {"none", 0.25, 0.57},
+  {"less", 0.5, 0.86},
+  {"default", 1.0, 1.0},
+  {"aggressive", 2.0, 1.14},
+};
+
+double CompileCostPerInstruction(const OptimizationLevelCost& cost) {
+  return cost.compile_cost_factor * codegen_compile_instruction_cost;
+}
+
+double SavingPerInstructionAndRow(const OptimizationLevelCost& cost) {
+  return cost.saving_factor * codegen_instruction_saving;
+}
+
+}  // namespace
+
+CodegenManager::CodegenManager(const std::string& module_name,
+                               double plan_rows)
+    : unique_func_counter_(0),
+      plan_rows_(plan_rows),
+      optimization_level_(codegen_optimization_level),
+      skip_compilation_(false),
+      compilation_status_(false),
+      compilation_done_(false) {
   module_name_ = module_name;
   codegen_utils_.reset(new gpcodegen::GpCodegenUtils(module_name));
 }
 
+CodegenManager::~CodegenManager() {
+  // The compilation thread uses codegen_utils_
+  if (compilation_thread_.joinable()) {
+    compilation_thread_.join();
+  }
+}
+
 bool CodegenManager::EnrollCodeGenerator(
     CodegenFuncLifespan funcLifespan, CodegenInterface* generator) {
   // Only CodegenFuncLifespan_Parameter_Invariant is supported as of now
@@ -57,14 +129,77 @@ unsigned int CodegenManager::GenerateCode() {
       enrolled_code_generators_) {
     success_count += generator->GenerateCode(codegen_utils_.get());
   }
+  ChooseOptimizationLevel();
   return success_count;
 }
 
+bool CodegenManager::MayBreakEven() const {
+  if (!codegen_cost_based_enrollment || plan_rows_ < 0) {
+    return true;
+  }
+  // However large the module, the saving per instruction over all the rows
+  // has to exceed the compilation cost per instruction
+  for (int level = CODEGEN_OPTIMIZATION_LEVEL_NONE;
+       level <= codegen_optimization_level; ++level) {
+    const OptimizationLevelCost& cost = kOptimizationLevelCosts[level];
+    if (plan_rows_ * SavingPerInstructionAndRow(cost) >
+        CompileCostPerInstruction(cost)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void CodegenManager::ChooseOptimizationLevel() {
+  optimization_level_ = codegen_optimization_level;
+  skip_compilation_ = false;
+  if (!codegen_cost_based_enrollment || plan_rows_ < 0) {
+    codegen_decision_ = std::string("optimization level ") +
+        kOptimizationLevelCosts[optimization_level_].name;
+    return;
+  }
+
+  size_t instructions = 0;
+  for (const llvm::Function& function : *codegen_utils_->module()) {
+    for (const llvm::BasicBlock& block : function) {
+      instructions += block.size();
+    }
+  }
+
+  // Pick the level with the largest net saving, up to the level allowed by
+  // codegen_optimization_level
+  double best_saving = 0;
+  skip_compilation_ = true;
+  for (int level = CODEGEN_OPTIMIZATION_LEVEL_NONE;
+       level <= codegen_optimization_level; ++level) {
+    const OptimizationLevelCost& cost = kOptimizationLevelCosts[level];
+    double saving =
+        plan_rows_ * instructions * SavingPerInstructionAndRow(cost) -
+        (codegen_compile_fixed_cost +
+         instructions * CompileCostPerInstruction(cost));
+    if (saving > best_saving) {
+      best_saving = saving;
+      optimization_level_ = level;
+      skip_compilation_ = false;
+    }
+  }
+
+  std::string estimate = std::to_string(static_cast<int64_t>(plan_rows_)) +
+      " estimated rows, " + std::to_string(instructions) + " instructions";
+  if (skip_compilation_) {
+    codegen_decision_ = "not compiled: " + estimate + " do not pay off";
+  } else {
+    codegen_decision_ = std::string("optimization level ") +
+        kOptimizationLevelCosts[optimization_level_].name + ": " + estimate;
+  }
+}
+
 unsigned int CodegenManager::PrepareGeneratedFunctions() {
   unsigned int success_count = 0;
 
-  // If no generator registered, just return with success count as 0
-  if (enrolled_code_generators_.empty()) {
+  // If no generator registered, or compiling is not worth it, just return
+  // with success count as 0
+  if (enrolled_code_generators_.empty() || skip_compilation_) {
     return success_count;
   }
 
@@ -77,17 +212,56 @@ unsigned int CodegenManager::PrepareGeneratedFunctions() {
   STATIC_ASSERT_OPTIMIZATION_LEVEL(kAggressive,
                                    CODEGEN_OPTIMIZATION_LEVEL_AGGRESSIVE);
 
+  // Reuse the object code of an identical module compiled before if there is
+  // one
+  llvm::ObjectCache* object_cache =
+      codegen_module_cache_size > 0 ? CodegenModuleCache::GetInstance()
+                                    : nullptr;
+
+  // The callers keep using the regular functions until the background
+  // compilation is done, see SwapCompiledFunctions()
+  if (codegen_async_compile &&
+      StartBackgroundCompilation(optimization_level_, object_cache)) {
+    return success_count;
+  }
+
   // Call GpCodegenUtils to compile entire module
   bool compilation_status = codegen_utils_->PrepareForExecution(
-      gpcodegen::GpCodegenUtils::OptimizationLevel(codegen_optimization_level),
-      true);
+      gpcodegen::GpCodegenUtils::OptimizationLevel(optimization_level_),
+      true,
+      object_cache);
 
   if (!compilation_status) {
     return success_count;
   }
 
+  return SetGeneratorsToGenerated();
+}
+
+unsigned int CodegenManager::SwapCompiledFunctions() {
+  if (!compilation_thread_.joinable() ||
+      !compilation_done_.load(std::memory_order_acquire)) {
+    return 0;
+  }
+  compilation_thread_.join();
+
+  if (!compilation_status_) {
+    return 0;
+  }
+  return SetGeneratorsToGenerated();
+}
+
+void CodegenManager::WaitForBackgroundCompilations() {
+  std::unique_lock<std::mutex> lock(background_compilations_mutex);
+  background_compilations_done.wait(lock, [] {
+    return background_compilations == 0;
+  });
+}
+
+unsigned int CodegenManager::SetGeneratorsToGenerated() {
   // On successful compilation, go through all generator and swap
   // the pointer so compiled function get called
+  unsigned int success_count = 0;
   gpcodegen::GpCodegenUtils* codegen_utils = codegen_utils_.get();
   for (std::unique_ptr<CodegenInterface>& generator :
       enrolled_code_generators_) {
@@ -96,6 +270,47 @@ unsigned int CodegenManager::PrepareGeneratedFunctions() {
   return success_count;
 }
 
+bool CodegenManager::StartBackgroundCompilation(
+    int optimization_level, llvm::ObjectCache* object_cache) {
+  {
+    std::lock_guard<std::mutex> guard(background_compilations_mutex);
+    background_compilations++;
+  }
+  try {
+    compilation_thread_ = std::thread(&CodegenManager::CompileInBackground,
+                                      this, optimization_level, object_cache);
+  } catch (const std::system_error&) {
+    // Out of threads, so compile in the foreground instead
+    std::lock_guard<std::mutex> guard(background_compilations_mutex);
+    background_compilations--;
+    background_compilations_done.notify_all();
+    return false;
+  }
+  return true;
+}
+
+void CodegenManager::CompileInBackground(int optimization_level,
+                                         llvm::ObjectCache* object_cache) {
+  // Leave signal handling to the main thread of the backend
+  gp_set_thread_sigmasks();
+
+  // Compile everything here, so that SwapCompiledFunctions() only has to
+  // look up the addresses of the compiled functions. This touches nothing but
+  // codegen_utils_, which the main thread leaves alone until
+  // compilation_done_ is set.
+  compilation_status_ =
+      codegen_utils_->PrepareForExecution(
+          gpcodegen::GpCodegenUtils::OptimizationLevel(optimization_level),
+          true,
+          object_cache) &&
+      codegen_utils_->CompileModules();
+  compilation_done_.store(true, std::memory_order_release);
+
+  std::lock_guard<std::mutex> guard(background_compilations_mutex);
+  background_compilations--;
+  background_compilations_done.notify_all();
+}
+
 void CodegenManager::NotifyParameterChange() {
   // no support for parameter change yet
   assert(false);
@@ -112,11 +327,11 @@ const std::string& CodegenManager::GetExplainString() {
 }
 
 void CodegenManager::AccumulateExplainString() {
-  explain_string_.clear();
+  explain_string_ = "==== CODEGEN DECISION ====\n" + codegen_decision_ + "\n";
   // This is called only when EXPLAIN CODEGEN. Because we don't want to compile
   // at this time, we need to call CodegenUtils::Optimize to "optimize" LLVM IR.
   codegen_utils_->Optimize(gpcodegen::CodegenUtils::OptimizationLevel(
-                               codegen_optimization_level),
+                               optimization_level_),
                            gpcodegen::CodegenUtils::SizeLevel::kNormal,
                            false);
   llvm::raw_string_ostream out(explain_string_);
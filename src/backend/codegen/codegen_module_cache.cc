@@ -0,0 +1,112 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    codegen_module_cache.cc
+//
+//  @doc:
+//    Implementation of the cache of the machine code of compiled modules
+//
+//---------------------------------------------------------------------------
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "codegen/codegen_config.h"
+#include "codegen/codegen_module_cache.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "utils/guc.h"
+}
+
+using gpcodegen::CodegenModuleCache;
+
+CodegenModuleCache* CodegenModuleCache::GetInstance() {
+  static CodegenModuleCache instance;
+  return &instance;
+}
+
+CodegenModuleCache::CodegenModuleCache()
+    : size_in_bytes_(0),
+      hits_(0),
+      misses_(0),
+      evictions_(0) {
+}
+
+std::string CodegenModuleCache::GetKey(const llvm::Module* module) {
+  std::string ir;
+  llvm::raw_string_ostream out(ir);
+  module->print(out, nullptr);
+  out.flush();
+
+  // The first line of the IR is "; ModuleID = '<module name>'"
+  size_t body = ir.find('\n');
+  return body == std::string::npos ? ir : ir.substr(body + 1);
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CodegenModuleCache::getObject(
+    const llvm::Module* module) {
+  std::string key = GetKey(module);
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    misses_++;
+    pending_keys_[module] = std::move(key);
+    return nullptr;
+  }
+
+  hits_++;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return llvm::MemoryBuffer::getMemBufferCopy(
+      it->second->object->getBuffer(),
+      it->second->object->getBufferIdentifier());
+}
+
+void CodegenModuleCache::notifyObjectCompiled(const llvm::Module* module,
+                                              llvm::MemoryBufferRef object) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto pending = pending_keys_.find(module);
+  if (pending == pending_keys_.end()) {
+    return;
+  }
+  std::string key = std::move(pending->second);
+  pending_keys_.erase(pending);
+
+  if (codegen_module_cache_size <= 0 || index_.find(key) != index_.end()) {
+    return;
+  }
+
+  Entry entry;
+  entry.key = std::move(key);
+  entry.object = llvm::MemoryBuffer::getMemBufferCopy(
+      object.getBuffer(), object.getBufferIdentifier());
+  size_in_bytes_ += entry.key.size() + entry.object->getBufferSize();
+  entries_.push_front(std::move(entry));
+  index_[entries_.front().key] = entries_.begin();
+
+  Shrink();
+}
+
+void CodegenModuleCache::Shrink() {
+  const size_t max_size =
+      static_cast<size_t>(std::max(codegen_module_cache_size, 0)) * 1024L;
+  while (!entries_.empty() && size_in_bytes_ > max_size) {
+    Entry& victim = entries_.back();
+    size_in_bytes_ -= victim.key.size() + victim.object->getBufferSize();
+    index_.erase(victim.key);
+    entries_.pop_back();
+    evictions_++;
+  }
+}
+
+void CodegenModuleCache::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  index_.clear();
+  entries_.clear();
+  size_in_bytes_ = 0;
+}
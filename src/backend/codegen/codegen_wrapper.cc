@@ -13,43 +13,79 @@
 #include "codegen/codegen_wrapper.h"
 
 #include <assert.h>
+#include <algorithm>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "codegen/codegen_config.h"
 #include "codegen/base_codegen.h"
 #include "codegen/codegen_manager.h"
+#include "codegen/codegen_module_cache.h"
 #include "codegen/exec_eval_expr_codegen.h"
 #include "codegen/exec_variable_list_codegen.h"
 #include "codegen/expr_tree_generator.h"
 #include "codegen/utils/gp_codegen_utils.h"
 #include "codegen/advance_aggregates_codegen.h"
+#include "codegen/calc_hash_value_codegen.h"
+#include "codegen/match_agg_hash_entry_codegen.h"
+#include "codegen/exec_hash_get_hash_value_codegen.h"
 
 extern "C" {
 #include "lib/stringinfo.h"
 #include "postgres.h"  // NOLINT(build/include)
+#include "storage/ipc.h"
 }
 
 using gpcodegen::CodegenManager;
+using gpcodegen::CodegenModuleCache;
 using gpcodegen::BaseCodegen;
 using gpcodegen::ExecVariableListCodegen;
 using gpcodegen::ExecEvalExprCodegen;
 using gpcodegen::AdvanceAggregatesCodegen;
+using gpcodegen::ExecHashGetHashValueCodegen;
+using gpcodegen::CalcHashValueCodegen;
+using gpcodegen::MatchAggHashEntryCodegen;
 
 // Current code generator manager that oversees all code generators
 static void* ActiveCodeGeneratorManager = nullptr;
 
+// Managers destroyed while their module was still compiling in the
+// background. They are deleted once the compilation is done, so that ending a
+// plan node never waits for LLVM.
+static std::vector<CodegenManager*> RetiredCodeGeneratorManagers;
+
+static void DeleteRetiredCodeGeneratorManagers() {
+  auto compiling_end = std::partition(
+      RetiredCodeGeneratorManagers.begin(),
+      RetiredCodeGeneratorManagers.end(),
+      [](CodegenManager* manager) { return manager->IsCompiling(); });
+  for (auto it = compiling_end; it != RetiredCodeGeneratorManagers.end();
+      ++it) {
+    delete *it;
+  }
+  RetiredCodeGeneratorManagers.erase(compiling_end,
+                                     RetiredCodeGeneratorManagers.end());
+}
+
+// Background compilations must not outlive the process' global objects.
+static void WaitForBackgroundCompilations(int code, Datum arg) {
+  CodegenManager::WaitForBackgroundCompilations();
+}
+
 // Perform global set-up tasks for code generation. Returns 0 on
 // success, nonzero on error.
 unsigned int InitCodegen() {
+  on_proc_exit(WaitForBackgroundCompilations, 0);
   return gpcodegen::GpCodegenUtils::InitializeGlobal();
 }
 
-void* CodeGeneratorManagerCreate(const char* module_name) {
+void* CodeGeneratorManagerCreate(const char* module_name, double plan_rows) {
   if (!codegen) {
     return nullptr;
   }
-  return new CodegenManager(module_name);
+  DeleteRetiredCodeGeneratorManagers();
+  return new CodegenManager(module_name, plan_rows);
 }
 
 unsigned int CodeGeneratorManagerGenerateCode(void* manager) {
@@ -66,6 +102,13 @@ unsigned int CodeGeneratorManagerPrepareGeneratedFunctions(void* manager) {
   return static_cast<CodegenManager*>(manager)->PrepareGeneratedFunctions();
 }
 
+unsigned int CodeGeneratorManagerSwapCompiledFunctions(void* manager) {
+  if (!codegen || nullptr == manager) {
+    return 0;
+  }
+  return static_cast<CodegenManager*>(manager)->SwapCompiledFunctions();
+}
+
 unsigned int CodeGeneratorManagerNotifyParameterChange(void* manager) {
   // parameter change notification is not supported yet
   assert(false);
@@ -92,7 +135,14 @@ char* CodeGeneratorManagerGetExplainString(void* manager) {
 }
 
 void CodeGeneratorManagerDestroy(void* manager) {
-  delete (static_cast<CodegenManager*>(manager));
+  CodegenManager* codegen_manager = static_cast<CodegenManager*>(manager);
+  if (nullptr != codegen_manager && codegen_manager->IsCompiling()) {
+    // The generators refer to the plan node, so they go now
+    codegen_manager->DestroyGenerators();
+    RetiredCodeGeneratorManagers.push_back(codegen_manager);
+    return;
+  }
+  delete codegen_manager;
 }
 
 void* GetActiveCodeGeneratorManager() {
@@ -103,6 +153,20 @@ void SetActiveCodeGeneratorManager(void* manager) {
   ActiveCodeGeneratorManager = manager;
 }
 
+char* CodegenModuleCacheStats() {
+  CodegenModuleCache* cache = CodegenModuleCache::GetInstance();
+  std::string stats =
+      "hits: " + std::to_string(cache->hits()) +
+      ", misses: " + std::to_string(cache->misses()) +
+      ", evictions: " + std::to_string(cache->evictions()) +
+      ", entries: " + std::to_string(cache->entries()) +
+      ", size: " + std::to_string((cache->size_in_bytes() + 1023) / 1024) +
+      " kB";
+  StringInfo return_string = makeStringInfo();
+  appendStringInfoString(return_string, stats.c_str());
+  return return_string->data;
+}
+
 Datum
 slot_getattr_regular(TupleTableSlot *slot, int attnum, bool *isnull) {
   return slot_getattr(slot, attnum, isnull);
@@ -173,3 +237,52 @@ void* AdvanceAggregatesCodegenEnroll(
   return generator;
 }
 
+void* ExecHashGetHashValueCodegenEnroll(
+    ExecHashGetHashValueFn regular_func_ptr,
+    ExecHashGetHashValueFn* ptr_to_chosen_func_ptr,
+    List *hashkeys,
+    List *hashoperators,
+    bool outer_tuple) {
+  CodegenManager* manager = static_cast<CodegenManager*>(
+      GetActiveCodeGeneratorManager());
+  ExecHashGetHashValueCodegen* generator =
+      CodegenManager::CreateAndEnrollGenerator<ExecHashGetHashValueCodegen>(
+          manager,
+          regular_func_ptr,
+          ptr_to_chosen_func_ptr,
+          hashkeys,
+          hashoperators,
+          outer_tuple);
+  return generator;
+}
+
+void* CalcHashValueCodegenEnroll(
+    CalcHashValueFn regular_func_ptr,
+    CalcHashValueFn* ptr_to_chosen_func_ptr,
+    AggState *aggstate) {
+  CodegenManager* manager = static_cast<CodegenManager*>(
+      GetActiveCodeGeneratorManager());
+  CalcHashValueCodegen* generator =
+      CodegenManager::CreateAndEnrollGenerator<CalcHashValueCodegen>(
+          manager,
+          regular_func_ptr,
+          ptr_to_chosen_func_ptr,
+          aggstate);
+  return generator;
+}
+
+void* MatchAggHashEntryCodegenEnroll(
+    MatchAggHashEntryFn regular_func_ptr,
+    MatchAggHashEntryFn* ptr_to_chosen_func_ptr,
+    AggState *aggstate) {
+  CodegenManager* manager = static_cast<CodegenManager*>(
+      GetActiveCodeGeneratorManager());
+  MatchAggHashEntryCodegen* generator =
+      CodegenManager::CreateAndEnrollGenerator<MatchAggHashEntryCodegen>(
+          manager,
+          regular_func_ptr,
+          ptr_to_chosen_func_ptr,
+          aggstate);
+  return generator;
+}
+
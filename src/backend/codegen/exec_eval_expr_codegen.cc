@@ -93,6 +93,11 @@ void ExecEvalExprCodegen::PrepareSlotGetAttr() {
       // generated slot_getattr(). This may not be true always, but calling the
       // regular slot_getattr() will still preserve correctness.
       break;
+    case T_HashJoinState:
+      // The hash clauses compare the current outer tuple with the inner
+      // tuples of a bucket, which are stored in a different slot per batch.
+      // Both are read with the regular slot_getattr().
+      break;
     default:
       elog(DEBUG1,
           "Attempting to generate ExecEvalExpr for an unsupported operator!");
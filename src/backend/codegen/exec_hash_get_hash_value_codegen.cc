@@ -0,0 +1,359 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    exec_hash_get_hash_value_codegen.cc
+//
+//  @doc:
+//    Generates code for ExecHashGetHashValue function.
+//
+//---------------------------------------------------------------------------
+#include <string>
+
+#include "codegen/exec_hash_get_hash_value_codegen.h"
+
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "access/hash.h"
+#include "catalog/pg_type.h"
+#include "executor/hashjoin.h"
+#include "executor/tuptable.h"
+#include "fmgr.h"
+#include "nodes/execnodes.h"
+#include "nodes/nodes.h"
+#include "nodes/pg_list.h"
+#include "nodes/primnodes.h"
+#include "utils/fmgroids.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+}
+
+namespace llvm {
+class BasicBlock;
+class Function;
+class Value;
+}  // namespace llvm
+
+using gpcodegen::ExecHashGetHashValueCodegen;
+
+constexpr char ExecHashGetHashValueCodegen::kExecHashGetHashValuePrefix[];
+
+ExecHashGetHashValueCodegen::ExecHashGetHashValueCodegen(
+    CodegenManager* manager,
+    ExecHashGetHashValueFn regular_func_ptr,
+    ExecHashGetHashValueFn* ptr_to_regular_func_ptr,
+    List *hashkeys,
+    List *hashoperators,
+    bool outer_tuple)
+: BaseCodegen(manager,
+              kExecHashGetHashValuePrefix,
+              regular_func_ptr,
+              ptr_to_regular_func_ptr),
+              hashkeys_(hashkeys),
+              hashoperators_(hashoperators),
+              outer_tuple_(outer_tuple) {
+}
+
+llvm::Value* ExecHashGetHashValueCodegen::GenerateHashKey(
+    gpcodegen::GpCodegenUtils* codegen_utils,
+    Oid hash_func,
+    Oid key_type,
+    llvm::Value* llvm_keyval,
+    llvm::Value* llvm_fmgr_info) {
+  auto irb = codegen_utils->ir_builder();
+  llvm::Function* llvm_hash_uint32 =
+      codegen_utils->GetOrRegisterExternalFunction(hash_uint32,
+                                                   "hash_uint32");
+  llvm::Value* llvm_hkey = nullptr;
+
+  if (F_HASHINT4 == hash_func &&
+      (INT4OID == key_type || DATEOID == key_type)) {
+    // hashint4: hash_uint32(DatumGetInt32(keyval))
+    llvm_hkey = irb->CreateCall(llvm_hash_uint32, {
+        codegen_utils->CreateDatumToCppTypeCast<uint32_t>(llvm_keyval)});
+  } else if (F_HASHINT8 == hash_func && INT8OID == key_type) {
+    // hashint8: xor the high half into the low half, so that logically
+    // equal int4 and int8 values get the same hash.
+    llvm::Value* llvm_val =
+        codegen_utils->CreateDatumToCppTypeCast<int64_t>(llvm_keyval);
+    llvm::Value* llvm_lohalf = irb->CreateTrunc(
+        llvm_val, codegen_utils->GetType<uint32_t>());
+    llvm::Value* llvm_hihalf = irb->CreateTrunc(
+        irb->CreateAShr(llvm_val, 32), codegen_utils->GetType<uint32_t>());
+    // lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+    llvm_lohalf = irb->CreateXor(
+        llvm_lohalf,
+        irb->CreateSelect(
+            irb->CreateICmpSGE(llvm_val,
+                               codegen_utils->GetConstant<int64_t>(0)),
+            llvm_hihalf,
+            irb->CreateNot(llvm_hihalf)));
+    llvm_hkey = irb->CreateCall(llvm_hash_uint32, {llvm_lohalf});
+  } else {
+    // FunctionCall1(&hashfunctions[i], keyval)
+    llvm::Function* llvm_FunctionCall1 =
+        codegen_utils->GetOrRegisterExternalFunction(FunctionCall1,
+                                                     "FunctionCall1");
+    llvm_hkey = irb->CreateCall(llvm_FunctionCall1,
+                                {llvm_fmgr_info, llvm_keyval});
+  }
+
+  // DatumGetUInt32(hkey)
+  return codegen_utils->CreateDatumToCppTypeCast<uint32_t>(llvm_hkey);
+}
+
+bool ExecHashGetHashValueCodegen::GenerateExecHashGetHashValue(
+    gpcodegen::GpCodegenUtils* codegen_utils) {
+
+  assert(NULL != codegen_utils);
+  if (nullptr == hashkeys_ ||
+      list_length(hashkeys_) != list_length(hashoperators_)) {
+    return false;
+  }
+
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::Function* exec_hash_get_hash_value_func =
+      CreateFunction<ExecHashGetHashValueFn>(
+          codegen_utils, GetUniqueFuncName());
+
+  // BasicBlock of function entry.
+  llvm::BasicBlock* entry_block = codegen_utils->CreateBasicBlock(
+      "entry_block", exec_hash_get_hash_value_func);
+  llvm::BasicBlock* implementation_block = codegen_utils->CreateBasicBlock(
+      "implementation_block", exec_hash_get_hash_value_func);
+  llvm::BasicBlock* error_hashkeys_block = codegen_utils->CreateBasicBlock(
+      "error_hashkeys_block", exec_hash_get_hash_value_func);
+
+  // External functions
+  llvm::Function* llvm_slot_getattr =
+      codegen_utils->GetOrRegisterExternalFunction(slot_getattr_regular,
+                                                   "slot_getattr_regular");
+  llvm::Function* llvm_MemoryContextReset =
+      codegen_utils->GetOrRegisterExternalFunction(MemoryContextReset,
+                                                   "MemoryContextReset");
+  llvm::Function* llvm_MemoryContextSwitchTo =
+      codegen_utils->GetOrRegisterExternalFunction(MemoryContextSwitchTo,
+                                                   "MemoryContextSwitchTo");
+
+  // Function arguments to ExecHashGetHashValue
+  llvm::Value* llvm_hashtable_arg = ArgumentByPosition(
+      exec_hash_get_hash_value_func, 1);
+  llvm::Value* llvm_econtext_arg = ArgumentByPosition(
+      exec_hash_get_hash_value_func, 2);
+  llvm::Value* llvm_hashkeys_arg = ArgumentByPosition(
+      exec_hash_get_hash_value_func, 3);
+  llvm::Value* llvm_outer_tuple_arg = ArgumentByPosition(
+      exec_hash_get_hash_value_func, 4);
+  llvm::Value* llvm_keep_nulls_arg = ArgumentByPosition(
+      exec_hash_get_hash_value_func, 5);
+  llvm::Value* llvm_hashvalue_arg = ArgumentByPosition(
+      exec_hash_get_hash_value_func, 6);
+  llvm::Value* llvm_hashkeys_null_arg = ArgumentByPosition(
+      exec_hash_get_hash_value_func, 7);
+
+  // entry block
+  // ----------
+  irb->SetInsertPoint(entry_block);
+
+#ifdef CODEGEN_DEBUG
+  EXPAND_CREATE_ELOG(codegen_utils, DEBUG1,
+                     "Codegen'ed ExecHashGetHashValue called!");
+#endif
+
+  // Compare the hash keys given during code generation and the ones passed
+  // in as an argument to ExecHashGetHashValue
+  irb->CreateCondBr(
+      irb->CreateAnd(
+          irb->CreateICmpEQ(codegen_utils->GetConstant(hashkeys_),
+                            llvm_hashkeys_arg),
+          irb->CreateICmpEQ(codegen_utils->GetConstant<bool>(outer_tuple_),
+                            llvm_outer_tuple_arg)),
+      implementation_block /* true */,
+      error_hashkeys_block /* false */);
+
+  // implementation block
+  // ----------
+  irb->SetInsertPoint(implementation_block);
+
+  // *hashkeys_null = true;
+  irb->CreateStore(codegen_utils->GetConstant<bool>(true),
+                   llvm_hashkeys_null_arg);
+
+  // ResetExprContext(econtext);
+  // oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+  llvm::Value* llvm_per_tuple_memory = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(
+          llvm_econtext_arg, &ExprContext::ecxt_per_tuple_memory));
+  irb->CreateCall(llvm_MemoryContextReset, {llvm_per_tuple_memory});
+  llvm::Value* llvm_oldContext = irb->CreateCall(llvm_MemoryContextSwitchTo,
+                                                 {llvm_per_tuple_memory});
+
+  // hashfunctions = outer_tuple ? hashtable->outer_hashfunctions :
+  //                               hashtable->inner_hashfunctions;
+  llvm::Value* llvm_hashfunctions = irb->CreateLoad(
+      codegen_utils->GetPointerToMember(
+          llvm_hashtable_arg,
+          outer_tuple_ ? &HashJoinTableData::outer_hashfunctions :
+              &HashJoinTableData::inner_hashfunctions));
+
+  llvm::Value* llvm_hashkey_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<uint32_t>(), nullptr, "hashkey");
+  irb->CreateStore(codegen_utils->GetConstant<uint32_t>(0), llvm_hashkey_ptr);
+  llvm::Value* llvm_result_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "result");
+  irb->CreateStore(codegen_utils->GetConstant<bool>(true), llvm_result_ptr);
+  llvm::Value* llvm_isnull_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "isNull");
+
+  int i = 0;
+  ListCell *hk;
+  ListCell *ho;
+  forboth(hk, hashkeys_, ho, hashoperators_) {
+    ExprState *keyexpr = static_cast<ExprState*>(lfirst(hk));
+    Oid hashop = lfirst_oid(ho);
+    Oid left_hashfn;
+    Oid right_hashfn;
+
+    if (nullptr == keyexpr->expr || T_Var != nodeTag(keyexpr->expr)) {
+      elog(DEBUG1, "We only codegen hash keys that are plain columns");
+      return false;
+    }
+    if (!get_op_hash_functions(hashop, &left_hashfn, &right_hashfn)) {
+      elog(DEBUG1, "Could not find hash function for hash operator %u",
+           hashop);
+      return false;
+    }
+    Var *var = reinterpret_cast<Var*>(keyexpr->expr);
+    if (var->varattno <= 0) {
+      elog(DEBUG1, "We don't codegen hash keys on system columns");
+      return false;
+    }
+
+    llvm::BasicBlock* null_key_block = codegen_utils->CreateBasicBlock(
+        "null_key_block_" + std::to_string(i), exec_hash_get_hash_value_func);
+    llvm::BasicBlock* not_null_key_block = codegen_utils->CreateBasicBlock(
+        "not_null_key_block_" + std::to_string(i),
+        exec_hash_get_hash_value_func);
+    llvm::BasicBlock* hash_key_block = codegen_utils->CreateBasicBlock(
+        "hash_key_block_" + std::to_string(i), exec_hash_get_hash_value_func);
+    llvm::BasicBlock* next_key_block = codegen_utils->CreateBasicBlock(
+        "next_key_block_" + std::to_string(i), exec_hash_get_hash_value_func);
+
+    // hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+    llvm::Value* llvm_hashkey = irb->CreateLoad(llvm_hashkey_ptr);
+    irb->CreateStore(
+        irb->CreateOr(irb->CreateShl(llvm_hashkey, 1),
+                      irb->CreateLShr(llvm_hashkey, 31)),
+        llvm_hashkey_ptr);
+
+    // keyval = ExecEvalExpr(keyexpr, econtext, &isNull, NULL); {{{
+    // The slot is loaded at execution time, since it changes per tuple.
+    TupleTableSlot* ExprContext::* slot_member = nullptr;
+    switch (var->varno) {
+      case INNER:  /* get the tuple from the inner node */
+        slot_member = &ExprContext::ecxt_innertuple;
+        break;
+
+      case OUTER:  /* get the tuple from the outer node */
+        slot_member = &ExprContext::ecxt_outertuple;
+        break;
+
+      default:     /* get the tuple from the relation being scanned */
+        slot_member = &ExprContext::ecxt_scantuple;
+        break;
+    }
+    llvm::Value* llvm_slot = irb->CreateLoad(
+        codegen_utils->GetPointerToMember(llvm_econtext_arg, slot_member));
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false), llvm_isnull_ptr);
+    llvm::Value* llvm_keyval = irb->CreateCall(llvm_slot_getattr, {
+        llvm_slot,
+        codegen_utils->GetConstant<int32_t>(var->varattno),
+        llvm_isnull_ptr});
+    // }}}
+    irb->CreateCondBr(irb->CreateLoad(llvm_isnull_ptr),
+                      null_key_block /* true */,
+                      not_null_key_block /* false */);
+
+    // null_key_block
+    // --------------
+    // If the join operator is strict, the tuple cannot match unless we keep
+    // nulls; otherwise we act like the hashcode of NULL is zero.
+    irb->SetInsertPoint(null_key_block);
+    if (op_strict(hashop)) {
+      // if (!keep_nulls) result = false;
+      irb->CreateStore(irb->CreateAnd(irb->CreateLoad(llvm_result_ptr),
+                                      llvm_keep_nulls_arg),
+                       llvm_result_ptr);
+    }
+    irb->CreateBr(next_key_block);
+
+    // not_null_key_block
+    // ------------------
+    irb->SetInsertPoint(not_null_key_block);
+    // *hashkeys_null = false;
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                     llvm_hashkeys_null_arg);
+    irb->CreateCondBr(irb->CreateLoad(llvm_result_ptr),
+                      hash_key_block /* true */,
+                      next_key_block /* false */);
+
+    // hash_key_block
+    // --------------
+    // hashkey ^= hkey;
+    irb->SetInsertPoint(hash_key_block);
+    llvm::Value* llvm_fmgr_info = irb->CreateGEP(
+        llvm_hashfunctions,
+        {codegen_utils->GetConstant(sizeof(FmgrInfo) * i)});
+    llvm::Value* llvm_hkey = GenerateHashKey(
+        codegen_utils,
+        outer_tuple_ ? left_hashfn : right_hashfn,
+        var->vartype,
+        llvm_keyval,
+        llvm_fmgr_info);
+    irb->CreateStore(irb->CreateXor(irb->CreateLoad(llvm_hashkey_ptr),
+                                    llvm_hkey),
+                     llvm_hashkey_ptr);
+    irb->CreateBr(next_key_block);
+
+    // next_key_block
+    // --------------
+    irb->SetInsertPoint(next_key_block);
+    i++;
+  }
+
+  // MemoryContextSwitchTo(oldContext);
+  irb->CreateCall(llvm_MemoryContextSwitchTo, {llvm_oldContext});
+  // *hashvalue = hashkey;
+  irb->CreateStore(irb->CreateLoad(llvm_hashkey_ptr), llvm_hashvalue_arg);
+  irb->CreateRet(irb->CreateLoad(llvm_result_ptr));
+
+  // Error hashkeys block
+  // ---------------
+  irb->SetInsertPoint(error_hashkeys_block);
+
+  EXPAND_CREATE_ELOG(codegen_utils, ERROR, "Codegened ExecHashGetHashValue: "
+                     "use of different hash keys.");
+
+  irb->CreateRet(codegen_utils->GetConstant<bool>(false));
+
+  return true;
+}
+
+
+bool ExecHashGetHashValueCodegen::GenerateCodeInternal(
+    GpCodegenUtils* codegen_utils) {
+  bool isGenerated = GenerateExecHashGetHashValue(codegen_utils);
+
+  if (isGenerated) {
+    elog(DEBUG1, "ExecHashGetHashValue was generated successfully!");
+    return true;
+  } else {
+    elog(DEBUG1, "ExecHashGetHashValue generation failed!");
+    return false;
+  }
+}
@@ -21,11 +21,19 @@ extern bool codegen_exec_variable_list;
 extern bool codegen_slot_getattr;
 extern bool codegen_exec_eval_expr;
 extern bool codegen_advance_aggregate;
+extern bool codegen_exec_hash_get_hash_value;
+extern bool codegen_agg_hash_lookup;
+extern bool codegen_async_compile;
+extern bool codegen_cost_based_enrollment;
+extern double codegen_compile_fixed_cost;
+extern double codegen_compile_instruction_cost;
+extern double codegen_instruction_saving;
 // TODO(shardikar): Retire this GUC after performing experiments to find the
 // tradeoff of codegen-ing slot_getattr() (potentially by measuring the
 // difference in the number of instructions) when one of the first few
 // attributes is varlen.
 extern int codegen_varlen_tolerance;
+extern int codegen_module_cache_size;
 }
 
 namespace gpcodegen {
@@ -39,6 +47,9 @@ class ExecVariableListCodegen;
 class SlotGetAttrCodegen;
 class ExecEvalExprCodegen;
 class AdvanceAggregatesCodegen;
+class ExecHashGetHashValueCodegen;
+class CalcHashValueCodegen;
+class MatchAggHashEntryCodegen;
 
 class CodegenConfig {
  public:
@@ -73,6 +84,21 @@ inline bool CodegenConfig::IsGeneratorEnabled<AdvanceAggregatesCodegen>() {
   return codegen_advance_aggregate;
 }
 
+template<>
+inline bool CodegenConfig::IsGeneratorEnabled<ExecHashGetHashValueCodegen>() {
+  return codegen_exec_hash_get_hash_value;
+}
+
+template<>
+inline bool CodegenConfig::IsGeneratorEnabled<CalcHashValueCodegen>() {
+  return codegen_agg_hash_lookup;
+}
+
+template<>
+inline bool CodegenConfig::IsGeneratorEnabled<MatchAggHashEntryCodegen>() {
+  return codegen_agg_hash_lookup;
+}
+
 
 /** @} */
 
@@ -23,6 +23,7 @@ namespace gpcodegen {
 
 // Forward declaration
 class GpCodegenUtils;
+class CodegenManager;
 
 /**
  * @brief Interface for all code generators.
@@ -97,14 +98,21 @@ class CodegenInterface {
    * @brief	Utility function to construct a unique function name from the
    * 			original function name by appending a numeric suffix.
    *
+   * @note 	Names are unique within the module of a manager, so that the
+   * 			modules generated for the same plan node on every execution are
+   * 			identical and can share compiled code.
+   *
    * @param orig_func_name	Function name that needs to be made unique.
+   * @param manager	Manager of the generator, or nullptr to make the name
+   * 			unique within the process.
    * @return 	Unique string for given input string.
    *
    **/
-  static std::string GenerateUniqueName(const std::string& orig_func_name);
+  static std::string GenerateUniqueName(const std::string& orig_func_name,
+                                        CodegenManager* manager);
 
  private:
-  // Unique counter for all instances of Codegen Interface.
+  // Unique counter for instances of Codegen Interface without a manager.
   static unsigned unique_counter_;
 };
 
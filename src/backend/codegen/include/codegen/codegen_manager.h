@@ -13,7 +13,9 @@
 #ifndef GPCODEGEN_CODEGEN_MANAGER_H_  // NOLINT(build/header_guard)
 #define GPCODEGEN_CODEGEN_MANAGER_H_
 
+#include <atomic>  // NOLINT(build/c++11)
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 #include <string>
 
@@ -22,6 +24,10 @@
 #include "codegen/codegen_interface.h"
 #include "codegen/base_codegen.h"
 
+namespace llvm {
+class ObjectCache;
+}  // namespace llvm
+
 namespace gpcodegen {
 /** \addtogroup gpcodegen
  *  @{
@@ -43,10 +49,17 @@ class CodegenManager {
    *
    * @param module_name A human-readable name for the module that this
    *        CodegenManager will manage.
+   * @param plan_rows Planner estimate of the number of rows the plan node
+   *        processes, or a negative value if it is not known.
    **/
-  explicit CodegenManager(const std::string& module_name);
+  explicit CodegenManager(const std::string& module_name,
+                          double plan_rows = -1);
 
-  ~CodegenManager() = default;
+  /**
+   * @brief Destructor. Waits for the background compilation of the module, if
+   *        there is one in progress.
+   **/
+  ~CodegenManager();
 
   /**
    * @brief Template function to facilitate enroll for any type of
@@ -66,8 +79,9 @@ class CodegenManager {
    * This function creates a new code generator object of type ClassType using
    * the passed-in args, and enrolls it in the given codegen manager.
    *
-   * It does not create a generator when codegen or manager is unset, or the
-   * code generator ClassType is disabled (with the appropriate GUC).
+   * It does not create a generator when codegen or manager is unset, the
+   * code generator ClassType is disabled (with the appropriate GUC), or the
+   * plan node processes too few rows for generated code to pay off.
    * It always initializes the given double function pointer
    * (ptr_to_chosen_func_ptr) to the regular_func_ptr.
    *
@@ -90,7 +104,9 @@ class CodegenManager {
         (nullptr != manager) &&
         codegen &&  // if codegen guc is false
         // if generator is disabled
-        CodegenConfig::IsGeneratorEnabled<ClassType>();
+        CodegenConfig::IsGeneratorEnabled<ClassType>() &&
+        // if too few rows to make up for the compilation
+        manager->MayBreakEven();
     if (!can_enroll) {
       gpcodegen::BaseCodegen<FuncType>::SetToRegular(
           regular_func_ptr, ptr_to_chosen_func_ptr);
@@ -132,11 +148,49 @@ class CodegenManager {
    * @brief Compile all the generated functions. On success,
    *        a pointer to the generated method becomes available to the caller.
    *
+   * @note With codegen_async_compile, the module is compiled on a background
+   *       thread instead, and the callers keep using the regular functions
+   *       until SwapCompiledFunctions() finds the compilation done.
+   *
    * @return The number of enrolled codegen that successully generated code
-   *         and 0 on failure
+   *         and 0 on failure or if the module is compiled in the background
    **/
   unsigned int PrepareGeneratedFunctions();
 
+  /**
+   * @brief Make the callers use the generated functions once their background
+   *        compilation is done.
+   *
+   * @note This is called by the executor before each call to the plan node,
+   *       so the function pointers only change between calls, on the thread
+   *       that calls them.
+   *
+   * @return The number of function pointers swapped by this call.
+   **/
+  unsigned int SwapCompiledFunctions();
+
+  /**
+   * @return true while the module is being compiled in the background.
+   **/
+  bool IsCompiling() const {
+    return compilation_thread_.joinable() &&
+        !compilation_done_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Destroy all enrolled generators, which reverts their callers to the
+   *        regular functions.
+   **/
+  void DestroyGenerators() {
+    enrolled_code_generators_.clear();
+  }
+
+  /**
+   * @brief Wait for the background compilations of all the managers of this
+   *        process to finish.
+   **/
+  static void WaitForBackgroundCompilations();
+
   /**
    * @brief 	Notifies the manager of a parameter change.
    *
@@ -154,6 +208,12 @@ class CodegenManager {
    **/
   bool InvalidateGeneratedFunctions();
 
+  /**
+   * @return false if the plan node processes too few rows for any generated
+   *         code to make up for the cost of compiling it.
+   **/
+  bool MayBreakEven() const;
+
   /**
    * @return Number of enrolled generators.
    **/
@@ -161,6 +221,14 @@ class CodegenManager {
     return enrolled_code_generators_.size();
   }
 
+  /**
+   * @return Suffix that makes the name of a generated function unique within
+   *         the module of this manager.
+   **/
+  unsigned int GetNextUniqueFuncId() {
+    return unique_func_counter_++;
+  }
+
   /*
    * @brief Accumulate the explain string with a dump of all the underlying LLVM
    *        modules
@@ -173,6 +241,24 @@ class CodegenManager {
   const std::string& GetExplainString();
 
  private:
+  // Swap the function pointers of all the generators to the compiled
+  // functions.
+  unsigned int SetGeneratorsToGenerated();
+
+  // Start compiling the module on compilation_thread_. Returns false if no
+  // thread could be started.
+  bool StartBackgroundCompilation(int optimization_level,
+                                  llvm::ObjectCache* object_cache);
+
+  // Body of compilation_thread_.
+  void CompileInBackground(int optimization_level,
+                           llvm::ObjectCache* object_cache);
+
+  // Weigh the cost of compiling the generated code against what it saves
+  // over plan_rows_, and set optimization_level_ to the most profitable
+  // level, or skip_compilation_ if no level pays off.
+  void ChooseOptimizationLevel();
+
   // GpCodegenUtils provides a facade to LLVM subsystem.
   std::unique_ptr<gpcodegen::GpCodegenUtils> codegen_utils_;
 
@@ -184,6 +270,27 @@ class CodegenManager {
   // Holds the dumped IR of all underlying modules for EXPLAIN CODEGEN queries
   std::string explain_string_;
 
+  // Counter for the unique names of the generated functions
+  unsigned int unique_func_counter_;
+
+  // Planner estimate of the rows processed by the plan node, negative if
+  // unknown
+  double plan_rows_;
+
+  // Optimization level chosen for the module, and whether compiling it is
+  // not worth it at all
+  int optimization_level_;
+  bool skip_compilation_;
+
+  // Explanation of the above choice for EXPLAIN CODEGEN
+  std::string codegen_decision_;
+
+  // Thread compiling the module in the background, the result of the
+  // compilation and whether it is done.
+  std::thread compilation_thread_;
+  bool compilation_status_;
+  std::atomic<bool> compilation_done_;
+
   DISALLOW_COPY_AND_ASSIGN(CodegenManager);
 };
 
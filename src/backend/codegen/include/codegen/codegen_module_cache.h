@@ -0,0 +1,169 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    codegen_module_cache.h
+//
+//  @doc:
+//    Cache of the machine code of compiled modules
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_CODEGEN_MODULE_CACHE_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_CODEGEN_MODULE_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <unordered_map>
+
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "codegen/utils/macros.h"
+
+namespace llvm {
+class Module;
+}  // namespace llvm
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+/**
+ * @brief Object cache that keeps the machine code of the modules compiled in
+ *        this process, so that executing the same plan again skips the
+ *        optimization and compilation of its module.
+ *
+ * Modules are looked up by their IR, together with the optimization level
+ * they are compiled with. The generated code refers to runtime addresses
+ * only through external globals, which the ExecutionEngine maps anew for
+ * each execution, so the same machine code is valid for every execution
+ * that generates the same IR.
+ *
+ * The size of the cache is bounded by the codegen_module_cache_size GUC;
+ * the least recently used modules are evicted first.
+ *
+ * Modules compiled in the background (see codegen_async_compile) use the
+ * cache from their compilation threads, so all accesses are serialized.
+ **/
+class CodegenModuleCache : public llvm::ObjectCache {
+ public:
+  /**
+   * @return The cache shared by all code generator managers of this process.
+   **/
+  static CodegenModuleCache* GetInstance();
+
+  ~CodegenModuleCache() override = default;
+
+  /**
+   * @brief Called by the ExecutionEngine after it compiled a module that was
+   *        not found in the cache.
+   *
+   * @param module Module that was compiled.
+   * @param object Machine code of the module.
+   **/
+  void notifyObjectCompiled(const llvm::Module* module,
+                            llvm::MemoryBufferRef object) override;
+
+  /**
+   * @brief Called by the ExecutionEngine before it compiles a module.
+   *
+   * @param module Module about to be compiled.
+   * @return A copy of the machine code of an identical module compiled before,
+   *         or nullptr if there is none.
+   **/
+  std::unique_ptr<llvm::MemoryBuffer> getObject(
+      const llvm::Module* module) override;
+
+  /**
+   * @brief Drop all cached modules.
+   **/
+  void Clear();
+
+  /**
+   * @return Number of modules found in the cache.
+   **/
+  size_t hits() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return hits_;
+  }
+
+  /**
+   * @return Number of modules not found in the cache.
+   **/
+  size_t misses() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return misses_;
+  }
+
+  /**
+   * @return Number of modules evicted to keep the cache within its size.
+   **/
+  size_t evictions() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return evictions_;
+  }
+
+  /**
+   * @return Number of modules in the cache.
+   **/
+  size_t entries() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return entries_.size();
+  }
+
+  /**
+   * @return Total size in bytes of the machine code in the cache.
+   **/
+  size_t size_in_bytes() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return size_in_bytes_;
+  }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::unique_ptr<llvm::MemoryBuffer> object;
+  };
+
+  CodegenModuleCache();
+
+  // Key of a module: its IR without the module name, which is unique to
+  // each plan node. CodegenUtils::PrepareForExecution() records the
+  // optimization level in the IR.
+  static std::string GetKey(const llvm::Module* module);
+
+  // Evict the least recently used entries until the cache fits in
+  // codegen_module_cache_size. Must be called with mutex_ held.
+  void Shrink();
+
+  // Entries from the most to the least recently used
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+  // Keys of the modules missed in getObject(), which are added to the cache
+  // when notifyObjectCompiled() is called for them.
+  std::unordered_map<const llvm::Module*, std::string> pending_keys_;
+
+  // Protects all the members, since modules may be compiled concurrently.
+  mutable std::mutex mutex_;
+
+  size_t size_in_bytes_;
+  size_t hits_;
+  size_t misses_;
+  size_t evictions_;
+
+  DISALLOW_COPY_AND_ASSIGN(CodegenModuleCache);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+
+#endif  // GPCODEGEN_CODEGEN_MODULE_CACHE_H_
@@ -0,0 +1,111 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    exec_hash_get_hash_value_codegen.h
+//
+//  @doc:
+//    Headers for ExecHashGetHashValue codegen.
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_EXECHASHGETHASHVALUE_CODEGEN_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_EXECHASHGETHASHVALUE_CODEGEN_H_
+
+#include "codegen/base_codegen.h"
+#include "codegen/codegen_wrapper.h"
+
+namespace llvm {
+class Value;
+}  // namespace llvm
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class ExecHashGetHashValueCodegen
+    : public BaseCodegen<ExecHashGetHashValueFn> {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param regular_func_ptr        Regular version of the target function.
+   * @param ptr_to_chosen_func_ptr  Reference to the function pointer that the
+   *                                caller will call.
+   * @param hashkeys                List of ExprState of the hash keys of one
+   *                                side of the join.
+   * @param hashoperators           List of OIDs of the join operators.
+   * @param outer_tuple             true if hashkeys are the outer hash keys.
+   *
+   * @note 	The ptr_to_chosen_func_ptr can refer to either the generated
+   *        function or the corresponding regular version.
+   *
+   **/
+  explicit ExecHashGetHashValueCodegen(
+      CodegenManager* manager,
+      ExecHashGetHashValueFn regular_func_ptr,
+      ExecHashGetHashValueFn* ptr_to_regular_func_ptr,
+      List *hashkeys,
+      List *hashoperators,
+      bool outer_tuple);
+
+  virtual ~ExecHashGetHashValueCodegen() = default;
+
+  /**
+   * @brief Generates runtime code that computes the hash of one key, the
+   *        way the hash function of the key does.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @param hash_func OID of the hash function of the key.
+   * @param key_type OID of the type of the key.
+   * @param llvm_keyval Datum of the key.
+   * @param llvm_fmgr_info FmgrInfo of the hash function, used for the types
+   *        whose hash is not computed inline.
+   *
+   * @return The 32-bit hash of the key.
+   **/
+  static llvm::Value* GenerateHashKey(gpcodegen::GpCodegenUtils* codegen_utils,
+                                      Oid hash_func,
+                                      Oid key_type,
+                                      llvm::Value* llvm_keyval,
+                                      llvm::Value* llvm_fmgr_info);
+
+ protected:
+  /**
+   * @brief Generate code for ExecHashGetHashValue.
+   *
+   * @param codegen_utils
+   *
+   * @return true on successful generation; false otherwise.
+   *
+   * This implementation supports hash keys that are plain columns only. The
+   * hash of int4, date and int8 keys is computed inline; keys of other types
+   * (e.g. text) call their hash function directly, without evaluating the key
+   * expression through ExecEvalExpr.
+   *
+   */
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final;
+
+ private:
+  List *hashkeys_;
+  List *hashoperators_;
+  bool outer_tuple_;
+
+  static constexpr char kExecHashGetHashValuePrefix[] = "ExecHashGetHashValue";
+
+  /**
+   * @brief Generates runtime code that implements ExecHashGetHashValue.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @return true on successful generation.
+   **/
+  bool GenerateExecHashGetHashValue(gpcodegen::GpCodegenUtils* codegen_utils);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+#endif  // GPCODEGEN_EXECHASHGETHASHVALUE_CODEGEN_H_
@@ -0,0 +1,79 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    match_agg_hash_entry_codegen.h
+//
+//  @doc:
+//    Headers for match_agg_hash_entry codegen.
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPCODEGEN_MATCHAGGHASHENTRY_CODEGEN_H_  // NOLINT(build/header_guard)
+#define GPCODEGEN_MATCHAGGHASHENTRY_CODEGEN_H_
+
+#include "codegen/base_codegen.h"
+#include "codegen/codegen_wrapper.h"
+
+namespace gpcodegen {
+
+/** \addtogroup gpcodegen
+ *  @{
+ */
+
+class MatchAggHashEntryCodegen: public BaseCodegen<MatchAggHashEntryFn> {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param regular_func_ptr        Regular version of the target function.
+   * @param ptr_to_chosen_func_ptr  Reference to the function pointer that the
+   *                                caller will call.
+   * @param aggstate                The AggState to use for generating code.
+   *
+   * @note 	The ptr_to_chosen_func_ptr can refer to either the generated
+   *        function or the corresponding regular version.
+   *
+   **/
+  explicit MatchAggHashEntryCodegen(
+      CodegenManager* manager,
+      MatchAggHashEntryFn regular_func_ptr,
+      MatchAggHashEntryFn* ptr_to_regular_func_ptr,
+      AggState *aggstate);
+
+  virtual ~MatchAggHashEntryCodegen() = default;
+
+ protected:
+  /**
+   * @brief Generate code for match_agg_hash_entry.
+   *
+   * @param codegen_utils
+   *
+   * @return true on successful generation; false otherwise.
+   *
+   * Grouping columns whose equality function has a generator (e.g. int4eq,
+   * int8eq and date_eq) are compared inline; the other equality functions
+   * are called through their FmgrInfo.
+   *
+   */
+  bool GenerateCodeInternal(gpcodegen::GpCodegenUtils* codegen_utils) final;
+
+ private:
+  AggState *aggstate_;
+
+  static constexpr char kMatchAggHashEntryPrefix[] = "MatchAggHashEntry";
+
+  /**
+   * @brief Generates runtime code that implements match_agg_hash_entry.
+   *
+   * @param codegen_utils Utility to ease the code generation process.
+   * @return true on successful generation.
+   **/
+  bool GenerateMatchAggHashEntry(gpcodegen::GpCodegenUtils* codegen_utils);
+};
+
+/** @} */
+
+}  // namespace gpcodegen
+#endif  // GPCODEGEN_MATCHAGGHASHENTRY_CODEGEN_H_
@@ -32,6 +32,7 @@
 #include "llvm/ADT/Twine.h"
 #include "llvm/Analysis/CallGraph.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DerivedTypes.h"
@@ -464,11 +465,28 @@ class CodegenUtils {
    *        code at the expense of increased compilation time.
    * @param optimize_for_host_cpu If true, LLVM will optimize generated machine
    *        code for the specific CPU model we are running on.
+   * @param object_cache If not NULL, the ExecutionEngine takes the machine
+   *        code of the modules from this cache when it has them, and adds
+   *        them to it when it compiles them.
    * @return true if an ExecutionEngine was set up successfully, false if some
    *         error occured.
    **/
   bool PrepareForExecution(const OptimizationLevel cpu_opt_level,
-                           const bool optimize_for_host_cpu);
+                           const bool optimize_for_host_cpu,
+                           llvm::ObjectCache* object_cache = nullptr);
+
+  /**
+   * @brief Generate machine code for all the functions of this CodegenUtils,
+   *        instead of deferring it to the first GetFunctionPointer() call.
+   *
+   * @note PrepareForExecution() should be called before calling this method.
+   *       Since it only touches the ExecutionEngine of this CodegenUtils, it
+   *       may run on another thread than the one that generated the code.
+   *
+   * @return true if machine code was generated, false if there is no
+   *         ExecutionEngine to generate it with.
+   **/
+  bool CompileModules();
 
   /**
    * @brief Get a pointer to the compiled machine-code version of a function
@@ -0,0 +1,265 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright (C) 2016 Pivotal Software, Inc.
+//
+//  @filename:
+//    match_agg_hash_entry_codegen.cc
+//
+//  @doc:
+//    Generates code for match_agg_hash_entry function.
+//
+//---------------------------------------------------------------------------
+#include <string>
+#include <vector>
+
+#include "codegen/match_agg_hash_entry_codegen.h"
+#include "codegen/op_expr_tree_generator.h"
+
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#include "access/memtup.h"
+#include "executor/executor.h"
+#include "executor/tuptable.h"
+#include "fmgr.h"
+#include "nodes/execnodes.h"
+#include "nodes/plannodes.h"
+}
+
+namespace llvm {
+class BasicBlock;
+class Function;
+class Value;
+}  // namespace llvm
+
+using gpcodegen::MatchAggHashEntryCodegen;
+
+constexpr char MatchAggHashEntryCodegen::kMatchAggHashEntryPrefix[];
+
+MatchAggHashEntryCodegen::MatchAggHashEntryCodegen(
+    CodegenManager* manager,
+    MatchAggHashEntryFn regular_func_ptr,
+    MatchAggHashEntryFn* ptr_to_regular_func_ptr,
+    AggState *aggstate)
+: BaseCodegen(manager,
+              kMatchAggHashEntryPrefix,
+              regular_func_ptr,
+              ptr_to_regular_func_ptr),
+              aggstate_(aggstate) {
+}
+
+bool MatchAggHashEntryCodegen::GenerateMatchAggHashEntry(
+    gpcodegen::GpCodegenUtils* codegen_utils) {
+
+  assert(NULL != codegen_utils);
+  if (nullptr == aggstate_ ||
+      nullptr == aggstate_->eqfunctions ||
+      nullptr == aggstate_->hashslot) {
+    return false;
+  }
+
+  Agg *agg = reinterpret_cast<Agg*>(aggstate_->ss.ps.plan);
+  if (agg->numCols <= 0) {
+    return false;
+  }
+
+  auto irb = codegen_utils->ir_builder();
+
+  llvm::Function* match_agg_hash_entry_func =
+      CreateFunction<MatchAggHashEntryFn>(codegen_utils, GetUniqueFuncName());
+
+  // BasicBlock of function entry.
+  llvm::BasicBlock* entry_block = codegen_utils->CreateBasicBlock(
+      "entry_block", match_agg_hash_entry_func);
+  llvm::BasicBlock* implementation_block = codegen_utils->CreateBasicBlock(
+      "implementation_block", match_agg_hash_entry_func);
+  llvm::BasicBlock* no_match_block = codegen_utils->CreateBasicBlock(
+      "no_match_block", match_agg_hash_entry_func);
+  llvm::BasicBlock* error_aggstate_block = codegen_utils->CreateBasicBlock(
+      "error_aggstate_block", match_agg_hash_entry_func);
+  llvm::BasicBlock* overflow_block = codegen_utils->CreateBasicBlock(
+      "overflow_block", match_agg_hash_entry_func);
+
+  // External functions
+  llvm::Function* llvm_slot_getattr =
+      codegen_utils->GetOrRegisterExternalFunction(slot_getattr_regular,
+                                                   "slot_getattr_regular");
+  llvm::Function* llvm_memtuple_getattr =
+      codegen_utils->GetOrRegisterExternalFunction(memtuple_getattr,
+                                                   "memtuple_getattr");
+
+  // Function arguments to match_agg_hash_entry
+  llvm::Value* llvm_aggstate_arg = ArgumentByPosition(
+      match_agg_hash_entry_func, 0);
+  llvm::Value* llvm_inputslot_arg = ArgumentByPosition(
+      match_agg_hash_entry_func, 1);
+  llvm::Value* llvm_entry_tuple_arg = ArgumentByPosition(
+      match_agg_hash_entry_func, 2);
+
+  // Generation-time constants
+  llvm::Value* llvm_aggstate = codegen_utils->GetConstant(aggstate_);
+
+  // entry block
+  // ----------
+  irb->SetInsertPoint(entry_block);
+
+#ifdef CODEGEN_DEBUG
+  EXPAND_CREATE_ELOG(codegen_utils, DEBUG1,
+                     "Codegen'ed match_agg_hash_entry called!");
+#endif
+
+  // Compare aggstate given during code generation and the one passed
+  // in as an argument to match_agg_hash_entry
+  irb->CreateCondBr(
+      irb->CreateICmpEQ(llvm_aggstate, llvm_aggstate_arg),
+      implementation_block /* true */,
+      error_aggstate_block /* false */);
+
+  // implementation block
+  // ----------
+  irb->SetInsertPoint(implementation_block);
+
+  // mt_bind = aggstate->hashslot->tts_mt_bind;
+  // The binding is set up when the first input tuple is read, so we load it
+  // at execution time.
+  llvm::Value* llvm_mt_bind = irb->CreateLoad(
+      codegen_utils->GetConstant(&aggstate_->hashslot->tts_mt_bind));
+
+  llvm::Value* llvm_input_isnull_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "input_isNull");
+  llvm::Value* llvm_entry_isnull_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "entry_isNull");
+  llvm::Value* llvm_eq_isnull_ptr = irb->CreateAlloca(
+      codegen_utils->GetType<bool>(), nullptr, "eq_isNull");
+
+  for (int i = 0; i < agg->numCols; i++) {
+    AttrNumber att = agg->grpColIdx[i];
+    if (att <= 0) {
+      elog(DEBUG1, "We don't codegen grouping on system columns");
+      return false;
+    }
+
+    llvm::BasicBlock* null_key_block = codegen_utils->CreateBasicBlock(
+        "null_key_block_" + std::to_string(i), match_agg_hash_entry_func);
+    llvm::BasicBlock* compare_key_block = codegen_utils->CreateBasicBlock(
+        "compare_key_block_" + std::to_string(i), match_agg_hash_entry_func);
+    llvm::BasicBlock* next_key_block = codegen_utils->CreateBasicBlock(
+        "next_key_block_" + std::to_string(i), match_agg_hash_entry_func);
+
+    // input_datum = slot_getattr(inputslot, att, &input_isNull);
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                     llvm_input_isnull_ptr);
+    llvm::Value* llvm_input_datum = irb->CreateCall(llvm_slot_getattr, {
+        llvm_inputslot_arg,
+        codegen_utils->GetConstant<int32_t>(att),
+        llvm_input_isnull_ptr});
+    // entry_datum = memtuple_getattr(mtup, mt_bind, att, &entry_isNull);
+    irb->CreateStore(codegen_utils->GetConstant<bool>(false),
+                     llvm_entry_isnull_ptr);
+    llvm::Value* llvm_entry_datum = irb->CreateCall(llvm_memtuple_getattr, {
+        irb->CreateBitCast(llvm_entry_tuple_arg,
+                           codegen_utils->GetType<MemTuple>()),
+        llvm_mt_bind,
+        codegen_utils->GetConstant<int32_t>(att),
+        llvm_entry_isnull_ptr});
+
+    llvm::Value* llvm_input_isnull = irb->CreateLoad(llvm_input_isnull_ptr);
+    llvm::Value* llvm_entry_isnull = irb->CreateLoad(llvm_entry_isnull_ptr);
+    irb->CreateCondBr(irb->CreateOr(llvm_input_isnull, llvm_entry_isnull),
+                      null_key_block /* true */,
+                      compare_key_block /* false */);
+
+    // null_key_block
+    // --------------
+    // NULLs match in group keys.
+    irb->SetInsertPoint(null_key_block);
+    irb->CreateCondBr(irb->CreateAnd(llvm_input_isnull, llvm_entry_isnull),
+                      next_key_block /* true */,
+                      no_match_block /* false */);
+
+    // compare_key_block
+    // -----------------
+    // Both non-NULL: compare them with the equality function of the column.
+    irb->SetInsertPoint(compare_key_block);
+    FmgrInfo *eqfunction = &aggstate_->eqfunctions[i];
+    gpcodegen::PGFuncGeneratorInterface* pg_func_gen =
+        gpcodegen::OpExprTreeGenerator::GetPGFuncGenerator(
+            eqfunction->fn_oid);
+    llvm::Value* llvm_equal = nullptr;
+    if (nullptr != pg_func_gen) {
+      std::vector<llvm::Value*> llvm_args = {llvm_input_datum,
+                                             llvm_entry_datum};
+      std::vector<llvm::Value*> llvm_args_isNull = {
+          codegen_utils->GetConstant<bool>(false),
+          codegen_utils->GetConstant<bool>(false)};
+      gpcodegen::PGFuncGeneratorInfo pg_func_info(
+          match_agg_hash_entry_func,
+          overflow_block,
+          llvm_args,
+          llvm_args_isNull);
+      if (!pg_func_gen->GenerateCode(codegen_utils, pg_func_info,
+                                     &llvm_equal, llvm_eq_isnull_ptr)) {
+        elog(DEBUG1, "Function with oid = %d was not generated successfully!",
+             eqfunction->fn_oid);
+        return false;
+      }
+    } else {
+      // DatumGetBool(FunctionCall2(&eqfunctions[i], input_datum, entry_datum))
+      llvm::Function* llvm_FunctionCall2 =
+          codegen_utils->GetOrRegisterExternalFunction(FunctionCall2,
+                                                       "FunctionCall2");
+      llvm_equal = codegen_utils->CreateDatumToCppTypeCast<bool>(
+          irb->CreateCall(llvm_FunctionCall2, {
+              codegen_utils->GetConstant(eqfunction),
+              llvm_input_datum,
+              llvm_entry_datum}));
+    }
+    irb->CreateCondBr(llvm_equal,
+                      next_key_block /* true */,
+                      no_match_block /* false */);
+
+    irb->SetInsertPoint(next_key_block);
+  }
+
+  // All the grouping columns match
+  irb->CreateRet(codegen_utils->GetConstant<bool>(true));
+
+  // No match block
+  // ---------------
+  irb->SetInsertPoint(no_match_block);
+  irb->CreateRet(codegen_utils->GetConstant<bool>(false));
+
+  // Error aggstate block
+  // ---------------
+  irb->SetInsertPoint(error_aggstate_block);
+
+  EXPAND_CREATE_ELOG(codegen_utils, ERROR, "Codegened match_agg_hash_entry: "
+                     "use of different aggstate.");
+
+  irb->CreateRet(codegen_utils->GetConstant<bool>(false));
+
+  // Overflow block
+  // ---------------
+  irb->SetInsertPoint(overflow_block);
+  // The equality functions do not overflow, but the block is required by the
+  // built-in function generators.
+  irb->CreateRet(codegen_utils->GetConstant<bool>(false));
+
+  return true;
+}
+
+
+bool MatchAggHashEntryCodegen::GenerateCodeInternal(
+    GpCodegenUtils* codegen_utils) {
+  bool isGenerated = GenerateMatchAggHashEntry(codegen_utils);
+
+  if (isGenerated) {
+    elog(DEBUG1, "match_agg_hash_entry was generated successfully!");
+    return true;
+  } else {
+    elog(DEBUG1, "match_agg_hash_entry generation failed!");
+    return false;
+  }
+}
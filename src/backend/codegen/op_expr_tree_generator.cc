@@ -66,6 +66,13 @@ void OpExprTreeGenerator::InitializeSupportedFunction() {
           nullptr,
           true));
 
+  supported_function_[65] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int32_t, int32_t>(
+          65,
+          "int4eq",
+          &IRBuilder<>::CreateICmpEQ,
+          true));
+
   supported_function_[149] = std::unique_ptr<PGFuncGeneratorInterface>(
       new PGIRBuilderFuncGenerator<bool, int32_t, int32_t>(
           149,
@@ -108,6 +115,13 @@ void OpExprTreeGenerator::InitializeSupportedFunction() {
           nullptr,
           true));
 
+  supported_function_[467] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int64_t, int64_t>(
+          467,
+          "int8eq",
+          &IRBuilder<>::CreateICmpEQ,
+          true));
+
   supported_function_[1219] = std::unique_ptr<PGFuncGeneratorInterface>(
       new PGGenericFuncGenerator<int64_t, int64_t>(
           1219,
@@ -154,6 +168,11 @@ void OpExprTreeGenerator::InitializeSupportedFunction() {
           1088, "date_le", &IRBuilder<>::CreateICmpSLE,
           true));
 
+  supported_function_[1086] = std::unique_ptr<PGFuncGeneratorInterface>(
+      new PGIRBuilderFuncGenerator<bool, int32_t, int32_t>(
+          1086, "date_eq", &IRBuilder<>::CreateICmpEQ,
+          true));
+
   supported_function_[2339] = std::unique_ptr<PGFuncGeneratorInterface>(
       new PGGenericFuncGenerator<bool, int32_t, int64_t>(
           2339,
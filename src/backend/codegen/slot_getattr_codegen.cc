@@ -124,9 +124,10 @@ bool SlotGetAttrCodegen::GenerateCodeInternal(
     return true;
   }
 
-  // Give the function a human readable name
+  // Give the function a human readable name. It must not depend on the
+  // address of the slot, so that the module can share compiled code with the
+  // modules of other executions of the plan.
   std::string function_name = GetUniqueFuncName() + "_" +
-      std::to_string(reinterpret_cast<uint64_t>(slot_)) + "_" +
       std::to_string(max_attr_);
   llvm::Function* function = CreateFunction<SlotGetAttrFn>(codegen_utils,
                                                            function_name);
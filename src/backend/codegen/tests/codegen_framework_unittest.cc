@@ -58,11 +58,15 @@ extern "C" {
 #include "codegen/utils/gp_codegen_utils.h"
 #include "codegen/utils/utility.h"
 #include "codegen/codegen_manager.h"
+#include "codegen/codegen_module_cache.h"
 #include "codegen/codegen_wrapper.h"
 #include "codegen/codegen_interface.h"
 #include "codegen/base_codegen.h"
 
 extern bool codegen_validate_functions;
+extern int codegen_module_cache_size;
+extern bool codegen_async_compile;
+extern bool codegen_cost_based_enrollment;
 using gpcodegen::GpCodegenUtils;
 namespace gpcodegen {
 
@@ -403,7 +407,7 @@ TEST_F(CodegenManagerTest, TestGetters) {
 
   EXPECT_EQ(SumCodeGenerator::kAddFuncNamePrefix,
             code_gen->GetOrigFuncName());
-  // Static unique_counter will be zero to begin with.
+  // The unique counter of a new manager will be zero to begin with.
   // So uniqueFuncName return with suffix zero.
   EXPECT_EQ(SumCodeGenerator::kAddFuncNamePrefix + std::to_string(0),
             code_gen->GetUniqueFuncName());
@@ -625,6 +629,97 @@ TEST_F(CodegenManagerTest, ResetTest) {
   ASSERT_TRUE(SumFuncRegular == sum_func_ptr);
 }
 
+TEST_F(CodegenManagerTest, AsyncCompileTest) {
+  codegen_async_compile = true;
+
+  sum_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  EXPECT_EQ(1, manager_->GenerateCode());
+
+  // The module is compiled in the background, so the caller keeps using the
+  // regular version until the swap.
+  EXPECT_EQ(0, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(SumFuncRegular == sum_func_ptr);
+
+  CodegenManager::WaitForBackgroundCompilations();
+  ASSERT_FALSE(manager_->IsCompiling());
+  EXPECT_EQ(1, manager_->SwapCompiledFunctions());
+  ASSERT_TRUE(SumFuncRegular != sum_func_ptr);
+  EXPECT_EQ(3, sum_func_ptr(1, 2));
+
+  // Nothing left to swap
+  EXPECT_EQ(0, manager_->SwapCompiledFunctions());
+
+  codegen_async_compile = false;
+}
+
+TEST_F(CodegenManagerTest, CostBasedEnrollmentTest) {
+  codegen_cost_based_enrollment = true;
+
+  // Without an estimate, code is always generated
+  EXPECT_TRUE(manager_->MayBreakEven());
+
+  // Too few rows to make up for any compilation
+  manager_.reset(new CodegenManager("CodegenManagerTestFewRows", 10));
+  EXPECT_FALSE(manager_->MayBreakEven());
+  sum_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  EXPECT_EQ(1, manager_->GenerateCode());
+  EXPECT_EQ(0, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(SumFuncRegular == sum_func_ptr);
+
+  // Enough rows for the compilation to pay off
+  manager_.reset(new CodegenManager("CodegenManagerTestManyRows", 1e9));
+  EXPECT_TRUE(manager_->MayBreakEven());
+  sum_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  EXPECT_EQ(1, manager_->GenerateCode());
+  EXPECT_EQ(1, manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(SumFuncRegular != sum_func_ptr);
+  EXPECT_EQ(3, sum_func_ptr(1, 2));
+
+  codegen_cost_based_enrollment = false;
+}
+
+TEST_F(CodegenManagerTest, ModuleCacheTest) {
+  CodegenModuleCache* cache = CodegenModuleCache::GetInstance();
+  cache->Clear();
+  codegen_module_cache_size = 1024;
+
+  sum_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  EXPECT_EQ(1, manager_->GenerateCode());
+  size_t misses = cache->misses();
+  ASSERT_TRUE(manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(SumFuncRegular != sum_func_ptr);
+  EXPECT_EQ(misses + 1, cache->misses());
+  EXPECT_EQ(1, cache->entries());
+
+  // A second manager generates the same module, so its machine code comes
+  // from the cache.
+  manager_.reset(new CodegenManager("CodegenManagerTestAgain"));
+  sum_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  EXPECT_EQ(1, manager_->GenerateCode());
+  size_t hits = cache->hits();
+  ASSERT_TRUE(manager_->PrepareGeneratedFunctions());
+  ASSERT_TRUE(SumFuncRegular != sum_func_ptr);
+  EXPECT_EQ(hits + 1, cache->hits());
+  EXPECT_EQ(1, cache->entries());
+  EXPECT_EQ(3, sum_func_ptr(1, 2));
+
+  // With the cache disabled, compiled modules are not kept.
+  codegen_module_cache_size = 0;
+  cache->Clear();
+  manager_.reset(new CodegenManager("CodegenManagerTestNoCache"));
+  sum_func_ptr = nullptr;
+  EnrollCodegen<SumCodeGenerator, SumFunc>(SumFuncRegular, &sum_func_ptr);
+  EXPECT_EQ(1, manager_->GenerateCode());
+  ASSERT_TRUE(manager_->PrepareGeneratedFunctions());
+  EXPECT_EQ(0, cache->entries());
+  EXPECT_EQ(3, sum_func_ptr(1, 2));
+}
+
 TEST_F(CodegenManagerTest, TestDatumBoolCast) {
   CheckDatumCast<bool>(BoolGetDatum,
                        DatumGetBool,
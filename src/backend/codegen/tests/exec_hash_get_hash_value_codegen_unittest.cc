@@ -0,0 +1,178 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright 2017 Pivotal Software, Inc.
+//
+//  @filename:
+//    exec_hash_get_hash_value_codegen_unittest.cc
+//
+//  @doc:
+//    Unit tests for the hash keys generated by ExecHashGetHashValueCodegen
+//
+//  @test:
+//
+//---------------------------------------------------------------------------
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#undef newNode  // undef newNode so it doesn't have name collision with llvm
+#include "access/hash.h"
+#include "catalog/pg_type.h"
+#include "fmgr.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/elog.h"
+#include "utils/fmgroids.h"
+#include "utils/memutils.h"
+#include "utils/palloc.h"
+#undef elog
+#define elog(...)
+}
+
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Value.h"
+#include "llvm/IR/Verifier.h"
+
+#include "codegen/utils/gp_codegen_utils.h"
+#include "codegen/utils/utility.h"
+#include "codegen/exec_hash_get_hash_value_codegen.h"
+
+namespace gpcodegen {
+
+typedef uint32_t (*HashKeyFn) (Datum keyval);
+
+class ExecHashGetHashValueCodegenTestEnvironment
+    : public ::testing::Environment {
+ public:
+  virtual void SetUp() {
+    ASSERT_TRUE(GpCodegenUtils::InitializeGlobal());
+  }
+};
+
+class ExecHashGetHashValueCodegenTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    codegen_utils_.reset(new GpCodegenUtils("test_module"));
+    // textin() and hashtext() allocate in the current memory context
+    MemoryContextSwitchTo(
+        AllocSetContextCreate(nullptr,
+                              "ExecHashGetHashValueCodegenTest",
+                              ALLOCSET_SMALL_MINSIZE,
+                              ALLOCSET_SMALL_INITSIZE,
+                              ALLOCSET_SMALL_MAXSIZE));
+  }
+
+  // Generates and compiles a function that returns the hash GenerateHashKey()
+  // computes for its argument.
+  HashKeyFn GenerateHashKeyFn(Oid hash_func, Oid key_type) {
+    fmgr_info(hash_func, &hash_finfo_);
+
+    llvm::Function* hash_key_fn =
+        codegen_utils_->CreateFunction<HashKeyFn>("hash_key");
+    llvm::BasicBlock* body =
+        codegen_utils_->CreateBasicBlock("body", hash_key_fn);
+    codegen_utils_->ir_builder()->SetInsertPoint(body);
+    llvm::Value* llvm_hkey = ExecHashGetHashValueCodegen::GenerateHashKey(
+        codegen_utils_.get(),
+        hash_func,
+        key_type,
+        ArgumentByPosition(hash_key_fn, 0),
+        codegen_utils_->GetConstant(&hash_finfo_));
+    codegen_utils_->ir_builder()->CreateRet(llvm_hkey);
+
+    EXPECT_FALSE(llvm::verifyFunction(*hash_key_fn));
+    EXPECT_TRUE(codegen_utils_->PrepareForExecution(
+        CodegenUtils::OptimizationLevel::kNone,
+        true));
+    return codegen_utils_->GetFunctionPointer<HashKeyFn>("hash_key");
+  }
+
+  // Checks that the generated hash of each key is the one of the regular
+  // hash function, which ExecHashGetHashValue() calls.
+  void CheckHashKeys(Oid hash_func, Oid key_type,
+                     const std::vector<Datum>& keys) {
+    HashKeyFn hash_key_fn = GenerateHashKeyFn(hash_func, key_type);
+    ASSERT_NE(nullptr, hash_key_fn);
+
+    for (Datum key : keys) {
+      EXPECT_EQ(DatumGetUInt32(FunctionCall1(&hash_finfo_, key)),
+                hash_key_fn(key));
+    }
+  }
+
+  std::unique_ptr<GpCodegenUtils> codegen_utils_;
+  FmgrInfo hash_finfo_;
+};
+
+TEST_F(ExecHashGetHashValueCodegenTest, Int4HashKeyTest) {
+  CheckHashKeys(F_HASHINT4, INT4OID, {
+      Int32GetDatum(0),
+      Int32GetDatum(1),
+      Int32GetDatum(-1),
+      Int32GetDatum(12345),
+      Int32GetDatum(-12345),
+      Int32GetDatum(std::numeric_limits<int32_t>::max()),
+      Int32GetDatum(std::numeric_limits<int32_t>::min())});
+}
+
+TEST_F(ExecHashGetHashValueCodegenTest, DateHashKeyTest) {
+  // Days since 2000-01-01, so dates before it are negative
+  CheckHashKeys(F_HASHINT4, DATEOID, {
+      DateADTGetDatum(0),
+      DateADTGetDatum(6000),
+      DateADTGetDatum(-36524)});
+}
+
+TEST_F(ExecHashGetHashValueCodegenTest, Int8HashKeyTest) {
+  CheckHashKeys(F_HASHINT8, INT8OID, {
+      Int64GetDatum(0),
+      Int64GetDatum(1),
+      Int64GetDatum(-1),
+      Int64GetDatum(INT64CONST(4294967295)),
+      Int64GetDatum(INT64CONST(4294967296)),
+      Int64GetDatum(INT64CONST(123456789012345)),
+      Int64GetDatum(INT64CONST(-4294967296)),
+      Int64GetDatum(INT64CONST(-123456789012345)),
+      Int64GetDatum(std::numeric_limits<int64_t>::max()),
+      Int64GetDatum(std::numeric_limits<int64_t>::min())});
+}
+
+TEST_F(ExecHashGetHashValueCodegenTest, Int8HashesLikeInt4Test) {
+  // Cross-type hash joins rely on logically equal int4 and int8 keys having
+  // the same hash
+  HashKeyFn hash_key_fn = GenerateHashKeyFn(F_HASHINT8, INT8OID);
+  ASSERT_NE(nullptr, hash_key_fn);
+
+  for (int32_t key : {0, 1, -1, 12345, -12345}) {
+    EXPECT_EQ(DatumGetUInt32(DirectFunctionCall1(hashint4,
+                                                 Int32GetDatum(key))),
+              hash_key_fn(Int64GetDatum(key)));
+  }
+}
+
+TEST_F(ExecHashGetHashValueCodegenTest, TextHashKeyTest) {
+  // Hashed by calling the hash function of the key
+  CheckHashKeys(F_HASHTEXT, TEXTOID, {
+      DirectFunctionCall1(textin, CStringGetDatum("")),
+      DirectFunctionCall1(textin, CStringGetDatum("a")),
+      DirectFunctionCall1(textin, CStringGetDatum("hash join key"))});
+}
+
+}  // namespace gpcodegen
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  AddGlobalTestEnvironment(
+      new gpcodegen::ExecHashGetHashValueCodegenTestEnvironment);
+  return RUN_ALL_TESTS();
+}
+
+// EOF
@@ -0,0 +1,225 @@
+//---------------------------------------------------------------------------
+//  Greenplum Database
+//  Copyright 2017 Pivotal Software, Inc.
+//
+//  @filename:
+//    match_agg_hash_entry_codegen_unittest.cc
+//
+//  @doc:
+//    Unit tests for the group key matching generated by
+//    MatchAggHashEntryCodegen
+//
+//  @test:
+//
+//---------------------------------------------------------------------------
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "postgres.h"  // NOLINT(build/include)
+#undef newNode  // undef newNode so it doesn't have name collision with llvm
+#include "access/memtup.h"
+#include "access/tupdesc.h"
+#include "catalog/pg_type.h"
+#include "executor/execHHashagg.h"
+#include "executor/tuptable.h"
+#include "fmgr.h"
+#include "nodes/execnodes.h"
+#include "nodes/plannodes.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/elog.h"
+#include "utils/fmgroids.h"
+#include "utils/memutils.h"
+#include "utils/palloc.h"
+#undef elog
+#define elog(...)
+}
+
+#include "codegen/codegen_manager.h"
+#include "codegen/codegen_wrapper.h"
+#include "codegen/match_agg_hash_entry_codegen.h"
+
+extern bool codegen_validate_functions;
+
+namespace gpcodegen {
+
+// Grouping columns: int4, int8 and date keys are compared inline, text keys
+// through their equality function.
+static const int kNumCols = 4;
+
+class MatchAggHashEntryCodegenTestEnvironment
+    : public ::testing::Environment {
+ public:
+  virtual void SetUp() {
+    ASSERT_EQ(InitCodegen(), 1);
+  }
+};
+
+class MatchAggHashEntryCodegenTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    codegen_validate_functions = true;
+    MemoryContextSwitchTo(
+        AllocSetContextCreate(nullptr,
+                              "MatchAggHashEntryCodegenTest",
+                              ALLOCSET_DEFAULT_MINSIZE,
+                              ALLOCSET_DEFAULT_INITSIZE,
+                              ALLOCSET_DEFAULT_MAXSIZE));
+
+    // Built by hand, as there is no catalog to look the types up in
+    TupleDesc tupdesc = CreateTemplateTupleDesc(kNumCols, false);
+    InitAttribute(tupdesc, 1, INT4OID, sizeof(int32), true, 'i');
+    InitAttribute(tupdesc, 2, INT8OID, sizeof(int64), true, 'd');
+    InitAttribute(tupdesc, 3, DATEOID, sizeof(DateADT), true, 'i');
+    InitAttribute(tupdesc, 4, TEXTOID, -1, false, 'i');
+
+    agg_ = static_cast<Agg*>(palloc0(sizeof(Agg)));
+    agg_->numCols = kNumCols;
+    agg_->grpColIdx =
+        static_cast<AttrNumber*>(palloc(kNumCols * sizeof(AttrNumber)));
+    for (int i = 0; i < kNumCols; i++) {
+      agg_->grpColIdx[i] = i + 1;
+    }
+
+    aggstate_ = static_cast<AggState*>(palloc0(sizeof(AggState)));
+    aggstate_->ss.ps.plan = reinterpret_cast<Plan*>(agg_);
+    aggstate_->eqfunctions =
+        static_cast<FmgrInfo*>(palloc0(kNumCols * sizeof(FmgrInfo)));
+    fmgr_info(F_INT4EQ, &aggstate_->eqfunctions[0]);
+    fmgr_info(F_INT8EQ, &aggstate_->eqfunctions[1]);
+    fmgr_info(F_DATE_EQ, &aggstate_->eqfunctions[2]);
+    fmgr_info(F_TEXTEQ, &aggstate_->eqfunctions[3]);
+    aggstate_->hashslot = MakeSingleTupleTableSlot(tupdesc);
+    input_slot_ = MakeSingleTupleTableSlot(tupdesc);
+
+    manager_.reset(new CodegenManager("MatchAggHashEntryCodegenTest"));
+    match_fn_ = match_agg_hash_entry;
+    ASSERT_TRUE(manager_->EnrollCodeGenerator(
+        CodegenFuncLifespan_Parameter_Invariant,
+        new MatchAggHashEntryCodegen(manager_.get(),
+                                     match_agg_hash_entry,
+                                     &match_fn_,
+                                     aggstate_)));
+    EXPECT_EQ(1, manager_->GenerateCode());
+    ASSERT_TRUE(manager_->PrepareGeneratedFunctions());
+    ASSERT_TRUE(match_agg_hash_entry != match_fn_);
+  }
+
+  static void InitAttribute(TupleDesc tupdesc, AttrNumber attnum,
+                            Oid type, int16 len, bool byval, char align) {
+    Form_pg_attribute att = tupdesc->attrs[attnum - 1];
+    MemSet(att, 0, ATTRIBUTE_FIXED_PART_SIZE);
+    att->attnum = attnum;
+    att->atttypid = type;
+    att->atttypmod = -1;
+    att->attlen = len;
+    att->attbyval = byval;
+    att->attalign = align;
+    att->attstorage = byval ? 'p' : 'x';
+  }
+
+  struct GroupKeys {
+    int32 i4;
+    int64 i8;
+    DateADT d;
+    const char* t;  // nullptr for NULL
+    std::vector<bool> isnull;
+  };
+
+  static void FillValues(const GroupKeys& keys, Datum* values, bool* isnull) {
+    values[0] = Int32GetDatum(keys.i4);
+    values[1] = Int64GetDatum(keys.i8);
+    values[2] = DateADTGetDatum(keys.d);
+    values[3] = nullptr == keys.t ? 0 :
+        DirectFunctionCall1(textin, CStringGetDatum(keys.t));
+    for (int i = 0; i < kNumCols; i++) {
+      isnull[i] = keys.isnull.empty() ? false : keys.isnull[i];
+    }
+    isnull[3] = isnull[3] || nullptr == keys.t;
+  }
+
+  // Checks that the generated match of input keys against an entry's keys
+  // agrees with the regular match, and returns it.
+  bool Match(const GroupKeys& input, const GroupKeys& entry) {
+    Datum values[kNumCols];
+    bool isnull[kNumCols];
+
+    FillValues(entry, values, isnull);
+    MemTuple entry_tuple = memtuple_form_to(aggstate_->hashslot->tts_mt_bind,
+                                            values, isnull,
+                                            nullptr, nullptr, false);
+
+    ExecClearTuple(input_slot_);
+    FillValues(input, slot_get_values(input_slot_),
+               slot_get_isnull(input_slot_));
+    ExecStoreVirtualTuple(input_slot_);
+
+    bool expected = match_agg_hash_entry(aggstate_, input_slot_, entry_tuple);
+    EXPECT_EQ(expected, match_fn_(aggstate_, input_slot_, entry_tuple));
+    return expected;
+  }
+
+  std::unique_ptr<CodegenManager> manager_;
+  Agg* agg_;
+  AggState* aggstate_;
+  TupleTableSlot* input_slot_;
+  MatchAggHashEntryFn match_fn_;
+};
+
+TEST_F(MatchAggHashEntryCodegenTest, EqualKeysTest) {
+  EXPECT_TRUE(Match({1, 1, 0, "one"}, {1, 1, 0, "one"}));
+  EXPECT_TRUE(Match({-1, -1, -1, ""}, {-1, -1, -1, ""}));
+  EXPECT_TRUE(Match({0, INT64CONST(4294967296), -36524, "group key"},
+                    {0, INT64CONST(4294967296), -36524, "group key"}));
+}
+
+TEST_F(MatchAggHashEntryCodegenTest, DifferentKeysTest) {
+  // Each column in turn differs
+  EXPECT_FALSE(Match({1, 1, 0, "one"}, {-1, 1, 0, "one"}));
+  EXPECT_FALSE(Match({1, 1, 0, "one"}, {1, -1, 0, "one"}));
+  EXPECT_FALSE(Match({1, 1, 0, "one"}, {1, 1, 1, "one"}));
+  EXPECT_FALSE(Match({1, 1, 0, "one"}, {1, 1, 0, "two"}));
+  EXPECT_FALSE(Match({1, 1, 0, "one"}, {1, 1, 0, "one "}));
+
+  // int8 keys that only differ in the high half
+  EXPECT_FALSE(Match({1, INT64CONST(1), 0, "one"},
+                     {1, INT64CONST(4294967297), 0, "one"}));
+}
+
+TEST_F(MatchAggHashEntryCodegenTest, NullKeysTest) {
+  const std::vector<bool> no_nulls = {false, false, false, false};
+  const std::vector<bool> all_nulls = {true, true, true, true};
+
+  // NULLs match each other in group keys
+  EXPECT_TRUE(Match({0, 0, 0, nullptr, all_nulls},
+                    {0, 0, 0, nullptr, all_nulls}));
+  EXPECT_TRUE(Match({1, 0, 0, "one", {false, true, false, false}},
+                    {1, 0, 0, "one", {false, true, false, false}}));
+  EXPECT_TRUE(Match({1, 1, 0, nullptr}, {1, 1, 0, nullptr}));
+
+  // But a NULL doesn't match a value, whichever side it is on
+  for (int i = 0; i < kNumCols; i++) {
+    std::vector<bool> one_null = no_nulls;
+    one_null[i] = true;
+    EXPECT_FALSE(Match({1, 1, 0, "one", one_null},
+                       {1, 1, 0, "one", no_nulls}));
+    EXPECT_FALSE(Match({1, 1, 0, "one", no_nulls},
+                       {1, 1, 0, "one", one_null}));
+  }
+}
+
+}  // namespace gpcodegen
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  AddGlobalTestEnvironment(
+      new gpcodegen::MatchAggHashEntryCodegenTestEnvironment);
+  return RUN_ALL_TESTS();
+}
+
+// EOF
@@ -226,7 +226,8 @@ bool CodegenUtils::Optimize(const OptimizationLevel generic_opt_level,
 }
 
 bool CodegenUtils::PrepareForExecution(const OptimizationLevel cpu_opt_level,
-                                        const bool optimize_for_host_cpu) {
+                                        const bool optimize_for_host_cpu,
+                                        llvm::ObjectCache* object_cache) {
   if (engine_.get() != nullptr) {
     // This method was already called successfully.
     return false;
@@ -237,6 +238,14 @@ bool CodegenUtils::PrepareForExecution(const OptimizationLevel cpu_opt_level,
     return false;
   }
 
+  // The machine code depends on the optimization level as well as on the IR,
+  // so record it in the module for the cache to tell them apart.
+  if (object_cache != nullptr) {
+    module_->addModuleFlag(llvm::Module::Warning,
+                           "gpcodegen.cpu_opt_level",
+                           static_cast<std::uint32_t>(cpu_opt_level));
+  }
+
   llvm::EngineBuilder builder(std::move(module_));
   builder.setEngineKind(llvm::EngineKind::JIT);
   builder.setOptLevel(OptLevelCodegenToLLVM(cpu_opt_level));
@@ -249,6 +258,12 @@ bool CodegenUtils::PrepareForExecution(const OptimizationLevel cpu_opt_level,
     return false;
   }
 
+  // Modules are compiled lazily, so the cache has to be in place before any
+  // function pointer is requested.
+  if (object_cache != nullptr) {
+    engine_->setObjectCache(object_cache);
+  }
+
   // Add auxiliary modules generated by companion tools to the ExecutionEngine.
   for (std::unique_ptr<llvm::Module>& auxiliary_module : auxiliary_modules_) {
     engine_->addModule(std::move(auxiliary_module));
@@ -288,6 +303,14 @@ bool CodegenUtils::PrepareForExecution(const OptimizationLevel cpu_opt_level,
   return true;
 }
 
+bool CodegenUtils::CompileModules() {
+  if (engine_.get() == nullptr) {
+    return false;
+  }
+  engine_->finalizeObject();
+  return true;
+}
+
 void CodegenUtils::PrintUnderlyingModules(llvm::raw_ostream& out) {
   // Print the main module
   out << "==== MAIN MODULE ====" << "\n";
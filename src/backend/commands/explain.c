@@ -26,6 +26,7 @@
 #include "nodes/pg_list.h"
 #include "nodes/print.h"
 #include "optimizer/clauses.h"
+#include "optimizer/optprofile.h"
 #include "optimizer/planner.h"
 #include "optimizer/var.h"
 #include "parser/parsetree.h"
@@ -285,12 +286,22 @@ ExplainOneQuery(Query *query, ExplainStmt *stmt, const char *queryString,
 	else
 	{
 		PlannedStmt *plan;
+		const OptProfile *optProfile = NULL;
+		uint64		optimizations = GetSessionOptProfile()->optimizations;
 
 		/* plan the query */
 		plan = planner(query, 0, params);
 
+		/*
+		 * Show the profile of the optimization if ORCA produced the plan just
+		 * now, rather than taking it from its plan cache.
+		 */
+		if (plan->planGen == PLANGEN_OPTIMIZER &&
+			GetSessionOptProfile()->optimizations != optimizations)
+			optProfile = GetOptProfile();
+
 		/* run it (if needed) and produce output */
-		ExplainOnePlan(plan, params, stmt, queryString, tstate);
+		ExplainOnePlan(plan, params, stmt, queryString, tstate, optProfile);
 	}
 }
 
@@ -357,13 +368,17 @@ ExplainCodegen(PlanState *planstate, TupOutputState *tstate) {
  * query.  This is different from pre-8.3 behavior but seems more useful than
  * not running the query.  No cursor will be created, however.
  *
+ * optProfile is the profile of the ORCA optimization that produced the
+ * plan, shown by EXPLAIN ANALYZE, or NULL if it isn't known.
+ *
  * This is exported because it's called back from prepare.c in the
  * EXPLAIN EXECUTE case, and because an index advisor plugin would need
  * to call it.
  */
 void
 ExplainOnePlan(PlannedStmt *plannedstmt, ParamListInfo params,
-			   ExplainStmt *stmt, const char *queryString, TupOutputState *tstate)
+			   ExplainStmt *stmt, const char *queryString, TupOutputState *tstate,
+			   const OptProfile *optProfile)
 {
 	QueryDesc  *queryDesc;
 	instr_time	starttime;
@@ -681,6 +696,14 @@ ExplainOnePlan(PlannedStmt *plannedstmt, ParamListInfo params,
 	}
 #endif
 
+	/* Display how ORCA's planning time was spent */
+	if (stmt->analyze && optProfile != NULL)
+	{
+		appendStringInfo(&buf, "Optimizer profile: ");
+		AppendOptProfile(&buf, optProfile);
+		appendStringInfoChar(&buf, '\n');
+	}
+
     /*
      * Display final elapsed time.
      */
@@ -730,7 +730,7 @@ ExplainExecuteQuery(ExecuteStmt *execstmt, ExplainStmt *stmt,
 				pstmt->intoClause = execstmt->into;
 			}
 
-			ExplainOnePlan(pstmt, paramLI, stmt, queryString, tstate);
+			ExplainOnePlan(pstmt, paramLI, stmt, queryString, tstate, NULL);
 		}
 		else
 		{
@@ -115,7 +115,8 @@ static void *readHashEntry(AggState *aggstate,
 						   int32 *p_input_size);
 
 /* Methods for hash table */
-static uint32 calc_hash_value(AggState* aggstate, TupleTableSlot *inputslot);
+static bool agg_hash_keys_match(AggState *aggstate, void *input_record,
+								InputRecordType input_type, MemTuple mtup);
 static void spill_hash_table(AggState *aggstate);
 static void expand_hash_table(AggState *aggstate);
 static void init_agg_hash_iter(HashAggTable* ht);
@@ -174,6 +175,70 @@ calc_hash_value(AggState* aggstate, TupleTableSlot *inputslot)
 	return (uint32) hash_any((unsigned char *) hashtable->hashkey_buf, agg->numCols * sizeof(HashKey));
 }
 
+/* Function: agg_hash_keys_match
+ *
+ * Returns true if the group keys of the input record are equal to the group
+ * keys of the given hash table entry. NULLs match in group keys.
+ */
+static bool
+agg_hash_keys_match(AggState *aggstate, void *input_record,
+					InputRecordType input_type, MemTuple mtup)
+{
+	MemTupleBinding *mt_bind = aggstate->hashslot->tts_mt_bind;
+	Agg *agg = (Agg*)aggstate->ss.ps.plan;
+	int i;
+	bool match = true;
+
+	for (i = 0; match && i < agg->numCols; i++)
+	{
+		AttrNumber	att = agg->grpColIdx[i];
+		Datum input_datum = 0;
+		Datum entry_datum = 0;
+		bool input_isNull = false;
+		bool entry_isNull = false;
+
+		switch(input_type)
+		{
+			case INPUT_RECORD_TUPLE:
+				input_datum = slot_getattr((TupleTableSlot *)input_record, att, &input_isNull);
+				break;
+			case INPUT_RECORD_GROUP_AND_AGGS:
+				input_datum = memtuple_getattr((MemTuple)input_record, mt_bind, att, &input_isNull);
+				break;
+			default:
+				insist_log(false, "invalid record type %d", input_type);
+		}
+
+		entry_datum = memtuple_getattr(mtup, mt_bind, att, &entry_isNull);
+
+		if ( !input_isNull && !entry_isNull &&
+			 (DatumGetBool(FunctionCall2(&aggstate->eqfunctions[i],
+										 input_datum,
+										 entry_datum)) ) )
+			continue; /* Both non-NULL and equal. */
+		match = (input_isNull && entry_isNull);/* NULLs match in group keys. */
+	}
+
+	return match;
+}
+
+/* Function: match_agg_hash_entry
+ *
+ * Returns true if the group keys of the input tuple are equal to the group
+ * keys of the given hash table entry.
+ *
+ * The input tuples of the first pass are matched through this function, so
+ * that codegen can replace it with a version specialized to the grouping
+ * columns.
+ */
+bool
+match_agg_hash_entry(AggState *aggstate, TupleTableSlot *inputslot,
+					 void *entry_tuple)
+{
+	return agg_hash_keys_match(aggstate, (void *)inputslot, INPUT_RECORD_TUPLE,
+							   (MemTuple)entry_tuple);
+}
+
 /* Function: adjustInputGroup
  *
  * Adjust the datum pointers stored in the byte array of an input group.
@@ -392,14 +457,12 @@ lookup_agg_hash_entry(AggState *aggstate,
 {
 	HashAggEntry *entry;
 	HashAggTable *hashtable = aggstate->hhashtable;
-	MemTupleBinding *mt_bind = aggstate->hashslot->tts_mt_bind;
 	ExprContext *tmpcontext = aggstate->tmpcontext; /* per input tuple context */
-	Agg *agg = (Agg*)aggstate->ss.ps.plan;
 	MemoryContext oldcxt;
 	unsigned int bucket_idx;
 	uint64 bloomval;			/* bloom filter value */
    
-	Assert(mt_bind != NULL);
+	Assert(aggstate->hashslot->tts_mt_bind != NULL);
 
 	if (p_isnew != NULL)
 		*p_isnew = false;
@@ -420,44 +483,19 @@ lookup_agg_hash_entry(AggState *aggstate,
 	while (entry != NULL)
 	{
 		MemTuple mtup = (MemTuple) entry->tuple_and_aggs;
-		int i;
-		bool match = true;
+		bool match;
 
 		if (hashkey != entry->hashvalue)
 		{
 			entry = entry->next;
 			continue;
 		}
-		
-		for (i = 0; match && i < agg->numCols; i++)
-		{
-			AttrNumber	att = agg->grpColIdx[i];
-			Datum input_datum = 0;
-			Datum entry_datum = 0;
-			bool input_isNull = false;
-			bool entry_isNull = false;
-				
-			switch(input_type)
-			{
-				case INPUT_RECORD_TUPLE:
-					input_datum = slot_getattr((TupleTableSlot *)input_record, att, &input_isNull);
-					break;
-				case INPUT_RECORD_GROUP_AND_AGGS:
-					input_datum = memtuple_getattr((MemTuple)input_record, mt_bind, att, &input_isNull);
-					break;
-				default:
-					insist_log(false, "invalid record type %d", input_type);
-			}
-
-			entry_datum = memtuple_getattr(mtup, mt_bind, att, &entry_isNull);
 
-			if ( !input_isNull && !entry_isNull &&
-				 (DatumGetBool(FunctionCall2(&aggstate->eqfunctions[i],
-											 input_datum,
-											 entry_datum)) ) )
-				continue; /* Both non-NULL and equal. */
-			match = (input_isNull && entry_isNull);/* NULLs match in group keys. */
-		}
+		if (input_type == INPUT_RECORD_TUPLE)
+			match = call_MatchAggHashEntry(aggstate, (TupleTableSlot *)input_record,
+										   (void *)mtup);
+		else
+			match = agg_hash_keys_match(aggstate, input_record, input_type, mtup);
 		
 		/* Break if found an existing matching entry. */
 		if (match)
@@ -870,6 +908,9 @@ agg_hash_initial_pass(AggState *aggstate)
 
 		Gpmon_Incr_Rows_In(GpmonPktFromAggState(aggstate));
 
+		/* the whole input is read in one call, see ExecProcNode() */
+		swap_CompiledFunctions_codegen(&aggstate->ss.ps);
+
 		if (aggstate->hashslot->tts_tupleDescriptor == NULL)
 		{
 			int size;
@@ -889,7 +930,7 @@ agg_hash_initial_pass(AggState *aggstate)
 
 		/* Find or (if there's room) build a hash table entry for the
 		 * input tuple's group. */
-		hashkey = calc_hash_value(aggstate, outerslot);
+		hashkey = call_CalcHashValue(aggstate, outerslot);
 		entry = lookup_agg_hash_entry(aggstate, (void *)outerslot,
 									  INPUT_RECORD_TUPLE, 0, hashkey, &isNew);
 		
@@ -81,6 +81,7 @@
 #include "postgres.h"
 
 #include "executor/executor.h"
+#include "executor/execHHashagg.h"
 #include "executor/instrument.h"
 #include "executor/nodeAgg.h"
 #include "executor/nodeAppend.h"
@@ -232,7 +233,22 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 	StringInfo	codegenManagerName = makeStringInfo();
 
 	appendStringInfo(codegenManagerName, "%s-%d-%d", "execProcnode", node->plan_node_id, node->type);
-	void	   *CodegenManager = CodeGeneratorManagerCreate(codegenManagerName->data);
+
+	/*
+	 * The node processes at least the rows it emits and those of its inputs.
+	 * The estimates are per execution of the node, so nodes on the inner side
+	 * of a nested loop, or in a correlated subplan, are credited with the
+	 * rows of one loop only, and may be left without generated code they
+	 * would have made up for.
+	 */
+	double		codegenRows = node->plan_rows;
+
+	if (node->lefttree != NULL)
+		codegenRows = Max(codegenRows, node->lefttree->plan_rows);
+	if (node->righttree != NULL)
+		codegenRows = Max(codegenRows, node->righttree->plan_rows);
+
+	void	   *CodegenManager = CodeGeneratorManagerCreate(codegenManagerName->data, codegenRows);
 
 	START_CODE_GENERATOR_MANAGER(CodegenManager);
 	{
@@ -647,7 +663,17 @@ ExecInitNode(Plan *node, EState *estate, int eflags)
 			  }
 			  enroll_AdvanceAggregates_codegen(advance_aggregates,
 			        &aggstate->AdvanceAggregates_gen_info.AdvanceAggregates_fn,
-			        aggstate);			}
+			        aggstate);
+			  if (AGG_HASHED == ((Agg *) node)->aggstrategy)
+			  {
+			    enroll_CalcHashValue_codegen(calc_hash_value,
+			          &aggstate->CalcHashValue_gen_info.CalcHashValue_fn,
+			          aggstate);
+			    enroll_MatchAggHashEntry_codegen(match_agg_hash_entry,
+			          &aggstate->MatchAggHashEntry_gen_info.MatchAggHashEntry_fn,
+			          aggstate);
+			  }
+			}
 			}
 			END_MEMORY_ACCOUNT();
 			break;
@@ -993,6 +1019,13 @@ ExecProcNode(PlanState *node)
 
 	CHECK_FOR_INTERRUPTS();
 
+	/*
+	 * Switch to the generated functions once their background compilation is
+	 * done.  Doing it here, on the executor's own thread, swaps them between
+	 * calls to the node.
+	 */
+	swap_CompiledFunctions_codegen(node);
+
 	/*
 	 * Even if we are requested to finish query, Motion has to do its work
 	 * to tell End of Stream message to upper slice.  He will probably get
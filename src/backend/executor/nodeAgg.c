@@ -1326,6 +1326,8 @@ agg_retrieve_direct(AggState *aggstate)
 
 					Gpmon_Incr_Rows_In(GpmonPktFromAggState(aggstate));
 					CheckSendPlanStateGpmonPkt(&aggstate->ss.ps);
+					/* a whole group is read in one call, see ExecProcNode() */
+					swap_CompiledFunctions_codegen(&aggstate->ss.ps);
 					/* set up for next advance aggregates call */
 					tmpcontext->ecxt_outertuple = outerslot;
 
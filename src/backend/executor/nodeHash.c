@@ -126,12 +126,24 @@ MultiExecHash(HashState *node)
 
 		Gpmon_Incr_Rows_In(GpmonPktFromHashState(node));
 		CheckSendPlanStateGpmonPkt(&node->ps);
+		/*
+		 * The whole input is read in one call, see ExecProcNode().  The hash
+		 * value computation is enrolled in the manager of the parent.
+		 */
+		swap_CompiledFunctions_codegen(&node->ps);
+		swap_ManagerCompiledFunctions_codegen(node->hs_hashkeysCodegenManager);
+#ifdef USE_CODEGEN
+		if (hashtable->stats &&
+			node->ExecHashGetHashValue_gen_info.ExecHashGetHashValue_fn != ExecHashGetHashValue)
+			hashtable->stats->codegenrows++;
+#endif
 		/* We have to compute the hash value */
 		econtext->ecxt_innertuple = slot;
 		bool hashkeys_null = false;
 
-		if (ExecHashGetHashValue(node, hashtable, econtext, hashkeys, false,
-								 node->hs_keepnull, &hashvalue, &hashkeys_null))
+		if (call_ExecHashGetHashValue(node, node, hashtable, econtext, hashkeys,
+									  false, node->hs_keepnull, &hashvalue,
+									  &hashkeys_null))
 		{
 			ExecHashTableInsert(node, hashtable, slot, hashvalue);
 		}
@@ -1426,6 +1438,12 @@ ExecHashTableExplainEnd(PlanState *planstate, struct StringInfoData *buf)
                              hashtable->nbatch - stats->nonemptybatches);
         appendStringInfoChar(buf, '\n');
     }
+
+    /* Report the inner rows hashed by generated code. */
+    if (stats->codegenrows > 0)
+        appendStringInfo(buf,
+                         "Generated code hashed " UINT64_FORMAT " inner rows.\n",
+                         stats->codegenrows);
 }                               /* ExecHashTableExplainEnd */
 
 
@@ -610,6 +610,36 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	/* child Hash node needs to evaluate inner hash keys, too */
 	((HashState *) innerPlanState(hjstate))->hashkeys = rclauses;
 
+	/*
+	 * Enroll the hash value computation of both sides, and the evaluation of
+	 * the hash clauses that check the keys of the tuples in a bucket, in the
+	 * code generator manager of this node.
+	 */
+	enroll_ExecHashGetHashValue_codegen(ExecHashGetHashValue,
+			&hjstate->ExecHashGetHashValue_gen_info.ExecHashGetHashValue_fn,
+			hjstate, lclauses, hoperators, true);
+	enroll_ExecHashGetHashValue_codegen(ExecHashGetHashValue,
+			&((HashState *) innerPlanState(hjstate))->ExecHashGetHashValue_gen_info.ExecHashGetHashValue_fn,
+			(HashState *) innerPlanState(hjstate), rclauses, hoperators, false);
+#ifdef USE_CODEGEN
+	/*
+	 * The child builds the whole hash table in one call, so it has to swap in
+	 * the inner hash value computation compiled in the background itself.
+	 */
+	((HashState *) innerPlanState(hjstate))->hs_hashkeysCodegenManager =
+		GetActiveCodeGeneratorManager();
+	foreach(l, hjstate->hashqualclauses)
+	{
+		ExprState  *exprstate = (ExprState *) lfirst(l);
+
+		enroll_ExecEvalExpr_codegen(exprstate->evalfunc,
+									&exprstate->evalfunc,
+									exprstate,
+									hjstate->js.ps.ps_ExprContext,
+									(PlanState *) hjstate);
+	}
+#endif
+
 	hjstate->js.ps.ps_OuterTupleSlot = NULL;
 	hjstate->hj_NeedNewOuter = true;
 	hjstate->hj_MatchedOuter = false;
@@ -726,12 +756,12 @@ ExecHashJoinOuterGetTuple(PlanState *outerNode,
 					(hjstate->js.jointype == JOIN_LASJ) ||
 					(hjstate->js.jointype == JOIN_LASJ_NOTIN) ||
 					hjstate->hj_nonequijoin;
-			if (ExecHashGetHashValue(hashState, hashtable, econtext,
-									 hjstate->hj_OuterHashKeys,
-									 true,		/* outer tuple */
-									 keep_nulls,
-									 hashvalue,
-									 &hashkeys_null))
+			if (call_ExecHashGetHashValue(hjstate, hashState, hashtable, econtext,
+										  hjstate->hj_OuterHashKeys,
+										  true,		/* outer tuple */
+										  keep_nulls,
+										  hashvalue,
+										  &hashkeys_null))
 			{
 				/* remember outer relation is not empty for possible rescan */
 				hjstate->hj_OuterNotEmpty = true;
@@ -19,6 +19,8 @@
 #include "gpopt/config/CConfigParamMapping.h"
 #include "gpopt/xforms/CXform.h"
 
+#include "gpos/memory/CMemoryPoolManager.h"
+
 using namespace gpos;
 using namespace gpdxl;
 using namespace gpopt;
@@ -356,6 +358,126 @@ CConfigParamMapping::SConfigMappingElem CConfigParamMapping::m_elem[] =
 		}
 };
 
+// config params that disable groups of xforms, in addition to optimizer_xforms
+BOOL *CConfigParamMapping::m_rgpfXformParams[] =
+{
+	&optimizer_enable_indexjoin,
+	&optimizer_enable_bitmapscan,
+	&optimizer_enable_outerjoin_to_unionall_rewrite,
+	&optimizer_enable_assert_maxonerow,
+	&optimizer_enable_partial_index,
+	&optimizer_enable_hashjoin,
+	&optimizer_enable_dynamictablescan,
+	&optimizer_enable_tablescan,
+	&optimizer_enable_indexscan
+};
+
+// memory pool holding the cached traceflags, lives as long as the process
+IMemoryPool *CConfigParamMapping::m_pmpCache = NULL;
+
+// config param values the cached traceflags were packed from
+BOOL *CConfigParamMapping::m_rgfCachedParams = NULL;
+
+// traceflags packed from m_rgfCachedParams
+CBitSet *CConfigParamMapping::m_pbsCached = NULL;
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CConfigParamMapping::UlParams
+//
+//	@doc:
+//		Number of config params the traceflags are packed from
+//
+//---------------------------------------------------------------------------
+ULONG
+CConfigParamMapping::UlParams
+	(
+	ULONG ulXforms // number of available xforms
+	)
+{
+	return GPOS_ARRAY_SIZE(m_elem) + ulXforms + GPOS_ARRAY_SIZE(m_rgpfXformParams);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CConfigParamMapping::FParam
+//
+//	@doc:
+//		Current value of the config param at the given position, params
+//		are numbered as mapping elements, xforms, then xform group params
+//
+//---------------------------------------------------------------------------
+BOOL
+CConfigParamMapping::FParam
+	(
+	ULONG ulPos,
+	ULONG ulXforms // number of available xforms
+	)
+{
+	GPOS_ASSERT(ulPos < UlParams(ulXforms));
+
+	if (ulPos < GPOS_ARRAY_SIZE(m_elem))
+	{
+		return *m_elem[ulPos].m_pfParam;
+	}
+	ulPos -= GPOS_ARRAY_SIZE(m_elem);
+
+	if (ulPos < ulXforms)
+	{
+		return optimizer_xforms[ulPos];
+	}
+	ulPos -= ulXforms;
+
+	return *m_rgpfXformParams[ulPos];
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CConfigParamMapping::PbsPackCached
+//
+//	@doc:
+//		Return the GPDB config params packed into a bitset, the bitset is
+//		packed again only if a config param changed since the last call;
+//		caller owns a reference to the returned bitset
+//
+//---------------------------------------------------------------------------
+CBitSet *
+CConfigParamMapping::PbsPackCached
+	(
+	ULONG ulXforms // number of available xforms
+	)
+{
+	const ULONG ulParams = UlParams(ulXforms);
+
+	if (NULL == m_pmpCache)
+	{
+		m_pmpCache = CMemoryPoolManager::Pmpm()->PmpCreate(CMemoryPoolManager::EatTracker, false /* fThreadSafe */, gpos::ullong_max);
+		m_rgfCachedParams = GPOS_NEW_ARRAY(m_pmpCache, BOOL, ulParams);
+	}
+
+	BOOL fChanged = (NULL == m_pbsCached);
+	for (ULONG ul = 0; ul < ulParams; ul++)
+	{
+		BOOL fVal = FParam(ul, ulXforms);
+		if (fVal != m_rgfCachedParams[ul])
+		{
+			m_rgfCachedParams[ul] = fVal;
+			fChanged = true;
+		}
+	}
+
+	if (fChanged)
+	{
+		// reset first, so that a failure while packing forces a repack next time
+		CRefCount::SafeRelease(m_pbsCached);
+		m_pbsCached = NULL;
+		m_pbsCached = PbsPack(m_pmpCache, ulXforms);
+	}
+
+	m_pbsCached->AddRef();
+	return m_pbsCached;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CConfigParamMapping::PbsPack
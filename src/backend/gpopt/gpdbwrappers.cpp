@@ -48,358 +48,6 @@
 
 using namespace gpos;
 
-bool
-gpdb::FBoolFromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetBool(d);
-	}
-	GP_WRAP_END;
-	return false;
-}
-
-Datum
-gpdb::DDatumFromBool
-	(
-	bool b
-	)
-{
-	GP_WRAP_START;
-	{
-		return BoolGetDatum(b);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-char
-gpdb::CCharFromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetChar(d);
-	}
-	GP_WRAP_END;
-	return '\0';
-}
-
-Datum
-gpdb::DDatumFromChar
-	(
-	char c
-	)
-{
-	GP_WRAP_START;
-	{
-		return CharGetDatum(c);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-int8
-gpdb::CInt8FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetInt8(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromInt8
-	(
-	int8 i8
-	)
-{
-	GP_WRAP_START;
-	{
-		return Int8GetDatum(i8);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-uint8
-gpdb::UcUint8FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetUInt8(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromUint8
-	(
-	uint8 ui8
-	)
-{
-	GP_WRAP_START;
-	{
-		return UInt8GetDatum(ui8);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-int16
-gpdb::SInt16FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetInt16(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromInt16
-	(
-	int16 i16
-	)
-{
-	GP_WRAP_START;
-	{
-		return Int16GetDatum(i16);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-uint16
-gpdb::UsUint16FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetUInt16(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromUint16
-	(
-	uint16 ui16
-	)
-{
-	GP_WRAP_START;
-	{
-		return UInt16GetDatum(ui16);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-int32
-gpdb::IInt32FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetInt32(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromInt32
-	(
-	int32 i32
-	)
-{
-	GP_WRAP_START;
-	{
-		return Int32GetDatum(i32);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-uint32
-gpdb::UlUint32FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetUInt32(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromUint32
-	(
-	uint32 ui32
-	)
-{
-	GP_WRAP_START;
-	{
-		return UInt32GetDatum(ui32);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-int64
-gpdb::LlInt64FromDatum
-	(
-	Datum d
-	)
-{
-	Datum d2 = d;
-	GP_WRAP_START;
-	{
-		return DatumGetInt64(d2);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromInt64
-	(
-	int64 i64
-	)
-{
-	int64 ii64 = i64;
-	GP_WRAP_START;
-	{
-		return Int64GetDatum(ii64);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-uint64
-gpdb::UllUint64FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetUInt64(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromUint64
-	(
-	uint64 ui64
-	)
-{
-	GP_WRAP_START;
-	{
-		return UInt64GetDatum(ui64);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Oid
-gpdb::OidFromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetObjectId(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-void *
-gpdb::PvPointerFromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetPointer(d);
-	}
-	GP_WRAP_END;
-	return NULL;
-}
-
-float4
-gpdb::FpFloat4FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetFloat4(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-float8
-gpdb::DFloat8FromDatum
-	(
-	Datum d
-	)
-{
-	GP_WRAP_START;
-	{
-		return DatumGetFloat8(d);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-Datum
-gpdb::DDatumFromPointer
-	(
-	const void *p
-	)
-{
-	GP_WRAP_START;
-	{
-		return PointerGetDatum(p);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
 bool
 gpdb::FAggregateExists
 	(
@@ -444,7 +92,7 @@ gpdb::PvCopyObject
 }
 
 Size
-gpdb::SDatumSize
+gpdb::SDatumSizeChecked
 	(
 	Datum value,
 	bool typByVal,
@@ -996,8 +644,31 @@ gpdb::PnodePartConstraintRel
 {
 	GP_WRAP_START;
 	{
-		/* catalog tables: pg_partition, pg_partition_rule, pg_constraint */
-		return get_relation_part_constraints(oidRel, pplDefaultLevels);
+		PartTableInfoEntry *entry = part_table_info_entry(oidRel);
+
+		if (!entry->partConstraintBuilt)
+		{
+			MemoryContext oldcxt = MemoryContextSwitchTo(part_table_info_context);
+
+			PG_TRY();
+			{
+				/* catalog tables: pg_partition, pg_partition_rule, pg_constraint */
+				entry->defaultLevels = NIL;
+				entry->partConstraint = get_relation_part_constraints(oidRel, &entry->defaultLevels);
+			}
+			PG_CATCH();
+			{
+				MemoryContextSwitchTo(oldcxt);
+				PG_RE_THROW();
+			}
+			PG_END_TRY();
+
+			MemoryContextSwitchTo(oldcxt);
+			entry->partConstraintBuilt = true;
+		}
+
+		*pplDefaultLevels = entry->defaultLevels;
+		return entry->partConstraint;
 	}
 	GP_WRAP_END;
 	return NULL;
@@ -1417,6 +1088,26 @@ gpdb::PlAppendElement
 	return NIL;
 }
 
+List *
+gpdb::PlAppendElements
+	(
+	List *plist,
+	void **rgpvElems,
+	int iElems
+	)
+{
+	GP_WRAP_START;
+	{
+		for (int i = 0; i < iElems; i++)
+		{
+			plist = lappend(plist, rgpvElems[i]);
+		}
+		return plist;
+	}
+	GP_WRAP_END;
+	return NIL;
+}
+
 List *
 gpdb::PlAppendInt
 	(
@@ -1492,120 +1183,33 @@ gpdb::PlPrependOid
 	return NIL;
 }
 
-List *
-gpdb::PlConcat
-	(
-	List *list1,
-	List *list2
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_concat(list1, list2);
-	}
-	GP_WRAP_END;
-	return NIL;
-}
-
-List *
-gpdb::PlCopy
-	(
-	List *list
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_copy(list);
-	}
-	GP_WRAP_END;
-	return NIL;
-}
-
-ListCell *
-gpdb::PlcListHead
-	(
-	List *l
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_head(l);
-	}
-	GP_WRAP_END;
-	return NULL;
-}
-
-ListCell *
-gpdb::PlcListTail
-	(
-	List *l
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_tail(l);
-	}
-	GP_WRAP_END;
-	return NULL;
-}
-
-uint32
-gpdb::UlListLength
-	(
-	List *l
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_length(l);
-	}
-	GP_WRAP_END;
-	return 0;
-}
-
-void *
-gpdb::PvListNth
-	(
-	List *list,
-	int n
-	)
-{
-	GP_WRAP_START;
-	{
-		return list_nth(list, n);
-	}
-	GP_WRAP_END;
-	return NULL;
-}
-
-int
-gpdb::IListNth
+List *
+gpdb::PlConcat
 	(
-	List *list,
-	int n
+	List *list1,
+	List *list2
 	)
 {
 	GP_WRAP_START;
 	{
-		return list_nth_int(list, n);
+		return list_concat(list1, list2);
 	}
 	GP_WRAP_END;
-	return 0;
+	return NIL;
 }
 
-Oid
-gpdb::OidListNth
+List *
+gpdb::PlCopy
 	(
-	List *list,
-	int n
+	List *list
 	)
 {
 	GP_WRAP_START;
 	{
-		return list_nth_oid(list, n);
+		return list_copy(list);
 	}
 	GP_WRAP_END;
-	return 0;
+	return NIL;
 }
 
 bool
@@ -2385,6 +1989,59 @@ gpdb::PlRelationIndexes
 	return NIL;
 }
 
+/*
+ * Logical indexes and part constraints of the partitioned tables looked up by
+ * the current task. Building either walks every leaf of the hierarchy, and
+ * the relcache translator needs them once for the root and once more for
+ * each of its indexes, so they are remembered until ResetPartTableInfo().
+ * They are built in a memory context of their own, which that deletes.
+ */
+typedef struct PartTableInfoEntry
+{
+	Oid			rootOid;
+	bool		logicalIndexesBuilt;
+	LogicalIndexes *logicalIndexes;	/* NULL if the table has no indexes */
+	bool		partConstraintBuilt;
+	Node	   *partConstraint;
+	List	   *defaultLevels;	/* levels with a default part */
+} PartTableInfoEntry;
+
+static MemoryContext part_table_info_context = NULL;
+static List *part_table_info = NIL;
+
+/* find the entry of the given table, or add an empty one */
+static PartTableInfoEntry *
+part_table_info_entry(Oid rootOid)
+{
+	PartTableInfoEntry *entry;
+	MemoryContext oldcxt;
+	ListCell   *lc;
+
+	foreach(lc, part_table_info)
+	{
+		entry = (PartTableInfoEntry *) lfirst(lc);
+		if (entry->rootOid == rootOid)
+			return entry;
+	}
+
+	if (NULL == part_table_info_context)
+	{
+		part_table_info_context = AllocSetContextCreate(TopMemoryContext,
+														"ORCA partitioned table info",
+														ALLOCSET_DEFAULT_MINSIZE,
+														ALLOCSET_DEFAULT_INITSIZE,
+														ALLOCSET_DEFAULT_MAXSIZE);
+	}
+
+	oldcxt = MemoryContextSwitchTo(part_table_info_context);
+	entry = (PartTableInfoEntry *) palloc0(sizeof(PartTableInfoEntry));
+	entry->rootOid = rootOid;
+	part_table_info = lappend(part_table_info, entry);
+	MemoryContextSwitchTo(oldcxt);
+
+	return entry;
+}
+
 LogicalIndexes *
 gpdb::Plgidx
 	(
@@ -2393,13 +2050,45 @@ gpdb::Plgidx
 {
 	GP_WRAP_START;
 	{
-		/* catalog tables: pg_partition, pg_partition_rule, pg_index */
-		return BuildLogicalIndexInfo(oid);
+		PartTableInfoEntry *entry = part_table_info_entry(oid);
+
+		if (!entry->logicalIndexesBuilt)
+		{
+			MemoryContext oldcxt = MemoryContextSwitchTo(part_table_info_context);
+
+			PG_TRY();
+			{
+				/* catalog tables: pg_partition, pg_partition_rule, pg_index */
+				entry->logicalIndexes = BuildLogicalIndexInfo(oid);
+			}
+			PG_CATCH();
+			{
+				MemoryContextSwitchTo(oldcxt);
+				PG_RE_THROW();
+			}
+			PG_END_TRY();
+
+			MemoryContextSwitchTo(oldcxt);
+			entry->logicalIndexesBuilt = true;
+		}
+
+		return entry->logicalIndexes;
 	}
 	GP_WRAP_END;
 	return NULL;
 }
 
+void
+gpdb::ResetPartTableInfo()
+{
+	part_table_info = NIL;
+	if (NULL != part_table_info_context)
+	{
+		MemoryContextDelete(part_table_info_context);
+		part_table_info_context = NULL;
+	}
+}
+
 LogicalIndexInfo *
 gpdb::Plgidxinfo
 	(
@@ -2822,6 +2511,21 @@ gpdb::PexprEvaluate
 	return NULL;
 }
 
+bool
+gpdb::FContainsVolatileFunctions
+	(
+	Node *pnode
+	)
+{
+	GP_WRAP_START;
+	{
+		/* catalog tables: pg_proc */
+		return contain_volatile_functions(pnode);
+	}
+	GP_WRAP_END;
+	return true;
+}
+
 // interpret the value of "With oids" option from a list of defelems
 bool
 gpdb::FInterpretOidsOption
@@ -2927,16 +2631,24 @@ gpdb::UlLeafPartitions
 }
 
 /*
- * To detect changes to catalog tables that require resetting the Metadata
- * Cache, we use the normal PostgreSQL catalog cache invalidation mechanism.
- * We register a callback to a cache on all the catalog tables that contain
- * information that's contained in the ORCA metadata cache.
-
- * There is no fine-grained mechanism in the metadata cache for invalidating
- * individual entries ATM, so we just blow the whole cache whenever anything
- * changes. The callback simply increments a counter. Whenever we start
- * planning a query, we check the counter to see if it has changed since the
- * last planned query, and reset the whole cache if it has.
+ * To detect changes to catalog tables that require invalidating entries of
+ * the Metadata Cache, we use the normal PostgreSQL catalog cache invalidation
+ * mechanism. We register a callback to a cache on all the catalog tables that
+ * contain information that's contained in the ORCA metadata cache.
+ *
+ * Whenever an object is fetched into the metadata cache, the translator
+ * registers the catalog entries it was built from, identified by the syscache
+ * id and the hash value of the syscache key (see RegisterMDCacheDependency()).
+ * The callbacks just remember the invalidated syscache entries and relations.
+ * Whenever we start planning a query, the pending invalidations are mapped
+ * back to the registered objects, and only those are evicted from the cache.
+ * The same dependencies are stored along with objects in the metadata cache
+ * shared by all backends (see utils/cache/sharedmdcache.c).
+ *
+ * Changes to catalog tables whose syscache keys can't be mapped to individual
+ * objects (e.g. pg_cast, pg_amop and partitioning catalogs), a cache reset
+ * request, or more invalidations than we can remember, still blow the whole
+ * cache.
  *
  * To make sure we've covered all catalog tables that contain information
  * that's stored in the metadata cache, there are "catalog tables: xxx"
@@ -2945,38 +2657,114 @@ gpdb::UlLeafPartitions
  * anything fetched via the wrapper functions in this file can end up in the
  * metadata cache and hence need to have an invalidation callback registered.
  */
-static bool mdcache_invalidation_counter_registered = false;
-static int64 mdcache_invalidation_counter = 0;
-static int64 last_mdcache_invalidation_counter = 0;
+#define MDCACHE_MAX_PENDING_INVALIDATIONS	1024
+#define MDCACHE_MAX_DEPENDENCIES			65536
+
+typedef struct MDCacheDependencyKey
+{
+	int			cacheId;		/* syscache id, or MDCACHE_RELCACHE_ID */
+	uint32		hashValue;		/* hash value of syscache key, or relation oid */
+} MDCacheDependencyKey;
+
+typedef struct MDCacheDependencyEntry
+{
+	MDCacheDependencyKey key;
+	List	   *objects;		/* list of gpdb::SMDCacheObject */
+} MDCacheDependencyEntry;
+
+static bool mdcache_invalidation_callbacks_registered = false;
+static bool mdcache_needs_reset = false;
+
+/* invalidations received since the last planned query */
+static MDCacheDependencyKey mdcache_pending_invalidations[MDCACHE_MAX_PENDING_INVALIDATIONS];
+static int mdcache_num_pending_invalidations = 0;
+
+/* catalog entries the cached objects are built from, lives in mdcache_context */
+static MemoryContext mdcache_context = NULL;
+static HTAB *mdcache_dependencies = NULL;
+
+static gpdb::SMDCacheStats mdcache_stats;
+
+/*
+ * Dependencies of the objects being translated for the shared metadata cache.
+ * Translating an object may fetch other objects, which are translated in the
+ * middle of it, so there is one frame for each translation in progress, and
+ * dependencies are collected in the frame of the innermost one.
+ */
+#define MDCACHE_MAX_NESTED_TRANSLATIONS		32
+
+typedef struct MDCacheCollectedDeps
+{
+	SharedMDCacheDep deps[SHARED_MDCACHE_MAX_DEPS];
+	int			ndeps;
+	bool		overflow;		/* too many dependencies to share the object */
+} MDCacheCollectedDeps;
+
+static MDCacheCollectedDeps mdcache_collected_deps[MDCACHE_MAX_NESTED_TRANSLATIONS];
+static int mdcache_translation_depth = 0;
+
+/*
+ * Callbacks are called while processing invalidation messages, so they must
+ * not allocate memory or throw errors.
+ */
+static void
+mdcache_add_pending_invalidation(int cacheid, uint32 hashValue)
+{
+	if (mdcache_num_pending_invalidations >= MDCACHE_MAX_PENDING_INVALIDATIONS)
+	{
+		mdcache_needs_reset = true;
+		return;
+	}
+
+	mdcache_pending_invalidations[mdcache_num_pending_invalidations].cacheId = cacheid;
+	mdcache_pending_invalidations[mdcache_num_pending_invalidations].hashValue = hashValue;
+	mdcache_num_pending_invalidations++;
+}
 
 static void
-mdsyscache_invalidation_counter_callback(Datum arg, int cacheid,  ItemPointer tuplePtr)
+mdsyscache_invalidation_callback(Datum arg, int cacheid, ItemPointer tuplePtr,
+								 uint32 hashValue)
 {
-	mdcache_invalidation_counter++;
+	bool		fine_grained = DatumGetBool(arg);
+
+	if (NULL == tuplePtr || !fine_grained)
+		mdcache_needs_reset = true;
+	else
+		mdcache_add_pending_invalidation(cacheid, hashValue);
 }
 
 static void
-mdrelcache_invalidation_counter_callback(Datum arg, Oid relid)
+mdrelcache_invalidation_callback(Datum arg, Oid relid)
 {
-	mdcache_invalidation_counter++;
+	if (!OidIsValid(relid))
+		mdcache_needs_reset = true;
+	else
+		mdcache_add_pending_invalidation(MDCACHE_RELCACHE_ID, relid);
 }
 
 static void
 register_mdcache_invalidation_callbacks(void)
 {
-	/* These are all the catalog tables that we care about. */
-	int			metadata_caches[] = {
+	/*
+	 * Catalog tables whose syscache key is the OID of a single metadata
+	 * object (or a relation column), registered by the translator.
+	 */
+	int			fine_grained_caches[] = {
 		AGGFNOID,			/* pg_aggregate */
-		AMOPOPID,			/* pg_amop */
-		CASTSOURCETARGET,	/* pg_cast */
 		CONSTROID,			/* pg_constraint */
 		OPEROID,			/* pg_operator */
-		OPFAMILYOID,		/* pg_opfamily */
-		PARTOID,			/* pg_partition */
-		PARTRULEOID,		/* pg_partition_rule */
 		STATRELATT,			/* pg_statistics */
 		TYPEOID,			/* pg_type */
 		PROCOID,			/* pg_proc */
+	};
+
+	/* Catalog tables whose changes reset the whole cache. */
+	int			other_caches[] = {
+		AMOPOPID,			/* pg_amop */
+		CASTSOURCETARGET,	/* pg_cast */
+		OPFAMILYOID,		/* pg_opfamily */
+		PARTOID,			/* pg_partition */
+		PARTRULEOID,		/* pg_partition_rule */
 
 		/*
 		 * lookup_type_cache() will also access pg_opclass, via GetDefaultOpClass(),
@@ -3017,19 +2805,127 @@ register_mdcache_invalidation_callbacks(void)
 	};
 	unsigned int i;
 
-	for (i = 0; i < lengthof(metadata_caches); i++)
+	for (i = 0; i < lengthof(fine_grained_caches); i++)
+	{
+		CacheRegisterSyscacheCallback(fine_grained_caches[i],
+									  &mdsyscache_invalidation_callback,
+									  BoolGetDatum(true));
+	}
+
+	for (i = 0; i < lengthof(other_caches); i++)
 	{
-		CacheRegisterSyscacheCallback(metadata_caches[i],
-									  &mdsyscache_invalidation_counter_callback,
-									  (Datum) 0);
+		CacheRegisterSyscacheCallback(other_caches[i],
+									  &mdsyscache_invalidation_callback,
+									  BoolGetDatum(false));
 	}
 
 	/* also register the relcache callback */
-	CacheRegisterRelcacheCallback(&mdrelcache_invalidation_counter_callback,
+	CacheRegisterRelcacheCallback(&mdrelcache_invalidation_callback,
 								  (Datum) 0);
 }
 
-// Has there been any catalog changes since last call?
+/* forget all registered dependencies, called when the whole cache is reset */
+static void
+reset_mdcache_dependencies(void)
+{
+	HASHCTL		ctl;
+
+	if (NULL == mdcache_context)
+	{
+		mdcache_context = AllocSetContextCreate(TopMemoryContext,
+												"ORCA metadata cache dependencies",
+												ALLOCSET_DEFAULT_MINSIZE,
+												ALLOCSET_DEFAULT_INITSIZE,
+												ALLOCSET_DEFAULT_MAXSIZE);
+	}
+	else
+	{
+		MemoryContextReset(mdcache_context);
+	}
+
+	MemSet(&ctl, 0, sizeof(ctl));
+	ctl.keysize = sizeof(MDCacheDependencyKey);
+	ctl.entrysize = sizeof(MDCacheDependencyEntry);
+	ctl.hash = tag_hash;
+	ctl.hcxt = mdcache_context;
+	mdcache_dependencies = hash_create("ORCA metadata cache dependencies",
+									   1024,
+									   &ctl,
+									   HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+	mdcache_num_pending_invalidations = 0;
+}
+
+/* track the object as built from the given catalog entry, unless it already is */
+static void
+add_mdcache_dependency(const MDCacheDependencyKey *key, const gpdb::SMDCacheObject *pmdcobj)
+{
+	MDCacheDependencyEntry *entry;
+	MemoryContext oldcxt;
+	ListCell   *lc;
+	bool		found;
+
+	/* the cache is built before the callbacks are registered, nothing to track */
+	if (NULL == mdcache_dependencies)
+		return;
+
+	entry = (MDCacheDependencyEntry *) hash_search(mdcache_dependencies,
+												   key, HASH_ENTER, &found);
+	if (!found)
+		entry->objects = NIL;
+
+	/* objects fetched again after an eviction are registered again */
+	foreach(lc, entry->objects)
+	{
+		gpdb::SMDCacheObject *obj = (gpdb::SMDCacheObject *) lfirst(lc);
+
+		if (obj->m_ekind == pmdcobj->m_ekind &&
+			obj->m_oid == pmdcobj->m_oid &&
+			obj->m_oidSecond == pmdcobj->m_oidSecond &&
+			obj->m_ulPos == pmdcobj->m_ulPos)
+			return;
+	}
+
+	oldcxt = MemoryContextSwitchTo(mdcache_context);
+	gpdb::SMDCacheObject *obj = (gpdb::SMDCacheObject *) palloc(sizeof(gpdb::SMDCacheObject));
+	memcpy(obj, pmdcobj, sizeof(gpdb::SMDCacheObject));
+	entry->objects = lappend(entry->objects, obj);
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/* append the objects registered for the given catalog entry, and forget them */
+static List *
+pop_mdcache_dependency(List *objects, int cacheid, uint32 hashValue)
+{
+	MDCacheDependencyKey key;
+	MDCacheDependencyEntry *entry;
+	ListCell   *lc;
+
+	MemSet(&key, 0, sizeof(key));
+	key.cacheId = cacheid;
+	key.hashValue = hashValue;
+
+	entry = (MDCacheDependencyEntry *) hash_search(mdcache_dependencies,
+												   &key, HASH_FIND, NULL);
+	if (NULL == entry)
+		return objects;
+
+	foreach(lc, entry->objects)
+	{
+		gpdb::SMDCacheObject *obj = (gpdb::SMDCacheObject *) palloc(sizeof(gpdb::SMDCacheObject));
+
+		memcpy(obj, lfirst(lc), sizeof(gpdb::SMDCacheObject));
+		objects = lappend(objects, obj);
+	}
+
+	list_free_deep(entry->objects);
+	hash_search(mdcache_dependencies, &key, HASH_REMOVE, NULL);
+
+	return objects;
+}
+
+// Has there been any catalog changes since last call that require resetting
+// the whole cache?
 bool
 gpdb::FMDCacheNeedsReset
 		(
@@ -3038,22 +2934,230 @@ gpdb::FMDCacheNeedsReset
 {
 	GP_WRAP_START;
 	{
-		if (!mdcache_invalidation_counter_registered)
+		if (!mdcache_invalidation_callbacks_registered)
 		{
 			register_mdcache_invalidation_callbacks();
-			mdcache_invalidation_counter_registered = true;
+			reset_mdcache_dependencies();
+			mdcache_invalidation_callbacks_registered = true;
 		}
-		if (last_mdcache_invalidation_counter == mdcache_invalidation_counter)
+
+		/* translations interrupted by errors in earlier queries left their frames */
+		mdcache_translation_depth = 0;
+
+		if (!mdcache_needs_reset &&
+			hash_get_num_entries(mdcache_dependencies) < MDCACHE_MAX_DEPENDENCIES)
 			return false;
+
+		mdcache_needs_reset = false;
+		reset_mdcache_dependencies();
+		mdcache_stats.m_ullResets++;
+		return true;
+	}
+	GP_WRAP_END;
+
+	return true;
+}
+
+void
+gpdb::RegisterMDCacheDependency
+	(
+	int iCacheId,
+	Datum key1,
+	Datum key2,
+	const SMDCacheObject *pmdcobj
+	)
+{
+	GP_WRAP_START;
+	{
+		MDCacheDependencyKey key;
+
+		MemSet(&key, 0, sizeof(key));
+		key.cacheId = iCacheId;
+		if (MDCACHE_RELCACHE_ID == iCacheId)
+			key.hashValue = DatumGetObjectId(key1);
 		else
+			key.hashValue = GetSysCacheHashValue2(iCacheId, key1, key2);
+
+		/* collect it for the shared metadata cache, in the innermost translation */
+		if (0 < mdcache_translation_depth &&
+			mdcache_translation_depth <= MDCACHE_MAX_NESTED_TRANSLATIONS)
 		{
-			last_mdcache_invalidation_counter = mdcache_invalidation_counter;
-			return true;
+			MDCacheCollectedDeps *collected = &mdcache_collected_deps[mdcache_translation_depth - 1];
+
+			if (collected->ndeps < SHARED_MDCACHE_MAX_DEPS)
+			{
+				collected->deps[collected->ndeps].cacheId = key.cacheId;
+				collected->deps[collected->ndeps].hashValue = key.hashValue;
+				collected->ndeps++;
+			}
+			else
+			{
+				collected->overflow = true;
+			}
 		}
+
+		add_mdcache_dependency(&key, pmdcobj);
+		return;
 	}
 	GP_WRAP_END;
+}
 
-	return true;
+void
+gpdb::ResetMDCacheDependencies
+		(
+			void
+		)
+{
+	GP_WRAP_START;
+	{
+		reset_mdcache_dependencies();
+		return;
+	}
+	GP_WRAP_END;
+}
+
+List *
+gpdb::PlMDCacheInvalidatedObjects
+		(
+			void
+		)
+{
+	GP_WRAP_START;
+	{
+		List	   *objects = NIL;
+		int			i;
+
+		for (i = 0; i < mdcache_num_pending_invalidations; i++)
+		{
+			int			cacheid = mdcache_pending_invalidations[i].cacheId;
+			uint32		hashValue = mdcache_pending_invalidations[i].hashValue;
+
+			objects = pop_mdcache_dependency(objects, cacheid, hashValue);
+		}
+
+		mdcache_num_pending_invalidations = 0;
+		return objects;
+	}
+	GP_WRAP_END;
+
+	return NIL;
+}
+
+gpdb::SMDCacheStats *
+gpdb::PmdcstatsMDCache
+		(
+			void
+		)
+{
+	return &mdcache_stats;
+}
+
+bool
+gpdb::FSharedMDCacheEnabled
+		(
+			void
+		)
+{
+	GP_WRAP_START;
+	{
+		return SharedMDCacheEnabled();
+	}
+	GP_WRAP_END;
+
+	return false;
+}
+
+uint64
+gpdb::UllSharedMDCacheSnapshot
+		(
+			void
+		)
+{
+	GP_WRAP_START;
+	{
+		return SharedMDCacheSnapshot();
+	}
+	GP_WRAP_END;
+
+	return 0;
+}
+
+char *
+gpdb::SzSharedMDCacheLookup
+	(
+	const char *szKey,
+	const SMDCacheObject *pmdcobj
+	)
+{
+	GP_WRAP_START;
+	{
+		SharedMDCacheDep deps[SHARED_MDCACHE_MAX_DEPS];
+		int			ndeps = 0;
+		char	   *szValue = SharedMDCacheLookup(szKey, deps, &ndeps);
+
+		if (NULL == szValue)
+			return NULL;
+
+		/* track the object as if it had been translated by this backend */
+		for (int i = 0; i < ndeps; i++)
+		{
+			MDCacheDependencyKey key;
+
+			MemSet(&key, 0, sizeof(key));
+			key.cacheId = deps[i].cacheId;
+			key.hashValue = deps[i].hashValue;
+			add_mdcache_dependency(&key, pmdcobj);
+		}
+
+		return szValue;
+	}
+	GP_WRAP_END;
+
+	return NULL;
+}
+
+void
+gpdb::BeginMDCacheDependencies
+		(
+			void
+		)
+{
+	mdcache_translation_depth++;
+	if (mdcache_translation_depth <= MDCACHE_MAX_NESTED_TRANSLATIONS)
+	{
+		mdcache_collected_deps[mdcache_translation_depth - 1].ndeps = 0;
+		mdcache_collected_deps[mdcache_translation_depth - 1].overflow = false;
+	}
+}
+
+void
+gpdb::SharedMDCacheInsert
+	(
+	const char *szKey,
+	const char *szValue,
+	uint64 ullSnapshot
+	)
+{
+	GP_WRAP_START;
+	{
+		/* the frames were dropped by an optimization nested in the translation */
+		if (0 == mdcache_translation_depth)
+			return;
+
+		/* objects whose dependencies weren't all collected can't be validated */
+		if (mdcache_translation_depth <= MDCACHE_MAX_NESTED_TRANSLATIONS)
+		{
+			MDCacheCollectedDeps *collected = &mdcache_collected_deps[mdcache_translation_depth - 1];
+
+			if (!collected->overflow)
+				::SharedMDCacheInsert(szKey, szValue, ullSnapshot,
+									  collected->deps, collected->ndeps);
+		}
+
+		mdcache_translation_depth--;
+		return;
+	}
+	GP_WRAP_END;
 }
 
 // EOF
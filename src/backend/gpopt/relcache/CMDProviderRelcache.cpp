@@ -18,6 +18,7 @@
 #include "gpopt/relcache/CMDProviderRelcache.h"
 #include "gpopt/translate/CTranslatorRelcacheToDXL.h"
 #include "gpopt/mdcache/CMDAccessor.h"
+#include "gpopt/gpdbwrappers.h"
 
 #include "naucrates/dxl/CDXLUtils.h"
 
@@ -40,7 +41,8 @@ CMDProviderRelcache::CMDProviderRelcache
 	IMemoryPool *pmp
 	)
 	:
-	m_pmp(pmp)
+	m_pmp(pmp),
+	m_ulFetchDepth(0)
 {
 	GPOS_ASSERT(NULL != m_pmp);
 }
@@ -50,7 +52,8 @@ CMDProviderRelcache::CMDProviderRelcache
 //		CMDProviderRelcache::PstrObject
 //
 //	@doc:
-//		Returns the DXL of the requested object in the provided memory pool
+//		Returns the DXL of the requested object in the provided memory pool,
+//		and adds the time it took to the optimization profile
 //
 //---------------------------------------------------------------------------
 CWStringBase *
@@ -62,6 +65,91 @@ CMDProviderRelcache::PstrObject
 	)
 	const
 {
+	// only the outermost fetch is timed, so that the time of nested fetches
+	// isn't counted twice
+	if (0 < m_ulFetchDepth)
+	{
+		return PstrFetchObject(pmp, pmda, pmdid);
+	}
+
+	instr_time starttime;
+	INSTR_TIME_SET_CURRENT(starttime);
+
+	// an error aborts the whole task, along with this provider
+	m_ulFetchDepth++;
+	CWStringBase *pstr = PstrFetchObject(pmp, pmda, pmdid);
+	m_ulFetchDepth--;
+
+	instr_time endtime;
+	INSTR_TIME_SET_CURRENT(endtime);
+	INSTR_TIME_SUBTRACT(endtime, starttime);
+	GetOptProfile()->mdFetchTime += INSTR_TIME_GET_MILLISEC(endtime);
+
+	return pstr;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDProviderRelcache::PstrFetchObject
+//
+//	@doc:
+//		Returns the DXL of the requested object in the provided memory pool.
+//		Objects already translated by other backends are taken from the
+//		shared metadata cache, if it is enabled
+//
+//---------------------------------------------------------------------------
+CWStringBase *
+CMDProviderRelcache::PstrFetchObject
+	(
+	IMemoryPool *pmp,
+	CMDAccessor *pmda,
+	IMDId *pmdid
+	)
+	const
+{
+	// objects are only requested from the provider on metadata cache misses
+	gpdb::PmdcstatsMDCache()->m_ullMisses++;
+
+	if (!gpdb::FSharedMDCacheEnabled())
+	{
+		IMDCacheObject *pimdobj = CTranslatorRelcacheToDXL::Pimdobj(pmp, pmda, pmdid);
+
+		GPOS_ASSERT(NULL != pimdobj);
+
+		CWStringDynamic *pstr = CDXLUtils::PstrSerializeMDObj(m_pmp, pimdobj, true /*fSerializeHeaders*/, false /*findent*/);
+
+		// cleanup DXL object
+		pimdobj->Release();
+
+		return pstr;
+	}
+
+	// the snapshot must be taken before the lookup, which accepts pending
+	// invalidations first
+	ULLONG ullSnapshot = gpdb::UllSharedMDCacheSnapshot();
+
+	// objects taken from the shared cache are evicted from the local cache
+	// by changes to the same catalog entries as the ones translated here
+	gpdb::SMDCacheObject mdcobj;
+	CTranslatorRelcacheToDXL::InitMDCacheObject(pmdid, &mdcobj);
+
+	CHAR *szKey = CDXLUtils::SzFromWsz(pmp, pmdid->Wsz());
+	CHAR *szDXL = gpdb::SzSharedMDCacheLookup(szKey, &mdcobj);
+	if (NULL != szDXL)
+	{
+		CWStringDynamic *pstr = CDXLUtils::PstrFromSz(m_pmp, szDXL);
+
+		gpdb::GPDBFree(szDXL);
+		GPOS_DELETE_ARRAY(szKey);
+		gpdb::PmdcstatsMDCache()->m_ullSharedHits++;
+
+		return pstr;
+	}
+
+	// objects fetched while translating this one collect their dependencies
+	// separately
+	gpdb::BeginMDCacheDependencies();
+
 	IMDCacheObject *pimdobj = CTranslatorRelcacheToDXL::Pimdobj(pmp, pmda, pmdid);
 
 	GPOS_ASSERT(NULL != pimdobj);
@@ -71,6 +159,12 @@ CMDProviderRelcache::PstrObject
 	// cleanup DXL object
 	pimdobj->Release();
 
+	szDXL = CDXLUtils::SzFromWsz(pmp, pstr->Wsz());
+	gpdb::SharedMDCacheInsert(szKey, szDXL, ullSnapshot);
+
+	GPOS_DELETE_ARRAY(szDXL);
+	GPOS_DELETE_ARRAY(szKey);
+
 	return pstr;
 }
 
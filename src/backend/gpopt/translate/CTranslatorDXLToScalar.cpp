@@ -1296,7 +1296,9 @@ CTranslatorDXLToScalar::PminmaxFromDXLNodeScMinMax
 //		CTranslatorDXLToScalar::PlistTranslateScalarChildren
 //
 //	@doc:
-//		Translate children of DXL node, and add them to list
+//		Translate children of DXL node, and add them to list; the children
+//		are appended in one wrapped call, as arrays and IN-lists can have
+//		many thousands of them
 //
 //---------------------------------------------------------------------------
 List *
@@ -1307,16 +1309,22 @@ CTranslatorDXLToScalar::PlistTranslateScalarChildren
 	CMappingColIdVar *pmapcidvar
 	)
 {
-	List *plistNew = plist;
-
 	const ULONG ulArity = pdxln->UlArity();
+	if (0 == ulArity)
+	{
+		return plist;
+	}
+
+	void **rgpvChildren = GPOS_NEW_ARRAY(m_pmp, void *, ulArity);
 	for (ULONG ul = 0; ul < ulArity; ul++)
 	{
 		CDXLNode *pdxlnChild = (*pdxln)[ul];
-		Expr *pexprChild = PexprFromDXLNodeScalar(pdxlnChild, pmapcidvar);
-		plistNew = gpdb::PlAppendElement(plistNew, pexprChild);
+		rgpvChildren[ul] = PexprFromDXLNodeScalar(pdxlnChild, pmapcidvar);
 	}
 
+	List *plistNew = gpdb::PlAppendElements(plist, rgpvChildren, (int) ulArity);
+	GPOS_DELETE_ARRAY(rgpvChildren);
+
 	return plistNew;
 }
 
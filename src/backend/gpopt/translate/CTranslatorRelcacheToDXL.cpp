@@ -136,9 +136,201 @@ CTranslatorRelcacheToDXL::Pimdobj
 		GPOS_RAISE(gpdxl::ExmaMD, gpdxl::ExmiMDCacheEntryNotFound, pmdid->Wsz());
 	}
 
+	RegisterMDCacheDependencies(pmda, pmdid, pmdcacheobj);
+
 	return pmdcacheobj;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CTranslatorRelcacheToDXL::InitMDCacheObject
+//
+//	@doc:
+//		Identify the metadata cache object of the given metadata id, the way
+//		its catalog dependencies are registered
+//
+//---------------------------------------------------------------------------
+void
+CTranslatorRelcacheToDXL::InitMDCacheObject
+	(
+	IMDId *pmdid,
+	gpdb::SMDCacheObject *pmdcobj
+	)
+{
+	pmdcobj->m_ekind = gpdb::SMDCacheObject::EmdcoGPDB;
+	pmdcobj->m_oid = InvalidOid;
+	pmdcobj->m_oidSecond = InvalidOid;
+	pmdcobj->m_ulPos = 0;
+
+	switch (pmdid->Emdidt())
+	{
+		case IMDId::EmdidGPDB:
+			pmdcobj->m_oid = CMDIdGPDB::PmdidConvert(pmdid)->OidObjectId();
+			break;
+
+		case IMDId::EmdidRelStats:
+		{
+			IMDId *pmdidRel = CMDIdRelStats::PmdidConvert(pmdid)->PmdidRel();
+
+			pmdcobj->m_ekind = gpdb::SMDCacheObject::EmdcoRelStats;
+			pmdcobj->m_oid = CMDIdGPDB::PmdidConvert(pmdidRel)->OidObjectId();
+			break;
+		}
+
+		case IMDId::EmdidColStats:
+		{
+			CMDIdColStats *pmdidColStats = CMDIdColStats::PmdidConvert(pmdid);
+
+			pmdcobj->m_ekind = gpdb::SMDCacheObject::EmdcoColStats;
+			pmdcobj->m_oid = CMDIdGPDB::PmdidConvert(pmdidColStats->PmdidRel())->OidObjectId();
+			pmdcobj->m_ulPos = pmdidColStats->UlPos();
+			break;
+		}
+
+		case IMDId::EmdidCastFunc:
+		{
+			CMDIdCast *pmdidCast = CMDIdCast::PmdidConvert(pmdid);
+
+			pmdcobj->m_ekind = gpdb::SMDCacheObject::EmdcoCast;
+			pmdcobj->m_oid = CMDIdGPDB::PmdidConvert(pmdidCast->PmdidSrc())->OidObjectId();
+			pmdcobj->m_oidSecond = CMDIdGPDB::PmdidConvert(pmdidCast->PmdidDest())->OidObjectId();
+			break;
+		}
+
+		case IMDId::EmdidScCmp:
+		{
+			CMDIdScCmp *pmdidScCmp = CMDIdScCmp::PmdidConvert(pmdid);
+
+			pmdcobj->m_ekind = gpdb::SMDCacheObject::EmdcoScCmp;
+			pmdcobj->m_oid = CMDIdGPDB::PmdidConvert(pmdidScCmp->PmdidLeft())->OidObjectId();
+			pmdcobj->m_oidSecond = CMDIdGPDB::PmdidConvert(pmdidScCmp->PmdidRight())->OidObjectId();
+			pmdcobj->m_ulPos = pmdidScCmp->Ecmpt();
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CTranslatorRelcacheToDXL::RegisterMDCacheDependencies
+//
+//	@doc:
+//		Register the catalog entries a metadata cache object is built from.
+//		Relations, indexes and relation statistics depend on the relcache
+//		entry of their own oid.
+//
+//---------------------------------------------------------------------------
+void
+CTranslatorRelcacheToDXL::RegisterMDCacheDependencies
+	(
+	CMDAccessor *pmda,
+	IMDId *pmdid,
+	const IMDCacheObject *pimdobj
+	)
+{
+	gpdb::SMDCacheObject mdcobj;
+	InitMDCacheObject(pmdid, &mdcobj);
+
+	switch (pmdid->Emdidt())
+	{
+		case IMDId::EmdidGPDB:
+		{
+			OID oid = mdcobj.m_oid;
+			Datum datumOid = ObjectIdGetDatum(oid);
+
+			switch (pimdobj->Emdt())
+			{
+				case IMDCacheObject::EmdtType:
+					gpdb::RegisterMDCacheDependency(TYPEOID, datumOid, 0, &mdcobj);
+					break;
+
+				case IMDCacheObject::EmdtOp:
+					gpdb::RegisterMDCacheDependency(OPEROID, datumOid, 0, &mdcobj);
+					break;
+
+				case IMDCacheObject::EmdtAgg:
+					gpdb::RegisterMDCacheDependency(AGGFNOID, datumOid, 0, &mdcobj);
+					gpdb::RegisterMDCacheDependency(PROCOID, datumOid, 0, &mdcobj);
+					break;
+
+				case IMDCacheObject::EmdtFunc:
+					gpdb::RegisterMDCacheDependency(PROCOID, datumOid, 0, &mdcobj);
+					break;
+
+				case IMDCacheObject::EmdtTrigger:
+					// pg_trigger has no syscache, changes invalidate the relcache of the table
+					gpdb::RegisterMDCacheDependency(MDCACHE_RELCACHE_ID, ObjectIdGetDatum(gpdb::OidTriggerRelid(oid)), 0, &mdcobj);
+					break;
+
+				case IMDCacheObject::EmdtCheckConstraint:
+					gpdb::RegisterMDCacheDependency(CONSTROID, datumOid, 0, &mdcobj);
+					gpdb::RegisterMDCacheDependency(MDCACHE_RELCACHE_ID, ObjectIdGetDatum(gpdb::OidCheckConstraintRelid(oid)), 0, &mdcobj);
+					break;
+
+				default:
+					// relations and indexes
+					gpdb::RegisterMDCacheDependency(MDCACHE_RELCACHE_ID, datumOid, 0, &mdcobj);
+					break;
+			}
+			break;
+		}
+
+		case IMDId::EmdidRelStats:
+		{
+			OID oidRelation = mdcobj.m_oid;
+
+			// number of rows is taken from pg_class
+			gpdb::RegisterMDCacheDependency(MDCACHE_RELCACHE_ID, ObjectIdGetDatum(oidRelation), 0, &mdcobj);
+			break;
+		}
+
+		case IMDId::EmdidColStats:
+		{
+			IMDId *pmdidRel = CMDIdColStats::PmdidConvert(pmdid)->PmdidRel();
+			OID oidRelation = mdcobj.m_oid;
+
+			// fetching the relation may translate it, which collects its own
+			// dependencies separately from the ones of the column statistics
+			AttrNumber attrnum = (AttrNumber) pmda->Pmdrel(pmdidRel)->Pmdcol(mdcobj.m_ulPos)->IAttno();
+
+			// number of rows is taken from pg_class, and the rest from pg_statistic
+			gpdb::RegisterMDCacheDependency(MDCACHE_RELCACHE_ID, ObjectIdGetDatum(oidRelation), 0, &mdcobj);
+			if (0 < attrnum)
+			{
+				gpdb::RegisterMDCacheDependency(STATRELATT, ObjectIdGetDatum(oidRelation), Int16GetDatum(attrnum), &mdcobj);
+			}
+			break;
+		}
+
+		case IMDId::EmdidCastFunc:
+		{
+			IMDId *pmdidCastFunc = dynamic_cast<const IMDCast *>(pimdobj)->PmdidCastFunc();
+
+			// changes to pg_cast itself reset the whole cache
+			OID oidCastFunc = CMDIdGPDB::PmdidConvert(pmdidCastFunc)->OidObjectId();
+			if (InvalidOid != oidCastFunc)
+			{
+				gpdb::RegisterMDCacheDependency(PROCOID, ObjectIdGetDatum(oidCastFunc), 0, &mdcobj);
+			}
+			break;
+		}
+
+		case IMDId::EmdidScCmp:
+		{
+			IMDId *pmdidOp = dynamic_cast<const IMDScCmp *>(pimdobj)->PmdidOp();
+
+			gpdb::RegisterMDCacheDependency(OPEROID, ObjectIdGetDatum(CMDIdGPDB::PmdidConvert(pmdidOp)->OidObjectId()), 0, &mdcobj);
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CTranslatorRelcacheToDXL::PimdobjGPDB
@@ -346,8 +538,6 @@ CTranslatorRelcacheToDXL::PlIndexOidsPartTable
 		plOids = gpdb::PlAppendOid(plOids, pidxinfo->logicalIndexOid);
 	}
 	
-	gpdb::GPDBFree(plgidx);
-	
 	return plOids;
 }
 
@@ -992,6 +1182,9 @@ CTranslatorRelcacheToDXL::Pmdindex
 	
 		if (pmdrel->FPartitioned())
 		{
+			// the logical indexes of the root were built when translating
+			// the relation above, this looks them up without walking the
+			// partition hierarchy again
 			LogicalIndexes *plgidx = gpdb::Plgidx(oidRel);
 			GPOS_ASSERT(NULL != plgidx);
 
@@ -999,8 +1192,6 @@ CTranslatorRelcacheToDXL::Pmdindex
 
 			// cleanup
 			pmdidRel->Release();
-	
-			gpdb::GPDBFree(plgidx);
 			gpdb::CloseRelation(relIndex);
 
 			return pmdindex;
@@ -1251,7 +1442,6 @@ CTranslatorRelcacheToDXL::PmdindexPartTable
 			pdrgpulDefaultLevels->Append(GPOS_NEW(pmp) ULONG(ul));
 		}
 	}
-	gpdb::FreeList(plDefaultLevelsDerived);
 
 	BOOL fPartial = (NULL != pnodePartCnstr || NIL != plDefaultLevels);
 
@@ -20,10 +20,13 @@
 
 #include "gpopt/utils/CConstExprEvaluatorProxy.h"
 
+#include "gpos/common/CAutoP.h"
+
 #include "gpopt/gpdbwrappers.h"
 #include "gpopt/translate/CTranslatorScalarToDXL.h"
 
 #include "naucrates/exception.h"
+#include "naucrates/dxl/CDXLUtils.h"
 #include "naucrates/dxl/operators/CDXLNode.h"
 
 using namespace gpdxl;
@@ -58,6 +61,8 @@ CConstExprEvaluatorProxy::CEmptyMappingColIdVar::PvarFromDXLNodeScId
 //	@doc:
 //		Evaluate 'pdxlnExpr', assumed to be a constant expression, and return the DXL representation
 // 		of the result. Caller keeps ownership of 'pdxlnExpr' and takes ownership of the returned pointer.
+//		Expressions that were evaluated before are served from the memo of results, unless
+//		they call volatile functions.
 //
 //---------------------------------------------------------------------------
 CDXLNode *
@@ -66,6 +71,25 @@ CConstExprEvaluatorProxy::PdxlnEvaluateExpr
 	const CDXLNode *pdxlnExpr
 	)
 {
+	CAutoP<CWStringDynamic> a_pstrKey;
+	a_pstrKey = CDXLUtils::PstrSerializeScalarExpr
+					(
+					m_pmp,
+					pdxlnExpr,
+					false, // fSerializeHeaderFooter
+					false // fIndent
+					);
+
+	CDXLNode *pdxlnCached = m_phmstrdxlnResults->PtLookup(a_pstrKey.Pt());
+	if (NULL != pdxlnCached)
+	{
+		GetOptProfile()->constExprHits++;
+		pdxlnCached->AddRef();
+		return pdxlnCached;
+	}
+
+	GetOptProfile()->constExprEvals++;
+
 	// Translate DXL -> GPDB Expr
 	Expr *pexpr = m_trdxl2scalar.PexprFromDXLNodeScalar(pdxlnExpr, &m_emptymapcidvar);
 	GPOS_ASSERT(NULL != pexpr);
@@ -86,6 +110,18 @@ CConstExprEvaluatorProxy::PdxlnEvaluateExpr
 	Const *pconstResult = (Const *)pexprResult;
 	CDXLDatum *pdxldatum = CTranslatorScalarToDXL::Pdxldatum(m_pmp, m_pmda, pconstResult);
 	CDXLNode *pdxlnResult = GPOS_NEW(m_pmp) CDXLNode(m_pmp, GPOS_NEW(m_pmp) CDXLScalarConstValue(m_pmp, pdxldatum));
+
+	// a volatile expression may evaluate to a different value next time
+	if (!gpdb::FContainsVolatileFunctions((Node *) pexpr))
+	{
+		pdxlnResult->AddRef();
+#ifdef GPOS_DEBUG
+		BOOL fInserted =
+#endif // GPOS_DEBUG
+			m_phmstrdxlnResults->FInsert(a_pstrKey.PtReset(), pdxlnResult);
+		GPOS_ASSERT(fInserted);
+	}
+
 	gpdb::GPDBFree(pexprResult);
 	gpdb::GPDBFree(pexpr);
 
@@ -13,6 +13,8 @@
 //
 //---------------------------------------------------------------------------
 
+#include <sys/stat.h>
+
 #include "gpopt/utils/gpdbdefs.h"
 #include "gpopt/utils/CConstExprEvaluatorProxy.h"
 #include "gpopt/utils/COptTasks.h"
@@ -40,6 +42,7 @@
 #include "gpos/io/COstreamFile.h"
 #include "gpos/io/COstreamString.h"
 #include "gpos/memory/CAutoMemoryPool.h"
+#include "gpos/memory/CCacheAccessor.h"
 #include "gpos/task/CAutoTraceFlag.h"
 #include "gpos/common/CAutoP.h"
 
@@ -52,6 +55,7 @@
 #include "gpopt/engine/CCTEConfig.h"
 #include "gpopt/mdcache/CAutoMDAccessor.h"
 #include "gpopt/mdcache/CMDCache.h"
+#include "gpopt/mdcache/CMDKey.h"
 #include "gpopt/minidump/CMinidumperUtils.h"
 #include "gpopt/optimizer/COptimizer.h"
 #include "gpopt/optimizer/COptimizerConfig.h"
@@ -65,6 +69,7 @@
 
 #include "naucrates/md/IMDId.h"
 #include "naucrates/md/CMDIdRelStats.h"
+#include "naucrates/md/CMDIdColStats.h"
 
 #include "naucrates/md/CSystemId.h"
 #include "naucrates/md/IMDRelStats.h"
@@ -106,6 +111,14 @@ const ULONG rgulExpectedOptFallback[] =
 		gpopt::ExmiUnsupportedCompositePartKey	// composite partitioning keys
 	};
 
+// cached search strategy, see COptTasks::PdrgPssCached
+IMemoryPool *COptTasks::m_pmpSearchStrategy = NULL;
+DrgPss *COptTasks::m_pdrgpssCached = NULL;
+BOOL COptTasks::m_fSearchStrategyCached = false;
+CHAR *COptTasks::m_szSearchStrategyPath = NULL;
+LINT COptTasks::m_lSearchStrategyMtime = 0;
+LINT COptTasks::m_lSearchStrategySize = 0;
+
 // array of DXL minor exception types that trigger expected fallback to the planner
 const ULONG rgulExpectedDXLFallback[] =
 	{
@@ -137,6 +150,7 @@ SOptContext::SOptContext()
 	m_pquery(NULL),
 	m_szPlanDXL(NULL),
 	m_pplstmt(NULL),
+	m_pmcPlStmt(CurrentMemoryContext),
 	m_fGeneratePlStmt(false),
 	m_fSerializePlanDXL(false),
 	m_fUnexpectedFailure(false),
@@ -557,6 +571,10 @@ COptTasks::Execute
 	params.error_buffer_size = GPOPT_ERROR_BUFFER_SIZE;
 	params.abort_requested = &abort_flag;
 
+	// logical indexes and part constraints of partitioned tables are only
+	// remembered for the duration of one task
+	gpdb::ResetPartTableInfo();
+
 	// execute task and send log message to server log
 	GPOS_TRY
 	{
@@ -564,10 +582,12 @@ COptTasks::Execute
 	}
 	GPOS_CATCH_EX(ex)
 	{
+		gpdb::ResetPartTableInfo();
 		LogErrorAndDelete(err_buf);
 		GPOS_RETHROW(ex);
 	}
 	GPOS_CATCH_END;
+	gpdb::ResetPartTableInfo();
 	LogErrorAndDelete(err_buf);
 }
 
@@ -667,7 +687,9 @@ COptTasks::PvDXLFromQueryTask
 //		COptTasks::Pplstmt
 //
 //	@doc:
-//		Translate a DXL tree into a planned statement
+//		Translate a DXL tree into a planned statement. The nodes are
+//		allocated directly in the given memory context, so the result does
+//		not need to be copied out of the optimizer task
 //
 //---------------------------------------------------------------------------
 PlannedStmt *
@@ -676,12 +698,14 @@ COptTasks::Pplstmt
 	IMemoryPool *pmp,
 	CMDAccessor *pmda,
 	const CDXLNode *pdxln,
-	bool canSetTag
+	bool canSetTag,
+	MemoryContext pmcPlStmt
 	)
 {
 
 	GPOS_ASSERT(NULL != pmda);
 	GPOS_ASSERT(NULL != pdxln);
+	GPOS_ASSERT(NULL != pmcPlStmt);
 
 	CIdGenerator idgtorPlanId(1 /* ulStartId */);
 	CIdGenerator idgtorMotionId(1 /* ulStartId */);
@@ -702,7 +726,118 @@ COptTasks::Pplstmt
 	
 	// translate DXL -> PlannedStmt
 	CTranslatorDXLToPlStmt trdxltoplstmt(pmp, pmda, &ctxdxltoplstmt, gpdb::UlSegmentCountGP());
-	return trdxltoplstmt.PplstmtFromDXL(pdxln, canSetTag);
+
+	MemoryContext pmcOld = MemoryContextSwitchTo(pmcPlStmt);
+	PlannedStmt *pplstmt = NULL;
+	GPOS_TRY
+	{
+		pplstmt = trdxltoplstmt.PplstmtFromDXL(pdxln, canSetTag);
+	}
+	GPOS_CATCH_EX(ex)
+	{
+		MemoryContextSwitchTo(pmcOld);
+		GPOS_RETHROW(ex);
+	}
+	GPOS_CATCH_END;
+	MemoryContextSwitchTo(pmcOld);
+
+	return pplstmt;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::PmdidMDCacheObject
+//
+//	@doc:
+//		Create the metadata id of a metadata cache object tracked for
+//		invalidation
+//
+//---------------------------------------------------------------------------
+IMDId *
+COptTasks::PmdidMDCacheObject
+	(
+	IMemoryPool *pmp,
+	const gpdb::SMDCacheObject *pmdcobj
+	)
+{
+	switch (pmdcobj->m_ekind)
+	{
+		case gpdb::SMDCacheObject::EmdcoGPDB:
+			return GPOS_NEW(pmp) CMDIdGPDB(pmdcobj->m_oid);
+
+		case gpdb::SMDCacheObject::EmdcoRelStats:
+			return GPOS_NEW(pmp) CMDIdRelStats(GPOS_NEW(pmp) CMDIdGPDB(pmdcobj->m_oid));
+
+		case gpdb::SMDCacheObject::EmdcoColStats:
+			return GPOS_NEW(pmp) CMDIdColStats(GPOS_NEW(pmp) CMDIdGPDB(pmdcobj->m_oid), pmdcobj->m_ulPos);
+
+		case gpdb::SMDCacheObject::EmdcoCast:
+			return GPOS_NEW(pmp) CMDIdCast
+								(
+								GPOS_NEW(pmp) CMDIdGPDB(pmdcobj->m_oid),
+								GPOS_NEW(pmp) CMDIdGPDB(pmdcobj->m_oidSecond)
+								);
+
+		case gpdb::SMDCacheObject::EmdcoScCmp:
+			return GPOS_NEW(pmp) CMDIdScCmp
+								(
+								GPOS_NEW(pmp) CMDIdGPDB(pmdcobj->m_oid),
+								GPOS_NEW(pmp) CMDIdGPDB(pmdcobj->m_oidSecond),
+								(IMDType::ECmpType) pmdcobj->m_ulPos
+								);
+
+		default:
+			GPOS_ASSERT(!"Unexpected metadata cache object");
+			return NULL;
+	}
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::EvictInvalidatedMDCacheObjects
+//
+//	@doc:
+//		Evict the metadata cache objects affected by catalog changes since
+//		the last optimized query, instead of resetting the whole cache
+//
+//---------------------------------------------------------------------------
+void
+COptTasks::EvictInvalidatedMDCacheObjects()
+{
+	List *plObjects = gpdb::PlMDCacheInvalidatedObjects();
+	if (NIL == plObjects)
+	{
+		return;
+	}
+
+	AUTO_MEM_POOL(amp);
+	IMemoryPool *pmp = amp.Pmp();
+
+	gpdb::SMDCacheStats *pmdcstats = gpdb::PmdcstatsMDCache();
+
+	ListCell *plc = NULL;
+	ForEach (plc, plObjects)
+	{
+		gpdb::SMDCacheObject *pmdcobj = (gpdb::SMDCacheObject *) lfirst(plc);
+		IMDId *pmdid = PmdidMDCacheObject(pmp, pmdcobj);
+		CMDKey mdkey(pmdid);
+
+		{
+			// scope for cache accessor, the entry is deleted once it is released
+			CCacheAccessor<IMDCacheObject *, CMDKey *> cacc(CMDCache::Pcache());
+			if (NULL != cacc.PtLookup(&mdkey))
+			{
+				cacc.MarkForDeletion();
+				pmdcstats->m_ullEvictions++;
+			}
+		}
+
+		pmdid->Release();
+	}
+
+	gpdb::FreeListDeep(plObjects);
 }
 
 
@@ -753,6 +888,103 @@ COptTasks::PdrgPssLoad
 	return pdrgpss;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::PdrgPssCopy
+//
+//	@doc:
+//		Copy search strategy into given memory pool; search stages keep
+//		per-optimization state, so each query gets its own copy
+//
+//---------------------------------------------------------------------------
+DrgPss *
+COptTasks::PdrgPssCopy
+	(
+	IMemoryPool *pmp,
+	const DrgPss *pdrgpss
+	)
+{
+	DrgPss *pdrgpssCopy = GPOS_NEW(pmp) DrgPss(pmp);
+
+	const ULONG ulStages = pdrgpss->UlLength();
+	for (ULONG ul = 0; ul < ulStages; ul++)
+	{
+		CSearchStage *pss = (*pdrgpss)[ul];
+
+		CXformSet *pxfs = GPOS_NEW(pmp) CXformSet(pmp);
+		pxfs->Union(pss->Pxfs());
+
+		pdrgpssCopy->Append(GPOS_NEW(pmp) CSearchStage(pxfs, pss->UlTimeThreshold(), pss->CostThreshold()));
+	}
+
+	return pdrgpssCopy;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::PdrgPssCached
+//
+//	@doc:
+//		Return search strategy from given file; the file is parsed only when
+//		the path, or the modification time or size of the file changed since
+//		the last call, otherwise a copy of the cached strategy is returned
+//
+//---------------------------------------------------------------------------
+DrgPss *
+COptTasks::PdrgPssCached
+	(
+	IMemoryPool *pmp,
+	char *szPath
+	)
+{
+	LINT lMtime = 0;
+	LINT lSize = 0;
+	struct stat st;
+	if (NULL != szPath && 0 == stat(szPath, &st))
+	{
+		lMtime = (LINT) st.st_mtime;
+		lSize = (LINT) st.st_size;
+	}
+
+	BOOL fSamePath = (NULL == szPath && NULL == m_szSearchStrategyPath) ||
+					 (NULL != szPath && NULL != m_szSearchStrategyPath &&
+					  0 == strcmp(szPath, m_szSearchStrategyPath));
+
+	if (!m_fSearchStrategyCached || !fSamePath ||
+		lMtime != m_lSearchStrategyMtime || lSize != m_lSearchStrategySize)
+	{
+		if (NULL == m_pmpSearchStrategy)
+		{
+			m_pmpSearchStrategy = CMemoryPoolManager::Pmpm()->PmpCreate(CMemoryPoolManager::EatTracker, false /* fThreadSafe */, gpos::ullong_max);
+		}
+
+		// invalidate first, so that a failure while loading forces a reload next time
+		m_fSearchStrategyCached = false;
+		CRefCount::SafeRelease(m_pdrgpssCached);
+		m_pdrgpssCached = NULL;
+		GPOS_DELETE_ARRAY(m_szSearchStrategyPath);
+		m_szSearchStrategyPath = NULL;
+
+		m_pdrgpssCached = PdrgPssLoad(m_pmpSearchStrategy, szPath);
+		if (NULL != szPath)
+		{
+			ULONG ulLen = strlen(szPath);
+			m_szSearchStrategyPath = GPOS_NEW_ARRAY(m_pmpSearchStrategy, CHAR, ulLen + 1);
+			strncpy(m_szSearchStrategyPath, szPath, ulLen + 1);
+		}
+		m_lSearchStrategyMtime = lMtime;
+		m_lSearchStrategySize = lSize;
+		m_fSearchStrategyCached = true;
+	}
+
+	if (NULL == m_pdrgpssCached)
+	{
+		return NULL;
+	}
+
+	return PdrgPssCopy(pmp, m_pdrgpssCached);
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::PoconfCreate
@@ -954,6 +1186,55 @@ COptTasks::Pcm
 	return pcm;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::DElapsedMS
+//
+//	@doc:
+//		Return the milliseconds elapsed since the given time, and set it to
+//		the current time
+//
+//---------------------------------------------------------------------------
+double
+COptTasks::DElapsedMS
+	(
+	instr_time *pit
+	)
+{
+	instr_time itNow;
+	INSTR_TIME_SET_CURRENT(itNow);
+
+	instr_time itElapsed;
+	INSTR_TIME_ASSIGN(itElapsed, itNow);
+	INSTR_TIME_SUBTRACT(itElapsed, *pit);
+	INSTR_TIME_ASSIGN(*pit, itNow);
+
+	return INSTR_TIME_GET_MILLISEC(itElapsed);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::UpdateMemoryPeak
+//
+//	@doc:
+//		Record the size of the optimization memory pool in the profile, if
+//		it is the largest seen so far; sampled at the end of each phase
+//
+//---------------------------------------------------------------------------
+void
+COptTasks::UpdateMemoryPeak
+	(
+	IMemoryPool *pmp,
+	OptProfile *pprof
+	)
+{
+	ULLONG ullSize = pmp->UllTotalAllocatedSize();
+	if (ullSize > pprof->memoryPeak)
+	{
+		pprof->memoryPeak = ullSize;
+	}
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::PvOptimizeTask
@@ -978,6 +1259,14 @@ COptTasks::PvOptimizeTask
 	// initially assume no unexpected failure
 	poctx->m_fUnexpectedFailure = false;
 
+	// profile of the phases of this optimization
+	OptProfile *pprof = BeginOptProfile();
+	instr_time itStart;
+	instr_time itPhase;
+	INSTR_TIME_SET_CURRENT(itStart);
+	INSTR_TIME_ASSIGN(itPhase, itStart);
+	gpdb::SMDCacheStats mdcstatsStart = *gpdb::PmdcstatsMDCache();
+
 	AUTO_MEM_POOL(amp);
 	IMemoryPool *pmp = amp.Pmp();
 
@@ -994,20 +1283,27 @@ COptTasks::PvOptimizeTask
 	{
 		CMDCache::Init();
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		gpdb::ResetMDCacheDependencies();
 	}
 	else if (reset_mdcache)
 	{
 		CMDCache::Reset();
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
 	}
-	else if (CMDCache::ULLGetCacheQuota() != (ULLONG) optimizer_mdcache_size * 1024L)
+	else
 	{
-		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		// evict only the entries affected by catalog changes since last query
+		EvictInvalidatedMDCacheObjects();
+
+		if (CMDCache::ULLGetCacheQuota() != (ULLONG) optimizer_mdcache_size * 1024L)
+		{
+			CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		}
 	}
 
 
 	// load search strategy
-	DrgPss *pdrgpss = PdrgPssLoad(pmp, optimizer_search_strategy_path);
+	DrgPss *pdrgpss = PdrgPssCached(pmp, optimizer_search_strategy_path);
 
 	CBitSet *pbsTraceFlags = NULL;
 	CBitSet *pbsEnabled = NULL;
@@ -1020,7 +1316,7 @@ COptTasks::PvOptimizeTask
 	GPOS_TRY
 	{
 		// set trace flags
-		pbsTraceFlags = CConfigParamMapping::PbsPack(pmp, CXform::ExfSentinel);
+		pbsTraceFlags = CConfigParamMapping::PbsPackCached(CXform::ExfSentinel);
 		SetTraceflags(pmp, pbsTraceFlags, &pbsEnabled, &pbsDisabled);
 
 		// set up relcache MD provider
@@ -1062,7 +1358,13 @@ COptTasks::PvOptimizeTask
 			IConstExprEvaluator *pceeval =
 					GPOS_NEW(pmp) CConstExprEvaluatorDXL(pmp, &mda, &ceevalproxy);
 
+			// the time to create the translators is negligible, the phase
+			// starts here so that MD cache maintenance isn't attributed to it
+			INSTR_TIME_SET_CURRENT(itPhase);
 			CDXLNode *pdxlnQuery = ptrquerytodxl->PdxlnFromQuery();
+			pprof->queryToDXLTime = DElapsedMS(&itPhase);
+			UpdateMemoryPeak(pmp, pprof);
+
 			DrgPdxln *pdrgpdxlnQueryOutput = ptrquerytodxl->PdrgpdxlnQueryOutput();
 			DrgPdxln *pdrgpdxlnCTE = ptrquerytodxl->PdrgpdxlnCTE();
 			GPOS_ASSERT(NULL != pdrgpdxlnQueryOutput);
@@ -1085,6 +1387,8 @@ COptTasks::PvOptimizeTask
 									pdrgpss,
 									pocconf
 									);
+			pprof->optimizeTime = DElapsedMS(&itPhase);
+			UpdateMemoryPeak(pmp, pprof);
 
 			if (poctx->m_fSerializePlanDXL)
 			{
@@ -1100,7 +1404,10 @@ COptTasks::PvOptimizeTask
 			{
 				// always use poctx->m_pquery->canSetTag as the ptrquerytodxl->Pquery() is a mutated Query object
 				// that may not have the correct canSetTag
-				poctx->m_pplstmt = (PlannedStmt *) gpdb::PvCopyObject(Pplstmt(pmp, &mda, pdxlnPlan, poctx->m_pquery->canSetTag));
+				INSTR_TIME_SET_CURRENT(itPhase);
+				poctx->m_pplstmt = Pplstmt(pmp, &mda, pdxlnPlan, poctx->m_pquery->canSetTag, poctx->m_pmcPlStmt);
+				pprof->dxlToPlanTime = DElapsedMS(&itPhase);
+				UpdateMemoryPeak(pmp, pprof);
 			}
 
 			CStatisticsConfig *pstatsconf = pocconf->Pstatsconf();
@@ -1157,6 +1464,13 @@ COptTasks::PvOptimizeTask
 		CMDCache::Shutdown();
 	}
 
+	gpdb::SMDCacheStats *pmdcstats = gpdb::PmdcstatsMDCache();
+	pprof->mdFetches = pmdcstats->m_ullMisses - mdcstatsStart.m_ullMisses;
+	pprof->mdSharedHits = pmdcstats->m_ullSharedHits - mdcstatsStart.m_ullSharedHits;
+	// the profile is added to the session totals by the caller, once the
+	// plan is known to be used rather than falling back to the planner
+	pprof->totalTime = DElapsedMS(&itStart);
+
 	return NULL;
 }
 
@@ -1248,6 +1562,14 @@ COptTasks::PvOptimizeMinidumpTask
 	GPOS_ASSERT(NULL != poptmdpctxt->m_szFileName);
 	GPOS_ASSERT(NULL == poptmdpctxt->m_szDXLResult);
 
+	// profile the replay for benchmarks, it is not added to the session
+	// totals as it doesn't plan a query of the session
+	OptProfile *pprof = BeginOptProfile();
+	instr_time itStart;
+	instr_time itPhase;
+	INSTR_TIME_SET_CURRENT(itStart);
+	INSTR_TIME_ASSIGN(itPhase, itStart);
+
 	AUTO_MEM_POOL(amp);
 	IMemoryPool *pmp = amp.Pmp();
 
@@ -1265,6 +1587,8 @@ COptTasks::PvOptimizeMinidumpTask
 	GPOS_TRY
 	{
 		pdxlnResult = CMinidumperUtils::PdxlnExecuteMinidump(pmp, poptmdpctxt->m_szFileName, ulSegments, gp_session_id, gp_command_count, pocconf);
+		pprof->optimizeTime = DElapsedMS(&itPhase);
+		UpdateMemoryPeak(pmp, pprof);
 	}
 	GPOS_CATCH_EX(ex)
 	{
@@ -1290,6 +1614,8 @@ COptTasks::PvOptimizeMinidumpTask
 	CRefCount::SafeRelease(pdxlnResult);
 	pocconf->Release();
 
+	pprof->totalTime = DElapsedMS(&itStart);
+
 	return NULL;
 }
 
@@ -1325,23 +1651,6 @@ COptTasks::PvPlstmtFromDXLTask
 	CDXLNode *pdxlnOriginal =
 		CDXLUtils::PdxlnParsePlan(pmp, poctx->m_szPlanDXL, NULL /*XSD location*/, &ullPlanId, &ullPlanSpaceSize);
 
-	CIdGenerator idgtorPlanId(1);
-	CIdGenerator idgtorMotionId(1);
-	CIdGenerator idgtorParamId(0);
-
-	List *plRTable = NULL;
-	List *plSubplans = NULL;
-
-	CContextDXLToPlStmt ctxdxlplstmt
-							(
-							pmp,
-							&idgtorPlanId,
-							&idgtorMotionId,
-							&idgtorParamId,
-							&plRTable,
-							&plSubplans
-							);
-
 	// relcache MD provider
 	CMDProviderRelcache *pmdpr = GPOS_NEW(pmp) CMDProviderRelcache(pmp);
 
@@ -1349,17 +1658,15 @@ COptTasks::PvPlstmtFromDXLTask
 		CAutoMDAccessor amda(pmp, pmdpr, sysidDefault);
 
 		// translate DXL -> PlannedStmt
-		CTranslatorDXLToPlStmt trdxltoplstmt(pmp, amda.Pmda(), &ctxdxlplstmt, gpdb::UlSegmentCountGP());
-		PlannedStmt *pplstmt = trdxltoplstmt.PplstmtFromDXL(pdxlnOriginal, poctx->m_pquery->canSetTag);
+		PlannedStmt *pplstmt = Pplstmt(pmp, amda.Pmda(), pdxlnOriginal, poctx->m_pquery->canSetTag, poctx->m_pmcPlStmt);
 		if (optimizer_print_plan)
 		{
 			elog(NOTICE, "Plstmt: %s", gpdb::SzNodeToString(pplstmt));
 		}
 
 		GPOS_ASSERT(NULL != pplstmt);
-		GPOS_ASSERT(NULL != CurrentMemoryContext);
 
-		poctx->m_pplstmt = (PlannedStmt *) gpdb::PvCopyObject(pplstmt);
+		poctx->m_pplstmt = pplstmt;
 	}
 
 	// cleanup
@@ -1569,6 +1876,7 @@ COptTasks::PvEvalExprFromDXLTask
 	{
 		CMDCache::Init();
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		gpdb::ResetMDCacheDependencies();
 		fReleaseCache = true;
 	}
 	else if (reset_mdcache)
@@ -1576,9 +1884,15 @@ COptTasks::PvEvalExprFromDXLTask
 		CMDCache::Reset();
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
 	}
-	else if (CMDCache::ULLGetCacheQuota() != (ULLONG) optimizer_mdcache_size * 1024L)
+	else
 	{
-		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		// evict only the entries affected by catalog changes since last query
+		EvictInvalidatedMDCacheObjects();
+
+		if (CMDCache::ULLGetCacheQuota() != (ULLONG) optimizer_mdcache_size * 1024L)
+		{
+			CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		}
 	}
 
 	GPOS_TRY
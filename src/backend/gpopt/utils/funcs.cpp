@@ -118,6 +118,31 @@ LibraryVersion()
 }
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		MDCacheStats
+//
+//	@doc:
+//		Returns the metadata cache counters of the current session as a message
+//
+//---------------------------------------------------------------------------
+extern "C" {
+Datum
+MDCacheStats()
+{
+	gpdb::SMDCacheStats *pmdcstats = gpdb::PmdcstatsMDCache();
+
+	StringInfoData str;
+	initStringInfo(&str);
+	appendStringInfo(&str, "misses: " UINT64_FORMAT, pmdcstats->m_ullMisses);
+	appendStringInfo(&str, ", evictions: " UINT64_FORMAT, pmdcstats->m_ullEvictions);
+	appendStringInfo(&str, ", resets: " UINT64_FORMAT, pmdcstats->m_ullResets);
+	appendStringInfo(&str, ", shared hits: " UINT64_FORMAT, pmdcstats->m_ullSharedHits);
+	text *result = cstring_to_text(str.data);
+	PG_RETURN_TEXT_P(result);
+}
+}
+
 extern "C" {
 const char *
 OptVersion()
@@ -0,0 +1,536 @@
+/*-------------------------------------------------------------------------
+ *
+ * optplancache.c
+ *	  Cache of plans produced by ORCA.
+ *
+ * ORCA plans every query from scratch, which for short, frequently repeated
+ * statements can take longer than executing them.  This module remembers
+ * the plans ORCA produced in the current session, keyed by a fingerprint of
+ * the Query tree (its nodeToString() form), of the settings ORCA reads and
+ * of the number of segments, and hands out copies of them for identical
+ * queries.
+ *
+ * Queries calling stable or volatile functions are not cached: stable
+ * functions, like now(), are folded to constants before ORCA plans the
+ * query, so their values would be baked into the cached plan.
+ *
+ * For queries with parameter values, the decision between a generic plan
+ * and a plan for the actual values (a "custom" plan) is made like in
+ * plancache.c of newer PostgreSQL versions: the first few executions get
+ * custom plans, and a generic plan, planned without the parameter values,
+ * is used afterwards unless it is much more expensive than the average
+ * custom plan.  If ORCA can't produce a generic plan, custom plans are
+ * used instead.
+ *
+ * Queries ORCA could not plan are remembered too, so that we fall back to
+ * the Postgres planner right away the next time.  Such failures are
+ * forgotten after a while, in case they were caused by something that
+ * doesn't invalidate the entry.
+ *
+ * A relcache invalidation drops the entries of queries that reference the
+ * relation, any other change to a catalog ORCA reads metadata from (which
+ * includes updated statistics) drops the whole cache at the start of the
+ * next query.
+ *
+ * Copyright (c) 2017, Pivotal Software, Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "cdb/cdbutil.h"
+#include "lib/stringinfo.h"
+#include "nodes/pg_list.h"
+#include "optimizer/clauses.h"
+#include "optimizer/optplancache.h"
+#include "optimizer/planmain.h"
+#include "utils/guc.h"
+#include "utils/guc_tables.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/memutils.h"
+#include "utils/syscache.h"
+
+/* number of custom plans to make before considering a generic plan */
+#define OPT_PLAN_CACHE_CUSTOM_PLANS		5
+
+/* a generic plan is used if it costs at most this much more than a custom one */
+#define OPT_PLAN_CACHE_GENERIC_COST_FACTOR	1.1
+
+/* number of calls after which ORCA tries again to plan a query it failed on */
+#define OPT_PLAN_CACHE_FAILED_CALLS		100
+
+typedef struct OptPlanCacheEntry
+{
+	uint32		hashkey;		/* hash of fingerprint --- MUST BE FIRST */
+	MemoryContext context;		/* holds the fields below */
+	char	   *fingerprint;
+	List	   *relationOids;	/* relations the query depends on */
+	bool		dead;			/* a relation has been invalidated */
+	PlannedStmt *plan;			/* generic plan, or NULL */
+	bool		genericFailed;	/* ORCA can't plan the query generically */
+	int			numFailedCalls;	/* calls since ORCA failed */
+	int			numCustomPlans;
+	double		totalCustomCost;
+} OptPlanCacheEntry;
+
+static MemoryContext OptPlanCacheContext = NULL;
+static HTAB *OptPlanCacheHash = NULL;
+static bool opt_plan_cache_needs_reset = false;
+static uint64 opt_plan_cache_inval_count = 0;	/* invalidations received */
+static bool opt_plan_cache_callbacks_registered = false;
+
+/*
+ * Settings read by ORCA and by the translations to and from DXL, besides the
+ * optimizer* ones.  They are part of the fingerprint.
+ */
+static const char *const opt_plan_cache_gp_settings[] = {
+	"gp_external_enable_exec",
+	"gp_external_max_segs",
+};
+
+/* ORCA settings, which are part of the fingerprint */
+static struct config_generic **opt_plan_cache_settings = NULL;
+static int	opt_plan_cache_num_settings = 0;
+
+static OptPlanCacheStats opt_plan_cache_stats;
+
+/*
+ * Callbacks are called while processing invalidation messages, so they must
+ * not allocate memory or throw errors.
+ */
+static void
+opt_plan_cache_syscache_callback(Datum arg, int cacheid, ItemPointer tuplePtr,
+								 uint32 hashValue)
+{
+	opt_plan_cache_inval_count++;
+	opt_plan_cache_needs_reset = true;
+}
+
+static void
+opt_plan_cache_relcache_callback(Datum arg, Oid relid)
+{
+	HASH_SEQ_STATUS status;
+	OptPlanCacheEntry *entry;
+
+	opt_plan_cache_inval_count++;
+
+	if (OptPlanCacheHash == NULL)
+		return;
+
+	if (!OidIsValid(relid))
+	{
+		opt_plan_cache_needs_reset = true;
+		return;
+	}
+
+	hash_seq_init(&status, OptPlanCacheHash);
+	while ((entry = (OptPlanCacheEntry *) hash_seq_search(&status)) != NULL)
+	{
+		if (list_member_oid(entry->relationOids, relid))
+			entry->dead = true;
+	}
+}
+
+static void
+register_opt_plan_cache_callbacks(void)
+{
+	/* Same catalogs as the ORCA metadata cache listens to, see gpdbwrappers.cpp */
+	int			caches[] = {
+		AGGFNOID,
+		AMOPOPID,
+		CASTSOURCETARGET,
+		CONSTROID,
+		OPEROID,
+		OPFAMILYOID,
+		PARTOID,
+		PARTRULEOID,
+		PROCOID,
+		STATRELATT,
+		TYPEOID,
+	};
+	int			i;
+
+	for (i = 0; i < lengthof(caches); i++)
+		CacheRegisterSyscacheCallback(caches[i],
+									  opt_plan_cache_syscache_callback,
+									  (Datum) 0);
+
+	CacheRegisterRelcacheCallback(opt_plan_cache_relcache_callback, (Datum) 0);
+}
+
+/* Remember the ORCA settings, they affect the plans */
+static void
+init_opt_plan_cache_settings(void)
+{
+	struct config_generic **gucs = get_guc_variables();
+	int			num_gucs = get_num_guc_variables();
+	int			i;
+
+	opt_plan_cache_settings = (struct config_generic **)
+		MemoryContextAlloc(TopMemoryContext,
+						   num_gucs * sizeof(struct config_generic *));
+
+	for (i = 0; i < num_gucs; i++)
+	{
+		bool		read_by_orca;
+		int			j;
+
+		read_by_orca = strncmp(gucs[i]->name, "optimizer",
+							   strlen("optimizer")) == 0;
+		for (j = 0; j < lengthof(opt_plan_cache_gp_settings); j++)
+		{
+			if (strcmp(gucs[i]->name, opt_plan_cache_gp_settings[j]) == 0)
+				read_by_orca = true;
+		}
+
+		if (read_by_orca)
+			opt_plan_cache_settings[opt_plan_cache_num_settings++] = gucs[i];
+	}
+}
+
+static uint32
+opt_plan_cache_settings_hash(void)
+{
+	uint32		hash = 0;
+	int			i;
+
+	for (i = 0; i < opt_plan_cache_num_settings; i++)
+	{
+		struct config_generic *gconf = opt_plan_cache_settings[i];
+		uint32		value_hash = 0;
+
+		switch (gconf->vartype)
+		{
+			case PGC_BOOL:
+				value_hash = *((struct config_bool *) gconf)->variable;
+				break;
+			case PGC_INT:
+				value_hash = *((struct config_int *) gconf)->variable;
+				break;
+			case PGC_REAL:
+				value_hash = DatumGetUInt32(hash_any((unsigned char *) ((struct config_real *) gconf)->variable,
+													 sizeof(double)));
+				break;
+			case PGC_STRING:
+				if (*((struct config_string *) gconf)->variable != NULL)
+					value_hash = DatumGetUInt32(hash_any((unsigned char *) *((struct config_string *) gconf)->variable,
+														 strlen(*((struct config_string *) gconf)->variable)));
+				break;
+		}
+
+		hash = (hash << 1 | hash >> 31) ^ value_hash;
+	}
+
+	/* transformations disabled with disable_xform() */
+	hash ^= DatumGetUInt32(hash_any((unsigned char *) optimizer_xforms,
+									sizeof(optimizer_xforms)));
+
+	return hash;
+}
+
+static void
+remove_opt_plan_cache_entry(OptPlanCacheEntry *entry)
+{
+	MemoryContextDelete(entry->context);
+	hash_search(OptPlanCacheHash, &entry->hashkey, HASH_REMOVE, NULL);
+}
+
+/*
+ * ResetOptPlanCache
+ *		Drop all cached plans, e.g. when ORCA's configuration changed.
+ */
+void
+ResetOptPlanCache(void)
+{
+	HASHCTL		ctl;
+
+	if (OptPlanCacheContext == NULL)
+		OptPlanCacheContext = AllocSetContextCreate(CacheMemoryContext,
+													"ORCA plan cache",
+													ALLOCSET_DEFAULT_MINSIZE,
+													ALLOCSET_DEFAULT_INITSIZE,
+													ALLOCSET_DEFAULT_MAXSIZE);
+	else
+		MemoryContextResetAndDeleteChildren(OptPlanCacheContext);
+
+	MemSet(&ctl, 0, sizeof(ctl));
+	ctl.keysize = sizeof(uint32);
+	ctl.entrysize = sizeof(OptPlanCacheEntry);
+	ctl.hash = tag_hash;
+	ctl.hcxt = OptPlanCacheContext;
+	OptPlanCacheHash = hash_create("ORCA plan cache",
+								   128,
+								   &ctl,
+								   HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+	opt_plan_cache_needs_reset = false;
+}
+
+static char *
+make_fingerprint(Query *parse)
+{
+	StringInfoData buf;
+	char	   *query_str;
+
+	query_str = nodeToString(parse);
+
+	/* plans are made for the number of segments ORCA was told about */
+	initStringInfo(&buf);
+	appendStringInfo(&buf, "%u %d ", opt_plan_cache_settings_hash(),
+					 getgpsegmentCount());
+	appendStringInfoString(&buf, query_str);
+	pfree(query_str);
+
+	return buf.data;
+}
+
+/* Find the live entry of the given fingerprint, or NULL */
+static OptPlanCacheEntry *
+find_opt_plan_cache_entry(uint32 hashkey, const char *fingerprint)
+{
+	OptPlanCacheEntry *entry;
+
+	entry = (OptPlanCacheEntry *) hash_search(OptPlanCacheHash, &hashkey,
+											  HASH_FIND, NULL);
+	if (entry == NULL)
+		return NULL;
+
+	if (!entry->dead && strcmp(entry->fingerprint, fingerprint) == 0)
+		return entry;
+
+	if (entry->dead)
+		opt_plan_cache_stats.invalidations++;
+	remove_opt_plan_cache_entry(entry);
+
+	return NULL;
+}
+
+/* Find or create the entry of the given fingerprint */
+static OptPlanCacheEntry *
+enter_opt_plan_cache_entry(Query *parse, uint32 hashkey,
+						   const char *fingerprint)
+{
+	OptPlanCacheEntry *entry;
+	MemoryContext oldcxt;
+	List	   *invalItems;
+
+	entry = find_opt_plan_cache_entry(hashkey, fingerprint);
+	if (entry != NULL)
+		return entry;
+
+	/* make room, dead entries first */
+	if (hash_get_num_entries(OptPlanCacheHash) >= optimizer_plan_cache_size)
+	{
+		HASH_SEQ_STATUS status;
+
+		hash_seq_init(&status, OptPlanCacheHash);
+		while ((entry = (OptPlanCacheEntry *) hash_seq_search(&status)) != NULL)
+		{
+			if (entry->dead)
+			{
+				opt_plan_cache_stats.invalidations++;
+				remove_opt_plan_cache_entry(entry);
+			}
+		}
+
+		if (hash_get_num_entries(OptPlanCacheHash) >= optimizer_plan_cache_size)
+			ResetOptPlanCache();
+	}
+
+	entry = (OptPlanCacheEntry *) hash_search(OptPlanCacheHash, &hashkey,
+											  HASH_ENTER, NULL);
+
+	entry->context = AllocSetContextCreate(OptPlanCacheContext,
+										   "ORCA cached plan",
+										   ALLOCSET_SMALL_MINSIZE,
+										   ALLOCSET_SMALL_INITSIZE,
+										   ALLOCSET_DEFAULT_MAXSIZE);
+	entry->dead = false;
+	entry->plan = NULL;
+	entry->genericFailed = false;
+	entry->numFailedCalls = 0;
+	entry->numCustomPlans = 0;
+	entry->totalCustomCost = 0;
+
+	oldcxt = MemoryContextSwitchTo(entry->context);
+	entry->fingerprint = pstrdup(fingerprint);
+	extract_query_dependencies(list_make1(parse),
+							   &entry->relationOids,
+							   &invalItems);
+	MemoryContextSwitchTo(oldcxt);
+
+	return entry;
+}
+
+/*
+ * Plan the query without parameter values, and remember the plan.
+ *
+ * Planning can process invalidation messages, and even plan other queries
+ * (e.g. in functions evaluated by constant folding), so the entry is looked
+ * up again afterwards, and the plan is not remembered if any catalog
+ * changed meanwhile.
+ */
+static PlannedStmt *
+make_generic_plan(Query *parse, uint32 hashkey, const char *fingerprint,
+				  OptPlanCacheOptimizeFn optimize)
+{
+	OptPlanCacheEntry *entry;
+	PlannedStmt *result;
+	uint64		inval_count = opt_plan_cache_inval_count;
+	MemoryContext oldcxt;
+
+	result = optimize(parse, NULL);
+	opt_plan_cache_stats.misses++;
+
+	if (inval_count != opt_plan_cache_inval_count)
+		return result;
+
+	entry = enter_opt_plan_cache_entry(parse, hashkey, fingerprint);
+	if (result == NULL)
+	{
+		entry->genericFailed = true;
+		entry->numFailedCalls = 0;
+		return NULL;
+	}
+
+	oldcxt = MemoryContextSwitchTo(entry->context);
+	entry->plan = (PlannedStmt *) copyObject(result);
+	MemoryContextSwitchTo(oldcxt);
+
+	return result;
+}
+
+/* Plan the query for its parameter values, and remember the plan's cost */
+static PlannedStmt *
+make_custom_plan(Query *parse, ParamListInfo boundParams, uint32 hashkey,
+				 const char *fingerprint, OptPlanCacheOptimizeFn optimize)
+{
+	OptPlanCacheEntry *entry;
+	PlannedStmt *result;
+	uint64		inval_count = opt_plan_cache_inval_count;
+
+	result = optimize(parse, boundParams);
+	opt_plan_cache_stats.customPlans++;
+
+	if (result == NULL || inval_count != opt_plan_cache_inval_count)
+		return result;
+
+	entry = enter_opt_plan_cache_entry(parse, hashkey, fingerprint);
+	entry->numCustomPlans++;
+	entry->totalCustomCost += result->planTree->total_cost;
+
+	return result;
+}
+
+/*
+ * Is ORCA known to be unable to plan the query generically?  The failure is
+ * forgotten every OPT_PLAN_CACHE_FAILED_CALLS calls, to try again.
+ */
+static bool
+generic_plan_failed(OptPlanCacheEntry *entry)
+{
+	if (!entry->genericFailed)
+		return false;
+
+	if (++entry->numFailedCalls < OPT_PLAN_CACHE_FAILED_CALLS)
+		return true;
+
+	entry->genericFailed = false;
+	return false;
+}
+
+/*
+ * OptPlanCacheGetPlan
+ *		Return the plan of a query, planned with 'optimize' on cache misses.
+ *
+ * The returned plan belongs to the caller.  Returns NULL if ORCA can't plan
+ * the query.
+ */
+PlannedStmt *
+OptPlanCacheGetPlan(Query *parse, ParamListInfo boundParams,
+					OptPlanCacheOptimizeFn optimize)
+{
+	OptPlanCacheEntry *entry;
+	PlannedStmt *result;
+	char	   *fingerprint;
+	uint32		hashkey;
+	double		generic_cost_limit;
+
+	if (optimizer_plan_cache_size <= 0 ||
+		query_contain_mutable_functions(parse))
+		return optimize(parse, boundParams);
+
+	if (!opt_plan_cache_callbacks_registered)
+	{
+		register_opt_plan_cache_callbacks();
+		init_opt_plan_cache_settings();
+		ResetOptPlanCache();
+		opt_plan_cache_callbacks_registered = true;
+	}
+
+	AcceptInvalidationMessages();
+	if (opt_plan_cache_needs_reset)
+	{
+		opt_plan_cache_stats.invalidations += hash_get_num_entries(OptPlanCacheHash);
+		ResetOptPlanCache();
+	}
+
+	fingerprint = make_fingerprint(parse);
+	hashkey = DatumGetUInt32(hash_any((unsigned char *) fingerprint,
+									  strlen(fingerprint)));
+	entry = find_opt_plan_cache_entry(hashkey, fingerprint);
+
+	if (boundParams == NULL || boundParams->numParams == 0)
+	{
+		if (entry != NULL && entry->plan != NULL)
+		{
+			opt_plan_cache_stats.hits++;
+			return (PlannedStmt *) copyObject(entry->plan);
+		}
+		if (entry != NULL && generic_plan_failed(entry))
+		{
+			opt_plan_cache_stats.hits++;
+			return NULL;
+		}
+
+		return make_generic_plan(parse, hashkey, fingerprint, optimize);
+	}
+
+	/* consider a generic plan once we know what custom plans cost */
+	if (entry == NULL ||
+		entry->numCustomPlans < OPT_PLAN_CACHE_CUSTOM_PLANS ||
+		generic_plan_failed(entry))
+		return make_custom_plan(parse, boundParams, hashkey, fingerprint, optimize);
+
+	generic_cost_limit = entry->totalCustomCost / entry->numCustomPlans *
+		OPT_PLAN_CACHE_GENERIC_COST_FACTOR;
+
+	if (entry->plan != NULL)
+	{
+		if (entry->plan->planTree->total_cost <= generic_cost_limit)
+		{
+			opt_plan_cache_stats.hits++;
+			return (PlannedStmt *) copyObject(entry->plan);
+		}
+	}
+	else
+	{
+		result = make_generic_plan(parse, hashkey, fingerprint, optimize);
+		if (result != NULL && result->planTree->total_cost <= generic_cost_limit)
+			return result;
+	}
+
+	return make_custom_plan(parse, boundParams, hashkey, fingerprint, optimize);
+}
+
+/*
+ * GetOptPlanCacheStats
+ *		Return the plan cache counters of the current session.
+ */
+OptPlanCacheStats *
+GetOptPlanCacheStats(void)
+{
+	return &opt_plan_cache_stats;
+}
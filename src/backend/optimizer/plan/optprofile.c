@@ -0,0 +1,97 @@
+/*-------------------------------------------------------------------------
+ *
+ * optprofile.c
+ *	  Per-phase profile of ORCA optimizations.
+ *
+ * The total planning time alone doesn't tell whether a slow optimization
+ * was spent translating the query, fetching metadata, searching for a plan
+ * or translating the plan back.  COptTasks fills in the profile of the
+ * optimization in progress; the profile of the last optimization is shown
+ * by EXPLAIN ANALYZE, and gp_opt_profile() reports the totals of the
+ * current session.
+ *
+ * Copyright (c) 2017, Pivotal Software, Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "optimizer/optprofile.h"
+
+/* optimization in progress, or the last one */
+static OptProfile currentProfile;
+
+/* totals of the optimizations completed in this session */
+static OptProfile sessionProfile;
+
+/*
+ * Start profiling an optimization, and return the profile to fill in.
+ */
+OptProfile *
+BeginOptProfile(void)
+{
+	MemSet(&currentProfile, 0, sizeof(currentProfile));
+	return &currentProfile;
+}
+
+/*
+ * Return the profile of the optimization in progress, or of the last one.
+ */
+OptProfile *
+GetOptProfile(void)
+{
+	return &currentProfile;
+}
+
+/*
+ * Finish profiling an optimization that produced a plan, and add it to the
+ * session totals.  Optimizations that failed or fell back to the planner
+ * are not counted, so it is called by the planner once the plan is used.
+ */
+void
+EndOptProfile(void)
+{
+	currentProfile.optimizations = 1;
+
+	sessionProfile.optimizations++;
+	sessionProfile.totalTime += currentProfile.totalTime;
+	sessionProfile.queryToDXLTime += currentProfile.queryToDXLTime;
+	sessionProfile.optimizeTime += currentProfile.optimizeTime;
+	sessionProfile.dxlToPlanTime += currentProfile.dxlToPlanTime;
+	sessionProfile.mdFetchTime += currentProfile.mdFetchTime;
+	sessionProfile.mdFetches += currentProfile.mdFetches;
+	sessionProfile.mdSharedHits += currentProfile.mdSharedHits;
+	sessionProfile.constExprEvals += currentProfile.constExprEvals;
+	sessionProfile.constExprHits += currentProfile.constExprHits;
+	sessionProfile.memoryPeak = Max(sessionProfile.memoryPeak,
+									currentProfile.memoryPeak);
+}
+
+/*
+ * Return the totals of the optimizations completed in this session.  The
+ * memory peak is the highest of any single optimization.
+ */
+const OptProfile *
+GetSessionOptProfile(void)
+{
+	return &sessionProfile;
+}
+
+/*
+ * Append a one-line description of the phases and counters of a profile to
+ * a string.
+ */
+void
+AppendOptProfile(StringInfo str, const OptProfile *profile)
+{
+	appendStringInfo(str, "total: %.3f ms", profile->totalTime);
+	appendStringInfo(str, ", query to DXL: %.3f ms", profile->queryToDXLTime);
+	appendStringInfo(str, ", optimize: %.3f ms", profile->optimizeTime);
+	appendStringInfo(str, ", DXL to plan: %.3f ms", profile->dxlToPlanTime);
+	appendStringInfo(str, ", metadata fetches: " UINT64_FORMAT " (%.3f ms)",
+					 profile->mdFetches, profile->mdFetchTime);
+	appendStringInfo(str, ", shared metadata hits: " UINT64_FORMAT, profile->mdSharedHits);
+	appendStringInfo(str, ", const expr evaluations: " UINT64_FORMAT " (" UINT64_FORMAT " memoized)",
+					 profile->constExprEvals, profile->constExprHits);
+	appendStringInfo(str, ", memory peak: " UINT64_FORMAT " kB", (profile->memoryPeak + 1023) / 1024);
+}
@@ -26,6 +26,8 @@
 #include "nodes/makefuncs.h"
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
+#include "optimizer/optplancache.h"
+#include "optimizer/optprofile.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
 #include "optimizer/planmain.h"
@@ -233,6 +235,9 @@ optimize_query(Query *parse, ParamListInfo boundParams)
 	if (!result)
 		return NULL;
 
+	/* the optimizations that fell back are left out of the session totals */
+	EndOptProfile();
+
 	/*
 	 * Post-process the plan.
 	 */
@@ -365,7 +370,7 @@ planner(Query *parse, int cursorOptions, ParamListInfo boundParams)
 		}
 		START_MEMORY_ACCOUNT(MemoryAccounting_CreateAccount(0, MEMORY_OWNER_TYPE_Optimizer));
 		{
-			result = optimize_query(parse, boundParams);
+			result = OptPlanCacheGetPlan(parse, boundParams, optimize_query);
 		}
 		END_MEMORY_ACCOUNT();
 
@@ -742,12 +742,38 @@ contain_mutable_functions(Node *clause)
 	return contain_mutable_functions_walker(clause, NULL);
 }
 
+/*
+ * query_contain_mutable_functions
+ *	  Like contain_mutable_functions, but searches a whole Query, including
+ *	  its sub-selects.
+ */
+bool
+query_contain_mutable_functions(Query *query)
+{
+	bool		recurse = true;
+
+	return query_tree_walker(query, contain_mutable_functions_walker,
+							 &recurse, 0);
+}
+
+/*
+ * context is NULL, or points to true if sub-selects are searched too.
+ */
 static bool
 contain_mutable_functions_walker(Node *node, void *context)
 {
 	if (node == NULL)
 		return false;
 
+	if (IsA(node, Query))
+	{
+		if (context == NULL)
+			return false;
+		return query_tree_walker((Query *) node,
+								 contain_mutable_functions_walker,
+								 context, 0);
+	}
+
     /* the functions in predtest.c handle expressions and
      * RestrictInfo objects -- so make this function handle
      * them too for convenience */
@@ -69,6 +69,7 @@
 #include "executor/spi.h"
 #include "utils/workfile_mgr.h"
 #include "utils/session_state.h"
+#include "utils/sharedmdcache.h"
 
 shmem_startup_hook_type shmem_startup_hook = NULL;
 
@@ -233,6 +234,9 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 		/* Consider the size of the SessionState array */
 		size = add_size(size, SessionState_ShmemSize());
 
+		/* size of the shared metadata cache of the optimizer */
+		size = add_size(size, SharedMDCacheShmemSize());
+
 		/*
 		 * Create the shmem segment
 		 */
@@ -342,6 +346,9 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 
 	/* Initialize SessionState shared memory array */
 	SessionState_ShmemInit();
+
+	/* Initialize the shared metadata cache of the optimizer */
+	SharedMDCacheShmemInit();
 	/* Initialize vmem protection */
 	GPMemoryProtect_ShmemInit();
 
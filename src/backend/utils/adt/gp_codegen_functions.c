@@ -0,0 +1,28 @@
+/*
+ * gp_codegen_functions.c
+ *    Defines builtin functions for the code generator.
+ *
+ * gp_codegen_module_cache_stats: Returns the counters of the cache of
+ * compiled modules of the code generator.
+ *
+ * Copyright(c) 2017 - present, Pivotal Software, Inc.
+ */
+
+#include "postgres.h"
+
+#include "codegen/codegen_wrapper.h"
+#include "utils/builtins.h"
+
+/*
+* Returns the counters of the code generator's cache of compiled modules in
+* the current session.
+*/
+Datum
+gp_codegen_module_cache_stats(PG_FUNCTION_ARGS __attribute__((unused)))
+{
+#ifdef USE_CODEGEN
+	return CStringGetTextDatum(CodegenModuleCacheStats());
+#else
+	return CStringGetTextDatum("Server has been compiled without codegen");
+#endif
+}
@@ -8,12 +8,22 @@
  *
  * gp_opt_version: This function wraps LibraryVersion. 
  *
+ * gp_opt_mdcache_stats: This function wraps MDCacheStats.
+ *
+ * gp_opt_plancache_stats: Returns the counters of the ORCA plan cache.
+ *
+ * gp_opt_profile: Returns the time spent in each phase of the ORCA
+ * optimizations of the session, and the ORCA counters.
+ *
  * Copyright(c) 2012 - present, EMC/Greenplum
  */
 
 #include "postgres.h"
 
 #include "funcapi.h"
+#include "lib/stringinfo.h"
+#include "optimizer/optplancache.h"
+#include "optimizer/optprofile.h"
 #include "utils/builtins.h"
 
 extern Datum EnableXform(PG_FUNCTION_ARGS);
@@ -25,6 +35,8 @@ Datum
 enable_xform(PG_FUNCTION_ARGS)
 {
 #ifdef USE_ORCA
+	/* cached plans were produced with the old set of transformations */
+	ResetOptPlanCache();
 	return EnableXform(fcinfo);
 #else
 	return CStringGetTextDatum("Server has been compiled without ORCA");
@@ -40,6 +52,8 @@ Datum
 disable_xform(PG_FUNCTION_ARGS)
 {
 #ifdef USE_ORCA
+	/* cached plans were produced with the old set of transformations */
+	ResetOptPlanCache();
 	return DisableXform(fcinfo);
 #else
 	return CStringGetTextDatum("Server has been compiled without ORCA");
@@ -60,3 +74,59 @@ gp_opt_version(PG_FUNCTION_ARGS __attribute__((unused)))
 	return CStringGetTextDatum("Server has been compiled without ORCA");
 #endif
 }
+
+extern Datum MDCacheStats();
+
+/*
+* Returns the optimizer metadata cache counters of the current session.
+*/
+Datum
+gp_opt_mdcache_stats(PG_FUNCTION_ARGS __attribute__((unused)))
+{
+#ifdef USE_ORCA
+	return MDCacheStats();
+#else
+	return CStringGetTextDatum("Server has been compiled without ORCA");
+#endif
+}
+
+/*
+* Returns the optimizer plan cache counters of the current session.
+*/
+Datum
+gp_opt_plancache_stats(PG_FUNCTION_ARGS __attribute__((unused)))
+{
+#ifdef USE_ORCA
+	OptPlanCacheStats *stats = GetOptPlanCacheStats();
+	StringInfoData str;
+
+	initStringInfo(&str);
+	appendStringInfo(&str, "hits: " UINT64_FORMAT, stats->hits);
+	appendStringInfo(&str, ", misses: " UINT64_FORMAT, stats->misses);
+	appendStringInfo(&str, ", custom plans: " UINT64_FORMAT, stats->customPlans);
+	appendStringInfo(&str, ", invalidations: " UINT64_FORMAT, stats->invalidations);
+	return CStringGetTextDatum(str.data);
+#else
+	return CStringGetTextDatum("Server has been compiled without ORCA");
+#endif
+}
+
+/*
+* Returns the time spent in each optimizer phase, and the optimizer counters,
+* summed over the optimizations of the current session.
+*/
+Datum
+gp_opt_profile(PG_FUNCTION_ARGS __attribute__((unused)))
+{
+#ifdef USE_ORCA
+	const OptProfile *profile = GetSessionOptProfile();
+	StringInfoData str;
+
+	initStringInfo(&str);
+	appendStringInfo(&str, "optimizations: " UINT64_FORMAT ", ", profile->optimizations);
+	AppendOptProfile(&str, profile);
+	return CStringGetTextDatum(str.data);
+#else
+	return CStringGetTextDatum("Server has been compiled without ORCA");
+#endif
+}
@@ -163,10 +163,10 @@ static TransInvalidationInfo *transInvalInfo = NULL;
  * assumes there won't be very many of these at once; could improve if needed.
  */
 /*
- * MAX_SYSCACHE_CALLBACKS has been bumped up in GPDB, because ORCA registers
- * a lot of callbacks.
+ * MAX_SYSCACHE_CALLBACKS has been bumped up in GPDB, because ORCA and the
+ * shared metadata cache register a lot of callbacks.
  */
-#define MAX_SYSCACHE_CALLBACKS 40
+#define MAX_SYSCACHE_CALLBACKS 64
 #define MAX_RELCACHE_CALLBACKS 5
 
 static struct SYSCACHECALLBACK
@@ -537,7 +537,8 @@ LocalExecuteInvalidationMessage(SharedInvalidationMessage *msg)
 
 				if (ccitem->id == msg->cc.id)
 					(*ccitem->function) (ccitem->arg,
-										 msg->cc.id, &msg->cc.tuplePtr);
+										 msg->cc.id, &msg->cc.tuplePtr,
+										 msg->cc.hashValue);
 			}
 		}
 	}
@@ -595,7 +596,7 @@ InvalidateSystemCaches(void)
 	{
 		struct SYSCACHECALLBACK *ccitem = syscache_callback_list + i;
 
-		(*ccitem->function) (ccitem->arg, ccitem->id, NULL);
+		(*ccitem->function) (ccitem->arg, ccitem->id, NULL, 0);
 	}
 
 	for (i = 0; i < relcache_callback_count; i++)
@@ -1284,8 +1285,10 @@ CacheInvalidateRelcacheByRelid(Oid relid)
 /*
  * CacheRegisterSyscacheCallback
  *		Register the specified function to be called for all future
- *		invalidation events in the specified cache.  The cache ID and the
- *		TID of the tuple being invalidated will be passed to the function.
+ *		invalidation events in the specified cache.  The cache ID, the
+ *		TID of the tuple being invalidated and the hash value of its cache
+ *		key will be passed to the function.  GetSysCacheHashValue() computes
+ *		the same hash value from a key, to tell which entry is invalidated.
  *
  * NOTE: NULL will be passed for the TID if a cache reset request is received.
  * In this case the called routines should flush all cached state.
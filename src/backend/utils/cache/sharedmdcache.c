@@ -0,0 +1,486 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedmdcache.c
+ *	  Cache of serialized optimizer metadata objects, shared by all backends.
+ *
+ * The metadata cache of ORCA lives in backend-local memory, so every new
+ * session has to translate relcache entries, statistics and other catalog
+ * information into metadata objects again before it can plan its first
+ * queries.  This module keeps the serialized (DXL) form of those objects in
+ * shared memory, keyed by database and metadata id, so that a backend can
+ * pick up objects that another backend has already translated.
+ *
+ * Values are stored in a ring buffer: new values are appended at the head,
+ * overwriting the oldest ones, and an entry whose value has been overwritten
+ * is simply treated as missing.  Entries are therefore never freed
+ * explicitly, except when the hash table itself is full.
+ *
+ * Validity of an entry is tracked with a global invalidation counter, which
+ * plays the role of a catalog version.  Every catalog entry a cached object
+ * is built from is hashed into one of SHARED_MDCACHE_NUM_SLOTS slots.  When
+ * a backend processes an invalidation message, it bumps the counter and
+ * stamps the new value on the slot of the invalidated catalog entry (or on
+ * all slots, for a cache reset).  An object records the counter value taken
+ * before its catalog entries were read, and is valid as long as none of its
+ * slots has been stamped since.  Slot collisions only cause spurious misses.
+ * The counter and the slots are atomics, so that processing invalidation
+ * messages never waits for SharedMDCacheLock.
+ *
+ * Each backend processes the invalidation messages itself, and accepts them
+ * before taking a snapshot of the counter.  So only the backends that use the
+ * cache, i.e. ORCA on the dispatcher, need to register the callbacks, which
+ * they do at backend startup.
+ *
+ * Entries also keep the catalog entries they depend on, so that a backend
+ * that takes an object from the cache can track it in its own metadata cache
+ * as if it had translated the object itself.
+ *
+ * Copyright (c) 2017, Pivotal Software, Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "access/transam.h"
+#include "access/xact.h"
+#include "cdb/cdbvars.h"
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/sharedmdcache.h"
+#include "utils/syscache.h"
+
+/* number of invalidation slots catalog entries are hashed into */
+#define SHARED_MDCACHE_NUM_SLOTS	4096
+
+/* expected average size of a serialized object, used to size the hash table */
+#define SHARED_MDCACHE_AVG_VALUE_SIZE	2048
+
+typedef struct SharedMDCacheKey
+{
+	Oid			dbid;
+	char		mdid[SHARED_MDCACHE_KEYLEN];
+} SharedMDCacheKey;
+
+typedef struct SharedMDCacheEntry
+{
+	SharedMDCacheKey key;		/* hash key --- MUST BE FIRST */
+	uint64		pos;			/* logical position of the value in the arena */
+	uint32		len;			/* length of the value, including NUL */
+	uint64		snapshot;		/* counter value the object was built at */
+	int			ndeps;
+	SharedMDCacheDep deps[SHARED_MDCACHE_MAX_DEPS];
+	uint16		slots[SHARED_MDCACHE_MAX_DEPS];	/* invalidation slots of deps */
+} SharedMDCacheEntry;
+
+/*
+ * counter, resetCounter and slotCounters are updated without holding
+ * SharedMDCacheLock; head is protected by the lock.
+ */
+typedef struct SharedMDCacheHeader
+{
+	pg_atomic_uint64 counter;	/* last invalidation counter value handed out */
+	pg_atomic_uint64 resetCounter;	/* counter value of the last cache reset */
+	uint64		head;			/* logical position of the next value */
+	pg_atomic_uint64 slotCounters[SHARED_MDCACHE_NUM_SLOTS];
+} SharedMDCacheHeader;
+
+static SharedMDCacheHeader *SharedMDCache = NULL;
+static HTAB *SharedMDCacheHash = NULL;
+static char *SharedMDCacheArena = NULL;
+
+static Size
+shared_mdcache_arena_size(void)
+{
+	return mul_size((Size) optimizer_shared_mdcache_size, 1024);
+}
+
+static long
+shared_mdcache_max_entries(void)
+{
+	return Max(shared_mdcache_arena_size() / SHARED_MDCACHE_AVG_VALUE_SIZE, 64);
+}
+
+/*
+ * Report shared-memory space needed by SharedMDCacheShmemInit
+ */
+Size
+SharedMDCacheShmemSize(void)
+{
+	Size		size;
+
+	if (optimizer_shared_mdcache_size <= 0)
+		return 0;
+
+	size = MAXALIGN(sizeof(SharedMDCacheHeader));
+	size = add_size(size, hash_estimate_size(shared_mdcache_max_entries(),
+											 sizeof(SharedMDCacheEntry)));
+	size = add_size(size, shared_mdcache_arena_size());
+
+	return size;
+}
+
+/*
+ * Initialize the shared metadata cache, if it is enabled
+ */
+void
+SharedMDCacheShmemInit(void)
+{
+	HASHCTL		info;
+	bool		found;
+
+	if (optimizer_shared_mdcache_size <= 0)
+		return;
+
+	SharedMDCache = (SharedMDCacheHeader *)
+		ShmemInitStruct("Shared MD Cache Header",
+						MAXALIGN(sizeof(SharedMDCacheHeader)),
+						&found);
+	if (!found)
+	{
+		int			i;
+
+		pg_atomic_init_u64(&SharedMDCache->counter, 0);
+		pg_atomic_init_u64(&SharedMDCache->resetCounter, 0);
+		SharedMDCache->head = 0;
+		for (i = 0; i < SHARED_MDCACHE_NUM_SLOTS; i++)
+			pg_atomic_init_u64(&SharedMDCache->slotCounters[i], 0);
+	}
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(SharedMDCacheKey);
+	info.entrysize = sizeof(SharedMDCacheEntry);
+	info.hash = tag_hash;
+
+	/*
+	 * The table must not grow into the shared memory slop other hash tables
+	 * rely on, inserts into a full table just don't cache the object.
+	 */
+	SharedMDCacheHash = ShmemInitHash("Shared MD Cache Hash",
+									  shared_mdcache_max_entries(),
+									  shared_mdcache_max_entries(),
+									  &info,
+									  HASH_ELEM | HASH_FUNCTION | HASH_FIXED_SIZE);
+	if (!SharedMDCacheHash)
+		ereport(FATAL,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("insufficient shared memory for shared metadata cache")));
+
+	SharedMDCacheArena = (char *) ShmemInitStruct("Shared MD Cache Arena",
+												  shared_mdcache_arena_size(),
+												  &found);
+}
+
+static int
+shared_mdcache_slot(int cacheId, uint32 hashValue)
+{
+	uint32		key[3];
+
+	/* the same catalog entry of different databases is different */
+	key[0] = MyDatabaseId;
+	key[1] = (uint32) cacheId;
+	key[2] = hashValue;
+
+	return DatumGetUInt32(hash_any((unsigned char *) key, sizeof(key))) %
+		SHARED_MDCACHE_NUM_SLOTS;
+}
+
+/*
+ * Raise *stamp to value.  Concurrent invalidations may hand out counter
+ * values in one order and stamp them in another, so a stamp never goes back.
+ */
+static void
+shared_mdcache_stamp(pg_atomic_uint64 *stamp, uint64 value)
+{
+	uint64		old = pg_atomic_read_u64(stamp);
+
+	while (old < value)
+	{
+		if (pg_atomic_compare_exchange_u64(stamp, &old, value))
+			break;
+	}
+}
+
+static void
+shared_mdcache_invalidate(int cacheId, uint32 hashValue)
+{
+	uint64		counter = pg_atomic_add_fetch_u64(&SharedMDCache->counter, 1);
+	int			slot = shared_mdcache_slot(cacheId, hashValue);
+
+	shared_mdcache_stamp(&SharedMDCache->slotCounters[slot], counter);
+}
+
+static void
+shared_mdcache_invalidate_all(void)
+{
+	uint64		counter = pg_atomic_add_fetch_u64(&SharedMDCache->counter, 1);
+
+	shared_mdcache_stamp(&SharedMDCache->resetCounter, counter);
+}
+
+/*
+ * Callbacks are called while processing invalidation messages, so they must
+ * not throw errors.
+ */
+static void
+shared_mdsyscache_callback(Datum arg, int cacheid, ItemPointer tuplePtr,
+						   uint32 hashValue)
+{
+	bool		fine_grained = DatumGetBool(arg);
+
+	if (NULL == tuplePtr || !fine_grained)
+		shared_mdcache_invalidate_all();
+	else
+		shared_mdcache_invalidate(cacheid, hashValue);
+}
+
+static void
+shared_mdrelcache_callback(Datum arg, Oid relid)
+{
+	if (!OidIsValid(relid))
+		shared_mdcache_invalidate_all();
+	else
+		shared_mdcache_invalidate(MDCACHE_RELCACHE_ID, relid);
+}
+
+/*
+ * InitSharedMDCache
+ *		Register the invalidation callbacks of the shared metadata cache.
+ *
+ * The catalogs are the same as the ones the ORCA metadata cache registers
+ * callbacks for, see gpdbwrappers.cpp.
+ */
+void
+InitSharedMDCache(void)
+{
+	/* Catalog tables whose syscache key identifies a single object. */
+	int			fine_grained_caches[] = {
+		AGGFNOID,
+		CONSTROID,
+		OPEROID,
+		STATRELATT,
+		TYPEOID,
+		PROCOID,
+	};
+
+	/* Catalog tables whose changes invalidate all objects. */
+	int			other_caches[] = {
+		AMOPOPID,
+		CASTSOURCETARGET,
+		OPFAMILYOID,
+		PARTOID,
+		PARTRULEOID,
+	};
+	int			i;
+
+	/* the cache is only used by ORCA on the dispatcher */
+	if (SharedMDCache == NULL || Gp_role != GP_ROLE_DISPATCH)
+		return;
+
+	for (i = 0; i < lengthof(fine_grained_caches); i++)
+		CacheRegisterSyscacheCallback(fine_grained_caches[i],
+									  shared_mdsyscache_callback,
+									  BoolGetDatum(true));
+
+	for (i = 0; i < lengthof(other_caches); i++)
+		CacheRegisterSyscacheCallback(other_caches[i],
+									  shared_mdsyscache_callback,
+									  BoolGetDatum(false));
+
+	CacheRegisterRelcacheCallback(shared_mdrelcache_callback, (Datum) 0);
+}
+
+/*
+ * SharedMDCacheEnabled
+ *		Can the current transaction use the shared metadata cache?
+ *
+ * A transaction that has an xid may have modified the catalogs, and objects
+ * it sees must not leak to other backends.
+ */
+bool
+SharedMDCacheEnabled(void)
+{
+	return SharedMDCache != NULL &&
+		Gp_role == GP_ROLE_DISPATCH &&
+		!TransactionIdIsValid(GetTopTransactionIdIfAny());
+}
+
+/*
+ * SharedMDCacheSnapshot
+ *		Return the invalidation counter to pass to SharedMDCacheInsert().
+ *
+ * Must be called before reading the catalog entries of the object to insert.
+ * Pending invalidation messages are processed after reading the counter, so
+ * that the catalog caches of this backend are not older than the snapshot.
+ */
+uint64
+SharedMDCacheSnapshot(void)
+{
+	uint64		snapshot;
+
+	Assert(SharedMDCache != NULL);
+
+	snapshot = pg_atomic_read_u64(&SharedMDCache->counter);
+	pg_memory_barrier();
+
+	AcceptInvalidationMessages();
+
+	return snapshot;
+}
+
+/* Is the entry still valid?  Caller must hold SharedMDCacheLock. */
+static bool
+shared_mdcache_entry_is_valid(SharedMDCacheEntry *entry)
+{
+	int			i;
+
+	/* value has been overwritten by newer ones */
+	if (SharedMDCache->head - entry->pos > shared_mdcache_arena_size())
+		return false;
+
+	if (pg_atomic_read_u64(&SharedMDCache->resetCounter) > entry->snapshot)
+		return false;
+
+	for (i = 0; i < entry->ndeps; i++)
+	{
+		if (pg_atomic_read_u64(&SharedMDCache->slotCounters[entry->slots[i]]) >
+			entry->snapshot)
+			return false;
+	}
+
+	return true;
+}
+
+static void
+shared_mdcache_make_key(SharedMDCacheKey *hkey, const char *key)
+{
+	MemSet(hkey, 0, sizeof(SharedMDCacheKey));
+	hkey->dbid = MyDatabaseId;
+	strlcpy(hkey->mdid, key, SHARED_MDCACHE_KEYLEN);
+}
+
+/*
+ * SharedMDCacheLookup
+ *		Look up the serialized object with the given key.
+ *
+ * Returns a palloc'd copy of the value, or NULL if there is no valid entry.
+ * The catalog entries the object depends on are returned in deps, which must
+ * have room for SHARED_MDCACHE_MAX_DEPS entries, and their number in *ndeps.
+ */
+char *
+SharedMDCacheLookup(const char *key, SharedMDCacheDep *deps, int *ndeps)
+{
+	SharedMDCacheKey hkey;
+	SharedMDCacheEntry *entry;
+	char	   *value = NULL;
+
+	Assert(SharedMDCache != NULL);
+
+	if (strlen(key) >= SHARED_MDCACHE_KEYLEN)
+		return NULL;
+
+	shared_mdcache_make_key(&hkey, key);
+
+	LWLockAcquire(SharedMDCacheLock, LW_SHARED);
+
+	entry = (SharedMDCacheEntry *) hash_search(SharedMDCacheHash, &hkey,
+											   HASH_FIND, NULL);
+	if (entry != NULL && shared_mdcache_entry_is_valid(entry))
+	{
+		value = palloc(entry->len);
+		memcpy(value,
+			   SharedMDCacheArena + entry->pos % shared_mdcache_arena_size(),
+			   entry->len);
+		memcpy(deps, entry->deps, entry->ndeps * sizeof(SharedMDCacheDep));
+		*ndeps = entry->ndeps;
+	}
+
+	LWLockRelease(SharedMDCacheLock);
+
+	return value;
+}
+
+/* Remove all invalid entries.  Caller must hold SharedMDCacheLock exclusively. */
+static void
+shared_mdcache_sweep(void)
+{
+	HASH_SEQ_STATUS status;
+	SharedMDCacheEntry *entry;
+
+	hash_seq_init(&status, SharedMDCacheHash);
+	while ((entry = (SharedMDCacheEntry *) hash_seq_search(&status)) != NULL)
+	{
+		if (!shared_mdcache_entry_is_valid(entry))
+			hash_search(SharedMDCacheHash, &entry->key, HASH_REMOVE, NULL);
+	}
+}
+
+/*
+ * SharedMDCacheInsert
+ *		Store a serialized object, built from the catalogs as of snapshot.
+ *
+ * Objects that don't fit are silently not cached.
+ */
+void
+SharedMDCacheInsert(const char *key, const char *value, uint64 snapshot,
+					const SharedMDCacheDep *deps, int ndeps)
+{
+	SharedMDCacheKey hkey;
+	SharedMDCacheEntry *entry;
+	Size		arenaSize = shared_mdcache_arena_size();
+	Size		len = strlen(value) + 1;
+	uint64		pos;
+	int			i;
+
+	Assert(SharedMDCache != NULL);
+
+	/* keep large objects from flushing out everything else */
+	if (strlen(key) >= SHARED_MDCACHE_KEYLEN ||
+		ndeps > SHARED_MDCACHE_MAX_DEPS ||
+		len > arenaSize / 4)
+		return;
+
+	shared_mdcache_make_key(&hkey, key);
+
+	LWLockAcquire(SharedMDCacheLock, LW_EXCLUSIVE);
+
+	entry = (SharedMDCacheEntry *) hash_search(SharedMDCacheHash, &hkey,
+											   HASH_ENTER_NULL, NULL);
+	if (entry == NULL)
+	{
+		shared_mdcache_sweep();
+		entry = (SharedMDCacheEntry *) hash_search(SharedMDCacheHash, &hkey,
+												   HASH_ENTER_NULL, NULL);
+		if (entry == NULL)
+		{
+			LWLockRelease(SharedMDCacheLock);
+			return;
+		}
+	}
+
+	/* values are contiguous, skip the end of the arena if it doesn't fit */
+	pos = SharedMDCache->head;
+	if (pos % arenaSize + len > arenaSize)
+		pos += arenaSize - pos % arenaSize;
+
+	memcpy(SharedMDCacheArena + pos % arenaSize, value, len);
+	SharedMDCache->head = pos + len;
+
+	entry->pos = pos;
+	entry->len = len;
+	entry->snapshot = snapshot;
+	entry->ndeps = ndeps;
+	for (i = 0; i < ndeps; i++)
+	{
+		entry->deps[i] = deps[i];
+		entry->slots[i] = shared_mdcache_slot(deps[i].cacheId,
+											  deps[i].hashValue);
+	}
+
+	LWLockRelease(SharedMDCacheLock);
+}
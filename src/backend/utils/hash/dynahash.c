@@ -167,6 +167,7 @@ struct HTAB
 	MemoryContext hcxt;			/* memory context if default allocator used */
 	char	   *tabname;		/* table name (for error messages) */
 	bool		isshared;		/* true if table is in shared memory */
+	bool		isfixed;		/* if true, don't enlarge */
 
 	/* freezing a shared table isn't allowed, so we can keep state here */
 	bool		frozen;			/* true = no more inserts allowed */
@@ -345,6 +346,8 @@ hash_create(const char *tabname, long nelem, HASHCTL *info, int flags)
 		/* hash table already exists, we're just attaching to it */
 		if (flags & HASH_ATTACH)
 		{
+			hashp->isfixed = (flags & HASH_FIXED_SIZE) != 0;
+
 			/* make local copies of some heavily-used values */
 			hctl = hashp->hctl;
 			hashp->keysize = hctl->keysize;
@@ -449,6 +452,8 @@ hash_create(const char *tabname, long nelem, HASHCTL *info, int flags)
 					 errmsg("out of memory")));
 	}
 
+	if (flags & HASH_FIXED_SIZE)
+		hashp->isfixed = true;
 	return hashp;
 }
 
@@ -1011,6 +1016,10 @@ get_hash_entry(HTAB *hashp)
 		if (IS_PARTITIONED(hctlv))
 			SpinLockRelease(&hctlv->mutex);
 
+		/* a fixed-size table doesn't grow beyond its preallocated elements */
+		if (hashp->isfixed)
+			return NULL;
+
 		if (!element_alloc(hashp, hctlv->nelem_alloc))
 		{
 			/* out of memory */
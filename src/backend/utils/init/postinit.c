@@ -55,6 +55,7 @@
 #include "utils/ps_status.h"
 #include "utils/relcache.h"
 #include "utils/resscheduler.h"
+#include "utils/sharedmdcache.h"
 #include "utils/sharedsnapshot.h"
 #include "utils/syscache.h"
 #include "pgstat.h"
@@ -638,6 +639,7 @@ InitPostgres(const char *in_dbname, Oid dboid, const char *username,
 	RelationCacheInitialize();
 	InitCatalogCache();
 	InitPlanCache();
+	InitSharedMDCache();
 
 	/* Initialize portal manager */
 	EnablePortalManager();
@@ -471,6 +471,8 @@ bool		optimizer_minidump;
 int			optimizer_cost_model;
 bool		optimizer_metadata_caching;
 int			optimizer_mdcache_size;
+int			optimizer_shared_mdcache_size;
+int			optimizer_plan_cache_size;
 
 /* Optimizer debugging GUCs */
 bool		optimizer_print_query;
@@ -577,8 +579,16 @@ bool		codegen_exec_variable_list;
 bool		codegen_slot_getattr;
 bool		codegen_exec_eval_expr;
 bool		codegen_advance_aggregate;
+bool		codegen_exec_hash_get_hash_value;
+bool		codegen_agg_hash_lookup;
+bool		codegen_async_compile;
+bool		codegen_cost_based_enrollment;
+double		codegen_compile_fixed_cost;
+double		codegen_compile_instruction_cost;
+double		codegen_instruction_saving;
 int		codegen_varlen_tolerance;
 int		codegen_optimization_level;
+int		codegen_module_cache_size;
 static char 	*codegen_optimization_level_str = NULL;
 
 /* System Information */
@@ -3256,6 +3266,53 @@ struct config_bool ConfigureNamesBool_gp[] =
 #endif
 		assign_codegen, NULL
 	},
+	{
+		{"codegen_exec_hash_get_hash_value", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Enable codegen for ExecHashGetHashValue"),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_exec_hash_get_hash_value,
+#ifdef USE_CODEGEN
+		true,
+#else
+		false,
+#endif
+		assign_codegen, NULL
+	},
+	{
+		{"codegen_agg_hash_lookup", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Enable codegen for the hash table lookup of hash aggregates (calc_hash_value and match_agg_hash_entry)"),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_agg_hash_lookup,
+#ifdef USE_CODEGEN
+		true,
+#else
+		false,
+#endif
+		assign_codegen, NULL
+	},
+	{
+		{"codegen_async_compile", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Compile generated code in the background, running the regular functions until it is ready."),
+			NULL,
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_async_compile,
+		false,
+		assign_codegen, NULL
+	},
+	{
+		{"codegen_cost_based_enrollment", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Generate code only for plan nodes whose estimated rows make up for the compilation, and choose the optimization level per node."),
+			gettext_noop("codegen_optimization_level is the highest level chosen."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_cost_based_enrollment,
+		false, assign_codegen, NULL
+	},
 	{
 		{"vmem_process_interrupt", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Checks for interrupts before reserving VMEM"),
@@ -4599,6 +4656,26 @@ struct config_int ConfigureNamesInt_gp[] =
 		16384, 0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"optimizer_shared_mdcache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the MDCache shared by all sessions."),
+			gettext_noop("0 disables the shared MDCache."),
+			GUC_UNIT_KB
+		},
+		&optimizer_shared_mdcache_size,
+		0, 0, MAX_KILOBYTES, NULL, NULL
+	},
+
+	{
+		{"optimizer_plan_cache_size", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the maximum number of plans produced by GPORCA cached in a session."),
+			gettext_noop("0 disables the plan cache."),
+			GUC_GPDB_ADDOPT
+		},
+		&optimizer_plan_cache_size,
+		0, 0, INT_MAX, NULL, NULL
+	},
+
 	{
 		{"memory_profiler_dataset_size", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Set the size in GB"),
@@ -4674,6 +4751,21 @@ struct config_int ConfigureNamesInt_gp[] =
 		0, INT_MAX, NULL, NULL
 	},
 
+	{
+		{"codegen_module_cache_size", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the maximum memory used to keep compiled code for reuse by later executions."),
+			gettext_noop("0 disables the cache."),
+			GUC_UNIT_KB | GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_module_cache_size,
+#ifdef USE_CODEGEN
+		8192,
+#else
+		0,
+#endif
+		0, MAX_KILOBYTES, NULL, NULL
+	},
+
 	{
 		{"dtx_phase2_retry_count", PGC_SUSET, DEVELOPER_OPTIONS,
 			gettext_noop("Maximum number of retries during two phase commit after which master PANICs."),
@@ -4879,6 +4971,36 @@ struct config_real ConfigureNamesReal_gp[] =
 		1.0, 0.0, DBL_MAX, NULL, NULL
 	},
 
+	{
+		{"codegen_compile_fixed_cost", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the estimated time, in microseconds, to set up the compilation of generated code."),
+			gettext_noop("Used by codegen_cost_based_enrollment."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_compile_fixed_cost,
+		2000.0, 0.0, DBL_MAX, NULL, NULL
+	},
+
+	{
+		{"codegen_compile_instruction_cost", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the estimated time, in microseconds, to compile an instruction of generated code at the default optimization level."),
+			gettext_noop("Used by codegen_cost_based_enrollment."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_compile_instruction_cost,
+		20.0, 0.0, DBL_MAX, NULL, NULL
+	},
+
+	{
+		{"codegen_instruction_saving", PGC_USERSET, DEVELOPER_OPTIONS,
+			gettext_noop("Sets the estimated time, in microseconds, saved per row by an instruction of generated code at the default optimization level."),
+			gettext_noop("Used by codegen_cost_based_enrollment."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&codegen_instruction_saving,
+		0.0035, 0.0, DBL_MAX, NULL, NULL
+	},
+
 	/* End-of-list marker */
 	{
 		{NULL, 0, 0, NULL, NULL}, NULL, 0.0, 0.0, 0.0, NULL, NULL
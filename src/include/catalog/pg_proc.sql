@@ -1699,6 +1699,14 @@ CREATE FUNCTION gp_nondbspecific_ptcat_verification() RETURNS bool LANGUAGE inte
  CREATE FUNCTION enable_xform(text) RETURNS text LANGUAGE internal IMMUTABLE STRICT AS 'enable_xform' WITH (OID=6088, DESCRIPTION="enables transformations in the optimizer");
 
  CREATE FUNCTION gp_opt_version() RETURNS text LANGUAGE internal IMMUTABLE STRICT AS 'gp_opt_version' WITH (OID=6089, DESCRIPTION="Returns the optimizer and gpos library versions");
+
+ CREATE FUNCTION gp_opt_mdcache_stats() RETURNS text LANGUAGE internal VOLATILE STRICT AS 'gp_opt_mdcache_stats' WITH (OID=6099, DESCRIPTION="Returns the optimizer metadata cache counters of the current session");
+
+ CREATE FUNCTION gp_opt_plancache_stats() RETURNS text LANGUAGE internal VOLATILE STRICT AS 'gp_opt_plancache_stats' WITH (OID=6100, DESCRIPTION="Returns the optimizer plan cache counters of the current session");
+
+ CREATE FUNCTION gp_opt_profile() RETURNS text LANGUAGE internal VOLATILE STRICT AS 'gp_opt_profile' WITH (OID=6110, DESCRIPTION="Returns the time spent in each optimizer phase and the optimizer counters of the current session");
+
+ CREATE FUNCTION gp_codegen_module_cache_stats() RETURNS text LANGUAGE internal VOLATILE STRICT AS 'gp_codegen_module_cache_stats' WITH (OID=6111, DESCRIPTION="Returns the code generator compiled module cache counters of the current session");
  
  
   -- functions for the complex data type
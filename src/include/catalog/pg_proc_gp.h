@@ -2814,6 +2814,22 @@ DESCR("enables transformations in the optimizer");
 DATA(insert OID = 6089 ( gp_opt_version  PGNSP PGUID 12 1 0 0 f f t f i 0 0 25 f "" _null_ _null_ _null_ _null_ gp_opt_version _null_ _null_ _null_ n ));
 DESCR("Returns the optimizer and gpos library versions");
 
+/* gp_opt_mdcache_stats() => text */ 
+DATA(insert OID = 6099 ( gp_opt_mdcache_stats  PGNSP PGUID 12 1 0 0 f f t f v 0 0 25 f "" _null_ _null_ _null_ _null_ gp_opt_mdcache_stats _null_ _null_ _null_ n ));
+DESCR("Returns the optimizer metadata cache counters of the current session");
+
+/* gp_opt_plancache_stats() => text */ 
+DATA(insert OID = 6100 ( gp_opt_plancache_stats  PGNSP PGUID 12 1 0 0 f f t f v 0 0 25 f "" _null_ _null_ _null_ _null_ gp_opt_plancache_stats _null_ _null_ _null_ n ));
+DESCR("Returns the optimizer plan cache counters of the current session");
+
+/* gp_opt_profile() => text */ 
+DATA(insert OID = 6110 ( gp_opt_profile  PGNSP PGUID 12 1 0 0 f f t f v 0 0 25 f "" _null_ _null_ _null_ _null_ gp_opt_profile _null_ _null_ _null_ n ));
+DESCR("Returns the time spent in each optimizer phase and the optimizer counters of the current session");
+
+/* gp_codegen_module_cache_stats() => text */ 
+DATA(insert OID = 6111 ( gp_codegen_module_cache_stats  PGNSP PGUID 12 1 0 0 f f t f v 0 0 25 f "" _null_ _null_ _null_ _null_ gp_codegen_module_cache_stats _null_ _null_ _null_ n ));
+DESCR("Returns the code generator compiled module cache counters of the current session");
+
 
   /* functions for the complex data type */
 /* complex_in(cstring) => complex */ 
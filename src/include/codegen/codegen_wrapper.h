@@ -34,6 +34,9 @@ struct PlanState;
 struct AggState;
 struct MemoryManagerContainer;
 struct AggStatePerGroupData;
+struct HashState;
+struct HashJoinTableData;
+struct List;
 /*
  * Enum used to mimic ExprDoneCond in ExecEvalExpr function pointer.
  */
@@ -45,19 +48,24 @@ typedef void (*AdvanceAggregatesFn) (struct AggState *aggstate, /*struct AggStat
 typedef void (*ExecVariableListFn) (struct ProjectionInfo *projInfo, Datum *values, bool *isnull);
 typedef Datum (*ExecEvalExprFn) (struct ExprState *expression, struct ExprContext *econtext, bool *isNull, /*ExprDoneCond*/ tmp_enum *isDone);
 typedef Datum (*SlotGetAttrFn) (struct TupleTableSlot *slot, int attnum, bool *isnull);
+typedef uint32 (*CalcHashValueFn) (struct AggState *aggstate, struct TupleTableSlot *inputslot);
+typedef bool (*MatchAggHashEntryFn) (struct AggState *aggstate, struct TupleTableSlot *inputslot, void *entry_tuple);
+typedef bool (*ExecHashGetHashValueFn) (struct HashState *hashState, struct HashJoinTableData *hashtable, struct ExprContext *econtext, struct List *hashkeys, bool outer_tuple, bool keep_nulls, uint32 *hashvalue, bool *hashkeys_null);
 
 #ifndef USE_CODEGEN
 
 #define InitCodegen() ((void) 1)
-#define CodeGeneratorManagerCreate(module_name) ((void *) NULL)
+#define CodeGeneratorManagerCreate(module_name, plan_rows) ((void *) NULL)
 #define CodeGeneratorManagerGenerateCode(manager) ((unsigned int) 1)
 #define CodeGeneratorManagerPrepareGeneratedFunctions(manager) ((unsigned int) 1)
+#define CodeGeneratorManagerSwapCompiledFunctions(manager) ((unsigned int) 0)
 #define CodeGeneratorManagerNotifyParameterChange(manager) ((unsigned int) 1)
 #define CodeGeneratorManagerAccumulateExplainString(manager) ((void) 1)
 #define CodeGeneratorManagerGetExplainString(manager) ((char *) NULL)
 #define CodeGeneratorManagerDestroy(manager) ((void) 1)
 #define GetActiveCodeGeneratorManager() ((void *) NULL)
 #define SetActiveCodeGeneratorManager(manager) ((void) 1)
+#define CodegenModuleCacheStats() ((char *) NULL)
 
 #define START_CODE_GENERATOR_MANAGER(newManager)
 #define END_CODE_GENERATOR_MANAGER()
@@ -67,6 +75,15 @@ typedef Datum (*SlotGetAttrFn) (struct TupleTableSlot *slot, int attnum, bool *i
 #define enroll_ExecVariableList_codegen(regular_func, ptr_to_chosen_func, proj_info, slot)
 #define call_AdvanceAggregates(aggstate, pergroup, mem_manager) advance_aggregates(aggstate, pergroup, mem_manager)
 #define enroll_AdvanceAggregates_codegen(regular_func, ptr_to_chosen_func, aggstate)
+#define call_ExecHashGetHashValue(gen_info_owner, hashState, hashtable, econtext, hashkeys, outer_tuple, keep_nulls, hashvalue, hashkeys_null) \
+		ExecHashGetHashValue(hashState, hashtable, econtext, hashkeys, outer_tuple, keep_nulls, hashvalue, hashkeys_null)
+#define enroll_ExecHashGetHashValue_codegen(regular_func, ptr_to_chosen_func, gen_info_owner, hashkeys, hashoperators, outer_tuple)
+#define call_CalcHashValue(aggstate, inputslot) calc_hash_value(aggstate, inputslot)
+#define enroll_CalcHashValue_codegen(regular_func, ptr_to_chosen_func, aggstate)
+#define call_MatchAggHashEntry(aggstate, inputslot, entry_tuple) match_agg_hash_entry(aggstate, inputslot, entry_tuple)
+#define enroll_MatchAggHashEntry_codegen(regular_func, ptr_to_chosen_func, aggstate)
+#define swap_CompiledFunctions_codegen(planstate)
+#define swap_ManagerCompiledFunctions_codegen(manager)
 #else
 
 /*
@@ -106,10 +123,10 @@ unsigned int
 InitCodegen();
 
 /*
- * Creates a manager for an operator
+ * Creates a manager for an operator expected to process plan_rows rows
  */
 void*
-CodeGeneratorManagerCreate(const char* module_name);
+CodeGeneratorManagerCreate(const char* module_name, double plan_rows);
 
 /*
  * Calls all the registered CodegenInterface to generate code
@@ -124,6 +141,13 @@ CodeGeneratorManagerGenerateCode(void* manager);
 unsigned int
 CodeGeneratorManagerPrepareGeneratedFunctions(void* manager);
 
+/*
+ * Makes the operator use the generated functions once their background
+ * compilation is done. Returns number of swapped functions
+ */
+unsigned int
+CodeGeneratorManagerSwapCompiledFunctions(void* manager);
+
 /*
  * Notifies a manager that the underlying operator has a parameter change
  */
@@ -161,6 +185,13 @@ GetActiveCodeGeneratorManager();
 void
 SetActiveCodeGeneratorManager(void* manager);
 
+/*
+ * Return a summary, in CurrentMemoryContext, of the activity of the cache of
+ * compiled modules
+ */
+char*
+CodegenModuleCacheStats(void);
+
 /*
  * Wrapper function for slot_getattr.
  */
@@ -212,6 +243,32 @@ AdvanceAggregatesCodegenEnroll(AdvanceAggregatesFn regular_func_ptr,
 		AdvanceAggregatesFn* ptr_to_regular_func_ptr,
 		struct AggState *aggstate);
 
+/*
+ * Enroll and returns the pointer to ExecHashGetHashValueGenerator
+ */
+void*
+ExecHashGetHashValueCodegenEnroll(ExecHashGetHashValueFn regular_func_ptr,
+		ExecHashGetHashValueFn* ptr_to_regular_func_ptr,
+		struct List *hashkeys,
+		struct List *hashoperators,
+		bool outer_tuple);
+
+/*
+ * Enroll and returns the pointer to CalcHashValueGenerator
+ */
+void*
+CalcHashValueCodegenEnroll(CalcHashValueFn regular_func_ptr,
+		CalcHashValueFn* ptr_to_regular_func_ptr,
+		struct AggState *aggstate);
+
+/*
+ * Enroll and returns the pointer to MatchAggHashEntryGenerator
+ */
+void*
+MatchAggHashEntryCodegenEnroll(MatchAggHashEntryFn regular_func_ptr,
+		MatchAggHashEntryFn* ptr_to_regular_func_ptr,
+		struct AggState *aggstate);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -269,6 +326,45 @@ AdvanceAggregatesCodegenEnroll(AdvanceAggregatesFn regular_func_ptr,
 #define call_AdvanceAggregates(aggstate, pergroup, mem_manager) \
 		aggstate->AdvanceAggregates_gen_info.AdvanceAggregates_fn(aggstate, pergroup, mem_manager)
 
+/*
+ * Call ExecHashGetHashValue using function pointer ExecHashGetHashValue_fn of
+ * gen_info_owner, the HashJoinState for the outer hash keys or the HashState
+ * for the inner ones. Function pointer may point to regular version or
+ * generated function
+ */
+#define call_ExecHashGetHashValue(gen_info_owner, hashState, hashtable, econtext, hashkeys, outer_tuple, keep_nulls, hashvalue, hashkeys_null) \
+		(gen_info_owner)->ExecHashGetHashValue_gen_info.ExecHashGetHashValue_fn(hashState, hashtable, econtext, hashkeys, outer_tuple, keep_nulls, hashvalue, hashkeys_null)
+
+/*
+ * Call calc_hash_value using function pointer CalcHashValue_fn.
+ * Function pointer may point to regular version or generated function
+ */
+#define call_CalcHashValue(aggstate, inputslot) \
+		aggstate->CalcHashValue_gen_info.CalcHashValue_fn(aggstate, inputslot)
+
+/*
+ * Call match_agg_hash_entry using function pointer MatchAggHashEntry_fn.
+ * Function pointer may point to regular version or generated function
+ */
+#define call_MatchAggHashEntry(aggstate, inputslot, entry_tuple) \
+		aggstate->MatchAggHashEntry_gen_info.MatchAggHashEntry_fn(aggstate, inputslot, entry_tuple)
+
+/*
+ * Make the operator use the functions compiled in the background once they
+ * are ready. ExecProcNode() does it before each call to an operator; the
+ * operators that consume their whole input in one call, like hash
+ * aggregation or the build side of a hash join, also do it for each input
+ * tuple
+ */
+#define swap_CompiledFunctions_codegen(planstate) \
+	swap_ManagerCompiledFunctions_codegen((planstate)->CodegenManager)
+
+#define swap_ManagerCompiledFunctions_codegen(manager) \
+	do { \
+		if (codegen && (manager) != NULL) \
+			(void) CodeGeneratorManagerSwapCompiledFunctions(manager); \
+	} while (0)
+
 /*
  * Enrollment macros
  * The enrollment process also ensures that the generated function pointer
@@ -289,6 +385,21 @@ AdvanceAggregatesCodegenEnroll(AdvanceAggregatesFn regular_func_ptr,
 				regular_func, ptr_to_regular_func_ptr, aggstate); \
 				Assert(aggstate->AdvanceAggregates_gen_info.AdvanceAggregates_fn == regular_func); \
 
+#define enroll_ExecHashGetHashValue_codegen(regular_func, ptr_to_regular_func_ptr, gen_info_owner, hashkeys, hashoperators, outer_tuple) \
+		(gen_info_owner)->ExecHashGetHashValue_gen_info.code_generator = ExecHashGetHashValueCodegenEnroll( \
+				regular_func, ptr_to_regular_func_ptr, hashkeys, hashoperators, outer_tuple); \
+				Assert((gen_info_owner)->ExecHashGetHashValue_gen_info.ExecHashGetHashValue_fn == regular_func); \
+
+#define enroll_CalcHashValue_codegen(regular_func, ptr_to_regular_func_ptr, aggstate) \
+		aggstate->CalcHashValue_gen_info.code_generator = CalcHashValueCodegenEnroll( \
+				regular_func, ptr_to_regular_func_ptr, aggstate); \
+				Assert(aggstate->CalcHashValue_gen_info.CalcHashValue_fn == regular_func); \
+
+#define enroll_MatchAggHashEntry_codegen(regular_func, ptr_to_regular_func_ptr, aggstate) \
+		aggstate->MatchAggHashEntry_gen_info.code_generator = MatchAggHashEntryCodegenEnroll( \
+				regular_func, ptr_to_regular_func_ptr, aggstate); \
+				Assert(aggstate->MatchAggHashEntry_gen_info.MatchAggHashEntry_fn == regular_func); \
+
 #endif //USE_CODEGEN
 
 #endif  // CODEGEN_WRAPPER_H_
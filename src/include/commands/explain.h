@@ -14,6 +14,7 @@
 #define EXPLAIN_H
 
 #include "executor/executor.h"
+#include "optimizer/optprofile.h"
 
 /* Hook for plugins to get control in ExplainOneQuery() */
 typedef void (*ExplainOneQuery_hook_type) (Query *query,
@@ -39,6 +40,7 @@ extern void ExplainOneUtility(Node *utilityStmt, ExplainStmt *stmt,
 				  TupOutputState *tstate);
 
 extern void ExplainOnePlan(PlannedStmt *plannedstmt, ParamListInfo params,
-			   ExplainStmt *stmt, const char *queryString, TupOutputState *tstate);
+			   ExplainStmt *stmt, const char *queryString, TupOutputState *tstate,
+			   const OptProfile *optProfile);
 
 #endif   /* EXPLAIN_H */
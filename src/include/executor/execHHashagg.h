@@ -223,6 +223,9 @@ extern void destroy_agg_hash_table(AggState *aggstate);
 
 extern void agg_hash_explain(AggState *aggstate);
 extern HashAggEntry *agg_hash_iter(AggState *aggstate);
+extern uint32 calc_hash_value(AggState *aggstate, TupleTableSlot *inputslot);
+extern bool match_agg_hash_entry(AggState *aggstate, TupleTableSlot *inputslot,
+								 void *entry_tuple);
 
 /*
  * Compute HHashTable entry size
@@ -105,6 +105,7 @@ typedef struct HashJoinTableStats
     int                     nonemptybatches;    /* num of nontrivial batches */
     Size                    workmem_max;        /* work_mem high water mark */
     CdbExplain_Agg          chainlength;        /* hash chain length stats */
+    uint64                  codegenrows;        /* inner rows hashed by generated code */
 } HashJoinTableStats;
 
 
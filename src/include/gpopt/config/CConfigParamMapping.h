@@ -63,6 +63,26 @@ namespace gpdxl
 			// array of mapping elements
 			static SConfigMappingElem m_elem[];
 
+			// config params that disable groups of xforms
+			static BOOL *m_rgpfXformParams[];
+
+			// memory pool of the cached traceflags
+			static IMemoryPool *m_pmpCache;
+
+			// config param values the cached traceflags were packed from
+			static BOOL *m_rgfCachedParams;
+
+			// cached traceflags
+			static CBitSet *m_pbsCached;
+
+			// number of config params the traceflags are packed from
+			static
+			ULONG UlParams(ULONG ulXforms);
+
+			// current value of the config param at the given position
+			static
+			BOOL FParam(ULONG ulPos, ULONG ulXforms);
+
 			// private ctor
 			CConfigParamMapping(const CConfigParamMapping &);
 
@@ -70,6 +90,10 @@ namespace gpdxl
 			// pack enabled optimizer config params in a traceflag bitset
 			static
 			CBitSet *PbsPack(IMemoryPool *pmp, ULONG ulXforms);
+
+			// return the traceflag bitset, repacking it only if a config param changed
+			static
+			CBitSet *PbsPackCached(ULONG ulXforms);
 	};
 }
 
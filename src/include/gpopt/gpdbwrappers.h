@@ -19,6 +19,13 @@
 #include "access/attnum.h"
 #include "utils/faultinjector.h"
 
+extern "C" {
+#include "nodes/pg_list.h"
+#include "optimizer/optprofile.h"
+#include "portability/instr_time.h"
+#include "utils/sharedmdcache.h"
+}
+
 // fwd declarations
 typedef struct SysScanDescData *SysScanDesc;
 typedef int LOCKMODE;
@@ -55,80 +62,219 @@ struct ArrayExpr;
 
 namespace gpdb {
 
+	// metadata cache object which can be evicted individually when the catalog
+	// entries it was built from are invalidated
+	struct SMDCacheObject
+	{
+		enum EKind
+		{
+			EmdcoGPDB,		// object with a GPDB oid: m_oid
+			EmdcoRelStats,	// statistics of relation m_oid
+			EmdcoColStats,	// statistics of column m_ulPos of relation m_oid
+			EmdcoCast,		// cast from type m_oid to type m_oidSecond
+			EmdcoScCmp		// comparison m_ulPos between types m_oid and m_oidSecond
+		};
+
+		EKind m_ekind;
+		Oid m_oid;
+		Oid m_oidSecond;
+		uint32 m_ulPos;
+	};
+
+	// counters of metadata cache activity in the current session
+	struct SMDCacheStats
+	{
+		// objects fetched from the catalog on cache misses
+		uint64 m_ullMisses;
+
+		// objects evicted because of catalog invalidations
+		uint64 m_ullEvictions;
+
+		// full cache resets
+		uint64 m_ullResets;
+
+		// misses served from the metadata cache shared by all backends
+		uint64 m_ullSharedHits;
+	};
+
+	// Wrappers below cannot raise a GPDB error, so they are defined inline
+	// and do not set up a PG_TRY frame like the ones in gpdbwrappers.cpp.
+	// The translators call them for every constant and list element.
+
 	// convert datum to bool
-	bool FBoolFromDatum(Datum d);
+	inline
+	bool FBoolFromDatum(Datum d)
+	{
+		return DatumGetBool(d);
+	}
 
 	// convert bool to datum
-	Datum DDatumFromBool(bool b);
+	inline
+	Datum DDatumFromBool(bool b)
+	{
+		return BoolGetDatum(b);
+	}
 
 	// convert datum to char
-	char CCharFromDatum(Datum d);
+	inline
+	char CCharFromDatum(Datum d)
+	{
+		return DatumGetChar(d);
+	}
 
 	// convert char to datum
-	Datum DDatumFromChar(char c);
+	inline
+	Datum DDatumFromChar(char c)
+	{
+		return CharGetDatum(c);
+	}
 
 	// convert datum to int8
-	int8 CInt8FromDatum(Datum d);
+	inline
+	int8 CInt8FromDatum(Datum d)
+	{
+		return DatumGetInt8(d);
+	}
 
 	// convert int8 to datum
-	Datum DDatumFromInt8(int8 i8);
+	inline
+	Datum DDatumFromInt8(int8 i8)
+	{
+		return Int8GetDatum(i8);
+	}
 
 	// convert datum to uint8
-	uint8 UcUint8FromDatum(Datum d);
+	inline
+	uint8 UcUint8FromDatum(Datum d)
+	{
+		return DatumGetUInt8(d);
+	}
 
 	// convert uint8 to datum
-	Datum DDatumFromUint8(uint8 ui8);
+	inline
+	Datum DDatumFromUint8(uint8 ui8)
+	{
+		return UInt8GetDatum(ui8);
+	}
 
 	// convert datum to int16
-	int16 SInt16FromDatum(Datum d);
+	inline
+	int16 SInt16FromDatum(Datum d)
+	{
+		return DatumGetInt16(d);
+	}
 
 	// convert int16 to datum
-	Datum DDatumFromInt16(int16 i16);
+	inline
+	Datum DDatumFromInt16(int16 i16)
+	{
+		return Int16GetDatum(i16);
+	}
 
 	// convert datum to uint16
-	uint16 UsUint16FromDatum(Datum d);
+	inline
+	uint16 UsUint16FromDatum(Datum d)
+	{
+		return DatumGetUInt16(d);
+	}
 
 	// convert uint16 to datum
-	Datum DDatumFromUint16(uint16 ui16);
+	inline
+	Datum DDatumFromUint16(uint16 ui16)
+	{
+		return UInt16GetDatum(ui16);
+	}
 
 	// convert datum to int32
-	int32 IInt32FromDatum(Datum d);
+	inline
+	int32 IInt32FromDatum(Datum d)
+	{
+		return DatumGetInt32(d);
+	}
 
 	// convert int32 to datum
-	Datum DDatumFromInt32(int32 i32);
+	inline
+	Datum DDatumFromInt32(int32 i32)
+	{
+		return Int32GetDatum(i32);
+	}
 
 	// convert datum to uint32
-	uint32 UlUint32FromDatum(Datum d);
+	inline
+	uint32 UlUint32FromDatum(Datum d)
+	{
+		return DatumGetUInt32(d);
+	}
 
 	// convert uint32 to datum
-	Datum DDatumFromUint32(uint32 ui32);
+	inline
+	Datum DDatumFromUint32(uint32 ui32)
+	{
+		return UInt32GetDatum(ui32);
+	}
 
 	// convert datum to int64
-	int64 LlInt64FromDatum(Datum d);
+	inline
+	int64 LlInt64FromDatum(Datum d)
+	{
+		return DatumGetInt64(d);
+	}
 
 	// convert int64 to datum
-	Datum DDatumFromInt64(int64 i64);
+	inline
+	Datum DDatumFromInt64(int64 i64)
+	{
+		return Int64GetDatum(i64);
+	}
 
 	// convert datum to uint64
-	uint64 UllUint64FromDatum(Datum d);
+	inline
+	uint64 UllUint64FromDatum(Datum d)
+	{
+		return DatumGetUInt64(d);
+	}
 
 	// convert uint64 to datum
-	Datum DDatumFromUint64(uint64 ui64);
+	inline
+	Datum DDatumFromUint64(uint64 ui64)
+	{
+		return UInt64GetDatum(ui64);
+	}
 
 	// convert datum to oid
-	Oid OidFromDatum(Datum d);
+	inline
+	Oid OidFromDatum(Datum d)
+	{
+		return DatumGetObjectId(d);
+	}
 
 	// convert datum to generic object with pointer handle
-	void *PvPointerFromDatum(Datum d);
+	inline
+	void *PvPointerFromDatum(Datum d)
+	{
+		return DatumGetPointer(d);
+	}
 
 	// convert datum to float4
-	float4 FpFloat4FromDatum(Datum d);
+	inline
+	float4 FpFloat4FromDatum(Datum d)
+	{
+		return DatumGetFloat4(d);
+	}
 
 	// convert datum to float8
-	float8 DFloat8FromDatum(Datum d);
+	inline
+	float8 DFloat8FromDatum(Datum d)
+	{
+		return DatumGetFloat8(d);
+	}
 
 	// convert pointer to datum
-	Datum DDatumFromPointer(const void *p);
+	inline
+	Datum DDatumFromPointer(const void *p)
+	{
+		return PointerGetDatum(p);
+	}
 
 	// does an aggregate exist with the given oid
 	bool FAggregateExists(Oid oid);
@@ -139,8 +285,35 @@ namespace gpdb {
 	// create a copy of an object
 	void *PvCopyObject(void *from);
 
-	// datum size
-	Size SDatumSize(Datum value, bool typByVal, int typLen);
+	// datum size, with the checks of datumGetSize; raises a GPDB error on an
+	// invalid pointer or type length
+	Size SDatumSizeChecked(Datum value, bool typByVal, int typLen);
+
+	// datum size; only datums that fail the checks of datumGetSize go through
+	// the wrapped call
+	inline
+	Size SDatumSize(Datum value, bool typByVal, int typLen)
+	{
+		if (typByVal || 0 < typLen)
+		{
+			return typLen;
+		}
+
+		if (PointerIsValid(DatumGetPointer(value)))
+		{
+			if (-1 == typLen)
+			{
+				return VARSIZE_ANY(DatumGetPointer(value));
+			}
+
+			if (-2 == typLen)
+			{
+				return strlen(DatumGetCString(value)) + 1;
+			}
+		}
+
+		return SDatumSizeChecked(value, typByVal, typLen);
+	}
 
 	// expression type
 	Oid OidExprType(Node *expr);
@@ -238,7 +411,8 @@ namespace gpdb {
 	// get the list of check constraints for a given relation
 	List *PlCheckConstraint(Oid oidRel);
 
-	// part constraint expression tree
+	// part constraint expression tree, the result and the default levels are
+	// owned by the wrappers and stay valid until ResetPartTableInfo
 	Node *PnodePartConstraintRel(Oid oidRel, List **pplDefaultLevels);
 
 	// get the cast function for the specified source and destination types
@@ -325,6 +499,9 @@ namespace gpdb {
 	// append an element to a list
 	List *PlAppendElement(List *list, void *datum);
 
+	// append the given array of elements to a list
+	List *PlAppendElements(List *list, void **rgpvElems, int iElems);
+
 	// append an integer to a list
 	List *PlAppendInt(List *list, int datum);
 
@@ -347,22 +524,46 @@ namespace gpdb {
 	List *PlCopy(List *list);
 
 	// first cell in a list
-	ListCell *PlcListHead(List *l);
+	inline
+	ListCell *PlcListHead(List *l)
+	{
+		return list_head(l);
+	}
 
 	// last cell in a list
-	ListCell *PlcListTail(List *l);
+	inline
+	ListCell *PlcListTail(List *l)
+	{
+		return list_tail(l);
+	}
 
 	// number of items in a list
-	uint32 UlListLength(List *l);
+	inline
+	uint32 UlListLength(List *l)
+	{
+		return list_length(l);
+	}
 
 	// return the nth element in a list of pointers
-	void *PvListNth(List *list, int n);
+	inline
+	void *PvListNth(List *list, int n)
+	{
+		return list_nth(list, n);
+	}
 
 	// return the nth element in a list of ints
-	int IListNth(List *list, int n);
+	inline
+	int IListNth(List *list, int n)
+	{
+		return list_nth_int(list, n);
+	}
 
 	// return the nth element in a list of oids
-	Oid OidListNth(List *list, int n);
+	inline
+	Oid OidListNth(List *list, int n)
+	{
+		return list_nth_oid(list, n);
+	}
 
 	// check whether the given oid is a member of the given list
 	bool FMemberOid(List *list, Oid oid);
@@ -516,8 +717,12 @@ namespace gpdb {
 	// close the given relation
 	void CloseRelation(Relation rel);
 
-	// return the logical indexes for a partitioned table
+	// return the logical indexes for a partitioned table, the result is
+	// owned by the wrappers and stays valid until ResetPartTableInfo
 	LogicalIndexes *Plgidx(Oid oid);
+
+	// forget the logical indexes and part constraints built by the current task
+	void ResetPartTableInfo();
 	
 	// return the logical info structure for a given logical index oid
 	LogicalIndexInfo *Plgidxinfo(Oid rootOid, Oid indexOid);
@@ -602,6 +807,9 @@ namespace gpdb {
 	// returns the result of evaluating 'pexpr' as an Expr. Caller keeps ownership of 'pexpr'
 	// and takes ownership of the result 
 	Expr *PexprEvaluate(Expr *pexpr, Oid oidResultType, int32 iTypeMod);
+
+	// does the expression call any volatile functions
+	bool FContainsVolatileFunctions(Node *pnode);
 	
 	// interpret the value of "With oids" option from a list of defelems
 	bool FInterpretOidsOption(List *plOptions);
@@ -625,9 +833,45 @@ namespace gpdb {
 	gpos::ULONG UlLeafPartitions(Oid oidRelation);
 
 	// Does the metadata cache need to be reset (because of a catalog
-	// table has been changed?)
+	// table has been changed in a way that can't be mapped to individual
+	// cache entries?)
 	bool FMDCacheNeedsReset(void);
 
+	// register the catalog entry identified by the given syscache id and keys
+	// as a source of a metadata cache object, so that invalidation of the entry
+	// evicts the object. MDCACHE_RELCACHE_ID stands for the relcache entry of
+	// relation 'key1'
+	void RegisterMDCacheDependency(int iCacheId, Datum key1, Datum key2, const SMDCacheObject *pmdcobj);
+
+	// forget all registered dependencies, when the metadata cache is created
+	void ResetMDCacheDependencies(void);
+
+	// return the list of metadata cache objects (SMDCacheObject) affected by
+	// catalog changes since last call
+	List *PlMDCacheInvalidatedObjects(void);
+
+	// per-session metadata cache counters
+	SMDCacheStats *PmdcstatsMDCache(void);
+
+	// can the current transaction use the metadata cache shared by all backends?
+	bool FSharedMDCacheEnabled(void);
+
+	// take a snapshot of the shared metadata cache before translating an object
+	uint64 UllSharedMDCacheSnapshot(void);
+
+	// look up a serialized object in the shared metadata cache, returns NULL on
+	// misses. On hits, the catalog entries the object is built from are
+	// registered for the given metadata cache object
+	char *SzSharedMDCacheLookup(const char *szKey, const SMDCacheObject *pmdcobj);
+
+	// start collecting the catalog entries the object about to be translated is
+	// built from, separately from the objects translated in the middle of it
+	void BeginMDCacheDependencies(void);
+
+	// store a serialized object translated since the given snapshot, along with
+	// the catalog entries collected since the matching BeginMDCacheDependencies()
+	void SharedMDCacheInsert(const char *szKey, const char *szValue, uint64 ullSnapshot);
+
 } //namespace gpdb
 
 #define ForEach(cell, l)	\
@@ -49,9 +49,16 @@ namespace gpmd
 			// memory pool
 			IMemoryPool *m_pmp;
 
+			// number of fetches in progress, objects fetched while
+			// translating another object are part of its fetch time
+			mutable ULONG m_ulFetchDepth;
+
 			// private copy ctor
 			CMDProviderRelcache(const CMDProviderRelcache&);
 
+			// fetch the DXL string of the requested metadata object
+			CWStringBase *PstrFetchObject(IMemoryPool *pmp, CMDAccessor *pmda, IMDId *pmdid) const;
+
 		public:
 			// ctor/dtor
 			explicit
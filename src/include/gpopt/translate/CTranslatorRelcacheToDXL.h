@@ -49,6 +49,11 @@ typedef struct RelationData* Relation;
 struct LogicalIndexes;
 struct LogicalIndexInfo;
 
+namespace gpdb
+{
+	struct SMDCacheObject;
+}
+
 namespace gpdxl
 {
 	using namespace gpos;
@@ -173,6 +178,11 @@ namespace gpdxl
 			static
 			void CheckUnsupportedRelation(OID oidRel);
 
+			// register the catalog entries a metadata cache object is built from,
+			// so that changes to them evict the object from the cache
+			static
+			void RegisterMDCacheDependencies(CMDAccessor *pmda, IMDId *pmdid, const IMDCacheObject *pimdobj);
+
 			// get type name from the relcache
 			static
 			CMDName *PmdnameType(IMemoryPool *pmp, IMDId *pmdid);
@@ -404,6 +414,11 @@ namespace gpdxl
 			static
 			IMDCacheObject *Pimdobj(IMemoryPool *pmp, CMDAccessor *pmda, IMDId *pmdid);
 
+			// identify the metadata cache object of the given metadata id, as
+			// its catalog dependencies are registered for
+			static
+			void InitMDCacheObject(IMDId *pmdid, gpdb::SMDCacheObject *pmdcobj);
+
 			// retrieve a relation from the relcache
 			static
 			IMDRelation *Pmdrel(IMemoryPool *pmp, CMDAccessor *pmda, IMDId *pmdid);
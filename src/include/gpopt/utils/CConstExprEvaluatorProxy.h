@@ -16,6 +16,8 @@
 #define GPDXL_CConstExprEvaluator_H
 
 #include "gpos/base.h"
+#include "gpos/common/CHashMap.h"
+#include "gpos/string/CWStringDynamic.h"
 
 #include "gpopt/eval/IConstDXLNodeEvaluator.h"
 #include "gpopt/mdcache/CMDAccessor.h"
@@ -26,6 +28,23 @@ namespace gpdxl
 {
 	class CDXLNode;
 
+	// hash on serialized DXL expressions
+	inline
+	ULONG UlHashDXLStr
+		(
+		const CWStringDynamic *pstr
+		)
+	{
+		return gpos::UlHashByteArray((BYTE *) pstr->Wsz(), pstr->UlLength() * GPOS_SIZEOF(WCHAR));
+	}
+
+	// equality on serialized DXL expressions
+	inline
+	BOOL FEqualDXLStr(const CWStringDynamic *pstrA, const CWStringDynamic *pstrB)
+	{
+		return pstrA->FEquals(pstrB);
+	}
+
 	//---------------------------------------------------------------------------
 	//	@class:
 	//		CConstExprEvaluatorProxy
@@ -38,6 +57,11 @@ namespace gpdxl
 	//		creating an instance of this class and should not be released before
 	//		the destructor of this class.
 	//
+	//		Results are remembered for the lifetime of the instance, keyed by
+	//		the serialized DXL of the expression, so that expressions evaluated
+	//		repeatedly, e.g. partition boundary comparisons during partition
+	//		elimination, only go through the executor once per optimization.
+	//
 	//---------------------------------------------------------------------------
 	class CConstExprEvaluatorProxy : public gpopt::IConstDXLNodeEvaluator
 	{
@@ -86,6 +110,13 @@ namespace gpdxl
 			// translator for the DXL input -> GPDB Expr
 			CTranslatorDXLToScalar m_trdxl2scalar;
 
+			// map of serialized DXL expressions to the results of their evaluation
+			typedef CHashMap<CWStringDynamic, CDXLNode, UlHashDXLStr, FEqualDXLStr,
+					CleanupDelete<CWStringDynamic>, CleanupRelease<CDXLNode> > HMStrDXLNode;
+
+			// results of the expressions evaluated so far
+			HMStrDXLNode *m_phmstrdxlnResults;
+
 		public:
 			// ctor
 			CConstExprEvaluatorProxy
@@ -97,7 +128,8 @@ namespace gpdxl
 				m_pmp(pmp),
 				m_emptymapcidvar(m_pmp),
 				m_pmda(pmda),
-				m_trdxl2scalar(m_pmp, m_pmda, 0)
+				m_trdxl2scalar(m_pmp, m_pmda, 0),
+				m_phmstrdxlnResults(GPOS_NEW(pmp) HMStrDXLNode(pmp))
 			{
 			}
 
@@ -105,6 +137,7 @@ namespace gpdxl
 			virtual
 			~CConstExprEvaluatorProxy()
 			{
+				m_phmstrdxlnResults->Release();
 			}
 
 			// evaluate given constant expressionand return the DXL representation of the result.
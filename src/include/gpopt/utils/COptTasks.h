@@ -20,6 +20,9 @@
 #include "gpopt/base/CColRef.h"
 #include "gpopt/search/CSearchStage.h"
 
+extern "C" {
+#include "portability/instr_time.h"
+}
 
 
 // fwd decl
@@ -34,6 +37,16 @@ namespace gpdxl
 	class CDXLNode;
 }
 
+namespace gpmd
+{
+	class IMDId;
+}
+
+namespace gpdb
+{
+	struct SMDCacheObject;
+}
+
 namespace gpopt
 {
 	class CExpression;
@@ -43,6 +56,7 @@ namespace gpopt
 	class ICostModel;
 }
 
+struct OptProfile;
 struct PlannedStmt;
 struct Query;
 struct List;
@@ -79,6 +93,10 @@ struct SOptContext
 	// plan object
 	PlannedStmt *m_pplstmt;
 
+	// memory context the plan object is allocated in, the caller's
+	// current context when the optimization context is created
+	struct MemoryContextData *m_pmcPlStmt;
+
 	// is generating a plan object required ?
 	BOOL m_fGeneratePlStmt;
 
@@ -165,6 +183,29 @@ class COptTasks
 			SOptimizeMinidumpContext *PoptmdpConvert(void *pv);
 		};
 
+		// memory pool of the cached search strategy
+		static
+		IMemoryPool *m_pmpSearchStrategy;
+
+		// search strategy parsed from m_szSearchStrategyPath, NULL if the default one is used
+		static
+		DrgPss *m_pdrgpssCached;
+
+		// is m_pdrgpssCached valid
+		static
+		BOOL m_fSearchStrategyCached;
+
+		// path of the cached search strategy file
+		static
+		CHAR *m_szSearchStrategyPath;
+
+		// modification time and size of the cached search strategy file
+		static
+		LINT m_lSearchStrategyMtime;
+
+		static
+		LINT m_lSearchStrategySize;
+
 		// execute a task given the argument
 		static
 		void Execute ( void *(*pfunc) (void *), void *pfuncArg);
@@ -213,14 +254,38 @@ class COptTasks
 		static
 		void* PvOptimizeMinidumpTask(void *pv);
 
-		// translate a DXL tree into a planned statement
+		// translate a DXL tree into a planned statement allocated in the given memory context
+		static
+		PlannedStmt *Pplstmt(IMemoryPool *pmp, CMDAccessor *pmda, const CDXLNode *pdxln, bool canSetTag, struct MemoryContextData *pmcPlStmt);
+
+		// create the metadata id of a metadata cache object tracked for invalidation
+		static
+		gpmd::IMDId *PmdidMDCacheObject(IMemoryPool *pmp, const gpdb::SMDCacheObject *pmdcobj);
+
+		// evict metadata cache objects affected by catalog changes since last query
 		static
-		PlannedStmt *Pplstmt(IMemoryPool *pmp, CMDAccessor *pmda, const CDXLNode *pdxln, bool canSetTag);
+		void EvictInvalidatedMDCacheObjects();
+
+		// milliseconds elapsed since given time, which is reset to the current time
+		static
+		double DElapsedMS(instr_time *pit);
+
+		// record the size of the memory pool in the profile if it is the largest so far
+		static
+		void UpdateMemoryPeak(IMemoryPool *pmp, OptProfile *pprof);
 
 		// load search strategy from given path
 		static
 		DrgPss *PdrgPssLoad(IMemoryPool *pmp, char *szPath);
 
+		// return search strategy from given path, parsing the file only if it changed
+		static
+		DrgPss *PdrgPssCached(IMemoryPool *pmp, char *szPath);
+
+		// copy search strategy into given memory pool
+		static
+		DrgPss *PdrgPssCopy(IMemoryPool *pmp, const DrgPss *pdrgpss);
+
 		// allocate memory for string
 		static
 		CHAR *SzAllocate(IMemoryPool *pmp, ULONG ulSize);
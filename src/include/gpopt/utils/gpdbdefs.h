@@ -49,6 +49,7 @@ extern "C" {
 #include "cdb/cdbmutate.h"
 #include "commands/defrem.h"
 #include "utils/typcache.h"
+#include "utils/memutils.h"
 #include "utils/numeric.h"
 #include "optimizer/tlist.h"
 #include "nodes/makefuncs.h"
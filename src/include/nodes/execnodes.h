@@ -2249,6 +2249,14 @@ typedef struct MergeJoinState
 typedef struct HashJoinTupleData *HashJoinTuple;
 typedef struct HashJoinTableData *HashJoinTable;
 
+typedef struct ExecHashGetHashValueCodegenInfo
+{
+	/* Pointer to store ExecHashGetHashValueCodegen from Codegen */
+	void* code_generator;
+	/* Function pointer that points to either regular or generated ExecHashGetHashValue */
+	ExecHashGetHashValueFn ExecHashGetHashValue_fn;
+} ExecHashGetHashValueCodegenInfo;
+
 typedef struct HashJoinState
 {
 	JoinState	js;				/* its first field is NodeTag */
@@ -2274,6 +2282,11 @@ typedef struct HashJoinState
 
 	/* set if the operator created workfiles */
 	bool workfiles_created;
+
+#ifdef USE_CODEGEN
+	/* computes the hash value of the outer tuples */
+	ExecHashGetHashValueCodegenInfo ExecHashGetHashValue_gen_info;
+#endif
 } HashJoinState;
 
 
@@ -2387,6 +2400,22 @@ typedef struct AdvanceAggregatesCodegenInfo
 	AdvanceAggregatesFn AdvanceAggregates_fn;
 } AdvanceAggregatesCodegenInfo;
 
+typedef struct CalcHashValueCodegenInfo
+{
+	/* Pointer to store CalcHashValueCodegen from Codegen */
+	void* code_generator;
+	/* Function pointer that points to either regular or generated calc_hash_value */
+	CalcHashValueFn CalcHashValue_fn;
+} CalcHashValueCodegenInfo;
+
+typedef struct MatchAggHashEntryCodegenInfo
+{
+	/* Pointer to store MatchAggHashEntryCodegen from Codegen */
+	void* code_generator;
+	/* Function pointer that points to either regular or generated match_agg_hash_entry */
+	MatchAggHashEntryFn MatchAggHashEntry_fn;
+} MatchAggHashEntryCodegenInfo;
+
 /* these structs are private in nodeAgg.c: */
 typedef struct AggStatePerAggData *AggStatePerAgg;
 typedef struct AggStatePerGroupData *AggStatePerGroup;
@@ -2447,6 +2476,8 @@ typedef struct AggState
 
 #ifdef USE_CODEGEN
 	AdvanceAggregatesCodegenInfo AdvanceAggregates_gen_info;
+	CalcHashValueCodegenInfo CalcHashValue_gen_info;
+	MatchAggHashEntryCodegenInfo MatchAggHashEntry_gen_info;
 #endif
 } AggState;
 
@@ -2542,6 +2573,13 @@ typedef struct HashState
 	bool		hs_quit_if_hashkeys_null;	/* quit building hash table if hashkeys are all null */
 	bool		hs_hashkeys_null;	/* found an instance wherein hashkeys are all null */
 	/* hashkeys is same as parent's hj_InnerHashKeys */
+
+#ifdef USE_CODEGEN
+	/* computes the hash value of the inner tuples, enrolled by the parent */
+	ExecHashGetHashValueCodegenInfo ExecHashGetHashValue_gen_info;
+	/* code generator manager of the parent, which the above is enrolled in */
+	void	   *hs_hashkeysCodegenManager;
+#endif
 } HashState;
 
 /* ----------------
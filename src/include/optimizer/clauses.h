@@ -77,6 +77,7 @@ extern double expression_returns_set_rows(Node *clause);
 extern bool contain_subplans(Node *clause);
 
 extern bool contain_mutable_functions(Node *clause);
+extern bool query_contain_mutable_functions(Query *query);
 extern bool contain_volatile_functions(Node *clause);
 extern bool contain_window_functions(Node *clause);
 extern bool contain_nonstrict_functions(Node *clause);
@@ -0,0 +1,36 @@
+/*-------------------------------------------------------------------------
+ *
+ * optplancache.h
+ *	  Cache of plans produced by ORCA, see optplancache.c.
+ *
+ * Copyright (c) 2017, Pivotal Software, Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef OPTPLANCACHE_H
+#define OPTPLANCACHE_H
+
+#include "nodes/params.h"
+#include "nodes/parsenodes.h"
+#include "nodes/plannodes.h"
+
+/* plans a Query with ORCA, returns NULL if ORCA can't plan it */
+typedef PlannedStmt *(*OptPlanCacheOptimizeFn) (Query *parse,
+												ParamListInfo boundParams);
+
+/* counters of plan cache activity in the current session */
+typedef struct OptPlanCacheStats
+{
+	uint64		hits;			/* plans (or fallbacks) served from the cache */
+	uint64		misses;			/* queries planned by ORCA and cached */
+	uint64		customPlans;	/* queries planned for their parameter values */
+	uint64		invalidations;	/* entries dropped due to catalog changes */
+} OptPlanCacheStats;
+
+extern PlannedStmt *OptPlanCacheGetPlan(Query *parse,
+					ParamListInfo boundParams,
+					OptPlanCacheOptimizeFn optimize);
+extern void ResetOptPlanCache(void);
+extern OptPlanCacheStats *GetOptPlanCacheStats(void);
+
+#endif   /* OPTPLANCACHE_H */
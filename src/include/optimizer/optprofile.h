@@ -0,0 +1,41 @@
+/*-------------------------------------------------------------------------
+ *
+ * optprofile.h
+ *	  Per-phase profile of ORCA optimizations, see optprofile.c.
+ *
+ * Copyright (c) 2017, Pivotal Software, Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef OPTPROFILE_H
+#define OPTPROFILE_H
+
+#include "lib/stringinfo.h"
+
+/*
+ * Times are in milliseconds.  Metadata fetches happen during the translation
+ * of the query and during optimization, so their time is included in those
+ * phases too.
+ */
+typedef struct OptProfile
+{
+	uint64		optimizations;	/* number of optimizations profiled */
+	double		totalTime;		/* whole optimization task */
+	double		queryToDXLTime;	/* translation of the Query to DXL */
+	double		optimizeTime;	/* search for the best plan */
+	double		dxlToPlanTime;	/* translation of the DXL plan to a PlannedStmt */
+	double		mdFetchTime;	/* metadata fetches from the catalog */
+	uint64		mdFetches;		/* metadata objects missing from the cache */
+	uint64		mdSharedHits;	/* ... of which found in the shared cache */
+	uint64		constExprEvals;	/* constant expressions evaluated */
+	uint64		constExprHits;	/* evaluations served from the memo */
+	uint64		memoryPeak;		/* peak size of the memory pool, in bytes */
+} OptProfile;
+
+extern OptProfile *BeginOptProfile(void);
+extern OptProfile *GetOptProfile(void);
+extern void EndOptProfile(void);
+extern const OptProfile *GetSessionOptProfile(void);
+extern void AppendOptProfile(StringInfo str, const OptProfile *profile);
+
+#endif   /* OPTPROFILE_H */
@@ -99,6 +99,7 @@ typedef enum LWLockId
 	FirstLockMgrLock = FirstBufMappingLock + NUM_BUFFER_PARTITIONS,
 	SessionStateLock = FirstLockMgrLock + NUM_LOCK_PARTITIONS,
 	RelfilenodeGenLock,
+	SharedMDCacheLock,
 
 	/* must be last except for MaxDynamicLWLock: */
 	NumFixedLWLocks,
@@ -1218,4 +1218,16 @@ extern Datum enable_xform(PG_FUNCTION_ARGS);
 /* Optimizer's version */
 extern Datum gp_opt_version(PG_FUNCTION_ARGS);
 
+/* Optimizer's metadata cache counters */
+extern Datum gp_opt_mdcache_stats(PG_FUNCTION_ARGS);
+
+/* Optimizer's plan cache counters */
+extern Datum gp_opt_plancache_stats(PG_FUNCTION_ARGS);
+
+/* Optimizer's per-phase profile */
+extern Datum gp_opt_profile(PG_FUNCTION_ARGS);
+
+/* Code generator's compiled module cache counters */
+extern Datum gp_codegen_module_cache_stats(PG_FUNCTION_ARGS);
+
 #endif   /* BUILTINS_H */
@@ -393,6 +393,8 @@ extern bool optimizer_minidump;
 extern int  optimizer_cost_model;
 extern bool optimizer_metadata_caching;
 extern int	optimizer_mdcache_size;
+extern int	optimizer_shared_mdcache_size;
+extern int	optimizer_plan_cache_size;
 
 /* Optimizer debugging GUCs */
 extern bool optimizer_print_query;
@@ -503,6 +505,7 @@ extern bool codegen;
 extern bool codegen_validate_functions;
 extern int codegen_varlen_tolerance;
 extern int codegen_optimization_level;
+extern int codegen_module_cache_size;
 
 /**
  * Enable logging of DPE match in optimizer.
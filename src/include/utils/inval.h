@@ -18,7 +18,8 @@
 #include "utils/rel.h"
 
 
-typedef void (*SyscacheCallbackFunction) (Datum arg, int cacheid, ItemPointer tuplePtr);
+typedef void (*SyscacheCallbackFunction) (Datum arg, int cacheid, ItemPointer tuplePtr,
+										   uint32 hashValue);
 typedef void (*RelcacheCallbackFunction) (Datum arg, Oid relid);
 
 
@@ -0,0 +1,47 @@
+/*-------------------------------------------------------------------------
+ *
+ * sharedmdcache.h
+ *	  Cache of serialized optimizer metadata objects, shared by all backends.
+ *
+ * See sharedmdcache.c for comments.
+ *
+ * Copyright (c) 2017, Pivotal Software, Inc.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SHAREDMDCACHE_H
+#define SHAREDMDCACHE_H
+
+/* pseudo syscache id used for dependencies on relcache entries */
+#define MDCACHE_RELCACHE_ID (-1)
+
+/* max length of a key, including the terminating NUL */
+#define SHARED_MDCACHE_KEYLEN		64
+
+/* max number of catalog entries a cached object can depend on */
+#define SHARED_MDCACHE_MAX_DEPS		8
+
+/*
+ * Catalog entry a cached object is built from, identified by the syscache id
+ * and the hash value of the syscache key, or by MDCACHE_RELCACHE_ID and the
+ * relation oid.
+ */
+typedef struct SharedMDCacheDep
+{
+	int			cacheId;
+	uint32		hashValue;
+} SharedMDCacheDep;
+
+extern Size SharedMDCacheShmemSize(void);
+extern void SharedMDCacheShmemInit(void);
+extern void InitSharedMDCache(void);
+
+extern bool SharedMDCacheEnabled(void);
+extern uint64 SharedMDCacheSnapshot(void);
+extern char *SharedMDCacheLookup(const char *key,
+					SharedMDCacheDep *deps, int *ndeps);
+extern void SharedMDCacheInsert(const char *key, const char *value,
+					uint64 snapshot,
+					const SharedMDCacheDep *deps, int ndeps);
+
+#endif   /* SHAREDMDCACHE_H */
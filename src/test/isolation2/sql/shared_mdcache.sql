@@ -0,0 +1,37 @@
+-- Metadata objects an ORCA session translated are shared with the other
+-- sessions through the shared MDCache, which must not hand out objects of a
+-- table that changed since.
+
+-- enable the shared MDCache and restart cluster.
+-- start_ignore
+! gpconfig -c optimizer_shared_mdcache_size -v 8192;
+! gpstop -rai;
+-- end_ignore
+
+1: SHOW optimizer_shared_mdcache_size;
+1: CREATE TABLE shared_mdcache_alter (a int, b int) DISTRIBUTED BY (a);
+1: INSERT INTO shared_mdcache_alter SELECT i, i FROM generate_series(1, 10) i;
+1: SET optimizer = on;
+1: SELECT * FROM shared_mdcache_alter WHERE a = 1;
+
+-- another session finds the metadata of the table in the shared MDCache
+2: SET optimizer = on;
+2: SELECT * FROM shared_mdcache_alter WHERE a = 1;
+2: SELECT substring(gp_opt_mdcache_stats() FROM 'shared hits: ([0-9]+)')::int > 0 AS shared_hits;
+
+-- but not once the table changed, neither in that session nor in new ones
+1: ALTER TABLE shared_mdcache_alter ADD COLUMN c int DEFAULT 7;
+2: SELECT * FROM shared_mdcache_alter WHERE a = 1;
+3: SET optimizer = on;
+3: SELECT * FROM shared_mdcache_alter WHERE a = 1;
+1: ALTER TABLE shared_mdcache_alter DROP COLUMN b;
+2: SELECT * FROM shared_mdcache_alter WHERE a = 1;
+4: SET optimizer = on;
+4: SELECT * FROM shared_mdcache_alter WHERE a = 1;
+1: DROP TABLE shared_mdcache_alter;
+
+-- reset the GUC and restart cluster.
+-- start_ignore
+! gpconfig -r optimizer_shared_mdcache_size;
+! gpstop -rai;
+-- end_ignore
@@ -0,0 +1,115 @@
+#! /usr/bin/env python
+
+'''
+Replay a directory of ORCA minidumps and report the optimization latency
+percentiles, memory pool peak and plan cost of each, using
+gpoptutils.BenchmarkMinidumpFromFile from contrib/orca_debug.
+
+The results are written as a CSV, and compared against a baseline CSV from an
+earlier run: the script fails if the median latency or the memory peak of a
+minidump grew by more than the threshold, or if its plan cost changed.
+'''
+import optparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+FIELDS = ['minidump', 'p50_ms', 'p90_ms', 'p99_ms', 'max_ms', 'memory_kb', 'cost']
+
+RESULT_RE = re.compile(r'iterations: \d+, p50: ([0-9.]+) ms, p90: ([0-9.]+) ms, '
+                       r'p99: ([0-9.]+) ms, max: ([0-9.]+) ms, '
+                       r'memory peak: (\d+) kB, cost: (\S+)$')
+
+def parse_args():
+    parser = optparse.OptionParser(usage='%prog [options] MINIDUMP_DIR')
+    parser.add_option('--iterations', type='int', default=20,
+                      help='times to optimize each minidump')
+    parser.add_option('--dbname', default=None,
+                      help='database with contrib/orca_debug installed')
+    parser.add_option('--baseline', default='minidump_baseline.csv',
+                      help='results of an earlier run to compare against')
+    parser.add_option('--threshold', type='float', default=20.0,
+                      help='allowed growth of latency and memory, in percent')
+    parser.add_option('--update-baseline', action='store_true', default=False,
+                      help='store the results as the new baseline')
+    parser.add_option('--output', default='perf_minidump_results.csv',
+                      help='file to write the results to')
+    options, args = parser.parse_args()
+    if len(args) != 1:
+        parser.error('expected the directory of the minidumps')
+    return options, args[0]
+
+def benchmark(options, path):
+    sql = "select gpoptutils.BenchmarkMinidumpFromFile('%s', %d)" % \
+        (path.replace("'", "''"), options.iterations)
+    cmd = ['psql', '-X', '-A', '-t', '-v', 'ON_ERROR_STOP=1', '-c', sql]
+    if options.dbname:
+        cmd += ['-d', options.dbname]
+    output = subprocess.check_output(cmd).decode().strip()
+    m = RESULT_RE.match(output)
+    if m is None:
+        raise Exception('failed to optimize %s: %s' % (path, output))
+    return list(m.groups())
+
+def read_results(filename):
+    results = {}
+    with open(filename, 'r') as f:
+        for line in f:
+            row = line.strip().split('|')
+            if row[0] == FIELDS[0]:
+                continue
+            results[row[0]] = row[1:]
+    return results
+
+def write_results(filename, results):
+    with open(filename, 'w') as f:
+        f.write('%s\n' % '|'.join(FIELDS))
+        for name in sorted(results):
+            f.write('%s\n' % '|'.join([name] + results[name]))
+
+def compare(results, baseline, threshold):
+    regressions = []
+    for name in sorted(results):
+        if name not in baseline:
+            continue
+        p50, memory, cost = float(results[name][0]), int(results[name][4]), results[name][5]
+        base_p50, base_memory, base_cost = float(baseline[name][0]), int(baseline[name][4]), baseline[name][5]
+        if p50 > base_p50 * (1 + threshold / 100):
+            regressions.append('%s: p50 %.3f ms, was %.3f ms' % (name, p50, base_p50))
+        if memory > base_memory * (1 + threshold / 100):
+            regressions.append('%s: memory peak %d kB, was %d kB' % (name, memory, base_memory))
+        if cost != base_cost:
+            regressions.append('%s: plan cost %s, was %s' % (name, cost, base_cost))
+    return regressions
+
+def main():
+    options, minidump_dir = parse_args()
+
+    results = {}
+    for name in sorted(os.listdir(minidump_dir)):
+        if not name.endswith('.mdp'):
+            continue
+        results[name] = benchmark(options, os.path.abspath(os.path.join(minidump_dir, name)))
+        print('%-40s p50 %10s ms  p99 %10s ms  memory %8s kB  cost %s' %
+              (name, results[name][0], results[name][2], results[name][4], results[name][5]))
+
+    write_results(options.output, results)
+
+    if options.update_baseline:
+        shutil.copyfile(options.output, options.baseline)
+        print('stored baseline in %s' % options.baseline)
+        return 0
+
+    if not os.path.exists(options.baseline):
+        print('no baseline in %s, run with --update-baseline to create one' % options.baseline)
+        return 0
+
+    regressions = compare(results, read_results(options.baseline), options.threshold)
+    for regression in regressions:
+        print('REGRESSION %s' % regression)
+    return 1 if regressions else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,26 @@
+--
+-- Plan queries with large IN-lists and VALUES lists with ORCA. Nothing is
+-- executed, so the test duration is dominated by the translation of the
+-- constants to and from DXL.
+--
+SET optimizer = on;
+SET optimizer_plan_cache_size = 0;
+CREATE TABLE optimizer_inlist (a int, b text) DISTRIBUTED BY (a);
+CREATE FUNCTION optimizer_inlist_explain(query text, iterations int) RETURNS void AS $$
+DECLARE
+	r record;
+BEGIN
+	FOR i IN 1..iterations LOOP
+		FOR r IN EXECUTE 'EXPLAIN ' || query LOOP
+		END LOOP;
+	END LOOP;
+END;
+$$ LANGUAGE plpgsql;
+-- IN-list of integers, passed by value
+SELECT optimizer_inlist_explain('SELECT * FROM optimizer_inlist WHERE a IN (' || array_to_string(ARRAY(SELECT i FROM generate_series(1, 10000) i), ',') || ')', 20);
+-- IN-list of text, passed by reference
+SELECT optimizer_inlist_explain('SELECT * FROM optimizer_inlist WHERE b IN (' || array_to_string(ARRAY(SELECT quote_literal(i::text) FROM generate_series(1, 10000) i), ',') || ')', 20);
+-- VALUES list
+SELECT optimizer_inlist_explain('SELECT * FROM (VALUES ' || array_to_string(ARRAY(SELECT '(' || i || ', ' || quote_literal(i::text) || ')' FROM generate_series(1, 2000) i), ',') || ') v(a, b)', 20);
+DROP FUNCTION optimizer_inlist_explain(text, int);
+DROP TABLE optimizer_inlist;
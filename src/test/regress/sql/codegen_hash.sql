@@ -0,0 +1,119 @@
+--
+-- Hash joins and hash aggregates must return the same results with and
+-- without code generation.  Enabling codegen fails in builds without it,
+-- and the queries then just run without it.
+--
+create table codegen_hash_r (i4 int4, i8 int8, d date, t text) distributed by (i4);
+create table codegen_hash_s (i4 int4, i8 int8, d date, t text) distributed by (t);
+insert into codegen_hash_r values
+  (1, 1, '2000-01-01', 'one'),
+  (-1, -1, '1999-12-31', 'minus one'),
+  (2, 4294967296, '1901-01-01', 'two'),
+  (-2, -4294967296, '1970-01-01', 'minus two'),
+  (null, null, null, null);
+insert into codegen_hash_s values
+  (1, 1, '2000-01-01', 'one'),
+  (-1, -1, '1999-12-31', 'minus one'),
+  (2, 4294967296, '1901-01-01', 'two'),
+  (3, 4294967297, '2017-01-01', 'three'),
+  (null, null, null, null);
+
+-- Hash join keys, with the NULL keys kept by outer joins
+set codegen = on;
+set codegen_exec_hash_get_hash_value = on;
+select r.i4, s.i4 from codegen_hash_r r left join codegen_hash_s s on r.i4 = s.i4 order by 1;
+select r.i8, s.i8 from codegen_hash_r r left join codegen_hash_s s on r.i8 = s.i8 order by 1;
+select r.t, s.t from codegen_hash_r r left join codegen_hash_s s on r.d = s.d order by 1;
+select r.t, s.t from codegen_hash_r r left join codegen_hash_s s on r.t = s.t order by 1;
+select r.i4, s.i8 from codegen_hash_r r left join codegen_hash_s s on r.i4 = s.i8 order by 1;
+
+set codegen_exec_hash_get_hash_value = off;
+select r.i4, s.i4 from codegen_hash_r r left join codegen_hash_s s on r.i4 = s.i4 order by 1;
+select r.i8, s.i8 from codegen_hash_r r left join codegen_hash_s s on r.i8 = s.i8 order by 1;
+select r.t, s.t from codegen_hash_r r left join codegen_hash_s s on r.d = s.d order by 1;
+select r.t, s.t from codegen_hash_r r left join codegen_hash_s s on r.t = s.t order by 1;
+select r.i4, s.i8 from codegen_hash_r r left join codegen_hash_s s on r.i4 = s.i8 order by 1;
+reset codegen_exec_hash_get_hash_value;
+reset codegen;
+
+-- With codegen_async_compile, the build side of a hash join switches to the
+-- compiled hash value computation while it builds the hash table.  Each
+-- inner row sleeps, so that the compilation is done before the table is.
+create function codegen_hash_slow(int) returns int as $$ select pg_sleep(0.001); select $1 $$ language sql volatile;
+create function codegen_hash_build_switched(query text) returns boolean as $$
+declare
+  r record;
+begin
+  for r in execute 'explain analyze ' || query loop
+    if r."QUERY PLAN" ~ 'Generated code hashed [1-9][0-9]* inner rows' then
+      return true;
+    end if;
+  end loop;
+  return false;
+end;
+$$ language plpgsql;
+create table codegen_hash_build (i int) distributed by (i);
+create table codegen_hash_probe (i int) distributed by (i);
+insert into codegen_hash_build select i from generate_series(1, 3000) i;
+insert into codegen_hash_probe select i from generate_series(1, 3000) i;
+analyze codegen_hash_build;
+analyze codegen_hash_probe;
+set codegen = on;
+set codegen_async_compile = on;
+select codegen_hash_build_switched('select count(*) from codegen_hash_probe p join (select i from codegen_hash_build where codegen_hash_slow(i) = i) b on p.i = b.i');
+reset codegen_async_compile;
+reset codegen;
+
+-- Hash aggregate keys, with NULL groups
+create table codegen_hash_g (i4 int4, i8 int8, d date, t text) distributed randomly;
+insert into codegen_hash_g select * from codegen_hash_r;
+insert into codegen_hash_g select * from codegen_hash_s;
+set enable_groupagg = off;
+set codegen = on;
+set codegen_agg_hash_lookup = on;
+select i4, count(*) from codegen_hash_g group by i4 order by 1;
+select i8, count(*) from codegen_hash_g group by i8 order by 1;
+select t, count(*) from codegen_hash_g group by d, t order by 1;
+select t, count(*) from codegen_hash_g group by t order by 1;
+select i4, i8, t, count(*) from codegen_hash_g group by i4, i8, d, t order by 1;
+
+set codegen_agg_hash_lookup = off;
+select i4, count(*) from codegen_hash_g group by i4 order by 1;
+select i8, count(*) from codegen_hash_g group by i8 order by 1;
+select t, count(*) from codegen_hash_g group by d, t order by 1;
+select t, count(*) from codegen_hash_g group by t order by 1;
+select i4, i8, t, count(*) from codegen_hash_g group by i4, i8, d, t order by 1;
+
+-- Hash aggregates that spill to disk
+create table codegen_hash_spill (i4 int4, i8 int8, d date, t text) distributed randomly;
+insert into codegen_hash_spill select i, i * 4294967297, '2000-01-01'::date + i, 'key ' || i from generate_series(1, 100000) i;
+insert into codegen_hash_spill select * from codegen_hash_spill;
+insert into codegen_hash_spill values (null, null, null, null), (null, null, null, null);
+set statement_mem = 1800;
+set codegen_agg_hash_lookup = on;
+select count(*), sum(c), min(c), max(c) from (select count(*) c from codegen_hash_spill group by i4) g;
+select count(*), sum(c), min(c), max(c) from (select count(*) c from codegen_hash_spill group by i8) g;
+select count(*), sum(c), min(c), max(c) from (select count(*) c from codegen_hash_spill group by d) g;
+select count(*), sum(c), min(c), max(c) from (select count(*) c from codegen_hash_spill group by t) g;
+select count(*), sum(c), min(c), max(c) from (select count(*) c from codegen_hash_spill group by i4, i8, d, t) g;
+
+set codegen_agg_hash_lookup = off;
+select count(*), sum(c), min(c), max(c) from (select count(*) c from codegen_hash_spill group by i4) g;
+select count(*), sum(c), min(c), max(c) from (select count(*) c from codegen_hash_spill group by i8) g;
+select count(*), sum(c), min(c), max(c) from (select count(*) c from codegen_hash_spill group by d) g;
+select count(*), sum(c), min(c), max(c) from (select count(*) c from codegen_hash_spill group by t) g;
+select count(*), sum(c), min(c), max(c) from (select count(*) c from codegen_hash_spill group by i4, i8, d, t) g;
+reset statement_mem;
+reset codegen_agg_hash_lookup;
+reset codegen;
+reset enable_groupagg;
+
+-- clean up
+drop table codegen_hash_r;
+drop table codegen_hash_s;
+drop table codegen_hash_g;
+drop table codegen_hash_spill;
+drop table codegen_hash_build;
+drop table codegen_hash_probe;
+drop function codegen_hash_build_switched(text);
+drop function codegen_hash_slow(int);
@@ -37,6 +37,16 @@ INSERT INTO explaintest SELECT generate_series(1, 10);
 
 EXPLAIN ANALYZE SELECT * FROM explaintest;
 
+-- ORCA's profile of the optimization. The timings and the memory peak are
+-- masked, but the counters are compared: everything was fetched into the
+-- metadata cache by the previous EXPLAIN.
+\t on
+SELECT * FROM get_explain_analyze_output($$
+    SELECT * FROM explaintest;
+  $$) as et
+WHERE et like 'Optimizer profile: %';
+\t off
+
 set explain_memory_verbosity='summary';
 
 -- The plan should consist of a Gather and a Seq Scan, with a
@@ -1,2 +1,19 @@
 select version() ~ '^PostgreSQL ([0-9]+\.){2}([0-9]+)? \(Greenplum Database ([0-9]+\.){2}[0-9]+.+' as version;
 select gp_opt_version() ~ '^(GPOPT version: ([0-9]+\.){2}[0-9]+, Xerces version: ([0-9]+\.){2}[0-9]+|Server has been compiled without ORCA)$' as version;
+select gp_opt_mdcache_stats() ~ '^(misses: [0-9]+, evictions: [0-9]+, resets: [0-9]+, shared hits: [0-9]+|Server has been compiled without ORCA)$' as mdcache_stats;
+select gp_opt_plancache_stats() ~ '^(hits: [0-9]+, misses: [0-9]+, custom plans: [0-9]+, invalidations: [0-9]+|Server has been compiled without ORCA)$' as plancache_stats;
+select gp_opt_profile() ~ '^(optimizations: [0-9]+, total: [0-9.]+ ms, query to DXL: [0-9.]+ ms, optimize: [0-9.]+ ms, DXL to plan: [0-9.]+ ms, metadata fetches: [0-9]+ [(][0-9.]+ ms[)], shared metadata hits: [0-9]+, const expr evaluations: [0-9]+ [(][0-9]+ memoized[)], memory peak: [0-9]+ kB|Server has been compiled without ORCA)$' as profile;
+select gp_codegen_module_cache_stats() ~ '^(hits: [0-9]+, misses: [0-9]+, evictions: [0-9]+, entries: [0-9]+, size: [0-9]+ kB|Server has been compiled without codegen)$' as codegen_module_cache_stats;
+
+-- Metadata cached by a session, or shared with other sessions, must not
+-- outlive changes to the table.
+create table mdcache_alter (a int, b int) distributed by (a);
+insert into mdcache_alter select i, i from generate_series(1, 10) i;
+select * from mdcache_alter where a = 1;
+\c regression
+select * from mdcache_alter where a = 1;
+alter table mdcache_alter add column c int default 7;
+select * from mdcache_alter where a = 1;
+alter table mdcache_alter drop column b;
+select * from mdcache_alter where a = 1;
+drop table mdcache_alter;
@@ -1404,6 +1404,36 @@ create table foo_ctas(a) as (select generate_series(1,10)) distributed by (a);
 reset client_min_messages;
 reset optimizer_enable_ctas;
 
+-- Stable functions are folded to constants before ORCA plans the query, so
+-- the plans of queries calling them must not be cached
+set optimizer_plan_cache_size = 100;
+create table plancache_now (t timestamptz) distributed randomly;
+insert into plancache_now select now();
+insert into plancache_now select now();
+insert into plancache_now select clock_timestamp();
+insert into plancache_now select clock_timestamp();
+select count(distinct t) from plancache_now;
+drop table plancache_now;
+
+-- Repeated queries are planned once, and their plans are dropped when a
+-- relation they read changes
+create function plancache_counter(counter text) returns bigint as $$ select substring(gp_opt_plancache_stats() from $1 || ': ([0-9]+)')::bigint $$ language sql volatile;
+create table plancache_alter (a int, b int) distributed by (a);
+insert into plancache_alter select i, i from generate_series(1, 10) i;
+create temp table plancache_counters as select plancache_counter('hits') as hits, plancache_counter('invalidations') as invalidations distributed randomly;
+select * from plancache_alter where a = 1;
+select * from plancache_alter where a = 1;
+select plancache_counter('hits') > hits as hit from plancache_counters;
+alter table plancache_alter add column c int default 7;
+select * from plancache_alter where a = 1;
+alter table plancache_alter drop column b;
+select * from plancache_alter where a = 1;
+select plancache_counter('invalidations') > invalidations as invalidated from plancache_counters;
+drop table plancache_counters;
+drop table plancache_alter;
+drop function plancache_counter(text);
+reset optimizer_plan_cache_size;
+
 -- clean up
 drop schema orca cascade;
 reset optimizer_segments;